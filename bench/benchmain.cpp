@@ -0,0 +1,121 @@
+#include "benchrunner.h"
+#include "benchscenarios.h"
+#include "features/new-tab/newtabmanager.h"
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonDocument>
+#include <QStandardPaths>
+#include <QTextStream>
+
+// mybrowser_bench: runs MainWindow on the offscreen platform and measures
+// end-to-end scenarios over the pages in tests/. See bench/README.md.
+
+namespace {
+const int EXIT_REGRESSION = 1;
+const int EXIT_USAGE = 2;
+} // namespace
+
+int main(int argc, char *argv[]) {
+  // Headless by default; an explicit QT_QPA_PLATFORM still wins
+  if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  }
+  if (!qEnvironmentVariableIsSet("QTWEBENGINE_CHROMIUM_FLAGS")) {
+    qputenv("QTWEBENGINE_CHROMIUM_FLAGS",
+            "--disable-gpu "
+            "--no-sandbox "
+            "--autoplay-policy=no-user-gesture-required "
+            "--force-device-scale-factor=1");
+  }
+  QCoreApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
+  NewTabManager::registerScheme();
+
+  QApplication app(argc, argv);
+  QApplication::setApplicationName("MyBrowserBench");
+
+  // Keep workspaces, bookmarks etc. away from the real user profile
+  QStandardPaths::setTestModeEnabled(true);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("MyBrowser end-to-end benchmark harness");
+  parser.addHelpOption();
+
+  QCommandLineOption iterationsOption("iterations", "Measured iterations per scenario.", "n", "10");
+  QCommandLineOption scenarioOption("scenario", "Run only this scenario (repeatable).", "name");
+  QCommandLineOption outputOption("output", "Write JSON results to this file instead of stdout.", "file");
+  QCommandLineOption baselineOption("baseline", "Compare against this baseline JSON and fail on regressions.", "file");
+  QCommandLineOption toleranceOption("tolerance", "Allowed relative p50 regression.", "ratio", "0.15");
+  QCommandLineOption minDeltaOption("min-delta", "Ignore regressions smaller than this many ms.", "ms", "2");
+  QCommandLineOption timeoutOption("timeout", "Per-wait timeout in ms.", "ms", "30000");
+  QCommandLineOption testsDirOption("tests-dir", "Directory with the test pages.", "dir", MYBROWSER_TESTS_DIR);
+  QCommandLineOption listOption("list", "List scenarios and exit.");
+  parser.addOptions({iterationsOption, scenarioOption, outputOption, baselineOption, toleranceOption,
+                     minDeltaOption, timeoutOption, testsDirOption, listOption});
+  parser.process(app);
+
+  QTextStream err(stderr);
+
+  QDir testsDir(parser.value(testsDirOption));
+  if (!testsDir.exists("click_test.html")) {
+    err << "Test pages not found in " << testsDir.absolutePath() << Qt::endl;
+    return EXIT_USAGE;
+  }
+
+  // Every MainWindow created by the scenarios opens a local page
+  BenchEnvironment env(testsDir, parser.value(timeoutOption).toInt());
+  qputenv("MYBROWSER_HOME_URL", env.pageUrl("click_test.html").toString().toUtf8());
+
+  QList<BenchScenario> scenarios = createScenarios(env);
+  if (parser.isSet(listOption)) {
+    QTextStream out(stdout);
+    for (const BenchScenario &scenario : scenarios) {
+      out << scenario.name << "\t" << scenario.description << Qt::endl;
+    }
+    return 0;
+  }
+
+  BenchRunner::Options options;
+  options.iterations = qMax(1, parser.value(iterationsOption).toInt());
+  options.only = parser.values(scenarioOption);
+
+  BenchRunner runner(options);
+  const QList<BenchStats> results = runner.run(scenarios);
+  const QJsonObject json = BenchRunner::resultsToJson(results);
+  const QByteArray data = QJsonDocument(json).toJson(QJsonDocument::Indented);
+
+  if (parser.isSet(outputOption)) {
+    QFile file(parser.value(outputOption));
+    if (!file.open(QIODevice::WriteOnly)) {
+      err << "Cannot write " << file.fileName() << Qt::endl;
+      return EXIT_USAGE;
+    }
+    file.write(data);
+  } else {
+    QTextStream(stdout) << data;
+  }
+
+  bool ok = true;
+  for (const BenchStats &stats : results) {
+    ok = ok && stats.error.isEmpty();
+  }
+
+  if (parser.isSet(baselineOption)) {
+    QFile baselineFile(parser.value(baselineOption));
+    if (!baselineFile.open(QIODevice::ReadOnly)) {
+      err << "Cannot read baseline " << baselineFile.fileName() << Qt::endl;
+      return EXIT_USAGE;
+    }
+
+    QStringList report;
+    const QJsonObject baseline = QJsonDocument::fromJson(baselineFile.readAll()).object();
+    ok = BenchRunner::compareWithBaseline(baseline, results, parser.value(toleranceOption).toDouble(),
+                                          parser.value(minDeltaOption).toDouble(), report) &&
+         ok;
+    for (const QString &line : report) {
+      err << line << Qt::endl;
+    }
+  }
+
+  return ok ? 0 : EXIT_REGRESSION;
+}
@@ -0,0 +1,191 @@
+#include "benchrunner.h"
+#include <QDateTime>
+#include <QSysInfo>
+#include <QTextStream>
+#include <QtGlobal>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+double percentile(const QVector<double> &sorted, double p) {
+  if (sorted.isEmpty())
+    return 0;
+
+  // Nearest-rank percentile
+  int rank = static_cast<int>(std::ceil(p / 100.0 * sorted.size()));
+  return sorted.at(qBound(0, rank - 1, sorted.size() - 1));
+}
+
+QTextStream &out() {
+  static QTextStream stream(stderr);
+  return stream;
+}
+} // namespace
+
+BenchStats BenchStats::fromSamples(const QString &name, QVector<double> samples) {
+  BenchStats stats;
+  stats.name = name;
+  stats.samples = samples.size();
+  if (samples.isEmpty())
+    return stats;
+
+  std::sort(samples.begin(), samples.end());
+  stats.min = samples.first();
+  stats.max = samples.last();
+  stats.p50 = percentile(samples, 50);
+  stats.p90 = percentile(samples, 90);
+  stats.p95 = percentile(samples, 95);
+  stats.p99 = percentile(samples, 99);
+
+  double total = 0;
+  for (double sample : samples) {
+    total += sample;
+  }
+  stats.mean = total / samples.size();
+  return stats;
+}
+
+BenchStats BenchStats::fromJson(const QString &name, const QJsonObject &json) {
+  BenchStats stats;
+  stats.name = name;
+  stats.samples = json["samples"].toInt();
+  stats.min = json["min"].toDouble();
+  stats.p50 = json["p50"].toDouble();
+  stats.p90 = json["p90"].toDouble();
+  stats.p95 = json["p95"].toDouble();
+  stats.p99 = json["p99"].toDouble();
+  stats.max = json["max"].toDouble();
+  stats.mean = json["mean"].toDouble();
+  stats.error = json["error"].toString();
+  return stats;
+}
+
+QJsonObject BenchStats::toJson() const {
+  QJsonObject json;
+  json["samples"] = samples;
+  json["min"] = min;
+  json["p50"] = p50;
+  json["p90"] = p90;
+  json["p95"] = p95;
+  json["p99"] = p99;
+  json["max"] = max;
+  json["mean"] = mean;
+  if (!error.isEmpty()) {
+    json["error"] = error;
+  }
+  return json;
+}
+
+BenchRunner::BenchRunner(const Options &options)
+    : options(options) {
+}
+
+QList<BenchStats> BenchRunner::run(const QList<BenchScenario> &scenarios) {
+  QList<BenchStats> results;
+
+  for (const BenchScenario &scenario : scenarios) {
+    if (!options.only.isEmpty() && !options.only.contains(scenario.name))
+      continue;
+
+    out() << "[bench] " << scenario.name << ": " << scenario.description << Qt::endl;
+
+    QString error;
+    if (scenario.setUp && !scenario.setUp(error)) {
+      BenchStats failed = BenchStats::fromSamples(scenario.name, {});
+      failed.error = "setUp failed: " + error;
+      out() << "[bench]   " << failed.error << Qt::endl;
+      results.append(failed);
+      continue;
+    }
+
+    const int iterations = scenario.iterations > 0 ? scenario.iterations : options.iterations;
+    QVector<double> samples;
+    samples.reserve(iterations);
+
+    for (int i = 0; i < scenario.warmup + iterations && error.isEmpty(); ++i) {
+      const double ms = scenario.run(error);
+      if (ms < 0) {
+        if (error.isEmpty()) {
+          error = "iteration failed";
+        }
+        break;
+      }
+      if (i >= scenario.warmup) {
+        samples.append(ms);
+      }
+    }
+
+    if (scenario.tearDown) {
+      scenario.tearDown();
+    }
+
+    BenchStats stats = BenchStats::fromSamples(scenario.name, samples);
+    stats.error = error;
+    if (error.isEmpty()) {
+      out() << QString("[bench]   p50 %1 ms  p90 %2 ms  max %3 ms (%4 samples)")
+                   .arg(stats.p50, 0, 'f', 2)
+                   .arg(stats.p90, 0, 'f', 2)
+                   .arg(stats.max, 0, 'f', 2)
+                   .arg(stats.samples)
+            << Qt::endl;
+    } else {
+      out() << "[bench]   failed: " << error << Qt::endl;
+    }
+    results.append(stats);
+  }
+
+  return results;
+}
+
+QJsonObject BenchRunner::resultsToJson(const QList<BenchStats> &results) {
+  QJsonObject scenarios;
+  for (const BenchStats &stats : results) {
+    scenarios[stats.name] = stats.toJson();
+  }
+
+  QJsonObject root;
+  root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+  root["qtVersion"] = QString(qVersion());
+  root["host"] = QSysInfo::machineHostName();
+  root["platform"] = QSysInfo::prettyProductName();
+  root["unit"] = "ms";
+  root["scenarios"] = scenarios;
+  return root;
+}
+
+bool BenchRunner::compareWithBaseline(const QJsonObject &baseline, const QList<BenchStats> &results,
+                                      double tolerance, double minDeltaMs, QStringList &report) {
+  const QJsonObject baselineScenarios = baseline["scenarios"].toObject();
+  bool ok = true;
+
+  for (const BenchStats &current : results) {
+    if (!current.error.isEmpty()) {
+      report << QString("FAIL %1: %2").arg(current.name, current.error);
+      ok = false;
+      continue;
+    }
+
+    if (!baselineScenarios.contains(current.name)) {
+      report << QString("NEW  %1: p50 %2 ms (no baseline)").arg(current.name).arg(current.p50, 0, 'f', 2);
+      continue;
+    }
+
+    const BenchStats base = BenchStats::fromJson(current.name, baselineScenarios[current.name].toObject());
+    const double delta = current.p50 - base.p50;
+    const double ratio = base.p50 > 0 ? delta / base.p50 : 0;
+    const bool regressed = ratio > tolerance && delta > minDeltaMs;
+
+    report << QString("%1 %2: p50 %3 ms vs %4 ms (%5%6%)")
+                  .arg(regressed ? "REGR" : "OK  ")
+                  .arg(current.name)
+                  .arg(current.p50, 0, 'f', 2)
+                  .arg(base.p50, 0, 'f', 2)
+                  .arg(ratio >= 0 ? "+" : "")
+                  .arg(ratio * 100, 0, 'f', 1);
+    if (regressed) {
+      ok = false;
+    }
+  }
+
+  return ok;
+}
@@ -0,0 +1,70 @@
+#ifndef BENCHRUNNER_H
+#define BENCHRUNNER_H
+
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+
+/**
+ * @brief One end-to-end benchmark scenario
+ *
+ * run() performs a single measured iteration and returns the latency in
+ * milliseconds, or a negative value on failure (with error set).
+ */
+struct BenchScenario {
+  QString name;
+  QString description;
+  int iterations = 0; // 0 = runner default
+  int warmup = 1;     // Unmeasured iterations before sampling
+  std::function<bool(QString &error)> setUp;
+  std::function<double(QString &error)> run;
+  std::function<void()> tearDown;
+};
+
+/**
+ * @brief Latency distribution for one scenario (milliseconds)
+ */
+struct BenchStats {
+  QString name;
+  int samples = 0;
+  double min = 0;
+  double p50 = 0;
+  double p90 = 0;
+  double p95 = 0;
+  double p99 = 0;
+  double max = 0;
+  double mean = 0;
+  QString error;
+
+  static BenchStats fromSamples(const QString &name, QVector<double> samples);
+  static BenchStats fromJson(const QString &name, const QJsonObject &json);
+  QJsonObject toJson() const;
+};
+
+class BenchRunner {
+public:
+  struct Options {
+    int iterations = 10;
+    QStringList only; // Run only these scenarios when not empty
+  };
+
+  explicit BenchRunner(const Options &options);
+
+  QList<BenchStats> run(const QList<BenchScenario> &scenarios);
+
+  static QJsonObject resultsToJson(const QList<BenchStats> &results);
+
+  // Returns false when any scenario regressed against the baseline or failed.
+  // A scenario regresses when its p50 exceeds the baseline p50 by more than
+  // tolerance (relative) and minDeltaMs (absolute, to ignore timer noise).
+  static bool compareWithBaseline(const QJsonObject &baseline, const QList<BenchStats> &results,
+                                  double tolerance, double minDeltaMs, QStringList &report);
+
+private:
+  Options options;
+};
+
+#endif // BENCHRUNNER_H
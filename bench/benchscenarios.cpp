@@ -0,0 +1,456 @@
+#include "benchscenarios.h"
+#include "features/command-palette/commandpalettedialog.h"
+#include "features/command-palette/commandpalettemanager.h"
+#include "features/main-window/mainwindow.h"
+#include "features/new-tab/newtabmanager.h"
+#include "features/picture-in-picture/pictureinpicturemanager.h"
+#include "features/tab-widget/verticaltabwidget.h"
+#include "features/webview/webview.h"
+#include "features/workspace/workspacemanager.h"
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QLineEdit>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSignalSpy>
+#include <QTest>
+#include <QWheelEvent>
+#include <memory>
+#include <vector>
+
+namespace {
+const int TABS_PER_WORKSPACE = 10;
+const int MANY_TABS = 100;
+const char *DEFAULT_PAGE = "click_test.html";
+const char *PIP_PAGE = "bench_pip.html";
+const char *SCROLL_PAGE = "scroll_jank_test.html";
+const int SCROLL_WHEEL_EVENTS = 120;
+const int SCROLL_WHEEL_INTERVAL_MS = 8; // Trackpads report at about 120Hz
+const int SCROLL_WHEEL_DELTA_PX = 40;
+
+double elapsedMs(const QElapsedTimer &timer) {
+  return timer.nsecsElapsed() / 1e6;
+}
+
+// Let deleteLater() and queued signals from the previous iteration settle
+void drainEvents() {
+  QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+  QCoreApplication::processEvents();
+}
+} // namespace
+
+BenchEnvironment::BenchEnvironment(const QDir &testsDir, int timeoutMs)
+    : testsDir(testsDir), timeoutMs(timeoutMs), sharedWindow(nullptr) {
+}
+
+BenchEnvironment::~BenchEnvironment() {
+  delete sharedWindow;
+}
+
+QUrl BenchEnvironment::pageUrl(const QString &fileName) const {
+  return QUrl::fromLocalFile(testsDir.absoluteFilePath(fileName));
+}
+
+MainWindow *BenchEnvironment::window() {
+  if (!sharedWindow) {
+    sharedWindow = new MainWindow();
+    sharedWindow->show();
+    QString error;
+    waitForLoad(sharedWindow->currentWebView(), error);
+  }
+  return sharedWindow;
+}
+
+void BenchEnvironment::resetTabs(int keep) {
+  VerticalTabWidget *tabs = window()->getTabWidget();
+  while (tabs->count() > keep) {
+    QWidget *widget = tabs->widget(tabs->count() - 1);
+    tabs->removeTab(tabs->count() - 1);
+    widget->deleteLater();
+  }
+  drainEvents();
+}
+
+// Both helpers must be called right after the navigation was started:
+// loadFinished is always delivered through the event loop, so a spy created
+// before returning to it cannot miss the signal.
+bool BenchEnvironment::waitForLoad(WebView *view, QString &error) const {
+  if (!view) {
+    error = "no web view";
+    return false;
+  }
+
+  QSignalSpy spy(view, &WebView::loadFinished);
+  if (!spy.wait(timeoutMs)) {
+    error = QString("page load timed out: %1").arg(view->url().toString());
+    return false;
+  }
+  return true;
+}
+
+bool BenchEnvironment::waitForAllTabs(QString &error, int firstIndex) const {
+  VerticalTabWidget *tabs = sharedWindow->getTabWidget();
+
+  std::vector<std::unique_ptr<QSignalSpy>> spies;
+  for (int i = firstIndex; i < tabs->count(); ++i) {
+    if (WebView *view = qobject_cast<WebView *>(tabs->widget(i))) {
+      spies.push_back(std::make_unique<QSignalSpy>(view, &WebView::loadFinished));
+    }
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+  for (const auto &spy : spies) {
+    while (spy->isEmpty()) {
+      const int remaining = timeoutMs - int(timer.elapsed());
+      if (remaining <= 0 || !spy->wait(remaining)) {
+        error = QString("%1 tabs did not finish loading").arg(tabs->count());
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool BenchEnvironment::waitForScript(WebView *view, const QString &condition, QString &error) const {
+  QElapsedTimer timer;
+  timer.start();
+
+  while (timer.elapsed() < timeoutMs) {
+    bool done = false;
+    bool result = false;
+    view->page()->runJavaScript(QString("!!(%1)").arg(condition), [&](const QVariant &value) {
+      result = value.toBool();
+      done = true;
+    });
+    while (!done && timer.elapsed() < timeoutMs) {
+      QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+    }
+    if (result)
+      return true;
+    QTest::qWait(5);
+  }
+
+  error = QString("condition not met: %1").arg(condition);
+  return false;
+}
+
+bool BenchEnvironment::evaluate(WebView *view, const QString &script, QVariant &result, QString &error) const {
+  QElapsedTimer timer;
+  timer.start();
+
+  bool done = false;
+  view->page()->runJavaScript(script, [&](const QVariant &value) {
+    result = value;
+    done = true;
+  });
+  while (!done && timer.elapsed() < timeoutMs) {
+    QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+  }
+  if (!done) {
+    error = QString("script timed out: %1").arg(script);
+  }
+  return done;
+}
+
+namespace {
+// Scrolls the page with a trackpad-like wheel gesture and returns the p95 rAF frame interval
+double measureScrollJank(BenchEnvironment &env, QString &error) {
+  WebView *view = env.window()->currentWebView();
+  QVariant ignored;
+  if (!env.evaluate(view, "window.scrollTo(0, 0); window.scrollJank.start(); true", ignored, error))
+    return -1;
+  QTest::qWait(50);
+
+  // Input reaches WebEngine through its render widget, which is the view's focus proxy
+  QWidget *target = view->focusProxy() ? view->focusProxy() : view;
+  const QPointF position = QRectF(target->rect()).center();
+  const QPointF globalPosition = target->mapToGlobal(position);
+  auto sendWheel = [&](Qt::ScrollPhase phase, int delta) {
+    QWheelEvent event(position, globalPosition, QPoint(0, delta), QPoint(0, delta * 3), Qt::NoButton, Qt::NoModifier,
+                      phase, false);
+    QCoreApplication::sendEvent(target, &event);
+  };
+
+  sendWheel(Qt::ScrollBegin, 0);
+  for (int i = 0; i < SCROLL_WHEEL_EVENTS; ++i) {
+    sendWheel(Qt::ScrollUpdate, -SCROLL_WHEEL_DELTA_PX);
+    QTest::qWait(SCROLL_WHEEL_INTERVAL_MS);
+  }
+  sendWheel(Qt::ScrollEnd, 0);
+  QTest::qWait(100); // Let the last scroll frames land
+
+  QVariant json;
+  if (!env.evaluate(view, "JSON.stringify(window.scrollJank.stop())", json, error))
+    return -1;
+  const QJsonObject stats = QJsonDocument::fromJson(json.toString().toUtf8()).object();
+  if (stats["scrollY"].toDouble() <= 0) {
+    error = "wheel events did not scroll the page";
+    return -1;
+  }
+  return stats["p95"].toDouble();
+}
+} // namespace
+
+QList<BenchScenario> createScenarios(BenchEnvironment &env) {
+  QList<BenchScenario> scenarios;
+
+  // --- Cold start: MainWindow construction to first paint of the home page
+  BenchScenario coldStart;
+  coldStart.name = "cold_start_first_paint";
+  coldStart.description = "new MainWindow until the home page reports first-paint";
+  coldStart.warmup = 0; // The first iteration also pays WebEngine process start-up
+  coldStart.run = [&env](QString &error) -> double {
+    QElapsedTimer timer;
+    timer.start();
+
+    MainWindow *window = new MainWindow();
+    window->show();
+    WebView *view = window->currentWebView();
+    bool ok = env.waitForLoad(view, error) &&
+              env.waitForScript(view, "performance.getEntriesByType('paint').length > 0", error);
+    const double ms = elapsedMs(timer);
+
+    delete window;
+    drainEvents();
+    return ok ? ms : -1;
+  };
+  scenarios.append(coldStart);
+
+  // --- New tab: newTab() until the home page finished loading
+  BenchScenario newTab;
+  newTab.name = "new_tab_latency";
+  newTab.description = "newTab() until the home page finished loading";
+  newTab.setUp = [&env](QString &) {
+    env.resetTabs();
+    return true;
+  };
+  newTab.run = [&env](QString &error) -> double {
+    MainWindow *window = env.window();
+
+    QElapsedTimer timer;
+    timer.start();
+    window->newTab();
+    bool ok = env.waitForLoad(window->currentWebView(), error);
+    const double ms = elapsedMs(timer);
+
+    env.resetTabs();
+    return ok ? ms : -1;
+  };
+  scenarios.append(newTab);
+
+  // --- Local new tab page: newTab() with mybrowser://newtab as home
+  BenchScenario newTabPage;
+  newTabPage.name = "new_tab_page";
+  newTabPage.description = "newTab() until mybrowser://newtab finished loading";
+  newTabPage.setUp = [&env](QString &) {
+    env.resetTabs();
+    return true;
+  };
+  newTabPage.run = [&env](QString &error) -> double {
+    MainWindow *window = env.window();
+    const QString homePage = window->getHomePageUrl();
+    window->setHomePageUrl(NewTabManager::newTabUrl().toString());
+
+    QElapsedTimer timer;
+    timer.start();
+    window->newTab();
+    bool ok = env.waitForLoad(window->currentWebView(), error);
+    const double ms = elapsedMs(timer);
+
+    window->setHomePageUrl(homePage);
+    env.resetTabs();
+    return ok ? ms : -1;
+  };
+  scenarios.append(newTabPage);
+
+  // --- 100 tabs: open MANY_TABS tabs and wait until every one finished
+  BenchScenario manyTabs;
+  manyTabs.name = "open_100_tabs";
+  manyTabs.description = "open 100 tabs until all of them finished loading";
+  manyTabs.iterations = 3;
+  manyTabs.warmup = 0;
+  manyTabs.run = [&env](QString &error) -> double {
+    MainWindow *window = env.window();
+    env.resetTabs();
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < MANY_TABS; ++i) {
+      window->newTab();
+    }
+    bool ok = env.waitForAllTabs(error, 1);
+    const double ms = elapsedMs(timer);
+
+    env.resetTabs();
+    return ok ? ms : -1;
+  };
+  scenarios.append(manyTabs);
+
+  // --- Workspace switch between two workspaces with TABS_PER_WORKSPACE tabs each
+  auto workspaceIds = std::make_shared<QStringList>();
+  auto switchCount = std::make_shared<int>(0);
+
+  BenchScenario workspaceSwitch;
+  workspaceSwitch.name = "workspace_switch";
+  workspaceSwitch.description = "switch between two 10-tab workspaces until all tabs loaded";
+  workspaceSwitch.setUp = [&env, workspaceIds](QString &error) {
+    MainWindow *window = env.window();
+    WorkspaceManager *workspaces = window->getWorkspaceManager();
+    const QString first = workspaces->getCurrentWorkspaceId();
+
+    env.resetTabs();
+    for (int i = 1; i < TABS_PER_WORKSPACE; ++i) {
+      window->newTab();
+    }
+    if (!env.waitForAllTabs(error, 1))
+      return false;
+
+    workspaces->createNewWorkspace("Bench");
+    const QString second = workspaces->getWorkspaceIds().last();
+    workspaces->loadWorkspace(second);
+    for (int i = 1; i < TABS_PER_WORKSPACE; ++i) {
+      window->newTab();
+    }
+    if (!env.waitForAllTabs(error))
+      return false;
+
+    *workspaceIds = {first, second};
+    return true;
+  };
+  workspaceSwitch.run = [&env, workspaceIds, switchCount](QString &error) -> double {
+    WorkspaceManager *workspaces = env.window()->getWorkspaceManager();
+    const QString target = workspaceIds->at((*switchCount)++ % 2);
+
+    QElapsedTimer timer;
+    timer.start();
+    workspaces->loadWorkspace(target);
+    bool ok = env.waitForAllTabs(error);
+    const double ms = elapsedMs(timer);
+
+    drainEvents();
+    return ok ? ms : -1;
+  };
+  workspaceSwitch.tearDown = [&env, workspaceIds]() {
+    if (!workspaceIds->isEmpty()) {
+      WorkspaceManager *workspaces = env.window()->getWorkspaceManager();
+      workspaces->loadWorkspace(workspaceIds->first());
+      workspaces->deleteWorkspace(workspaceIds->last());
+    }
+    env.resetTabs();
+  };
+  scenarios.append(workspaceSwitch);
+
+  // --- Palette: keystroke in the search field until the suggestion list is rebuilt
+  BenchScenario palette;
+  palette.name = "palette_keystroke";
+  palette.description = "keystroke in the command palette until suggestions are shown";
+  palette.setUp = [&env](QString &error) {
+    CommandPaletteManager *manager = env.window()->getCommandPaletteManager();
+    for (int i = 0; i < 50; ++i) {
+      manager->addToSearchHistory(QString("bench query %1").arg(i));
+    }
+    manager->showCommandPalette();
+    if (!manager->getCommandPaletteDialog()) {
+      error = "command palette dialog was not created";
+      return false;
+    }
+    return true;
+  };
+  palette.run = [&env](QString &error) -> double {
+    CommandPaletteDialog *dialog = env.window()->getCommandPaletteManager()->getCommandPaletteDialog();
+    QLineEdit *input = dialog->findChild<QLineEdit *>();
+    if (!input) {
+      error = "no search field";
+      return -1;
+    }
+
+    // Clear without timing and let the pending update run
+    if (!input->text().isEmpty()) {
+      QSignalSpy settle(dialog, &CommandPaletteDialog::suggestionsUpdated);
+      input->clear();
+      settle.wait(env.timeout());
+    }
+
+    QSignalSpy spy(dialog, &CommandPaletteDialog::suggestionsUpdated);
+    QElapsedTimer timer;
+    timer.start();
+    QTest::keyClicks(input, "b");
+    if (!spy.wait(env.timeout())) {
+      error = "suggestions were not updated";
+      return -1;
+    }
+    return elapsedMs(timer);
+  };
+  palette.tearDown = [&env]() {
+    if (CommandPaletteDialog *dialog = env.window()->getCommandPaletteManager()->getCommandPaletteDialog()) {
+      dialog->hide();
+    }
+  };
+  scenarios.append(palette);
+
+  // --- PiP: Image PiP action until the PiP window exists
+  BenchScenario pip;
+  pip.name = "pip_activation";
+  pip.description = "Image PiP shortcut until the PiP window is created";
+  pip.iterations = 5;
+  pip.setUp = [&env](QString &error) {
+    MainWindow *window = env.window();
+    env.resetTabs();
+    WebView *view = window->currentWebView();
+    view->load(env.pageUrl(PIP_PAGE));
+    return env.waitForLoad(view, error) &&
+           env.waitForScript(view, "document.body.dataset.ready === 'true'", error);
+  };
+  pip.run = [&env](QString &error) -> double {
+    PictureInPictureManager *pipManager = env.window()->getPictureInPictureManager();
+    QSignalSpy spy(pipManager, &PictureInPictureManager::pipWindowCreated);
+
+    QElapsedTimer timer;
+    timer.start();
+    pipManager->getImagePiPAction()->trigger();
+    if (!spy.wait(env.timeout())) {
+      error = "PiP window was not created";
+      return -1;
+    }
+    const double ms = elapsedMs(timer);
+
+    // The container PiP is created in the same script callback as the image PiP,
+    // so closing now takes both and nothing leaks into the next sample
+    drainEvents();
+    pipManager->closeAllPiP();
+    drainEvents();
+    return ms;
+  };
+  pip.tearDown = [&env]() {
+    env.window()->currentWebView()->load(env.pageUrl(DEFAULT_PAGE));
+  };
+  scenarios.append(pip);
+
+  // --- Scroll jank: the same wheel gesture with and without the old per-page wheel listener
+  for (const bool legacy : {false, true}) {
+    BenchScenario scroll;
+    scroll.name = legacy ? "scroll_wheel_legacy_listener" : "scroll_wheel_native";
+    scroll.description = legacy ? "p95 frame interval while wheel scrolling with the old swipe wheel listener"
+                                : "p95 frame interval while wheel scrolling (native swipe detection)";
+    scroll.setUp = [&env, legacy](QString &error) {
+      MainWindow *window = env.window();
+      env.resetTabs();
+      WebView *view = window->currentWebView();
+      QUrl url = env.pageUrl(SCROLL_PAGE);
+      if (legacy) {
+        url.setFragment("legacy");
+      }
+      view->load(url);
+      return env.waitForLoad(view, error) &&
+             env.waitForScript(view, "document.body.dataset.ready === 'true'", error);
+    };
+    scroll.run = [&env](QString &error) -> double { return measureScrollJank(env, error); };
+    scroll.tearDown = [&env]() {
+      env.window()->currentWebView()->load(env.pageUrl(DEFAULT_PAGE));
+    };
+    scenarios.append(scroll);
+  }
+
+  return scenarios;
+}
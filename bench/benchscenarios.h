@@ -0,0 +1,43 @@
+#ifndef BENCHSCENARIOS_H
+#define BENCHSCENARIOS_H
+
+#include "benchrunner.h"
+#include <QDir>
+#include <QList>
+#include <QUrl>
+
+class MainWindow;
+class WebView;
+
+/**
+ * @brief Shared state for the end-to-end scenarios
+ *
+ * Owns the MainWindow used by the warm scenarios. All pages come from the
+ * local tests/ directory so the benchmark never touches the network.
+ */
+class BenchEnvironment {
+public:
+  BenchEnvironment(const QDir &testsDir, int timeoutMs);
+  ~BenchEnvironment();
+
+  QUrl pageUrl(const QString &fileName) const;
+  int timeout() const { return timeoutMs; }
+
+  // Lazily created window for scenarios that do not measure startup
+  MainWindow *window();
+  void resetTabs(int keep = 1);
+
+  bool waitForLoad(WebView *view, QString &error) const;
+  bool waitForAllTabs(QString &error, int firstIndex = 0) const; // Tabs before firstIndex are already loaded
+  bool waitForScript(WebView *view, const QString &condition, QString &error) const;
+  bool evaluate(WebView *view, const QString &script, QVariant &result, QString &error) const;
+
+private:
+  QDir testsDir;
+  int timeoutMs;
+  MainWindow *sharedWindow;
+};
+
+QList<BenchScenario> createScenarios(BenchEnvironment &env);
+
+#endif // BENCHSCENARIOS_H
@@ -0,0 +1,349 @@
+#include "features/bookmark/bookmarkmanager.h"
+#include "features/command-palette/commandpalettedialog.h"
+#include "features/command-palette/commandpalettemanager.h"
+#include "features/tab-widget/verticaltabwidget.h"
+#include "features/theme/theme.h"
+#include "features/workspace/workspacemanager.h"
+#include "features/workspace/workspacesessionstore.h"
+#include "profilegenerator.h"
+#include <QApplication>
+#include <QDir>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QToolButton>
+#include <memory>
+#include <vector>
+
+// mybrowser_microbench: QBENCHMARK suite for bookmarks, workspaces, search
+// history and palette filtering at realistic data sizes, plus the cost of
+// styling a full sidebar tab list.
+//
+// MYBROWSER_BENCH_PROFILE  use an existing profile (see mybrowser_profilegen)
+// MYBROWSER_BENCH_SCALE    size factor for the generated profile (default 1)
+
+class MicroBench : public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+  void cleanupTestCase();
+
+  // Bookmarks
+  void bookmarksLoad();
+  void bookmarksSave();
+  void bookmarkLookup_data();
+  void bookmarkLookup();
+  void bookmarkTreePopulate();
+
+  // Workspaces
+  void workspaceSessionOpen();
+  void workspaceDecodeAll();
+  void workspaceSave_data();
+  void workspaceSave();
+  void workspaceLegacyJsonRead();
+  void workspaceManagerStartup();
+
+  // Search history and palette
+  void searchHistoryLoad();
+  void paletteFilter_data();
+  void paletteFilter();
+
+  // Sidebar styling
+  void tabRowsPolish_data();
+  void tabRowsPolish();
+
+private:
+  QString appDataPath() const;
+  void installProfile();
+
+  QTemporaryDir scratch;
+  QString profileDir;
+  int bookmarkCount = 0;
+  std::unique_ptr<QTemporaryDir> generatedProfile;
+  QStringList searchHistory;
+};
+
+QString MicroBench::appDataPath() const {
+  return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+}
+
+void MicroBench::installProfile() {
+  // The managers read from AppDataLocation, so copy the profile there
+  QDir appData(appDataPath());
+  appData.mkpath(".");
+  for (const QString &name : {"bookmarks.json", "workspaces.session", "workspaces.json"}) {
+    QFile::remove(appData.filePath(name));
+    QFile::copy(QDir(profileDir).filePath(name), appData.filePath(name));
+  }
+}
+
+void MicroBench::initTestCase() {
+  QStandardPaths::setTestModeEnabled(true);
+  QVERIFY(scratch.isValid());
+
+  ProfileGenerator::Options options = ProfileGenerator::scaled(qEnvironmentVariable("MYBROWSER_BENCH_SCALE", "1").toDouble());
+  profileDir = qEnvironmentVariable("MYBROWSER_BENCH_PROFILE");
+  if (profileDir.isEmpty()) {
+    generatedProfile = std::make_unique<QTemporaryDir>();
+    QVERIFY(generatedProfile->isValid());
+    profileDir = generatedProfile->path();
+
+    QString error;
+    QVERIFY2(ProfileGenerator(options).generate(profileDir, error), qPrintable(error));
+  }
+  bookmarkCount = options.bookmarks;
+
+  // Search history lives in ~/.mybrowser
+  qputenv("HOME", profileDir.toUtf8());
+  installProfile();
+
+  CommandPaletteManager manager;
+  searchHistory = manager.getSearchHistory();
+  QVERIFY(!searchHistory.isEmpty());
+}
+
+void MicroBench::cleanupTestCase() {
+  QDir(appDataPath()).removeRecursively();
+}
+
+void MicroBench::bookmarksLoad() {
+  // Managers save on destruction, so keep them alive until after the measurement
+  std::vector<std::unique_ptr<BookmarkManager>> managers;
+  QBENCHMARK {
+    managers.push_back(std::make_unique<BookmarkManager>());
+    managers.back()->loadBookmarks();
+  }
+  QVERIFY(!managers.back()->getRootItem()->children.isEmpty());
+  managers.clear();
+  installProfile();
+}
+
+void MicroBench::bookmarksSave() {
+  BookmarkManager manager;
+  manager.loadBookmarks();
+  QBENCHMARK {
+    manager.saveBookmarks();
+  }
+}
+
+void MicroBench::bookmarkLookup_data() {
+  QTest::addColumn<QString>("id");
+  QTest::newRow("first") << ProfileGenerator::bookmarkId(0);
+  QTest::newRow("middle") << ProfileGenerator::bookmarkId(bookmarkCount / 2);
+  QTest::newRow("last") << ProfileGenerator::bookmarkId(bookmarkCount - 1);
+  QTest::newRow("missing") << QString("no-such-id");
+}
+
+void MicroBench::bookmarkLookup() {
+  QFETCH(QString, id);
+
+  BookmarkManager manager;
+  manager.loadBookmarks();
+
+  BookmarkItem *found = nullptr;
+  QBENCHMARK {
+    found = manager.bookmarkById(id);
+  }
+  QCOMPARE(found != nullptr, id != "no-such-id");
+}
+
+void MicroBench::bookmarkTreePopulate() {
+  auto manager = std::make_unique<BookmarkManager>();
+  std::unique_ptr<QDockWidget> dock(manager->createBookmarkDock(nullptr)); // Loads and populates once
+
+  QBENCHMARK {
+    manager->populateTreeWidget();
+  }
+  manager.reset();
+}
+
+void MicroBench::workspaceSessionOpen() {
+  const QString path = QDir(profileDir).filePath("workspaces.session");
+  QBENCHMARK {
+    WorkspaceSessionStore store(path);
+    QList<Workspace> workspaces;
+    QString currentId;
+    QVERIFY(store.open(workspaces, currentId));
+  }
+}
+
+void MicroBench::workspaceDecodeAll() {
+  WorkspaceSessionStore store(QDir(profileDir).filePath("workspaces.session"));
+  QList<Workspace> encoded;
+  QString currentId;
+  QVERIFY(store.open(encoded, currentId));
+
+  QBENCHMARK {
+    QList<Workspace> workspaces = encoded;
+    for (Workspace &workspace : workspaces) {
+      store.decodeTabs(workspace);
+    }
+  }
+}
+
+void MicroBench::workspaceSave_data() {
+  QTest::addColumn<bool>("decoded");
+  QTest::newRow("lazy") << false;   // Untouched workspaces are copied verbatim
+  QTest::newRow("decoded") << true; // Every workspace re-encoded
+}
+
+void MicroBench::workspaceSave() {
+  QFETCH(bool, decoded);
+
+  const QString path = scratch.filePath("save.session");
+  QFile::remove(path);
+  QFile::copy(QDir(profileDir).filePath("workspaces.session"), path);
+
+  WorkspaceSessionStore store(path);
+  QList<Workspace> workspaces;
+  QString currentId;
+  QVERIFY(store.open(workspaces, currentId));
+  if (decoded) {
+    for (Workspace &workspace : workspaces) {
+      store.decodeTabs(workspace);
+    }
+  }
+
+  QBENCHMARK {
+    QVERIFY(store.save(workspaces, currentId));
+  }
+}
+
+void MicroBench::workspaceLegacyJsonRead() {
+  const QString path = QDir(profileDir).filePath("workspaces.json");
+  if (!QFile::exists(path)) {
+    QSKIP("profile has no legacy workspaces.json");
+  }
+
+  QBENCHMARK {
+    QList<Workspace> workspaces;
+    QString currentId;
+    QVERIFY(WorkspaceSessionStore::readJsonSession(path, workspaces, currentId));
+  }
+}
+
+void MicroBench::workspaceManagerStartup() {
+  std::vector<std::unique_ptr<WorkspaceManager>> managers;
+  QBENCHMARK {
+    managers.push_back(std::make_unique<WorkspaceManager>());
+  }
+  QVERIFY(!managers.back()->getWorkspaceIds().isEmpty());
+  managers.clear();
+  installProfile();
+}
+
+void MicroBench::searchHistoryLoad() {
+  std::vector<std::unique_ptr<CommandPaletteManager>> managers;
+  QBENCHMARK {
+    managers.push_back(std::make_unique<CommandPaletteManager>());
+  }
+  QCOMPARE(managers.back()->getSearchHistory().size(), searchHistory.size());
+}
+
+void MicroBench::paletteFilter_data() {
+  QTest::addColumn<QString>("query");
+  QTest::newRow("empty") << QString();
+  QTest::newRow("common") << QString("qt");        // Stops after a few matches
+  QTest::newRow("no-match") << QString("zzzz");    // Scans the whole history
+  QTest::newRow("commands") << QString(">zoom");   // Command list filtering
+}
+
+void MicroBench::paletteFilter() {
+  QFETCH(QString, query);
+
+  CommandPaletteDialog dialog;
+  dialog.setSearchHistory(searchHistory);
+  QLineEdit *input = dialog.findChild<QLineEdit *>();
+  QVERIFY(input);
+  input->setText(query); // Starts the debounce timer, which never fires here
+
+  QBENCHMARK {
+    QMetaObject::invokeMethod(&dialog, "updateSuggestions", Qt::DirectConnection);
+  }
+}
+
+namespace {
+const int SIDEBAR_TABS = 100;
+
+// The tab row as it was before TabItemDelegate: a widget per row, each part
+// with its own style sheet
+QWidget *legacyTabRow(const QString &text) {
+  QWidget *row = new QWidget();
+  row->setStyleSheet("QWidget { background-color: transparent; border-radius: 6px; }");
+  QHBoxLayout *layout = new QHBoxLayout(row);
+  layout->setContentsMargins(8, 6, 8, 6);
+
+  QLabel *icon = new QLabel();
+  icon->setFixedSize(16, 16);
+  icon->setStyleSheet("QLabel { background-color: transparent; }");
+  layout->addWidget(icon);
+
+  QLabel *label = new QLabel(text);
+  label->setStyleSheet("QLabel { color: #cccccc; font-size: 13px; background-color: transparent; }");
+  layout->addWidget(label, 1);
+
+  QToolButton *close = new QToolButton();
+  close->setText("×");
+  close->setFixedSize(20, 20);
+  close->setStyleSheet("QToolButton { border: none; color: #999999; font-weight: bold; font-size: 16px; "
+                       "background-color: transparent; border-radius: 3px; } "
+                       "QToolButton:hover { color: white; background-color: #dc3545; }");
+  layout->addWidget(close);
+  return row;
+}
+} // namespace
+
+void MicroBench::tabRowsPolish_data() {
+  QTest::addColumn<bool>("legacyRows");
+  QTest::newRow("per-widget-sheets") << true;
+  QTest::newRow("theme-delegate") << false;
+}
+
+void MicroBench::tabRowsPolish() {
+  QFETCH(bool, legacyRows);
+
+  QWidget window;
+  window.resize(1024, 768);
+  Theme::apply(&window);
+  VerticalTabWidget *tabs = new VerticalTabWidget(&window);
+  tabs->resize(window.size());
+  tabs->setTabsClosable(true);
+  window.show();
+  tabs->showSidebar();
+  QListWidget *list = tabs->getTabList();
+
+  // Add, style and paint a full tab list, then tear it down again
+  QBENCHMARK {
+    for (int i = 0; i < SIDEBAR_TABS; ++i) {
+      const QString title = QString("Tab %1").arg(i);
+      tabs->addTab(new QWidget(), title);
+      if (legacyRows) {
+        list->setItemWidget(list->item(i), legacyTabRow(title));
+      }
+    }
+    QVERIFY(!list->grab().isNull());
+    while (tabs->count() > 0) {
+      QWidget *page = tabs->widget(0);
+      tabs->removeTab(0);
+      delete page;
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  }
+  QCoreApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
+  QApplication app(argc, argv);
+  QApplication::setApplicationName("MyBrowserMicroBench");
+
+  MicroBench bench;
+  return QTest::qExec(&bench, argc, argv);
+}
+
+#include "microbench.moc"
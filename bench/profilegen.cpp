@@ -0,0 +1,59 @@
+#include "profilegenerator.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+// mybrowser_profilegen: writes a synthetic profile for mybrowser_microbench
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("mybrowser_profilegen");
+
+  ProfileGenerator::Options defaults;
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Generate a synthetic MyBrowser profile");
+  parser.addHelpOption();
+  parser.addPositionalArgument("directory", "Output directory.");
+
+  QCommandLineOption bookmarksOption("bookmarks", "Number of bookmarks.", "n", QString::number(defaults.bookmarks));
+  QCommandLineOption depthOption("folder-depth", "Bookmark folder depth.", "n", QString::number(defaults.folderDepth));
+  QCommandLineOption fanoutOption("folder-fanout", "Sub-folders per folder.", "n", QString::number(defaults.folderFanout));
+  QCommandLineOption workspacesOption("workspaces", "Number of workspaces.", "n", QString::number(defaults.workspaces));
+  QCommandLineOption tabsOption("tabs", "Tabs per workspace.", "n", QString::number(defaults.tabsPerWorkspace));
+  QCommandLineOption historyOption("history", "Search history entries.", "n", QString::number(defaults.historyEntries));
+  QCommandLineOption seedOption("seed", "Random seed.", "n", QString::number(defaults.seed));
+  QCommandLineOption noLegacyOption("no-legacy-json", "Do not write workspaces.json.");
+  parser.addOptions({bookmarksOption, depthOption, fanoutOption, workspacesOption, tabsOption, historyOption,
+                     seedOption, noLegacyOption});
+  parser.process(app);
+
+  QTextStream err(stderr);
+  if (parser.positionalArguments().size() != 1) {
+    parser.showHelp(2);
+  }
+
+  ProfileGenerator::Options options;
+  options.bookmarks = parser.value(bookmarksOption).toInt();
+  options.folderDepth = parser.value(depthOption).toInt();
+  options.folderFanout = qMax(1, parser.value(fanoutOption).toInt());
+  options.workspaces = parser.value(workspacesOption).toInt();
+  options.tabsPerWorkspace = parser.value(tabsOption).toInt();
+  options.historyEntries = parser.value(historyOption).toInt();
+  options.seed = parser.value(seedOption).toUInt();
+  options.legacyJson = !parser.isSet(noLegacyOption);
+
+  QElapsedTimer timer;
+  timer.start();
+
+  QString error;
+  const QString directory = parser.positionalArguments().first();
+  if (!ProfileGenerator(options).generate(directory, error)) {
+    err << "Error: " << error << Qt::endl;
+    return 1;
+  }
+
+  err << "Profile written to " << directory << " in " << timer.elapsed() << " ms" << Qt::endl;
+  return 0;
+}
@@ -0,0 +1,183 @@
+#include "profilegenerator.h"
+#include "features/workspace/workspacemanager.h"
+#include "features/workspace/workspacesessionstore.h"
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QVector>
+#include <functional>
+
+namespace {
+const char *WORDS[] = {"qt", "webengine", "browser", "tabs", "workspace", "bookmark", "video", "news",
+                       "weather", "recipe", "travel", "docs", "github", "release", "performance", "cache",
+                       "パフォーマンス", "ニュース", "天気", "レシピ"};
+const int WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+QString word(QRandomGenerator &rng) {
+  return QString::fromUtf8(WORDS[rng.bounded(WORD_COUNT)]);
+}
+
+QString randomUrl(QRandomGenerator &rng, int n) {
+  return QString("https://%1.example.com/%2/%3?id=%4").arg(word(rng), word(rng), word(rng)).arg(n);
+}
+
+QString randomTitle(QRandomGenerator &rng, int n) {
+  return QString("%1 %2 %3 #%4").arg(word(rng), word(rng), word(rng)).arg(n);
+}
+
+bool writeFile(const QString &path, const QByteArray &data, QString &error) {
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly)) {
+    error = QString("cannot write %1: %2").arg(path, file.errorString());
+    return false;
+  }
+  file.write(data);
+  return true;
+}
+} // namespace
+
+ProfileGenerator::ProfileGenerator(const Options &options)
+    : options(options) {
+}
+
+ProfileGenerator::Options ProfileGenerator::scaled(double factor) {
+  Options options;
+  options.bookmarks = qMax(1, int(options.bookmarks * factor));
+  options.workspaces = qMax(1, int(options.workspaces * factor));
+  options.tabsPerWorkspace = qMax(1, int(options.tabsPerWorkspace * factor));
+  options.historyEntries = qMax(1, int(options.historyEntries * factor));
+  if (factor < 1.0) {
+    options.folderDepth = qMax(1, options.folderDepth / 2);
+  }
+  return options;
+}
+
+bool ProfileGenerator::generate(const QString &directory, QString &error) const {
+  QDir dir(directory);
+  if (!dir.mkpath(".") || !dir.mkpath(".mybrowser")) {
+    error = QString("cannot create %1").arg(directory);
+    return false;
+  }
+
+  return writeBookmarks(dir.filePath("bookmarks.json"), error) &&
+         writeWorkspaces(directory, error) &&
+         writeHistory(dir.filePath(".mybrowser/search_history.txt"), error);
+}
+
+bool ProfileGenerator::writeBookmarks(const QString &path, QString &error) const {
+  QRandomGenerator rng(options.seed);
+
+  // Spread the bookmarks over the leaf folders of a fanout^depth tree
+  int leafCount = 1;
+  for (int i = 0; i < options.folderDepth; ++i) {
+    leafCount *= options.folderFanout;
+  }
+  QVector<QJsonArray> leaves(leafCount);
+  for (int n = 0; n < options.bookmarks; ++n) {
+    QJsonObject bookmark;
+    bookmark["id"] = bookmarkId(n);
+    bookmark["title"] = randomTitle(rng, n);
+    bookmark["url"] = randomUrl(rng, n);
+    bookmark["isFolder"] = false;
+    leaves[n % leafCount].append(bookmark);
+  }
+
+  int folderCounter = 0;
+  int leafIndex = 0;
+  std::function<QJsonObject(int)> makeFolder = [&](int depth) {
+    QJsonObject folder;
+    folder["id"] = QString("folder-%1").arg(folderCounter);
+    folder["title"] = QString("Folder %1").arg(folderCounter);
+    folder["url"] = QString();
+    folder["isFolder"] = true;
+    ++folderCounter;
+
+    if (depth == options.folderDepth) {
+      folder["children"] = leaves[leafIndex++];
+    } else {
+      QJsonArray children;
+      for (int i = 0; i < options.folderFanout; ++i) {
+        children.append(makeFolder(depth + 1));
+      }
+      folder["children"] = children;
+    }
+    return folder;
+  };
+
+  // The root object itself is not a folder entry, so start one level down
+  QJsonArray rootChildren;
+  if (options.folderDepth == 0) {
+    rootChildren = leaves.first();
+  } else {
+    for (int i = 0; i < options.folderFanout; ++i) {
+      rootChildren.append(makeFolder(1));
+    }
+  }
+
+  QJsonObject root;
+  root["children"] = rootChildren;
+  return writeFile(path, QJsonDocument(root).toJson(QJsonDocument::Compact), error);
+}
+
+bool ProfileGenerator::writeWorkspaces(const QString &directory, QString &error) const {
+  QRandomGenerator rng(options.seed + 1);
+
+  QList<Workspace> workspaces;
+  workspaces.reserve(options.workspaces);
+  for (int w = 0; w < options.workspaces; ++w) {
+    Workspace workspace(QString("Workspace %1").arg(w), QString("ws-%1").arg(w));
+    workspace.activeTabIndex = options.tabsPerWorkspace > 0 ? rng.bounded(options.tabsPerWorkspace) : 0;
+    for (int t = 0; t < options.tabsPerWorkspace; ++t) {
+      workspace.tabUrls.append(randomUrl(rng, t));
+      workspace.tabTitles.append(randomTitle(rng, t));
+    }
+    workspaces.append(workspace);
+  }
+  const QString currentId = workspaces.isEmpty() ? QString() : workspaces.first().id;
+
+  QDir dir(directory);
+  QFile::remove(dir.filePath("workspaces.session"));
+  WorkspaceSessionStore store(dir.filePath("workspaces.session"));
+  if (!store.save(workspaces, currentId)) {
+    error = "cannot write workspaces.session";
+    return false;
+  }
+
+  if (!options.legacyJson)
+    return true;
+
+  QJsonArray workspaceArray;
+  for (const Workspace &workspace : workspaces) {
+    QJsonObject obj;
+    obj["name"] = workspace.name;
+    obj["id"] = workspace.id;
+    obj["activeTabIndex"] = workspace.activeTabIndex;
+    obj["tabUrls"] = QJsonArray::fromStringList(workspace.tabUrls);
+    obj["tabTitles"] = QJsonArray::fromStringList(workspace.tabTitles);
+    workspaceArray.append(obj);
+  }
+  QJsonObject root;
+  root["currentWorkspaceId"] = currentId;
+  root["workspaces"] = workspaceArray;
+  return writeFile(dir.filePath("workspaces.json"), QJsonDocument(root).toJson(QJsonDocument::Compact), error);
+}
+
+bool ProfileGenerator::writeHistory(const QString &path, QString &error) const {
+  QRandomGenerator rng(options.seed + 2);
+
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    error = QString("cannot write %1: %2").arg(path, file.errorString());
+    return false;
+  }
+
+  QTextStream out(&file);
+  for (int n = 0; n < options.historyEntries; ++n) {
+    out << word(rng) << ' ' << word(rng) << ' ' << n << '\n';
+  }
+  return true;
+}
@@ -0,0 +1,48 @@
+#ifndef PROFILEGENERATOR_H
+#define PROFILEGENERATOR_H
+
+#include <QString>
+
+/**
+ * @brief Writes synthetic user profiles for the microbenchmarks
+ *
+ * Produces the same files the browser reads at runtime:
+ * - bookmarks.json          (nested folders, ids "bm-<n>" / "folder-<n>")
+ * - workspaces.session      (binary session, see WorkspaceSessionStore)
+ * - workspaces.json         (legacy format, for migration benchmarks)
+ * - .mybrowser/search_history.txt
+ *
+ * Output is deterministic for a given seed.
+ */
+class ProfileGenerator {
+public:
+  struct Options {
+    int bookmarks = 100000;
+    int folderDepth = 6;
+    int folderFanout = 4;
+    int workspaces = 50;
+    int tabsPerWorkspace = 200;
+    int historyEntries = 1000000;
+    bool legacyJson = true;
+    quint32 seed = 42;
+  };
+
+  explicit ProfileGenerator(const Options &options);
+
+  // Shrink every size by factor (e.g. 0.01 for smoke runs)
+  static Options scaled(double factor);
+
+  bool generate(const QString &directory, QString &error) const;
+
+  // Id of the n-th generated bookmark, for lookup benchmarks
+  static QString bookmarkId(int n) { return QString("bm-%1").arg(n); }
+
+private:
+  bool writeBookmarks(const QString &path, QString &error) const;
+  bool writeWorkspaces(const QString &directory, QString &error) const;
+  bool writeHistory(const QString &path, QString &error) const;
+
+  Options options;
+};
+
+#endif // PROFILEGENERATOR_H
@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""Minimal client for the MyBrowser automation socket (JSON-RPC 2.0).
+
+Start the browser with the endpoint enabled, then send calls or follow
+events:
+
+    ./build/MyBrowser --automation mybrowser-test
+    python3 scripts/automation_client.py mybrowser-test tabs.list
+    python3 scripts/automation_client.py mybrowser-test tabs.navigate '{"url": "https://example.com", "wait": true}'
+    python3 scripts/automation_client.py mybrowser-test --events tab.loadFinished perf.metrics
+
+--soak N opens N background tabs, loads them all at once with pipelined
+requests and prints when each finished, as a starting point for load tests.
+"""
+
+import argparse
+import itertools
+import json
+import os
+import socket
+import sys
+import tempfile
+import time
+
+
+class Client:
+    def __init__(self, name):
+        # QLocalServer puts plain names in the temp directory on Unix
+        path = name if os.path.isabs(name) else os.path.join(tempfile.gettempdir(), name)
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.connect(path)
+        self.reader = self.sock.makefile("r", encoding="utf-8")
+        self.ids = itertools.count(1)
+        self.pending = {}
+        self.arrived = {}  # Request id -> time.monotonic() when its reply was read
+
+    def send(self, method, params=None):
+        request_id = next(self.ids)
+        message = {"jsonrpc": "2.0", "id": request_id, "method": method}
+        if params is not None:
+            message["params"] = params
+        self.sock.sendall((json.dumps(message) + "\n").encode("utf-8"))
+        return request_id
+
+    def read(self):
+        line = self.reader.readline()
+        if not line:
+            raise ConnectionError("browser closed the connection")
+        return json.loads(line)
+
+    def wait(self, request_id):
+        # Replies can arrive out of order; keep the others for their callers
+        while request_id not in self.pending:
+            message = self.read()
+            if "id" in message:
+                self.pending[message["id"]] = message
+                self.arrived[message["id"]] = time.monotonic()
+        message = self.pending.pop(request_id)
+        if "error" in message:
+            raise RuntimeError(message["error"]["message"])
+        return message["result"]
+
+    def call(self, method, params=None):
+        return self.wait(self.send(method, params))
+
+
+def soak(client, url, count):
+    tabs = [client.call("tabs.open", {"url": "about:blank", "background": True}) for _ in range(count)]
+
+    # Pipelined: every navigation goes out before the first answer comes back
+    start = time.monotonic()
+    requests = {client.send("tabs.navigate", {"id": tab["id"], "url": url, "wait": True}): tab for tab in tabs}
+    times = []
+    for request_id, tab in requests.items():
+        result = client.wait(request_id)
+        times.append((client.arrived.pop(request_id) - start) * 1000)
+        print(f"tab {tab['id']}: {'ok' if result['ok'] else 'failed'} after {times[-1]:.0f} ms")
+
+    for tab in tabs:
+        client.send("tabs.close", {"id": tab["id"]})
+    client.call("browser.ping")
+    times.sort()
+    print(f"{count} loads: p50 {times[len(times) // 2]:.0f} ms, max {times[-1]:.0f} ms")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("name", help="socket name given to --automation")
+    parser.add_argument("method", nargs="?", help="method to call, e.g. tabs.list")
+    parser.add_argument("params", nargs="?", help="params as a JSON object")
+    parser.add_argument("--events", nargs="+", metavar="TYPE", help="print these events until interrupted")
+    parser.add_argument("--soak", type=int, metavar="N", help="open, load and close N tabs")
+    parser.add_argument("--url", default="https://example.com/", help="page for --soak")
+    args = parser.parse_args()
+
+    client = Client(args.name)
+    if args.soak:
+        soak(client, args.url, args.soak)
+    elif args.events:
+        client.call("events.subscribe", {"events": args.events})
+        while True:
+            message = client.read()
+            if message.get("method") == "event":
+                print(json.dumps(message["params"]), flush=True)
+    elif args.method:
+        params = json.loads(args.params) if args.params else None
+        print(json.dumps(client.call(args.method, params), indent=2, ensure_ascii=False))
+    else:
+        parser.print_usage()
+        return 2
+    return 0
+
+
+if __name__ == "__main__":
+    try:
+        sys.exit(main())
+    except KeyboardInterrupt:
+        sys.exit(130)
@@ -19,7 +19,7 @@ make -j$(nproc 2>/dev/null || sysctl -n hw.ncpu 2>/dev/null || echo 4)
 if [ $? -eq 0 ]; then
     echo "✅ Release build completed successfully!"
     echo "📍 Executable: ./build/MyBrowser"
-    echo "🏠 Homepage: https://www.google.com"
+    echo "🏠 Homepage: mybrowser://newtab"
     echo "📊 Logging: Minimal logging (errors only)"
 else
     echo "❌ Build failed!"
@@ -0,0 +1,38 @@
+#!/bin/bash
+# Runs mybrowser_microbench and appends the results to a history CSV
+#
+# Usage: ./scripts/run_microbench.sh [build-dir] [extra QTest arguments...]
+
+BUILD_DIR="${1:-build-bench}"
+shift
+HISTORY="${MICROBENCH_HISTORY:-bench/results/microbench_history.csv}"
+BINARY="$BUILD_DIR/mybrowser_microbench"
+
+if [ ! -x "$BINARY" ]; then
+    echo "❌ $BINARY not found. Configure with -DMYBROWSER_BUILD_BENCHMARKS=ON first."
+    exit 1
+fi
+
+mkdir -p "$(dirname "$HISTORY")"
+if [ ! -f "$HISTORY" ]; then
+    echo "timestamp,revision,function,tag,metric,value,iterations,total" > "$HISTORY"
+fi
+
+TIMESTAMP=$(date -u +%Y-%m-%dT%H:%M:%SZ)
+REVISION=$(git rev-parse --short HEAD 2>/dev/null || echo unknown)
+OUTPUT=$(mktemp)
+trap 'rm -f "$OUTPUT"' EXIT
+
+echo "Running microbenchmarks ($REVISION)..."
+QT_QPA_PLATFORM=offscreen "$BINARY" -csv -o "$OUTPUT,csv" "$@"
+STATUS=$?
+
+# QTest CSV rows: "function","tag","metric",value,iterations,total
+grep '^"' "$OUTPUT" | sed "s/^/$TIMESTAMP,$REVISION,/" >> "$HISTORY"
+
+if [ $STATUS -eq 0 ]; then
+    echo "✅ Results appended to $HISTORY"
+else
+    echo "❌ Microbenchmarks failed (exit $STATUS)"
+fi
+exit $STATUS
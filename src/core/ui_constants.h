@@ -1,33 +1,89 @@
 #ifndef UI_CONSTANTS_H
 #define UI_CONSTANTS_H
 
-#include <QString>
+#include <QRgb>
 
+// Design tokens. Theme turns the colors into the application style sheet
+// (see theme.qss) and delegates paint with them directly. constexpr values
+// cost nothing per translation unit, unlike QString globals.
 namespace UIConstants {
 // Color scheme
-const QString PRIMARY_COLOR = "#007ACC";
-const QString PRIMARY_HOVER = "#005a9e";
-const QString PRIMARY_PRESSED = "#004578";
-const QString DANGER_COLOR = "#dc3545";
-const QString DANGER_HOVER = "#c82333";
-const QString DANGER_PRESSED = "#bd2130";
+constexpr QRgb PRIMARY_COLOR = 0xff007acc;
+constexpr QRgb PRIMARY_HOVER = 0xff005a9e;
+constexpr QRgb PRIMARY_PRESSED = 0xff004578;
+constexpr QRgb DANGER_COLOR = 0xffdc3545;
+constexpr QRgb DANGER_HOVER = 0xffc82333;
+constexpr QRgb DANGER_PRESSED = 0xffbd2130;
 
 // Background colors
-const QString DARK_BG = "#2d2d30";
-const QString LIGHT_BG = "#f8f9fa";
-const QString WHITE_BG = "#ffffff";
-const QString BORDER_COLOR = "#d1d5db";
+constexpr QRgb DARK_BG = 0xff2d2d30;
+constexpr QRgb DARK_BORDER = 0xff3e3e42;
+constexpr QRgb LIGHT_BG = 0xfff8f9fa;
+constexpr QRgb LIGHT_BG_END = 0xffe9ecef; // Bottom of toolbar gradients
+constexpr QRgb WHITE_BG = 0xffffffff;
+constexpr QRgb BORDER_COLOR = 0xffd1d5db;
+constexpr QRgb BORDER_STRONG = 0xffadb5bd;
+constexpr QRgb DISABLED_BG = 0xff6c757d;
 
-// Typography
-const QString DEFAULT_FONT_SIZE = "13px";
-const QString LARGE_FONT_SIZE = "14px";
-const QString SMALL_FONT_SIZE = "12px";
+// Text
+constexpr QRgb TEXT_COLOR = 0xff2d2d30;
+constexpr QRgb TEXT_SECONDARY = 0xff495057;
+constexpr QRgb TEXT_MUTED = 0xff6b7280;
+
+// Sidebar (dark overlay)
+constexpr QRgb SIDEBAR_BG = 0xfa232326;
+constexpr QRgb SIDEBAR_BORDER = 0xc846464c;
+constexpr QRgb SIDEBAR_CONTROL_BG = 0x14ffffff;
+constexpr QRgb SIDEBAR_CONTROL_HOVER = 0x1fffffff;
+constexpr QRgb SIDEBAR_CONTROL_PRESSED = 0x29ffffff;
+constexpr QRgb SIDEBAR_CONTROL_BORDER = 0x66a0a0a0;
+constexpr QRgb SIDEBAR_TEXT = 0xffc8c8c8;
+constexpr QRgb SIDEBAR_TEXT_HOVER = 0xffe6e6e6;
+constexpr QRgb SIDEBAR_TEXT_ACTIVE = 0xffffffff;
+constexpr QRgb SIDEBAR_PLACEHOLDER = 0xcca0a0a0;
+constexpr QRgb SIDEBAR_ROW_HOVER = 0x08ffffff;
+constexpr QRgb SIDEBAR_ROW_SELECTED = 0x0dffffff;
+constexpr QRgb SIDEBAR_CLOSE = 0xff999999;
+constexpr QRgb SIDEBAR_FOCUS = 0xcc007acc;
+constexpr QRgb SIDEBAR_ACCENT_HOVER = 0x99007acc;
+constexpr QRgb SIDEBAR_SUBTLE_BG = 0x1affffff;   // Bookmark panel and workspace controls
+constexpr QRgb SIDEBAR_SUBTLE_HOVER = 0x33ffffff;
+constexpr QRgb SIDEBAR_SUBTLE_BORDER = 0x4dffffff;
+constexpr QRgb SIDEBAR_TEXT_DIM = 0xb3ffffff;
+constexpr QRgb SIDEBAR_HEADING = 0xe6ffffff;
+
+// Command palette
+constexpr QRgb PALETTE_BG = 0xf0191919;
+constexpr QRgb PALETTE_BORDER = 0x26ffffff;
+constexpr QRgb PALETTE_INPUT_BG = 0x14ffffff;
+constexpr QRgb PALETTE_INPUT_FOCUS_BG = 0x1fffffff;
+constexpr QRgb PALETTE_INPUT_BORDER = 0x1fffffff;
+constexpr QRgb PALETTE_TEXT = 0xd9ffffff;
+constexpr QRgb PALETTE_PLACEHOLDER = 0x80ffffff;
+constexpr QRgb PALETTE_HINT = 0x66ffffff;
+constexpr QRgb PALETTE_ACCENT_HOVER = 0x26007aff;
+constexpr QRgb PALETTE_ACCENT_SELECTED = 0x66007aff;
+constexpr QRgb PALETTE_ACCENT_FOCUS = 0x99007aff;
+
+// Performance HUD
+constexpr QRgb HUD_BG = 0xd2111827;
+constexpr QRgb HUD_TEXT = 0xffe5e7eb;
+
+// Network waterfall phases
+constexpr QRgb NETWORK_BLOCKED = 0xffc4c9d0;
+constexpr QRgb NETWORK_DNS = 0xff14b8a6;
+constexpr QRgb NETWORK_CONNECT = 0xfff59e0b;
+constexpr QRgb NETWORK_WAIT = 0xff22c55e;
+constexpr QRgb NETWORK_RECEIVE = 0xff007acc;
+constexpr QRgb NETWORK_UNTIMED = 0xff9ca3af; // Requests without Resource Timing data
 
 // Dimensions
-const int TAB_WIDGET_WIDTH = 250;
-const int TAB_ITEM_HEIGHT = 40;
-const int BUTTON_PADDING = 8;
-const int BORDER_RADIUS = 6;
+constexpr int SIDEBAR_WIDTH = 280;
+constexpr int TAB_WIDGET_WIDTH = 250;
+constexpr int TAB_ITEM_HEIGHT = 40;
+constexpr int TAB_ICON_SIZE = 16;
+constexpr int BUTTON_PADDING = 8;
+constexpr int BORDER_RADIUS = 6;
 } // namespace UIConstants
 
 #endif // UI_CONSTANTS_H
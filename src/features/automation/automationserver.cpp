@@ -0,0 +1,676 @@
+#include "automationserver.h"
+#include "../bookmark/bookmarkmanager.h"
+#include "../jobs/jobscheduler.h"
+#include "../logging/logcategories.h"
+#include "../main-window/mainwindow.h"
+#include "../media-governor/mediagovernor.h"
+#include "../page-events/pageeventbus.h"
+#include "../page-events/pagescriptrunner.h"
+#include "../performance-hud/performancehudmanager.h"
+#include "../performance-hud/performancestore.h"
+#include "../picture-in-picture/pictureinpicturemanager.h"
+#include "../single-instance/singleinstance.h"
+#include "../tab-widget/verticaltabwidget.h"
+#include "../webview/webview.h"
+#include "../workspace/workspacemanager.h"
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QWebEngineLoadingInfo>
+#include <QWebEngineScript>
+#include <memory>
+
+namespace {
+const qint64 MAX_LINE_SIZE = 4 * 1024 * 1024; // A client that sends more without a newline is dropped
+const char *ALL_EVENTS = "*";
+
+// Navigation and paint timings of the page, independent of the performance HUD
+const char *TIMINGS_SCRIPT = R"((function () {
+  const nav = performance.getEntriesByType("navigation")[0];
+  return {
+    timeOrigin: performance.timeOrigin,
+    navigation: nav ? nav.toJSON() : null,
+    paint: performance.getEntriesByType("paint").map(function (e) {
+      return { name: e.name, startTime: e.startTime };
+    }),
+    resourceCount: performance.getEntriesByType("resource").length,
+  };
+})())";
+
+QJsonObject metricsToJson(const PageMetrics &metrics) {
+  QJsonObject json;
+  json["url"] = metrics.url;
+  json["ttfb"] = metrics.ttfb;
+  json["domContentLoaded"] = metrics.domContentLoaded;
+  json["loadEvent"] = metrics.loadEvent;
+  json["lcp"] = metrics.lcp;
+  json["longTaskCount"] = metrics.longTaskCount;
+  json["longTaskTotal"] = metrics.longTaskTotal;
+  json["frames"] = metrics.frames;
+  json["jankFrames"] = metrics.jankFrames;
+  json["maxFrameGap"] = metrics.maxFrameGap;
+  json["resourceCount"] = metrics.resourceCount;
+  json["cacheHits"] = metrics.cacheHits;
+  return json;
+}
+
+QString lifecycleName(QWebEnginePage::LifecycleState state) {
+  switch (state) {
+  case QWebEnginePage::LifecycleState::Active:
+    return "active";
+  case QWebEnginePage::LifecycleState::Frozen:
+    return "frozen";
+  case QWebEnginePage::LifecycleState::Discarded:
+    return "discarded";
+  }
+  return QString();
+}
+
+QJsonObject bookmarkToJson(const BookmarkItem *item) {
+  QJsonObject json;
+  json["id"] = item->id;
+  json["title"] = item->title;
+  if (item->isFolder) {
+    QJsonArray children;
+    for (const BookmarkItem *child : item->children) {
+      children.append(bookmarkToJson(child));
+    }
+    json["children"] = children;
+  } else {
+    json["url"] = item->url;
+  }
+  return json;
+}
+} // namespace
+
+void AutomationReply::result(const QJsonValue &value) const {
+  // Notifications get no reply
+  if (!server || id.isUndefined())
+    return;
+  QJsonObject message;
+  message["jsonrpc"] = "2.0";
+  message["id"] = id;
+  message["result"] = value;
+  server->send(session, message);
+}
+
+void AutomationReply::error(int code, const QString &message) const {
+  if (!server || id.isUndefined())
+    return;
+  QJsonObject error;
+  error["code"] = code;
+  error["message"] = message;
+  QJsonObject response;
+  response["jsonrpc"] = "2.0";
+  response["id"] = id;
+  response["error"] = error;
+  server->send(session, response);
+}
+
+AutomationServer::AutomationServer(MainWindow *window)
+    : QObject(window), mainWindow(window), server(nullptr), nextSessionId(1) {
+  VerticalTabWidget *tabs = mainWindow->getTabWidget();
+  for (int i = 0; i < tabs->count(); ++i) {
+    if (WebView *view = qobject_cast<WebView *>(tabs->widget(i))) {
+      watch(view);
+    }
+  }
+  connect(mainWindow, &MainWindow::tabCreated, this, [this](WebView *view) {
+    watch(view);
+    broadcast("tab.created", {{"id", view->tabId()}});
+  });
+  connect(tabs, &VerticalTabWidget::currentChanged, this, [this, tabs](int index) {
+    if (WebView *view = qobject_cast<WebView *>(tabs->widget(index))) {
+      broadcast("tab.activated", {{"id", view->tabId()}});
+    }
+  });
+
+  WorkspaceManager *workspaces = mainWindow->getWorkspaceManager();
+  connect(workspaces, &WorkspaceManager::workspaceChanged, this, [this, workspaces](const QString &id) {
+    broadcast("workspace.changed", {{"id", id}, {"name", workspaces->getCurrentWorkspaceName()}});
+  });
+
+  PerformanceStore *store = mainWindow->getPerformanceHudManager()->getStore();
+  connect(store, &PerformanceStore::tabMetricsChanged, this, [this, store](int tabId) {
+    broadcast("perf.metrics", {{"id", tabId}, {"metrics", metricsToJson(store->tabMetrics(tabId))}});
+  });
+}
+
+AutomationServer::~AutomationServer() {
+  for (const Session &session : std::as_const(sessions)) {
+    if (session.socket) {
+      session.socket->disconnect(this);
+    }
+  }
+}
+
+bool AutomationServer::listen(const QString &name) {
+  server = new QLocalServer(this);
+  server->setSocketOptions(QLocalServer::UserAccessOption);
+  if (!server->listen(name)) {
+    // Never take the name from a process that is still using it
+    if (SingleInstance::isServing(name)) {
+      qCWarning(lcAutomation) << "AutomationServer:" << name << "is in use by another process";
+      return false;
+    }
+    // A socket file left by an earlier run
+    QLocalServer::removeServer(name);
+    if (!server->listen(name)) {
+      qCWarning(lcAutomation) << "AutomationServer: cannot listen on" << name << server->errorString();
+      return false;
+    }
+  }
+  connect(server, &QLocalServer::newConnection, this, &AutomationServer::onNewConnection);
+  qCInfo(lcAutomation) << "AutomationServer: listening on" << server->fullServerName();
+  return true;
+}
+
+const QHash<QString, AutomationServer::Handler> &AutomationServer::methods() {
+  static const QHash<QString, Handler> table = {
+      {"browser.ping", &AutomationServer::ping},
+      {"browser.stats", &AutomationServer::stats},
+      {"events.subscribe", &AutomationServer::subscribe},
+      {"events.unsubscribe", &AutomationServer::unsubscribe},
+      {"tabs.list", &AutomationServer::listTabs},
+      {"tabs.open", &AutomationServer::openTab},
+      {"tabs.close", &AutomationServer::closeTab},
+      {"tabs.activate", &AutomationServer::activateTab},
+      {"tabs.navigate", &AutomationServer::navigate},
+      {"tabs.reload", &AutomationServer::reload},
+      {"page.evaluate", &AutomationServer::evaluate},
+      {"page.timings", &AutomationServer::timings},
+      {"hud.setEnabled", &AutomationServer::setHudEnabled},
+      {"workspaces.list", &AutomationServer::listWorkspaces},
+      {"workspaces.switch", &AutomationServer::switchWorkspace},
+      {"workspaces.create", &AutomationServer::createWorkspace},
+      {"workspaces.save", &AutomationServer::saveWorkspace},
+      {"bookmarks.list", &AutomationServer::listBookmarks},
+      {"bookmarks.add", &AutomationServer::addBookmark},
+      {"pip.image", &AutomationServer::imagePiP},
+      {"pip.video", &AutomationServer::videoPiP},
+      {"pip.closeAll", &AutomationServer::closeAllPiP},
+  };
+  return table;
+}
+
+void AutomationServer::onNewConnection() {
+  while (QLocalSocket *socket = server->nextPendingConnection()) {
+    const quint64 sessionId = nextSessionId++;
+    sessions.insert(sessionId, {socket, QByteArray(), QSet<QString>()});
+    connect(socket, &QLocalSocket::readyRead, this, [this, sessionId]() { readRequests(sessionId); });
+    connect(socket, &QLocalSocket::disconnected, this, [this, sessionId, socket]() {
+      sessions.remove(sessionId);
+      socket->deleteLater();
+    });
+    qCDebug(lcAutomation) << "AutomationServer: client" << sessionId << "connected";
+  }
+}
+
+void AutomationServer::readRequests(quint64 sessionId) {
+  const auto it = sessions.find(sessionId);
+  if (it == sessions.end() || !it->socket)
+    return;
+
+  QByteArray &buffer = it->buffer;
+  buffer += it->socket->readAll();
+  const qsizetype lastNewline = buffer.lastIndexOf('\n');
+  if (lastNewline < 0) {
+    if (buffer.size() > MAX_LINE_SIZE) {
+      qCWarning(lcAutomation) << "AutomationServer: dropping client" << sessionId << "(line too long)";
+      it->socket->abort();
+    }
+    return;
+  }
+
+  // Every complete line of this read, in order; the session may change while they run
+  const QByteArray complete = buffer.left(lastNewline);
+  buffer.remove(0, lastNewline + 1);
+  for (const QByteArray &line : complete.split('\n')) {
+    const QByteArray request = line.trimmed();
+    if (!request.isEmpty()) {
+      handleRequest(sessionId, request);
+    }
+  }
+}
+
+void AutomationServer::handleRequest(quint64 sessionId, const QByteArray &line) {
+  AutomationReply reply;
+  reply.server = this;
+  reply.session = sessionId;
+
+  QJsonParseError parseError;
+  const QJsonDocument document = QJsonDocument::fromJson(line, &parseError);
+  if (parseError.error != QJsonParseError::NoError || !document.isObject()) {
+    reply.id = QJsonValue::Null;
+    if (parseError.error != QJsonParseError::NoError) {
+      reply.error(PARSE_ERROR, parseError.errorString());
+    } else {
+      reply.error(INVALID_REQUEST, "Expected one request object per line");
+    }
+    return;
+  }
+
+  const QJsonObject request = document.object();
+  reply.id = request.value("id");
+  const QString method = request["method"].toString();
+  if (request["jsonrpc"].toString() != "2.0" || method.isEmpty()) {
+    if (reply.id.isUndefined()) {
+      reply.id = QJsonValue::Null;
+    }
+    reply.error(INVALID_REQUEST, "Not a JSON-RPC 2.0 request");
+    return;
+  }
+  const QJsonValue params = request.value("params");
+  if (!params.isUndefined() && !params.isObject()) {
+    reply.error(INVALID_PARAMS, "params must be an object");
+    return;
+  }
+
+  const Handler handler = methods().value(method);
+  if (!handler) {
+    reply.error(METHOD_NOT_FOUND, QString("Unknown method %1").arg(method));
+    return;
+  }
+  qCDebug(lcAutomation) << "AutomationServer:" << sessionId << method;
+  (this->*handler)(params.toObject(), reply);
+}
+
+void AutomationServer::send(quint64 sessionId, const QJsonObject &message) {
+  const auto it = sessions.constFind(sessionId);
+  if (it == sessions.constEnd() || !it->socket)
+    return;
+  it->socket->write(QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n');
+}
+
+void AutomationServer::broadcast(const QString &type, QJsonObject params) {
+  QByteArray line; // Serialized once, and only if someone listens
+  for (const Session &session : std::as_const(sessions)) {
+    if (!session.socket || (!session.events.contains(type) && !session.events.contains(ALL_EVENTS)))
+      continue;
+    if (line.isEmpty()) {
+      params["type"] = type;
+      QJsonObject message;
+      message["jsonrpc"] = "2.0";
+      message["method"] = "event";
+      message["params"] = params;
+      line = QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n';
+    }
+    session.socket->write(line);
+  }
+}
+
+void AutomationServer::watch(WebView *view) {
+  const int id = view->tabId();
+  connect(view, &WebView::loadStarted, this, [this, id]() { broadcast("tab.loadStarted", {{"id", id}}); });
+  connect(view, &WebView::loadFinished, this, [this, view, id](bool ok) {
+    broadcast("tab.loadFinished", {{"id", id}, {"ok", ok}, {"url", view->url().toString()}});
+  });
+  connect(view, &WebView::urlChanged, this, [this, id](const QUrl &url) {
+    broadcast("tab.urlChanged", {{"id", id}, {"url", url.toString()}});
+  });
+  connect(view, &WebView::titleChanged, this, [this, id](const QString &title) {
+    broadcast("tab.titleChanged", {{"id", id}, {"title", title}});
+  });
+  connect(view, &QObject::destroyed, this, [this, id]() { broadcast("tab.closed", {{"id", id}}); });
+}
+
+WebView *AutomationServer::findTab(const QJsonObject &params, const AutomationReply &reply) const {
+  if (!params.contains("id")) {
+    WebView *view = mainWindow->currentWebView();
+    if (!view) {
+      reply.error(TAB_NOT_FOUND, "No current tab");
+    }
+    return view;
+  }
+
+  const int id = params["id"].toInt();
+  VerticalTabWidget *tabs = mainWindow->getTabWidget();
+  for (int i = 0; i < tabs->count(); ++i) {
+    WebView *view = qobject_cast<WebView *>(tabs->widget(i));
+    if (view && view->tabId() == id)
+      return view;
+  }
+  reply.error(TAB_NOT_FOUND, QString("No tab with id %1").arg(id));
+  return nullptr;
+}
+
+QJsonObject AutomationServer::describeTab(WebView *view) const {
+  QJsonObject json;
+  json["id"] = view->tabId();
+  json["index"] = mainWindow->getTabWidget()->indexOf(view);
+  json["url"] = view->url().toString();
+  json["title"] = view->title();
+  json["current"] = view == mainWindow->currentWebView();
+  return json;
+}
+
+void AutomationServer::ping(const QJsonObject &, const AutomationReply &reply) {
+  reply.result("pong");
+}
+
+void AutomationServer::subscribe(const QJsonObject &params, const AutomationReply &reply) {
+  const auto it = sessions.find(reply.session);
+  if (it == sessions.end())
+    return;
+  for (const QJsonValue &type : params["events"].toArray()) {
+    it->events.insert(type.toString());
+  }
+  reply.result(QJsonArray::fromStringList(it->events.values()));
+}
+
+void AutomationServer::unsubscribe(const QJsonObject &params, const AutomationReply &reply) {
+  const auto it = sessions.find(reply.session);
+  if (it == sessions.end())
+    return;
+  if (params.contains("events")) {
+    for (const QJsonValue &type : params["events"].toArray()) {
+      it->events.remove(type.toString());
+    }
+  } else {
+    it->events.clear();
+  }
+  reply.result(QJsonArray::fromStringList(it->events.values()));
+}
+
+void AutomationServer::listTabs(const QJsonObject &, const AutomationReply &reply) {
+  QJsonArray list;
+  VerticalTabWidget *tabs = mainWindow->getTabWidget();
+  for (int i = 0; i < tabs->count(); ++i) {
+    if (WebView *view = qobject_cast<WebView *>(tabs->widget(i))) {
+      list.append(describeTab(view));
+    }
+  }
+  reply.result(list);
+}
+
+void AutomationServer::openTab(const QJsonObject &params, const AutomationReply &reply) {
+  const QString url = params["url"].toString();
+  WebView *view = mainWindow->openTab(url.isEmpty() ? QUrl() : QUrl::fromUserInput(url),
+                                      params["background"].toBool() ? MainWindow::BackgroundTab
+                                                                    : MainWindow::ForegroundTab);
+  reply.result(describeTab(view));
+}
+
+void AutomationServer::closeTab(const QJsonObject &params, const AutomationReply &reply) {
+  WebView *view = findTab(params, reply);
+  if (!view)
+    return;
+  // Like the tab strip, the last tab stays open
+  const bool closed = mainWindow->getTabWidget()->count() > 1;
+  mainWindow->closeTab(mainWindow->getTabWidget()->indexOf(view));
+  reply.result(closed);
+}
+
+void AutomationServer::activateTab(const QJsonObject &params, const AutomationReply &reply) {
+  if (WebView *view = findTab(params, reply)) {
+    mainWindow->getTabWidget()->setCurrentIndex(mainWindow->getTabWidget()->indexOf(view));
+    reply.result(describeTab(view));
+  }
+}
+
+void AutomationServer::navigate(const QJsonObject &params, const AutomationReply &reply) {
+  WebView *view = findTab(params, reply);
+  if (!view)
+    return;
+  const QString url = params["url"].toString();
+  if (url.isEmpty()) {
+    reply.error(INVALID_PARAMS, "url is required");
+    return;
+  }
+
+  const QUrl target = QUrl::fromUserInput(url);
+  if (params["wait"].toBool()) {
+    // Answered when the load of this URL ends, or with an error if the tab goes away first.
+    // The load it replaces may still end (as failed) after load(): wait until ours has started
+    const QUrl requested = target.adjusted(QUrl::StripTrailingSlash);
+    QObject *waiter = new QObject(view);
+    auto started = std::make_shared<bool>(false);
+    auto answered = std::make_shared<bool>(false);
+    connect(view->page(), &QWebEnginePage::loadingChanged, waiter,
+            [reply, view, waiter, requested, started, answered](const QWebEngineLoadingInfo &info) {
+              if (info.status() == QWebEngineLoadingInfo::LoadStartedStatus) {
+                if (info.url().adjusted(QUrl::StripTrailingSlash) == requested) {
+                  *started = true;
+                }
+                return;
+              }
+              if (!*started)
+                return;
+              *answered = true;
+              const bool ok = info.status() == QWebEngineLoadingInfo::LoadSucceededStatus;
+              reply.result(QJsonObject{{"ok", ok}, {"url", view->url().toString()}});
+              waiter->deleteLater();
+            });
+    connect(waiter, &QObject::destroyed, this, [reply, answered]() {
+      if (!*answered) {
+        reply.error(OPERATION_FAILED, "Tab closed before the page loaded");
+      }
+    });
+  }
+  view->load(target);
+  if (!params["wait"].toBool()) {
+    reply.result(describeTab(view));
+  }
+}
+
+void AutomationServer::reload(const QJsonObject &params, const AutomationReply &reply) {
+  if (WebView *view = findTab(params, reply)) {
+    view->reload();
+    reply.result(true);
+  }
+}
+
+void AutomationServer::evaluate(const QJsonObject &params, const AutomationReply &reply) {
+  WebView *view = findTab(params, reply);
+  if (!view)
+    return;
+  const QString script = params["script"].toString();
+  if (script.isEmpty()) {
+    reply.error(INVALID_PARAMS, "script is required");
+    return;
+  }
+  if (!params["await"].toBool()) {
+    runScript(view, script, QWebEngineScript::MainWorld, reply,
+              [reply](const QVariant &value) { reply.result(QJsonValue::fromVariant(value)); });
+    return;
+  }
+
+  // One expression; a Promise is awaited, exceptions and timeouts become errors
+  const int timeoutMs = params["timeoutMs"].toInt(PageScriptRunner::DEFAULT_TIMEOUT_MS);
+  mainWindow->getPageScriptRunner()->run(view, script, timeoutMs).then(this, [reply](const PageScriptResult &result) {
+    switch (result.status) {
+    case PageScriptResult::Ok:
+      reply.result(QJsonValue::fromVariant(result.value));
+      break;
+    case PageScriptResult::Failed:
+      reply.error(OPERATION_FAILED, result.error);
+      break;
+    case PageScriptResult::TimedOut:
+      reply.error(OPERATION_FAILED, "Script timed out");
+      break;
+    case PageScriptResult::Cancelled:
+      reply.error(OPERATION_FAILED, "Tab closed before the script finished");
+      break;
+    }
+  });
+}
+
+void AutomationServer::timings(const QJsonObject &params, const AutomationReply &reply) {
+  WebView *view = findTab(params, reply);
+  if (!view)
+    return;
+
+  // HUD metrics (LCP, long tasks, jank) exist only while the HUD is on
+  QJsonValue hud;
+  PerformanceStore *store = mainWindow->getPerformanceHudManager()->getStore();
+  if (store->hasTab(view->tabId())) {
+    hud = metricsToJson(store->tabMetrics(view->tabId()));
+  }
+  runScript(view, QString::fromLatin1(TIMINGS_SCRIPT), QWebEngineScript::ApplicationWorld, reply,
+            [reply, hud](const QVariant &value) {
+              QJsonObject result = QJsonObject::fromVariantMap(value.toMap());
+              result["hud"] = hud;
+              reply.result(result);
+            });
+}
+
+void AutomationServer::runScript(WebView *view, const QString &script, quint32 worldId, const AutomationReply &reply,
+                                 const std::function<void(const QVariant &)> &done) {
+  // The callback may never run when the page goes away first: answer for it then
+  auto answered = std::make_shared<bool>(false);
+  QPointer<QObject> waiter = new QObject(view);
+  connect(waiter, &QObject::destroyed, this, [reply, answered]() {
+    if (!*answered) {
+      *answered = true;
+      reply.error(OPERATION_FAILED, "Tab closed before the script finished");
+    }
+  });
+  view->page()->runJavaScript(script, worldId, [answered, waiter, done](const QVariant &value) {
+    if (*answered)
+      return;
+    *answered = true;
+    done(value);
+    delete waiter;
+  });
+}
+
+void AutomationServer::stats(const QJsonObject &, const AutomationReply &reply) {
+  PerformanceStore *store = mainWindow->getPerformanceHudManager()->getStore();
+  QJsonArray tabList;
+  VerticalTabWidget *tabs = mainWindow->getTabWidget();
+  for (int i = 0; i < tabs->count(); ++i) {
+    WebView *view = qobject_cast<WebView *>(tabs->widget(i));
+    if (!view)
+      continue;
+    QJsonObject tab = describeTab(view);
+    tab["rendererPid"] = double(view->page()->renderProcessPid());
+    tab["lifecycle"] = lifecycleName(view->page()->lifecycleState());
+    if (store->hasTab(view->tabId())) {
+      tab["metrics"] = metricsToJson(store->tabMetrics(view->tabId()));
+    }
+    if (mainWindow->getMediaGovernor()->hasTab(view->tabId())) {
+      const MediaTabState media = mainWindow->getMediaGovernor()->tabState(view->tabId());
+      QJsonObject mediaState;
+      mediaState["playing"] = media.playing;
+      mediaState["audible"] = media.audible;
+      mediaState["held"] = media.held;
+      mediaState["blocked"] = media.blocked;
+      mediaState["savedMs"] = double(media.savedMs);
+      mediaState["framesSaved"] = double(media.framesSaved);
+      tab["media"] = mediaState;
+    }
+    tabList.append(tab);
+  }
+
+  const PageEventStats events = mainWindow->getPageEventBus()->stats();
+  QJsonObject eventBus;
+  eventBus["batches"] = double(events.batches);
+  eventBus["events"] = double(events.events);
+  eventBus["bytes"] = double(events.bytes);
+  eventBus["eventsPerSecond"] = events.eventsPerSecond;
+  eventBus["bytesPerSecond"] = events.bytesPerSecond;
+
+  QJsonArray jobs;
+  for (const JobClassStats &job : JobScheduler::instance()->stats()) {
+    jobs.append(QJsonObject{{"class", job.name},
+                            {"queued", job.queued},
+                            {"submitted", double(job.submitted)},
+                            {"completed", double(job.completed)},
+                            {"cancelled", double(job.cancelled)},
+                            {"coalesced", double(job.coalesced)},
+                            {"averageWaitMs", job.averageWaitMs},
+                            {"maxWaitMs", job.maxWaitMs},
+                            {"averageRunMs", job.averageRunMs}});
+  }
+
+  QJsonObject result;
+  result["pid"] = double(QCoreApplication::applicationPid());
+  result["tabs"] = tabList;
+  result["pageEvents"] = eventBus;
+  result["jobs"] = jobs;
+  result["mediaSavedMs"] = double(mainWindow->getMediaGovernor()->totalSavedMs());
+  result["backgroundJobsPaused"] = JobScheduler::instance()->isBackgroundPaused();
+  result["automationClients"] = sessions.size();
+  reply.result(result);
+}
+
+void AutomationServer::setHudEnabled(const QJsonObject &params, const AutomationReply &reply) {
+  PerformanceHudManager *hud = mainWindow->getPerformanceHudManager();
+  hud->setEnabled(params["enabled"].toBool(true));
+  reply.result(hud->isEnabled());
+}
+
+void AutomationServer::listWorkspaces(const QJsonObject &, const AutomationReply &reply) {
+  WorkspaceManager *workspaces = mainWindow->getWorkspaceManager();
+  const QStringList ids = workspaces->getWorkspaceIds();
+  const QStringList names = workspaces->getWorkspaceNames();
+  QJsonArray list;
+  for (int i = 0; i < ids.size() && i < names.size(); ++i) {
+    list.append(QJsonObject{
+        {"id", ids.at(i)}, {"name", names.at(i)}, {"current", ids.at(i) == workspaces->getCurrentWorkspaceId()}});
+  }
+  reply.result(list);
+}
+
+void AutomationServer::switchWorkspace(const QJsonObject &params, const AutomationReply &reply) {
+  WorkspaceManager *workspaces = mainWindow->getWorkspaceManager();
+  const QString id = params["id"].toString();
+  if (!workspaces->getWorkspaceIds().contains(id)) {
+    reply.error(INVALID_PARAMS, QString("No workspace with id %1").arg(id));
+    return;
+  }
+  workspaces->loadWorkspace(id);
+  reply.result(id);
+}
+
+void AutomationServer::createWorkspace(const QJsonObject &params, const AutomationReply &reply) {
+  const QString name = params["name"].toString();
+  if (name.isEmpty()) {
+    reply.error(INVALID_PARAMS, "name is required");
+    return;
+  }
+  WorkspaceManager *workspaces = mainWindow->getWorkspaceManager();
+  workspaces->createNewWorkspace(name);
+  reply.result(workspaces->getWorkspaceIds().constLast());
+}
+
+void AutomationServer::saveWorkspace(const QJsonObject &, const AutomationReply &reply) {
+  mainWindow->getWorkspaceManager()->saveCurrentWorkspace();
+  reply.result(true);
+}
+
+void AutomationServer::listBookmarks(const QJsonObject &, const AutomationReply &reply) {
+  reply.result(bookmarkToJson(mainWindow->getBookmarkManager()->getRootItem()));
+}
+
+void AutomationServer::addBookmark(const QJsonObject &params, const AutomationReply &reply) {
+  const QUrl url = QUrl::fromUserInput(params["url"].toString());
+  if (!url.isValid()) {
+    reply.error(INVALID_PARAMS, "url is required");
+    return;
+  }
+  const QString title = params["title"].toString();
+  mainWindow->getBookmarkManager()->addBookmark(title.isEmpty() ? url.toString() : title, url);
+  reply.result(true);
+}
+
+void AutomationServer::imagePiP(const QJsonObject &params, const AutomationReply &reply) {
+  if (WebView *view = findTab(params, reply)) {
+    mainWindow->getPictureInPictureManager()->createImagePiP(view);
+    reply.result(true);
+  }
+}
+
+void AutomationServer::videoPiP(const QJsonObject &params, const AutomationReply &reply) {
+  if (WebView *view = findTab(params, reply)) {
+    mainWindow->getPictureInPictureManager()->createVideoPiP(view);
+    reply.result(true);
+  }
+}
+
+void AutomationServer::closeAllPiP(const QJsonObject &, const AutomationReply &reply) {
+  mainWindow->getPictureInPictureManager()->closeAllPiP();
+  reply.result(true);
+}
@@ -0,0 +1,125 @@
+#ifndef AUTOMATIONSERVER_H
+#define AUTOMATIONSERVER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QString>
+#include <QVariant>
+#include <functional>
+
+class MainWindow;
+class WebView;
+class QLocalServer;
+class QLocalSocket;
+class AutomationServer;
+
+/**
+ * @brief Completes one JSON-RPC request
+ *
+ * Asynchronous methods keep a copy and call it when the work is done; a
+ * reply for a client that has gone away, or for a notification (no id), is
+ * dropped.
+ */
+class AutomationReply {
+public:
+  void result(const QJsonValue &value) const;
+  void error(int code, const QString &message) const;
+
+private:
+  friend class AutomationServer;
+
+  QPointer<AutomationServer> server;
+  quint64 session = 0;
+  QJsonValue id;
+};
+
+/**
+ * @brief Opt-in JSON-RPC 2.0 endpoint for driving the browser from scripts
+ *
+ * Listens on a local socket (current user only). Each message is one JSON
+ * object per line. Clients may pipeline: every complete line in a read is
+ * handled in order, synchronous methods answer at once and asynchronous ones
+ * (page.evaluate, tabs.navigate with wait) answer with their id when done, so
+ * replies can arrive out of order. events.subscribe turns on notifications
+ * ({"method": "event", "params": {"type": ...}}) for tab, workspace and
+ * performance events; nothing is serialized for event types nobody asked for.
+ */
+class AutomationServer : public QObject {
+  Q_OBJECT
+
+public:
+  // JSON-RPC error codes
+  static const int PARSE_ERROR = -32700;
+  static const int INVALID_REQUEST = -32600;
+  static const int METHOD_NOT_FOUND = -32601;
+  static const int INVALID_PARAMS = -32602;
+  static const int TAB_NOT_FOUND = -32001;
+  static const int OPERATION_FAILED = -32002;
+
+  explicit AutomationServer(MainWindow *window);
+  ~AutomationServer();
+
+  bool listen(const QString &name);
+
+private:
+  using Handler = void (AutomationServer::*)(const QJsonObject &params, const AutomationReply &reply);
+
+  struct Session {
+    QPointer<QLocalSocket> socket;
+    QByteArray buffer;
+    QSet<QString> events;
+  };
+
+  friend class AutomationReply;
+
+  static const QHash<QString, Handler> &methods();
+
+  void onNewConnection();
+  void readRequests(quint64 sessionId);
+  void handleRequest(quint64 sessionId, const QByteArray &line);
+  void send(quint64 sessionId, const QJsonObject &message);
+  void broadcast(const QString &type, QJsonObject params);
+
+  void watch(WebView *view);
+  WebView *findTab(const QJsonObject &params, const AutomationReply &reply) const;
+  QJsonObject describeTab(WebView *view) const;
+  // runJavaScript that answers reply with an error when the tab goes away before done is called
+  void runScript(WebView *view, const QString &script, quint32 worldId, const AutomationReply &reply,
+                 const std::function<void(const QVariant &)> &done);
+
+  // Methods
+  void ping(const QJsonObject &params, const AutomationReply &reply);
+  void subscribe(const QJsonObject &params, const AutomationReply &reply);
+  void unsubscribe(const QJsonObject &params, const AutomationReply &reply);
+  void listTabs(const QJsonObject &params, const AutomationReply &reply);
+  void openTab(const QJsonObject &params, const AutomationReply &reply);
+  void closeTab(const QJsonObject &params, const AutomationReply &reply);
+  void activateTab(const QJsonObject &params, const AutomationReply &reply);
+  void navigate(const QJsonObject &params, const AutomationReply &reply);
+  void reload(const QJsonObject &params, const AutomationReply &reply);
+  void evaluate(const QJsonObject &params, const AutomationReply &reply);
+  void timings(const QJsonObject &params, const AutomationReply &reply);
+  void stats(const QJsonObject &params, const AutomationReply &reply);
+  void setHudEnabled(const QJsonObject &params, const AutomationReply &reply);
+  void listWorkspaces(const QJsonObject &params, const AutomationReply &reply);
+  void switchWorkspace(const QJsonObject &params, const AutomationReply &reply);
+  void createWorkspace(const QJsonObject &params, const AutomationReply &reply);
+  void saveWorkspace(const QJsonObject &params, const AutomationReply &reply);
+  void listBookmarks(const QJsonObject &params, const AutomationReply &reply);
+  void addBookmark(const QJsonObject &params, const AutomationReply &reply);
+  void imagePiP(const QJsonObject &params, const AutomationReply &reply);
+  void videoPiP(const QJsonObject &params, const AutomationReply &reply);
+  void closeAllPiP(const QJsonObject &params, const AutomationReply &reply);
+
+  MainWindow *mainWindow;
+  QLocalServer *server;
+  QHash<quint64, Session> sessions;
+  quint64 nextSessionId;
+};
+
+#endif // AUTOMATIONSERVER_H
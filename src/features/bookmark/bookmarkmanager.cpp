@@ -1,4 +1,5 @@
 #include "bookmarkmanager.h"
+#include "../favicons/faviconstore.h"
 #include <QApplication>
 #include <QClipboard>
 #include <QDesktopServices>
@@ -6,6 +7,13 @@
 #include <QSplitter>
 #include <QUuid>
 
+namespace {
+QIcon bookmarkIcon(const QString &url) {
+  const QIcon favicon = FaviconStore::instance()->icon(QUrl(url));
+  return favicon.isNull() ? QIcon(":/icons/bookmark.png") : favicon;
+}
+} // namespace
+
 BookmarkManager::BookmarkManager(QObject *parent)
     : QObject(parent), dockWidget(nullptr), treeWidget(nullptr), rootItem(nullptr) {
 
@@ -21,6 +29,8 @@ BookmarkManager::BookmarkManager(QObject *parent)
   rootItem = new BookmarkItem("Root", "");
   rootItem->isFolder = true;
 
+  connect(FaviconStore::instance(), &FaviconStore::iconChanged, this, &BookmarkManager::updateFavicons);
+
   // Don't load bookmarks here - wait until UI is set up
 }
 
@@ -172,7 +182,7 @@ void BookmarkManager::addBookmark(const QString &title, const QUrl &url, Bookmar
   QTreeWidgetItem *treeItem = new QTreeWidgetItem(parentTreeItem);
   treeItem->setText(0, title);
   treeItem->setText(1, url.toString());
-  treeItem->setIcon(0, QIcon(":/icons/bookmark.png")); // You can add icons later
+  treeItem->setIcon(0, bookmarkIcon(url.toString()));
 
   treeToBookmarkMap[treeItem] = bookmark;
   bookmarkToTreeMap[bookmark] = treeItem;
@@ -351,7 +361,7 @@ void BookmarkManager::addItemToTree(BookmarkItem *item, QTreeWidgetItem *parentT
       addItemToTree(child, treeItem);
     }
   } else {
-    treeItem->setIcon(0, QIcon(":/icons/bookmark.png"));
+    treeItem->setIcon(0, bookmarkIcon(item->url));
   }
 
   treeToBookmarkMap[treeItem] = item;
@@ -491,3 +501,13 @@ void BookmarkManager::deleteBookmarkItem(BookmarkItem *item) {
   // Delete the item (this will also delete all children)
   delete item;
 }
+
+void BookmarkManager::updateFavicons(const QUrl &pageUrl) {
+  // A new icon may also be the host fallback for other bookmarks of the site
+  for (auto it = bookmarkToTreeMap.cbegin(); it != bookmarkToTreeMap.cend(); ++it) {
+    BookmarkItem *item = it.key();
+    if (!item->isFolder && QUrl(item->url).host() == pageUrl.host()) {
+      it.value()->setIcon(0, bookmarkIcon(item->url));
+    }
+  }
+}
@@ -52,8 +52,10 @@ public:
   void addFolder(const QString &name, BookmarkItem *parent = nullptr);
 
   BookmarkItem *getRootItem() const { return rootItem; }
+  BookmarkItem *bookmarkById(const QString &id) { return findBookmarkById(id); }
   void saveBookmarks();
   void loadBookmarks();
+  void populateTreeWidget();
 
 public slots:
   void onAddBookmarkClicked();
@@ -70,7 +72,6 @@ signals:
 private:
   void setupUI();
   void setupContextMenu();
-  void populateTreeWidget();
   void addItemToTree(BookmarkItem *item, QTreeWidgetItem *parentTreeItem = nullptr);
   BookmarkItem *getBookmarkItemFromTreeItem(QTreeWidgetItem *treeItem);
   QTreeWidgetItem *getTreeItemFromBookmarkItem(BookmarkItem *bookmarkItem);
@@ -79,6 +80,7 @@ private:
   QString generateBookmarkId() const;
   BookmarkItem *findBookmarkById(const QString &id, BookmarkItem *parent = nullptr);
   void deleteBookmarkItem(BookmarkItem *item);
+  void updateFavicons(const QUrl &pageUrl);
 
   QDockWidget *dockWidget;
   QTreeWidget *treeWidget;
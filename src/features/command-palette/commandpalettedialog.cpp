@@ -1,9 +1,15 @@
 #include "commandpalettedialog.h"
+#include "../../core/ui_constants.h"
+#include "../favicons/faviconstore.h"
+#include "../logging/logcategories.h"
+#include "../page-search/pageindex.h"
+#include "../theme/theme.h"
 #include <QApplication>
-#include <QDebug>
+#include <QDateTime>
 #include <QGraphicsDropShadowEffect>
 #include <QKeyEvent>
 #include <QListWidgetItem>
+#include <QPalette>
 #include <QScreen>
 
 CommandPaletteDialog::CommandPaletteDialog(QWidget *parent)
@@ -36,12 +42,7 @@ void CommandPaletteDialog::setupUI() {
 
   // コンテナウィジェット
   QWidget *container = new QWidget();
-  container->setStyleSheet(
-      "QWidget {"
-      "  background-color: rgba(25, 25, 25, 240);"
-      "  border: 1px solid rgba(255, 255, 255, 0.15);"
-      "  border-radius: 16px;"
-      "}");
+  container->setObjectName("paletteContainer");
 
   // シャドウエフェクト
   QGraphicsDropShadowEffect *shadow = new QGraphicsDropShadowEffect();
@@ -56,25 +57,11 @@ void CommandPaletteDialog::setupUI() {
 
   // 検索入力フィールド
   searchInput = new QLineEdit();
-  searchInput->setPlaceholderText("Search or type '>' for commands...");
-  searchInput->setStyleSheet(
-      "QLineEdit {"
-      "  background-color: rgba(255, 255, 255, 0.08);"
-      "  border: 2px solid rgba(255, 255, 255, 0.12);"
-      "  border-radius: 12px;"
-      "  padding: 16px 20px;"
-      "  font-size: 20px;"
-      "  font-weight: 500;"
-      "  color: white;"
-      "  selection-background-color: rgba(0, 122, 255, 0.4);"
-      "}"
-      "QLineEdit:focus {"
-      "  border-color: rgba(0, 122, 255, 0.6);"
-      "  background-color: rgba(255, 255, 255, 0.12);"
-      "}"
-      "QLineEdit::placeholder {"
-      "  color: rgba(255, 255, 255, 0.5);"
-      "}");
+  searchInput->setPlaceholderText("Search, '>' for commands, '?' for pages you visited...");
+  searchInput->setObjectName("paletteInput");
+  QPalette inputPalette = searchInput->palette();
+  inputPalette.setColor(QPalette::PlaceholderText, Theme::color(UIConstants::PALETTE_PLACEHOLDER));
+  searchInput->setPalette(inputPalette);
 
   connect(searchInput, &QLineEdit::textChanged, this, &CommandPaletteDialog::onTextChanged);
   connect(searchInput, &QLineEdit::returnPressed, this, &CommandPaletteDialog::executeSelected);
@@ -83,30 +70,7 @@ void CommandPaletteDialog::setupUI() {
 
   // 候補リスト
   suggestionsList = new QListWidget();
-  suggestionsList->setStyleSheet(
-      "QListWidget {"
-      "  background-color: transparent;"
-      "  border: none;"
-      "  outline: none;"
-      "  border-radius: 8px;"
-      "}"
-      "QListWidget::item {"
-      "  color: rgba(255, 255, 255, 0.85);"
-      "  padding: 12px 16px;"
-      "  border: none;"
-      "  border-radius: 8px;"
-      "  margin: 2px 0px;"
-      "  font-size: 15px;"
-      "  background-color: transparent;"
-      "}"
-      "QListWidget::item:hover {"
-      "  background-color: rgba(0, 122, 255, 0.15);"
-      "  color: white;"
-      "}"
-      "QListWidget::item:selected {"
-      "  background-color: rgba(0, 122, 255, 0.4);"
-      "  color: white;"
-      "}");
+  suggestionsList->setObjectName("paletteList");
 
   suggestionsList->setMaximumHeight(320);
   suggestionsList->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
@@ -118,12 +82,7 @@ void CommandPaletteDialog::setupUI() {
 
   // ヘルプテキスト
   QLabel *helpLabel = new QLabel("↑↓ Navigate • Enter Select • Esc Cancel");
-  helpLabel->setStyleSheet(
-      "QLabel {"
-      "  color: rgba(255, 255, 255, 0.4);"
-      "  font-size: 12px;"
-      "  padding: 8px 0px;"
-      "}");
+  helpLabel->setObjectName("paletteHelp");
   helpLabel->setAlignment(Qt::AlignCenter);
   containerLayout->addWidget(helpLabel);
 
@@ -138,26 +97,26 @@ void CommandPaletteDialog::setSearchHistory(const QStringList &history) {
 }
 
 void CommandPaletteDialog::showCentered() {
-  qDebug() << "CommandPaletteDialog::showCentered() called"; // デバッグ出力
+  qCDebug(lcPalette) << "CommandPaletteDialog::showCentered() called"; // デバッグ出力
 
   // 画面中央に表示
   if (QScreen *screen = QApplication::primaryScreen()) {
     QRect screenGeometry = screen->availableGeometry();
-    qDebug() << "Screen geometry:" << screenGeometry; // デバッグ出力
+    qCDebug(lcPalette) << "Screen geometry:" << screenGeometry; // デバッグ出力
 
     // ダイアログサイズを取得
     resize(700, 480); // サイズを明示的に設定
     QRect dialogGeometry = geometry();
-    qDebug() << "Dialog geometry:" << dialogGeometry; // デバッグ出力
+    qCDebug(lcPalette) << "Dialog geometry:" << dialogGeometry; // デバッグ出力
 
     int x = screenGeometry.x() + (screenGeometry.width() - width()) / 2;
     int y = screenGeometry.y() + screenGeometry.height() / 4; // Spotlightのように少し上に配置
 
-    qDebug() << "Moving dialog to:" << x << y; // デバッグ出力
+    qCDebug(lcPalette) << "Moving dialog to:" << x << y; // デバッグ出力
     move(x, y);
   }
 
-  qDebug() << "Showing dialog..."; // デバッグ出力
+  qCDebug(lcPalette) << "Showing dialog..."; // デバッグ出力
   show();
   activateWindow();
   raise();
@@ -166,7 +125,7 @@ void CommandPaletteDialog::showCentered() {
 
   // 初期候補を表示
   populateSuggestions("");
-  qDebug() << "Dialog should be visible now"; // デバッグ出力
+  qCDebug(lcPalette) << "Dialog should be visible now"; // デバッグ出力
 }
 
 void CommandPaletteDialog::keyPressEvent(QKeyEvent *event) {
@@ -226,9 +185,12 @@ void CommandPaletteDialog::updateSuggestions() {
   QString text = searchInput->text();
   if (text.startsWith(">")) {
     populateCommands(text.mid(1).trimmed());
+  } else if (text.startsWith("?")) {
+    populatePageSearch(text.mid(1));
   } else {
     populateSuggestions(text);
   }
+  emit suggestionsUpdated();
 }
 
 void CommandPaletteDialog::populateSuggestions(const QString &query) {
@@ -271,6 +233,7 @@ void CommandPaletteDialog::populateSuggestions(const QString &query) {
     if (query.contains(".") && !query.contains(" ")) {
       QListWidgetItem *urlItem = new QListWidgetItem(QString("🌐 Go to %1").arg(query));
       urlItem->setData(Qt::UserRole, "url");
+      urlItem->setIcon(FaviconStore::instance()->icon(QUrl::fromUserInput(query)));
       suggestionsList->addItem(urlItem);
     }
 
@@ -295,8 +258,10 @@ void CommandPaletteDialog::populateCommands(const QString &query) {
       "New Tab", "Close Tab", "New Window", "Close Window",
       "Reload", "Hard Reload", "Stop", "Go Back", "Go Forward",
       "Zoom In", "Zoom Out", "Reset Zoom", "Toggle Fullscreen",
-      "Add Bookmark", "Show Bookmarks", "Show History", "Clear History",
-      "Show Downloads", "Developer Tools", "View Source",
+      "Add Bookmark", "Show Bookmarks", "Show History", "Clear History", "Clear Page Index",
+      "Cache Statistics", "Clear Cache",
+      "Show Downloads", "Developer Tools", "View Source", "Performance HUD",
+      "Toggle Content Blocking", "Reload Filter Lists",
       "New Workspace", "Switch Workspace", "Rename Workspace",
       "Picture in Picture", "Find in Page", "Print Page", "Save Page"};
 
@@ -323,6 +288,47 @@ void CommandPaletteDialog::populateCommands(const QString &query) {
   }
 }
 
+void CommandPaletteDialog::populatePageSearch(const QString &query) {
+  suggestionsList->clear();
+
+  QListWidgetItem *headerItem = new QListWidgetItem(query.trimmed().isEmpty() ? "📄 Type to search pages you visited"
+                                                                              : "📄 Searching visited pages…");
+  headerItem->setData(Qt::UserRole, "header");
+  headerItem->setFlags(headerItem->flags() & ~Qt::ItemIsSelectable);
+  suggestionsList->addItem(headerItem);
+
+  if (!query.trimmed().isEmpty()) {
+    // Results arrive asynchronously through showPageResults()
+    emit pageSearchRequested(query);
+  }
+}
+
+void CommandPaletteDialog::showPageResults(const QString &query, const QList<PageSearchHit> &hits) {
+  const QString text = searchInput->text();
+  if (!text.startsWith("?") || text.mid(1) != query)
+    return;
+
+  suggestionsList->clear();
+  selectedIndex = -1;
+
+  QListWidgetItem *headerItem =
+      new QListWidgetItem(hits.isEmpty() ? "📄 No visited pages match" : "📄 Visited Pages");
+  headerItem->setData(Qt::UserRole, "header");
+  headerItem->setFlags(headerItem->flags() & ~Qt::ItemIsSelectable);
+  suggestionsList->addItem(headerItem);
+
+  for (const PageSearchHit &hit : hits) {
+    const QString title = hit.title.isEmpty() ? hit.url.host() : hit.title;
+    const QString visited = QDateTime::fromMSecsSinceEpoch(hit.visitedAt).toString("yyyy-MM-dd");
+    QListWidgetItem *item = new QListWidgetItem(QString("%1  ·  %2\n%3").arg(title, visited, hit.snippet));
+    item->setData(Qt::UserRole, "page");
+    item->setData(Qt::UserRole + 1, hit.url);
+    item->setToolTip(hit.url.toString());
+    item->setIcon(FaviconStore::instance()->icon(hit.url));
+    suggestionsList->addItem(item);
+  }
+}
+
 void CommandPaletteDialog::selectNextItem() {
   if (suggestionsList->count() == 0)
     return;
@@ -366,6 +372,10 @@ void CommandPaletteDialog::executeSelected() {
         QString command = itemText.startsWith("⌘ ") ? itemText.mid(2) : itemText.trimmed();
         executeCommand(command);
         return;
+      } else if (itemType == "page") {
+        emit pageRequested(selectedItem->data(Qt::UserRole + 1).toUrl());
+        accept();
+        return;
       } else if (itemType == "search" || itemType == "url") {
         // 検索またはURL
         QString searchQuery = itemText;
@@ -387,6 +397,16 @@ void CommandPaletteDialog::executeSelected() {
   // 選択項目がない場合、直接入力を処理
   if (query.startsWith(">")) {
     executeCommand(query.mid(1).trimmed());
+  } else if (query.startsWith("?")) {
+    // Open the best match, if the results are in
+    for (int i = 0; i < suggestionsList->count(); ++i) {
+      QListWidgetItem *item = suggestionsList->item(i);
+      if (item->data(Qt::UserRole).toString() == "page") {
+        emit pageRequested(item->data(Qt::UserRole + 1).toUrl());
+        accept();
+        return;
+      }
+    }
   } else if (!query.isEmpty()) {
     executeSearch(query);
   }
@@ -7,8 +7,11 @@
 #include <QListWidget>
 #include <QPropertyAnimation>
 #include <QTimer>
+#include <QUrl>
 #include <QVBoxLayout>
 
+struct PageSearchHit;
+
 class CommandPaletteDialog : public QDialog {
   Q_OBJECT
 
@@ -19,9 +22,15 @@ public:
   void setSearchHistory(const QStringList &history);
   void showCentered();
 
+  // Results for a "?" query; ignored if the input changed in the meantime
+  void showPageResults(const QString &query, const QList<PageSearchHit> &hits);
+
 signals:
   void searchRequested(const QString &query);
   void commandRequested(const QString &command);
+  void pageSearchRequested(const QString &query); // Text after a leading "?"
+  void pageRequested(const QUrl &url);
+  void suggestionsUpdated(); // Emitted after the suggestion list was rebuilt
 
 protected:
   void keyPressEvent(QKeyEvent *event) override;
@@ -37,6 +46,7 @@ private:
   void setupUI();
   void populateSuggestions(const QString &query);
   void populateCommands(const QString &query);
+  void populatePageSearch(const QString &query);
   void selectNextItem();
   void selectPreviousItem();
   void executeSelected();
@@ -1,5 +1,10 @@
 #include "commandpalettemanager.h"
+#include "../content-blocking/contentblockingmanager.h"
+#include "../downloads/downloadmanager.h"
+#include "../logging/logcategories.h"
 #include "../main-window/mainwindow.h"
+#include "../page-search/pagesearchservice.h"
+#include "../performance-hud/performancehudmanager.h"
 #include "../picture-in-picture/pictureinpicturemanager.h"
 #include "../tab-widget/verticaltabwidget.h"
 #include "../webview/webview.h"
@@ -7,7 +12,6 @@
 #include "commandpalettedialog.h"
 #include <QAction>
 #include <QCoreApplication>
-#include <QDebug>
 #include <QDir>
 #include <QFile>
 #include <QInputDialog>
@@ -27,7 +31,7 @@ CommandPaletteManager::~CommandPaletteManager() {
 }
 
 void CommandPaletteManager::setupActions() {
-  qDebug() << "CommandPaletteManager::setupActions() called";
+  qCDebug(lcPalette) << "CommandPaletteManager::setupActions() called";
 
   // Command palette action with Cmd+T and Ctrl+T shortcuts
   commandPaletteAction = new QAction("Command Palette", mainWindow);
@@ -38,14 +42,14 @@ void CommandPaletteManager::setupActions() {
   commandPaletteAction->setStatusTip("Open command palette (Cmd+T or Ctrl+T)");
   commandPaletteAction->setToolTip("Open command palette (Cmd+T or Ctrl+T)");
 
-  qDebug() << "Created commandPaletteAction with shortcuts:";
+  qCDebug(lcPalette) << "Created commandPaletteAction with shortcuts:";
   for (const QKeySequence &shortcut : commandPaletteAction->shortcuts()) {
-    qDebug() << "  -" << shortcut.toString();
+    qCDebug(lcPalette) << "  -" << shortcut.toString();
   }
-  qDebug() << "Action parent:" << commandPaletteAction->parent();
+  qCDebug(lcPalette) << "Action parent:" << commandPaletteAction->parent();
 
   connect(commandPaletteAction, &QAction::triggered, this, &CommandPaletteManager::onQuickSearchTriggered);
-  qDebug() << "Connected triggered signal to onQuickSearchTriggered slot";
+  qCDebug(lcPalette) << "Connected triggered signal to onQuickSearchTriggered slot";
 
 #ifdef QT_DEBUG
   // デバッグモード時のテストページアクション
@@ -59,11 +63,11 @@ void CommandPaletteManager::setupActions() {
 }
 
 void CommandPaletteManager::showCommandPalette() {
-  qDebug() << "Showing command palette..."; // デバッグ出力
+  qCDebug(lcPalette) << "Showing command palette..."; // デバッグ出力
 
   // 遅延初期化：初回使用時にダイアログを作成
   if (!commandPaletteDialog) {
-    qDebug() << "Creating command palette dialog for the first time...";
+    qCDebug(lcPalette) << "Creating command palette dialog for the first time...";
     commandPaletteDialog = new CommandPaletteDialog(mainWindow);
 
     // コマンドとクイック検索のシグナル接続
@@ -71,16 +75,25 @@ void CommandPaletteManager::showCommandPalette() {
             this, &CommandPaletteManager::handleCommand);
     connect(commandPaletteDialog, &CommandPaletteDialog::searchRequested,
             this, QOverload<const QString &>::of(&CommandPaletteManager::handleQuickSearch));
-
-    qDebug() << "Command palette dialog created and connected successfully";
+    connect(commandPaletteDialog, &CommandPaletteDialog::pageSearchRequested, this, [this](const QString &query) {
+      PageSearchService::instance()->search(query, 8, commandPaletteDialog,
+                                            [this, query](const QList<PageSearchHit> &hits) {
+                                              commandPaletteDialog->showPageResults(query, hits);
+                                            });
+    });
+    connect(commandPaletteDialog, &CommandPaletteDialog::pageRequested, this, [this](const QUrl &url) {
+      mainWindow->openTab(url);
+    });
+
+    qCDebug(lcPalette) << "Command palette dialog created and connected successfully";
   }
 
   if (commandPaletteDialog) {
-    qDebug() << "Dialog exists, showing it..."; // デバッグ出力
+    qCDebug(lcPalette) << "Dialog exists, showing it..."; // デバッグ出力
     commandPaletteDialog->setSearchHistory(searchHistory);
     commandPaletteDialog->showCentered();
   } else {
-    qDebug() << "Dialog is still null after creation attempt!"; // デバッグ出力
+    qCDebug(lcPalette) << "Dialog is still null after creation attempt!"; // デバッグ出力
   }
 }
 
@@ -131,10 +144,7 @@ void CommandPaletteManager::openTestPage() {
 
     if (QFile::exists(testFilePath)) {
       // 新しいタブでテストページを開く
-      mainWindow->newTab();
-      if (WebView *webView = mainWindow->currentWebView()) {
-        webView->load(testUrl);
-      }
+      mainWindow->openTab(testUrl);
     } else {
       QMessageBox::warning(mainWindow, "Test Page Not Found",
                            QString("Test file not found: %1").arg(testFilePath));
@@ -144,7 +154,7 @@ void CommandPaletteManager::openTestPage() {
 #endif
 
 void CommandPaletteManager::onQuickSearchTriggered() {
-  qDebug() << "Command palette triggered! (Cmd+T pressed)"; // デバッグ出力
+  qCDebug(lcPalette) << "Command palette triggered! (Cmd+T pressed)"; // デバッグ出力
   showCommandPalette();
 }
 
@@ -185,10 +195,7 @@ void CommandPaletteManager::handleQuickSearch(const QString &query, bool inNewTa
   if (url.isValid()) {
     if (inNewTab) {
       // 新しいタブで開く
-      mainWindow->newTab();
-      if (WebView *webView = mainWindow->currentWebView()) {
-        webView->load(url);
-      }
+      mainWindow->openTab(url);
     } else {
       // 現在のタブで開く
       if (WebView *webView = mainWindow->currentWebView()) {
@@ -202,8 +209,11 @@ void CommandPaletteManager::handleCommand(const QString &command) {
   QString cmd = command.toLower().trimmed();
 
   // コマンドカテゴリ別に処理を分散
-  if (cmd.contains("tab") || cmd.contains("back") || cmd.contains("forward") ||
-      cmd.contains("reload") || cmd.contains("stop")) {
+  // ("reload filter lists" must not fall into the navigation category)
+  if (cmd.contains("blocking") || cmd.contains("filter list") || cmd.contains("cache")) {
+    executeSettingsCommand(cmd);
+  } else if (cmd.contains("tab") || cmd.contains("back") || cmd.contains("forward") ||
+             cmd.contains("reload") || cmd.contains("stop")) {
     executeNavigationCommand(cmd);
   } else if (cmd.contains("zoom")) {
     executeZoomCommand(cmd);
@@ -211,10 +221,11 @@ void CommandPaletteManager::handleCommand(const QString &command) {
     executeBookmarkCommand(cmd);
   } else if (cmd.contains("workspace")) {
     executeWorkspaceCommand(cmd);
-  } else if (cmd.contains("history")) {
+  } else if (cmd.contains("history") || cmd.contains("download") || cmd.contains("page index")) {
     executeHistoryCommand(cmd);
   } else if (cmd.contains("devtools") || cmd.contains("developer") ||
-             cmd.contains("picture") || cmd.contains("pip") || cmd.contains("source")) {
+             cmd.contains("picture") || cmd.contains("pip") || cmd.contains("source") ||
+             cmd.contains("performance")) {
     executeDeveloperCommand(cmd);
   } else if (cmd.contains("print") || cmd.contains("save") || cmd.contains("find")) {
     executePageCommand(cmd);
@@ -296,8 +307,12 @@ void CommandPaletteManager::executeHistoryCommand(const QString &command) {
     clearSearchHistory();
     QMessageBox::information(mainWindow, "Command Palette", "Search history cleared");
   } else if (command == "show downloads" || command == "downloads") {
-    QMessageBox::information(mainWindow, "Command Palette",
-                             "Downloads view not implemented yet");
+    if (DownloadManager *downloadManager = mainWindow->getDownloadManager()) {
+      downloadManager->showDownloads();
+    }
+  } else if (command == "clear page index") {
+    PageSearchService::instance()->clear();
+    QMessageBox::information(mainWindow, "Command Palette", "Index of visited pages cleared");
   }
 }
 
@@ -313,6 +328,10 @@ void CommandPaletteManager::executeDeveloperCommand(const QString &command) {
     if (WebView *view = mainWindow->currentWebView()) {
       view->triggerPageAction(QWebEnginePage::ViewSource);
     }
+  } else if (command == "performance hud" || command == "toggle performance hud" || command == "performance") {
+    if (PerformanceHudManager *hudManager = mainWindow->getPerformanceHudManager()) {
+      hudManager->toggle();
+    }
 #ifdef QT_DEBUG
   } else if (command == "open test page" || command == "test page" || command == "test") {
     openTestPage();
@@ -351,6 +370,18 @@ void CommandPaletteManager::executeWindowCommand(const QString &command) {
 void CommandPaletteManager::executeSettingsCommand(const QString &command) {
   if (command == "settings" || command == "preferences") {
     mainWindow->showSettings();
+  } else if (command == "content blocking" || command == "toggle content blocking") {
+    if (ContentBlockingManager *blockingManager = mainWindow->getContentBlockingManager()) {
+      blockingManager->toggle();
+    }
+  } else if (command == "cache statistics" || command == "cache") {
+    mainWindow->showCacheStatistics();
+  } else if (command == "clear cache") {
+    mainWindow->clearCache();
+  } else if (command == "reload filter lists") {
+    if (ContentBlockingManager *blockingManager = mainWindow->getContentBlockingManager()) {
+      blockingManager->reloadFilterLists();
+    }
   }
 }
 
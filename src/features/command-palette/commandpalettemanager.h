@@ -40,6 +40,7 @@ public:
 
   // アクションの取得
   QAction *getCommandPaletteAction() const { return commandPaletteAction; }
+  CommandPaletteDialog *getCommandPaletteDialog() const { return commandPaletteDialog; }
 #ifdef QT_DEBUG
   QAction *getOpenTestPageAction() const { return openTestPageAction; }
 #endif
@@ -0,0 +1,157 @@
+#include "contentblocker.h"
+#include "../logging/logcategories.h"
+#include "filterlistcompiler.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QWebEngineUrlRequestInfo>
+
+namespace {
+const char *DEFAULT_FILTER_LIST = ":/src/features/content-blocking/default-filters.txt";
+
+quint32 resourceType(const QWebEngineUrlRequestInfo &info) {
+  switch (info.resourceType()) {
+  case QWebEngineUrlRequestInfo::ResourceTypeScript:
+  case QWebEngineUrlRequestInfo::ResourceTypeWorker:
+  case QWebEngineUrlRequestInfo::ResourceTypeSharedWorker:
+  case QWebEngineUrlRequestInfo::ResourceTypeServiceWorker:
+    return FilterMatcher::TypeScript;
+  case QWebEngineUrlRequestInfo::ResourceTypeImage:
+  case QWebEngineUrlRequestInfo::ResourceTypeFavicon:
+    return FilterMatcher::TypeImage;
+  case QWebEngineUrlRequestInfo::ResourceTypeStylesheet:
+    return FilterMatcher::TypeStylesheet;
+  case QWebEngineUrlRequestInfo::ResourceTypeFontResource:
+    return FilterMatcher::TypeFont;
+  case QWebEngineUrlRequestInfo::ResourceTypeSubFrame:
+    return FilterMatcher::TypeSubdocument;
+  case QWebEngineUrlRequestInfo::ResourceTypeXhr:
+    return FilterMatcher::TypeXmlHttpRequest;
+  case QWebEngineUrlRequestInfo::ResourceTypeMedia:
+    return FilterMatcher::TypeMedia;
+  case QWebEngineUrlRequestInfo::ResourceTypeObject:
+  case QWebEngineUrlRequestInfo::ResourceTypePluginResource:
+    return FilterMatcher::TypeObject;
+  case QWebEngineUrlRequestInfo::ResourceTypePing:
+  case QWebEngineUrlRequestInfo::ResourceTypeCspReport:
+    return FilterMatcher::TypePing;
+  default: {
+    const QString scheme = info.requestUrl().scheme();
+    return scheme == "ws" || scheme == "wss" ? FilterMatcher::TypeWebSocket : FilterMatcher::TypeOther;
+  }
+  }
+}
+} // namespace
+
+ContentBlocker::ContentBlocker(QObject *parent)
+    : QObject(parent), enabled(true) {
+  QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+  QDir dir(appDataPath);
+  if (!dir.exists()) {
+    dir.mkpath(appDataPath);
+  }
+  cachePath = appDataPath + "/content-blocking.bin";
+}
+
+ContentBlocker::~ContentBlocker() {
+}
+
+QString ContentBlocker::filterListDirectory() const {
+  return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/filters";
+}
+
+QStringList ContentBlocker::filterListFiles() const {
+  QStringList files = {DEFAULT_FILTER_LIST};
+  QDir dir(filterListDirectory());
+  for (const QString &name : dir.entryList({"*.txt"}, QDir::Files, QDir::Name)) {
+    files.append(dir.filePath(name));
+  }
+  return files;
+}
+
+quint64 ContentBlocker::listFingerprint(const QStringList &files) const {
+  // Path, size and mtime are enough to notice list updates without reading them
+  QByteArray key;
+  for (const QString &path : files) {
+    QFileInfo info(path);
+    key += path.toUtf8() + '\n' + QByteArray::number(info.size()) + '\n' +
+           QByteArray::number(info.lastModified().toMSecsSinceEpoch()) + '\n';
+  }
+  key += QByteArray::number(FilterMatcher::VERSION);
+  return FilterMatcher::hashDomain(key.constData(), key.size());
+}
+
+bool ContentBlocker::compileFilterLists(const QStringList &files, quint64 fingerprint) {
+  QElapsedTimer timer;
+  timer.start();
+
+  FilterListCompiler compiler;
+  for (const QString &path : files) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+      qCWarning(lcContentBlocking) << "ContentBlocker: cannot read filter list" << path;
+      continue;
+    }
+    compiler.addList(file.readAll());
+  }
+
+  QSaveFile cache(cachePath);
+  if (!cache.open(QIODevice::WriteOnly)) {
+    qCWarning(lcContentBlocking) << "ContentBlocker: cannot write" << cachePath;
+    return false;
+  }
+  cache.write(compiler.compile(fingerprint));
+  if (!cache.commit()) {
+    qCWarning(lcContentBlocking) << "ContentBlocker: cannot write" << cachePath;
+    return false;
+  }
+
+  qCDebug(lcContentBlocking) << "ContentBlocker: compiled" << compiler.ruleCount() << "rules ("
+                             << compiler.skippedCount() << "skipped ) in" << timer.elapsed() << "ms";
+  return true;
+}
+
+bool ContentBlocker::loadFilterLists() {
+  const QStringList files = filterListFiles();
+  const quint64 fingerprint = listFingerprint(files);
+
+  // Release the old mapping before the cache file is replaced
+  matcher.close();
+  if (!matcher.open(cachePath, fingerprint)) {
+    if (!compileFilterLists(files, fingerprint) || !matcher.open(cachePath, fingerprint)) {
+      qCWarning(lcContentBlocking) << "ContentBlocker: filter lists unavailable, blocking disabled";
+      return false;
+    }
+  }
+
+  emit filterListsLoaded(ruleCount());
+  return true;
+}
+
+bool ContentBlocker::blockRequest(QWebEngineUrlRequestInfo &info) {
+  if (!enabled || !matcher.isOpen())
+    return false;
+
+  // Never block top-level navigations
+  if (info.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeMainFrame)
+    return false;
+
+  const QUrl url = info.requestUrl();
+  const QString scheme = url.scheme();
+  if (scheme != "http" && scheme != "https" && scheme != "ws" && scheme != "wss")
+    return false;
+
+  FilterMatcher::Request request;
+  request.url = url.toEncoded().toLower();
+  request.host = url.host().toUtf8().toLower();
+  request.firstPartyHost = info.firstPartyUrl().host().toUtf8().toLower();
+  request.type = resourceType(info);
+
+  if (!matcher.shouldBlock(request))
+    return false;
+  info.block(true);
+  return true;
+}
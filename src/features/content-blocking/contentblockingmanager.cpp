@@ -0,0 +1,144 @@
+#include "contentblockingmanager.h"
+#include "../main-window/mainwindow.h"
+#include "../tab-widget/verticaltabwidget.h"
+#include "../webview/webview.h"
+#include "contentblocker.h"
+#include <QKeySequence>
+#include <QWebEngineUrlRequestInterceptor>
+
+/**
+ * @brief Page-level interceptor that runs one tab's requests through the blocker
+ *
+ * Runs on the UI thread, so a blocked request is counted for its own tab
+ * instead of being guessed from the first-party site.
+ */
+class BlockingInterceptor : public QWebEngineUrlRequestInterceptor {
+public:
+  BlockingInterceptor(ContentBlockingManager *manager, int tabId, QObject *parent)
+      : QWebEngineUrlRequestInterceptor(parent), manager(manager), tabId(tabId) {}
+
+  void interceptRequest(QWebEngineUrlRequestInfo &info) override {
+    if (manager->blocker && manager->blocker->blockRequest(info)) {
+      manager->onRequestBlocked(tabId);
+    }
+  }
+
+private:
+  ContentBlockingManager *manager;
+  int tabId;
+};
+
+ContentBlockingManager::ContentBlockingManager(MainWindow *parent)
+    : QObject(parent), mainWindow(parent), toggleAction(nullptr), reloadAction(nullptr) {
+}
+
+ContentBlockingManager::~ContentBlockingManager() {
+}
+
+void ContentBlockingManager::setupActions() {
+  toggleAction = new QAction("Content Blocking", mainWindow);
+  toggleAction->setShortcut(QKeySequence("Ctrl+Alt+B"));
+  toggleAction->setCheckable(true);
+  toggleAction->setChecked(true);
+  toggleAction->setEnabled(false); // Until a blocker is installed
+  toggleAction->setStatusTip("Block ads and trackers (Ctrl+Alt+B)");
+  connect(toggleAction, &QAction::toggled, this, &ContentBlockingManager::setEnabled);
+
+  reloadAction = new QAction("Reload Filter Lists", mainWindow);
+  reloadAction->setEnabled(false);
+  reloadAction->setStatusTip("Recompile the filter lists in the filters folder");
+  connect(reloadAction, &QAction::triggered, this, &ContentBlockingManager::reloadFilterLists);
+
+  connect(mainWindow->getTabWidget(), &VerticalTabWidget::currentChanged, this,
+          &ContentBlockingManager::updateCurrentTab);
+}
+
+void ContentBlockingManager::setBlocker(ContentBlocker *contentBlocker) {
+  if (blocker) {
+    disconnect(blocker, nullptr, this, nullptr);
+  }
+  blocker = contentBlocker;
+  if (!blocker)
+    return;
+
+  if (toggleAction) {
+    toggleAction->setEnabled(true);
+    toggleAction->setChecked(blocker->isEnabled());
+    reloadAction->setEnabled(true);
+  }
+}
+
+void ContentBlockingManager::attach(WebView *view) {
+  if (!view)
+    return;
+
+  const int tabId = view->tabId();
+  // First in the tab's chain, so later interceptors see the request already blocked
+  view->addRequestInterceptor(new BlockingInterceptor(this, tabId, view));
+  connect(view, &WebView::loadStarted, this, [this, view]() {
+    blockedCounts.remove(view->tabId());
+    updateTab(view);
+  });
+  connect(view, &QObject::destroyed, this, [this, tabId]() {
+    blockedCounts.remove(tabId);
+  });
+}
+
+int ContentBlockingManager::blockedCount(WebView *view) const {
+  return view ? blockedCounts.value(view->tabId()) : 0;
+}
+
+void ContentBlockingManager::setEnabled(bool enable) {
+  if (!blocker)
+    return;
+
+  blocker->setEnabled(enable);
+  if (toggleAction && toggleAction->isChecked() != enable) {
+    toggleAction->setChecked(enable);
+  }
+}
+
+void ContentBlockingManager::toggle() {
+  if (blocker) {
+    setEnabled(!blocker->isEnabled());
+  }
+}
+
+void ContentBlockingManager::reloadFilterLists() {
+  if (blocker) {
+    blocker->loadFilterLists();
+  }
+}
+
+void ContentBlockingManager::onRequestBlocked(int tabId) {
+  ++blockedCounts[tabId];
+
+  VerticalTabWidget *tabWidget = mainWindow->getTabWidget();
+  for (int i = 0; i < tabWidget->count(); ++i) {
+    WebView *view = qobject_cast<WebView *>(tabWidget->widget(i));
+    if (view && view->tabId() == tabId) {
+      updateTab(view);
+      return;
+    }
+  }
+}
+
+void ContentBlockingManager::updateCurrentTab() {
+  updateTab(mainWindow->currentWebView());
+}
+
+void ContentBlockingManager::updateTab(WebView *view) {
+  if (!view)
+    return;
+
+  const int count = blockedCount(view);
+  VerticalTabWidget *tabWidget = mainWindow->getTabWidget();
+  const int index = tabWidget->indexOf(view);
+  if (index >= 0) {
+    tabWidget->setTabToolTip(index, count > 0 ? QString("%1 requests blocked").arg(count) : QString());
+  }
+
+  if (toggleAction && view == mainWindow->currentWebView()) {
+    toggleAction->setText(count > 0 ? QString("Content Blocking (%1 blocked)").arg(count) : QString("Content Blocking"));
+  }
+}
@@ -0,0 +1,60 @@
+#ifndef CONTENTBLOCKINGMANAGER_H
+#define CONTENTBLOCKINGMANAGER_H
+
+#include <QAction>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+
+class MainWindow;
+class WebView;
+class ContentBlocker;
+
+/**
+ * @brief Window-side UI for the content blocker
+ *
+ * Owns the on/off and reload actions and keeps a blocked-request count per
+ * tab, shown in the tab tooltip and in the toggle action of the current tab.
+ */
+class ContentBlockingManager : public QObject {
+  Q_OBJECT
+
+public:
+  explicit ContentBlockingManager(MainWindow *parent = nullptr);
+  ~ContentBlockingManager();
+
+  void setupActions();
+  QAction *getToggleAction() const { return toggleAction; }
+  QAction *getReloadAction() const { return reloadAction; }
+
+  // The blocker is created in main.cpp; tabs attached before it block nothing
+  void setBlocker(ContentBlocker *blocker);
+  ContentBlocker *getBlocker() const { return blocker; }
+
+  // Called for every new tab: adds the tab's blocking interceptor; counts reset on each navigation
+  void attach(WebView *view);
+
+  int blockedCount(WebView *view) const;
+
+public slots:
+  void setEnabled(bool enable);
+  void toggle();
+  void reloadFilterLists();
+
+private slots:
+  void updateCurrentTab();
+
+private:
+  friend class BlockingInterceptor;
+
+  void onRequestBlocked(int tabId);
+  void updateTab(WebView *view);
+
+  MainWindow *mainWindow;
+  QPointer<ContentBlocker> blocker;
+  QAction *toggleAction;
+  QAction *reloadAction;
+  QHash<int, int> blockedCounts; // tab id -> blocked requests
+};
+
+#endif // CONTENTBLOCKINGMANAGER_H
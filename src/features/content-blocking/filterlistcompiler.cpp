@@ -0,0 +1,263 @@
+#include "filterlistcompiler.h"
+#include "filtermatcher.h"
+#include <QHash>
+#include <QList>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+quint32 typeForOption(const QByteArray &name) {
+  static const QHash<QByteArray, quint32> types = {
+      {"script", FilterMatcher::TypeScript},
+      {"image", FilterMatcher::TypeImage},
+      {"stylesheet", FilterMatcher::TypeStylesheet},
+      {"css", FilterMatcher::TypeStylesheet},
+      {"object", FilterMatcher::TypeObject},
+      {"xmlhttprequest", FilterMatcher::TypeXmlHttpRequest},
+      {"xhr", FilterMatcher::TypeXmlHttpRequest},
+      {"subdocument", FilterMatcher::TypeSubdocument},
+      {"frame", FilterMatcher::TypeSubdocument},
+      {"media", FilterMatcher::TypeMedia},
+      {"font", FilterMatcher::TypeFont},
+      {"ping", FilterMatcher::TypePing},
+      {"websocket", FilterMatcher::TypeWebSocket},
+      {"other", FilterMatcher::TypeOther}};
+  return types.value(name, 0);
+}
+
+bool isPlainDomain(const QByteArray &pattern) {
+  for (char c : pattern) {
+    if (!((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '.' || c == '-'))
+      return false;
+  }
+  return !pattern.isEmpty();
+}
+
+// Tokens that occur in nearly every URL make poor index keys
+bool isCommonToken(const QByteArray &token) {
+  static const QSet<QByteArray> common = {"http", "https", "www", "com", "net", "org", "js", "html"};
+  return common.contains(token);
+}
+
+void align(QByteArray &out) {
+  while (out.size() % 8) {
+    out.append('\0');
+  }
+}
+
+template <typename T>
+quint32 appendArray(QByteArray &out, const T *items, int count) {
+  align(out);
+  const quint32 offset = quint32(out.size());
+  out.append(reinterpret_cast<const char *>(items), qsizetype(sizeof(T)) * count);
+  return offset;
+}
+} // namespace
+
+FilterListCompiler::FilterListCompiler()
+    : skipped(0) {
+}
+
+void FilterListCompiler::addList(const QByteArray &text) {
+  for (const QByteArray &line : text.split('\n')) {
+    addLine(line.trimmed());
+  }
+}
+
+void FilterListCompiler::addLine(QByteArray line) {
+  // Comments and list headers
+  if (line.isEmpty() || line.startsWith('!') || line.startsWith('['))
+    return;
+
+  // Element hiding and scriptlets are not request filters
+  if (line.contains("##") || line.contains("#@#") || line.contains("#?#") || line.contains("#$#")) {
+    ++skipped;
+    return;
+  }
+
+  ParsedRule rule{QByteArray(), QByteArray(), 0, FilterMatcher::TypeAll};
+  if (line.startsWith("@@")) {
+    rule.flags |= FilterMatcher::RuleException;
+    line = line.mid(2);
+  }
+
+  bool hasOptions = false;
+  const int dollar = line.lastIndexOf('$');
+  if (dollar >= 0 && !(line.startsWith('/') && line.endsWith('/'))) {
+    if (!parseOptions(line.mid(dollar + 1).toLower(), rule)) {
+      ++skipped;
+      return;
+    }
+    hasOptions = true;
+    line = line.left(dollar);
+  }
+
+  // Regex rules would need a regex engine per request
+  if (line.size() > 1 && line.startsWith('/') && line.endsWith('/')) {
+    ++skipped;
+    return;
+  }
+
+  QByteArray pattern = line.toLower();
+  if (pattern.startsWith("||")) {
+    rule.flags |= FilterMatcher::RuleAnchorDomain;
+    pattern = pattern.mid(2);
+  } else if (pattern.startsWith('|')) {
+    rule.flags |= FilterMatcher::RuleAnchorStart;
+    pattern = pattern.mid(1);
+  }
+  if (pattern.endsWith('|')) {
+    rule.flags |= FilterMatcher::RuleAnchorEnd;
+    pattern.chop(1);
+  }
+
+  // Leading/trailing wildcards add nothing but cancel the matching anchor
+  if (pattern.startsWith('*')) {
+    rule.flags &= ~(FilterMatcher::RuleAnchorStart | FilterMatcher::RuleAnchorDomain);
+  }
+  if (pattern.endsWith('*')) {
+    rule.flags &= ~FilterMatcher::RuleAnchorEnd;
+  }
+  while (pattern.startsWith('*')) {
+    pattern = pattern.mid(1);
+  }
+  while (pattern.endsWith('*')) {
+    pattern.chop(1);
+  }
+
+  // An empty pattern would match every request
+  if (pattern.isEmpty() || pattern.size() > 0xffff || rule.domains.size() > 0xffff) {
+    ++skipped;
+    return;
+  }
+
+  // "||example.com^" goes into the domain hash set
+  if (!hasOptions && (rule.flags & ~FilterMatcher::RuleException) == FilterMatcher::RuleAnchorDomain &&
+      pattern.endsWith('^') && isPlainDomain(pattern.left(pattern.size() - 1))) {
+    const QByteArray domain = pattern.left(pattern.size() - 1);
+    const quint64 hash = FilterMatcher::hashDomain(domain.constData(), domain.size());
+    if (rule.flags & FilterMatcher::RuleException) {
+      allowDomains.insert(hash);
+    } else {
+      blockDomains.insert(hash);
+    }
+    return;
+  }
+
+  rule.pattern = pattern;
+  rules.append(rule);
+}
+
+bool FilterListCompiler::parseOptions(const QByteArray &options, ParsedRule &rule) const {
+  quint32 include = 0;
+  quint32 exclude = 0;
+
+  for (const QByteArray &option : options.split(',')) {
+    if (option == "third-party" || option == "3p") {
+      rule.flags |= FilterMatcher::RuleThirdParty;
+    } else if (option == "~third-party" || option == "first-party" || option == "1p") {
+      rule.flags |= FilterMatcher::RuleFirstParty;
+    } else if (option.startsWith("domain=")) {
+      rule.domains = option.mid(7);
+    } else if (option == "match-case" || option == "important") {
+      // Everything is matched lower-cased; exceptions always win here
+    } else if (option.startsWith('~') && typeForOption(option.mid(1))) {
+      exclude |= typeForOption(option.mid(1));
+    } else if (typeForOption(option)) {
+      include |= typeForOption(option);
+    } else {
+      // $document, $popup, $redirect=, $csp=, ... change more than allow/block
+      return false;
+    }
+  }
+
+  rule.typeMask = (include ? include : quint32(FilterMatcher::TypeAll)) & ~exclude;
+  return rule.typeMask != 0;
+}
+
+QByteArray FilterListCompiler::bestToken(const ParsedRule &rule) {
+  // A token is usable only if it must appear as a complete token in the URL:
+  // bounded by a literal separator or an anchor on both sides, never by '*'
+  const QByteArray &pattern = rule.pattern;
+  QByteArray best;
+  for (int i = 0; i < pattern.size();) {
+    if (!FilterMatcher::isTokenChar(pattern.at(i))) {
+      ++i;
+      continue;
+    }
+    int j = i;
+    while (j < pattern.size() && FilterMatcher::isTokenChar(pattern.at(j))) {
+      ++j;
+    }
+
+    const bool leftBounded = i > 0 ? pattern.at(i - 1) != '*'
+                                   : bool(rule.flags & (FilterMatcher::RuleAnchorStart | FilterMatcher::RuleAnchorDomain));
+    const bool rightBounded = j < pattern.size() ? pattern.at(j) != '*' : bool(rule.flags & FilterMatcher::RuleAnchorEnd);
+    const QByteArray token = pattern.mid(i, j - i);
+    if (leftBounded && rightBounded && !isCommonToken(token) && token.size() > best.size()) {
+      best = token;
+    }
+    i = j;
+  }
+  return best;
+}
+
+QByteArray FilterListCompiler::compile(quint64 fingerprint) const {
+  QList<quint64> blocked(blockDomains.begin(), blockDomains.end());
+  QList<quint64> allowed(allowDomains.begin(), allowDomains.end());
+  std::sort(blocked.begin(), blocked.end());
+  std::sort(allowed.begin(), allowed.end());
+
+  QByteArray strings;
+  QList<FilterMatcher::Rule> table;
+  QList<FilterMatcher::TokenEntry> tokens;
+  QList<quint32> untokenized;
+  table.reserve(rules.size());
+
+  for (const ParsedRule &parsed : rules) {
+    FilterMatcher::Rule rule;
+    memset(&rule, 0, sizeof(rule));
+    rule.patternOffset = quint32(strings.size());
+    rule.patternLength = quint16(parsed.pattern.size());
+    strings.append(parsed.pattern);
+    rule.domainsOffset = quint32(strings.size());
+    rule.domainsLength = quint16(parsed.domains.size());
+    strings.append(parsed.domains);
+    rule.flags = parsed.flags;
+    rule.typeMask = parsed.typeMask;
+
+    const quint32 ruleIndex = quint32(table.size());
+    const QByteArray token = bestToken(parsed);
+    if (token.isEmpty()) {
+      untokenized.append(ruleIndex);
+    } else {
+      tokens.append({FilterMatcher::hashToken(token.constData(), token.size()), ruleIndex});
+    }
+    table.append(rule);
+  }
+  std::stable_sort(tokens.begin(), tokens.end(),
+                   [](const FilterMatcher::TokenEntry &a, const FilterMatcher::TokenEntry &b) { return a.hash < b.hash; });
+
+  FilterMatcher::Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, FilterMatcher::MAGIC, sizeof(header.magic));
+  header.version = FilterMatcher::VERSION;
+  header.fingerprint = fingerprint;
+
+  QByteArray out(sizeof(header), '\0');
+  header.blockDomainCount = quint32(blocked.size());
+  header.blockDomainOffset = appendArray(out, blocked.constData(), blocked.size());
+  header.allowDomainCount = quint32(allowed.size());
+  header.allowDomainOffset = appendArray(out, allowed.constData(), allowed.size());
+  header.ruleCount = quint32(table.size());
+  header.ruleOffset = appendArray(out, table.constData(), table.size());
+  header.tokenCount = quint32(tokens.size());
+  header.tokenOffset = appendArray(out, tokens.constData(), tokens.size());
+  header.untokenizedCount = quint32(untokenized.size());
+  header.untokenizedOffset = appendArray(out, untokenized.constData(), untokenized.size());
+  header.stringsSize = quint32(strings.size());
+  header.stringsOffset = appendArray(out, strings.constData(), strings.size());
+
+  memcpy(out.data(), &header, sizeof(header));
+  return out;
+}
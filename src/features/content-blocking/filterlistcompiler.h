@@ -0,0 +1,44 @@
+#ifndef FILTERLISTCOMPILER_H
+#define FILTERLISTCOMPILER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QSet>
+
+/**
+ * @brief Compiles EasyList-style filter lists into the FilterMatcher format
+ *
+ * Supported: "||domain^" and "@@" exceptions, "|" / "||" / trailing "|"
+ * anchors, "*" and "^" wildcards, $third-party / $~third-party, $domain= and
+ * resource type options. Element hiding, regex rules and options that change
+ * more than allow/block ($redirect, $csp, $removeparam, ...) are skipped.
+ */
+class FilterListCompiler {
+public:
+  FilterListCompiler();
+
+  void addList(const QByteArray &text);
+  QByteArray compile(quint64 fingerprint) const;
+
+  int ruleCount() const { return rules.size() + blockDomains.size() + allowDomains.size(); }
+  int skippedCount() const { return skipped; }
+
+private:
+  struct ParsedRule {
+    QByteArray pattern;
+    QByteArray domains;
+    quint16 flags;
+    quint32 typeMask;
+  };
+
+  void addLine(QByteArray line);
+  bool parseOptions(const QByteArray &options, ParsedRule &rule) const;
+  static QByteArray bestToken(const ParsedRule &rule);
+
+  QList<ParsedRule> rules;
+  QSet<quint64> blockDomains;
+  QSet<quint64> allowDomains;
+  int skipped;
+};
+
+#endif // FILTERLISTCOMPILER_H
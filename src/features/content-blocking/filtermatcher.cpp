@@ -0,0 +1,347 @@
+#include "filtermatcher.h"
+#include <QVarLengthArray>
+#include <algorithm>
+#include <cstring>
+
+const char FilterMatcher::MAGIC[4] = {'M', 'B', 'C', 'F'};
+
+namespace {
+// ABP separator: anything but a letter, a digit or one of _ - . %
+bool isSeparator(char c) {
+  return !((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_' || c == '-' || c == '.' || c == '%');
+}
+
+// Glob match of pattern [p, pEnd) against the start of [s, sEnd).
+// '*' matches any run, '^' a separator or the end of the URL.
+bool matchHere(const char *p, const char *pEnd, const char *s, const char *sEnd, bool anchorEnd) {
+  const char *starP = nullptr;
+  const char *starS = nullptr;
+  while (true) {
+    if (p == pEnd) {
+      if (!anchorEnd || s == sEnd)
+        return true;
+    } else if (*p == '*') {
+      starP = ++p;
+      starS = s;
+      continue;
+    } else if (s < sEnd && (*p == '^' ? isSeparator(*s) : *p == *s)) {
+      ++p;
+      ++s;
+      continue;
+    } else if (s == sEnd && *p == '^' && p + 1 == pEnd) {
+      return true;
+    }
+
+    if (!starP || starS >= sEnd)
+      return false;
+    p = starP;
+    s = ++starS;
+  }
+}
+
+// "www.example.co.uk" -> "example.co.uk"; no public suffix list, so two-letter
+// country codes with a short second level (co.uk, com.au) get three labels
+QByteArray baseDomain(const QByteArray &host) {
+  const int last = host.lastIndexOf('.');
+  if (last <= 0)
+    return host;
+  const int second = host.lastIndexOf('.', last - 1);
+  if (second < 0)
+    return host;
+
+  const bool shortSecondLevel = host.size() - last - 1 == 2 && last - second - 1 <= 3;
+  if (shortSecondLevel) {
+    const int third = host.lastIndexOf('.', second - 1);
+    return third < 0 ? host : host.mid(third + 1);
+  }
+  return host.mid(second + 1);
+}
+
+// A table of count entries at offset lies inside a file of size bytes, suitably aligned
+template <typename T>
+bool tableFits(quint32 offset, quint32 count, qint64 size) {
+  return offset % alignof(T) == 0 && quint64(offset) + quint64(count) * sizeof(T) <= quint64(size);
+}
+
+bool hostMatchesDomain(const QByteArray &host, const char *domain, int length) {
+  if (host.size() == length)
+    return memcmp(host.constData(), domain, length) == 0;
+  return host.size() > length && host.at(host.size() - length - 1) == '.' &&
+         memcmp(host.constData() + host.size() - length, domain, length) == 0;
+}
+} // namespace
+
+FilterMatcher::FilterMatcher()
+    : data(nullptr), size(0), header(nullptr) {
+}
+
+FilterMatcher::~FilterMatcher() {
+  close();
+}
+
+bool FilterMatcher::open(const QString &path, quint64 expectedFingerprint) {
+  close();
+
+  file.setFileName(path);
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+
+  size = file.size();
+  if (size < qint64(sizeof(Header))) {
+    close();
+    return false;
+  }
+
+  data = file.map(0, size);
+  if (!data) {
+    close();
+    return false;
+  }
+
+  header = reinterpret_cast<const Header *>(data);
+  if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION ||
+      header->fingerprint != expectedFingerprint || !isValid()) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+bool FilterMatcher::isValid() const {
+  // Matching trusts every offset in the file, so a damaged cache must not get past here
+  if (!tableFits<quint64>(header->blockDomainOffset, header->blockDomainCount, size) ||
+      !tableFits<quint64>(header->allowDomainOffset, header->allowDomainCount, size) ||
+      !tableFits<Rule>(header->ruleOffset, header->ruleCount, size) ||
+      !tableFits<TokenEntry>(header->tokenOffset, header->tokenCount, size) ||
+      !tableFits<quint32>(header->untokenizedOffset, header->untokenizedCount, size) ||
+      !tableFits<char>(header->stringsOffset, header->stringsSize, size)) {
+    return false;
+  }
+
+  const Rule *rules = reinterpret_cast<const Rule *>(data + header->ruleOffset);
+  for (quint32 i = 0; i < header->ruleCount; ++i) {
+    const Rule &rule = rules[i];
+    if (quint64(rule.patternOffset) + rule.patternLength > header->stringsSize ||
+        quint64(rule.domainsOffset) + rule.domainsLength > header->stringsSize) {
+      return false;
+    }
+  }
+
+  const TokenEntry *index = reinterpret_cast<const TokenEntry *>(data + header->tokenOffset);
+  for (quint32 i = 0; i < header->tokenCount; ++i) {
+    if (index[i].rule >= header->ruleCount)
+      return false;
+  }
+
+  const quint32 *untokenized = reinterpret_cast<const quint32 *>(data + header->untokenizedOffset);
+  for (quint32 i = 0; i < header->untokenizedCount; ++i) {
+    if (untokenized[i] >= header->ruleCount)
+      return false;
+  }
+  return true;
+}
+
+void FilterMatcher::close() {
+  if (data) {
+    file.unmap(const_cast<uchar *>(data));
+    data = nullptr;
+  }
+  header = nullptr;
+  size = 0;
+  if (file.isOpen()) {
+    file.close();
+  }
+}
+
+quint64 FilterMatcher::fingerprint() const {
+  return header ? header->fingerprint : 0;
+}
+
+int FilterMatcher::ruleCount() const {
+  return header ? int(header->ruleCount) : 0;
+}
+
+int FilterMatcher::domainCount() const {
+  return header ? int(header->blockDomainCount + header->allowDomainCount) : 0;
+}
+
+quint64 FilterMatcher::hashDomain(const char *data, int length) {
+  // FNV-1a; stable across runs, unlike qHash
+  quint64 hash = 14695981039346656037ULL;
+  for (int i = 0; i < length; ++i) {
+    hash ^= uchar(data[i]);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+quint32 FilterMatcher::hashToken(const char *data, int length) {
+  quint32 hash = 2166136261U;
+  for (int i = 0; i < length; ++i) {
+    hash ^= uchar(data[i]);
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+bool FilterMatcher::isTokenChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '%';
+}
+
+bool FilterMatcher::isThirdParty(const QByteArray &host, const QByteArray &firstPartyHost) {
+  if (firstPartyHost.isEmpty() || host == firstPartyHost)
+    return false;
+  return baseDomain(host) != baseDomain(firstPartyHost);
+}
+
+bool FilterMatcher::hasDomain(quint32 offset, quint32 count, const QByteArray &host) const {
+  if (count == 0 || host.isEmpty())
+    return false;
+
+  const quint64 *begin = reinterpret_cast<const quint64 *>(data + offset);
+  const quint64 *end = begin + count;
+
+  // Try the host and every parent domain: a.b.example.com, b.example.com, ...
+  int start = 0;
+  while (start < host.size()) {
+    const quint64 hash = hashDomain(host.constData() + start, host.size() - start);
+    if (std::binary_search(begin, end, hash))
+      return true;
+    const int dot = host.indexOf('.', start);
+    if (dot < 0)
+      break;
+    start = dot + 1;
+  }
+  return false;
+}
+
+bool FilterMatcher::domainsMatch(const Rule &rule, const QByteArray &firstPartyHost) const {
+  if (rule.domainsLength == 0)
+    return true;
+
+  const char *domains = reinterpret_cast<const char *>(data + header->stringsOffset + rule.domainsOffset);
+  const char *end = domains + rule.domainsLength;
+  bool hasIncludes = false;
+  bool included = false;
+
+  while (domains < end) {
+    const char *next = std::find(domains, end, '|');
+    const bool negated = *domains == '~';
+    const char *domain = negated ? domains + 1 : domains;
+    const bool matches = hostMatchesDomain(firstPartyHost, domain, int(next - domain));
+    if (negated && matches)
+      return false;
+    if (!negated) {
+      hasIncludes = true;
+      included = included || matches;
+    }
+    domains = next < end ? next + 1 : end;
+  }
+  return !hasIncludes || included;
+}
+
+bool FilterMatcher::ruleMatches(const Rule &rule, const Request &request, int hostStart, int hostEnd) const {
+  if (!(rule.typeMask & request.type))
+    return false;
+
+  const char *pattern = reinterpret_cast<const char *>(data + header->stringsOffset + rule.patternOffset);
+  const char *patternEnd = pattern + rule.patternLength;
+  const char *url = request.url.constData();
+  const char *urlEnd = url + request.url.size();
+  const bool anchorEnd = rule.flags & RuleAnchorEnd;
+
+  bool matched = false;
+  if (rule.flags & RuleAnchorDomain) {
+    // Start at the host or right after any dot inside it
+    for (int i = hostStart; i >= 0 && i < hostEnd && !matched; ++i) {
+      if (i == hostStart || url[i - 1] == '.') {
+        matched = matchHere(pattern, patternEnd, url + i, urlEnd, anchorEnd);
+      }
+    }
+  } else if (rule.flags & RuleAnchorStart) {
+    matched = matchHere(pattern, patternEnd, url, urlEnd, anchorEnd);
+  } else {
+    const char first = rule.patternLength > 0 ? pattern[0] : '*';
+    for (const char *s = url; s <= urlEnd && !matched; ++s) {
+      if (first != '*' && first != '^') {
+        s = static_cast<const char *>(memchr(s, first, urlEnd - s));
+        if (!s)
+          break;
+      }
+      matched = matchHere(pattern, patternEnd, s, urlEnd, anchorEnd);
+    }
+  }
+
+  return matched && domainsMatch(rule, request.firstPartyHost);
+}
+
+bool FilterMatcher::shouldBlock(const Request &request) const {
+  if (!header)
+    return false;
+
+  if (hasDomain(header->allowDomainOffset, header->allowDomainCount, request.host))
+    return false;
+
+  const bool thirdParty = isThirdParty(request.host, request.firstPartyHost);
+
+  int hostStart = request.url.indexOf("://");
+  int hostEnd = -1;
+  if (hostStart >= 0) {
+    hostStart += 3;
+    hostEnd = hostStart;
+    while (hostEnd < request.url.size() && !strchr("/?#:", request.url.at(hostEnd))) {
+      ++hostEnd;
+    }
+  }
+
+  // Hash every token of the URL once
+  QVarLengthArray<quint32, 64> tokens;
+  const char *url = request.url.constData();
+  for (int i = 0; i < request.url.size();) {
+    if (!isTokenChar(url[i])) {
+      ++i;
+      continue;
+    }
+    int j = i;
+    while (j < request.url.size() && isTokenChar(url[j])) {
+      ++j;
+    }
+    tokens.append(hashToken(url + i, j - i));
+    i = j;
+  }
+
+  const Rule *rules = reinterpret_cast<const Rule *>(data + header->ruleOffset);
+  const TokenEntry *index = reinterpret_cast<const TokenEntry *>(data + header->tokenOffset);
+  const TokenEntry *indexEnd = index + header->tokenCount;
+  const quint32 *untokenized = reinterpret_cast<const quint32 *>(data + header->untokenizedOffset);
+
+  auto check = [&](const Rule &rule, bool exception) {
+    if (bool(rule.flags & RuleException) != exception)
+      return false;
+    if ((rule.flags & RuleThirdParty) && !thirdParty)
+      return false;
+    if ((rule.flags & RuleFirstParty) && thirdParty)
+      return false;
+    return ruleMatches(rule, request, hostStart, hostEnd);
+  };
+
+  auto findMatch = [&](bool exception) {
+    for (quint32 token : tokens) {
+      auto range = std::equal_range(index, indexEnd, TokenEntry{token, 0},
+                                    [](const TokenEntry &a, const TokenEntry &b) { return a.hash < b.hash; });
+      for (const TokenEntry *entry = range.first; entry != range.second; ++entry) {
+        if (check(rules[entry->rule], exception))
+          return true;
+      }
+    }
+    for (quint32 i = 0; i < header->untokenizedCount; ++i) {
+      if (check(rules[untokenized[i]], exception))
+        return true;
+    }
+    return false;
+  };
+
+  const bool blocked = hasDomain(header->blockDomainOffset, header->blockDomainCount, request.host) ||
+                       findMatch(false);
+  return blocked && !findMatch(true);
+}
@@ -0,0 +1,126 @@
+#ifndef FILTERMATCHER_H
+#define FILTERMATCHER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+/**
+ * @brief Matches requests against a compiled filter list
+ *
+ * The compiled list (see FilterListCompiler) is a flat binary file that is
+ * memory-mapped and used in place, so opening it costs a single mmap:
+ *
+ * - sorted 64-bit hashes of "||domain^" block and "@@||domain^" allow rules
+ * - a rule table (pattern, anchors, options) for everything else
+ * - a token index: sorted (token hash, rule) pairs, one token per rule
+ * - rules without a usable token, which are checked for every request
+ * - a string pool with the lower-cased patterns and $domain= lists
+ *
+ * A request is tokenized once; only rules whose token occurs in the URL are
+ * verified against the full pattern.
+ */
+class FilterMatcher {
+public:
+  // Resource types for $script, $image, ... options
+  enum ResourceType : quint32 {
+    TypeOther = 1 << 0,
+    TypeScript = 1 << 1,
+    TypeImage = 1 << 2,
+    TypeStylesheet = 1 << 3,
+    TypeObject = 1 << 4,
+    TypeXmlHttpRequest = 1 << 5,
+    TypeSubdocument = 1 << 6,
+    TypeMedia = 1 << 7,
+    TypeFont = 1 << 8,
+    TypePing = 1 << 9,
+    TypeWebSocket = 1 << 10,
+    TypeAll = (1 << 11) - 1
+  };
+
+  enum RuleFlag : quint16 {
+    RuleException = 1 << 0,
+    RuleAnchorStart = 1 << 1,  // |pattern
+    RuleAnchorEnd = 1 << 2,    // pattern|
+    RuleAnchorDomain = 1 << 3, // ||pattern
+    RuleThirdParty = 1 << 4,
+    RuleFirstParty = 1 << 5
+  };
+
+  // On-disk layout; native byte order, the cache never leaves this machine
+  struct Header {
+    char magic[4];
+    quint32 version;
+    quint64 fingerprint;
+    quint32 blockDomainCount;
+    quint32 blockDomainOffset;
+    quint32 allowDomainCount;
+    quint32 allowDomainOffset;
+    quint32 ruleCount;
+    quint32 ruleOffset;
+    quint32 tokenCount;
+    quint32 tokenOffset;
+    quint32 untokenizedCount;
+    quint32 untokenizedOffset;
+    quint32 stringsOffset;
+    quint32 stringsSize;
+  };
+
+  struct Rule {
+    quint32 patternOffset;
+    quint32 domainsOffset; // "a.com|~b.com", empty when unrestricted
+    quint16 patternLength;
+    quint16 domainsLength;
+    quint16 flags;
+    quint16 reserved;
+    quint32 typeMask;
+  };
+
+  struct TokenEntry {
+    quint32 hash;
+    quint32 rule;
+  };
+
+  static const char MAGIC[4];
+  static const quint32 VERSION = 1;
+
+  struct Request {
+    QByteArray url;       // lower-cased, encoded
+    QByteArray host;      // lower-cased request host
+    QByteArray firstPartyHost;
+    quint32 type = TypeOther;
+  };
+
+  FilterMatcher();
+  ~FilterMatcher();
+
+  // Map a compiled list; fails on a missing, truncated, corrupt or stale file
+  bool open(const QString &path, quint64 expectedFingerprint);
+  void close();
+  bool isOpen() const { return data != nullptr; }
+
+  quint64 fingerprint() const;
+  int ruleCount() const;
+  int domainCount() const;
+
+  bool shouldBlock(const Request &request) const;
+
+  // Shared with the compiler
+  static quint64 hashDomain(const char *data, int length);
+  static quint32 hashToken(const char *data, int length);
+  static bool isTokenChar(char c);
+  static bool isThirdParty(const QByteArray &host, const QByteArray &firstPartyHost);
+
+private:
+  bool isValid() const;
+  bool hasDomain(quint32 offset, quint32 count, const QByteArray &host) const;
+  bool ruleMatches(const Rule &rule, const Request &request, int hostStart, int hostEnd) const;
+  bool domainsMatch(const Rule &rule, const QByteArray &firstPartyHost) const;
+
+  QFile file;
+  const uchar *data;
+  qint64 size;
+  const Header *header;
+};
+
+#endif // FILTERMATCHER_H
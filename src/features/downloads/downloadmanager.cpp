@@ -0,0 +1,302 @@
+#include "downloadmanager.h"
+#include "../logging/logcategories.h"
+#include "../main-window/mainwindow.h"
+#include "../profile/browserprofile.h"
+#include "../tab-snapshots/tabsnapshotstore.h"
+#include "downloadspanel.h"
+#include "segmenteddownload.h"
+#include <QDir>
+#include <QDockWidget>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QKeySequence>
+#include <QNetworkAccessManager>
+#include <QNetworkCookieJar>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStatusBar>
+#include <QWebEngineCookieStore>
+#include <QWebEngineDownloadRequest>
+#include <QWebEnginePage>
+#include <QWebEngineProfile>
+
+namespace {
+const int SAVE_DELAY_MS = 2000;
+const int STATUS_MESSAGE_MS = 5000;
+const int PROBE_TIMEOUT_MS = 5000; // WebEngine's download waits for the probe
+
+QByteArray mimeTypeOf(const QByteArray &contentType) {
+  return contentType.split(';').first().trimmed().toLower();
+}
+
+// Every window shares the profile; only the first manager takes its downloads
+QPointer<DownloadManager> profileOwner;
+
+bool isUnfinished(SegmentedDownload::State state) {
+  return state != SegmentedDownload::Completed && state != SegmentedDownload::Cancelled;
+}
+} // namespace
+
+DownloadManager::DownloadManager(MainWindow *parent)
+    : QObject(parent), mainWindow(parent), network(new QNetworkAccessManager(this)), panel(nullptr),
+      dockWidget(nullptr), showDownloadsAction(nullptr) {
+  QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+  QDir().mkpath(appDataPath);
+  statePath = appDataPath + "/downloads.json";
+
+  saveTimer.setSingleShot(true);
+  saveTimer.setInterval(SAVE_DELAY_MS);
+  connect(&saveTimer, &QTimer::timeout, this, &DownloadManager::saveState);
+
+  if (!profileOwner) {
+    profileOwner = this;
+    connect(BrowserProfile::instance()->profile(), &QWebEngineProfile::downloadRequested, this,
+            &DownloadManager::onDownloadRequested);
+    syncCookies();
+    restoreState();
+  }
+}
+
+DownloadManager::~DownloadManager() {
+  // Downloads are still alive here, so in-flight ones are recorded as active
+  if (profileOwner == this) {
+    saveState();
+  }
+}
+
+void DownloadManager::setupActions() {
+  showDownloadsAction = new QAction("Downloads", mainWindow);
+  showDownloadsAction->setShortcut(QKeySequence("Ctrl+Shift+J"));
+  showDownloadsAction->setStatusTip("Show the downloads panel (Ctrl+Shift+J)");
+  connect(showDownloadsAction, &QAction::triggered, this, &DownloadManager::showDownloads);
+}
+
+QDockWidget *DownloadManager::createDownloadsDock(QWidget *parent) {
+  dockWidget = new QDockWidget("Downloads", parent);
+  dockWidget->setFeatures(QDockWidget::DockWidgetMovable | QDockWidget::DockWidgetFloatable |
+                          QDockWidget::DockWidgetClosable);
+  dockWidget->setAllowedAreas(Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea | Qt::BottomDockWidgetArea);
+
+  panel = new DownloadsPanel(dockWidget);
+  dockWidget->setWidget(panel);
+  connect(panel, &DownloadsPanel::clearFinishedRequested, this, &DownloadManager::clearFinished);
+
+  // Restored downloads exist before the panel does
+  for (SegmentedDownload *download : downloads()) {
+    panel->addDownload(download);
+  }
+  return dockWidget;
+}
+
+void DownloadManager::showDownloads() {
+  if (dockWidget) {
+    dockWidget->show();
+    dockWidget->raise();
+  }
+}
+
+QList<SegmentedDownload *> DownloadManager::downloads() const {
+  QList<SegmentedDownload *> result;
+  for (const QPointer<SegmentedDownload> &download : items) {
+    if (download)
+      result.append(download);
+  }
+  return result;
+}
+
+QString DownloadManager::downloadDirectory() const {
+  const QString path = BrowserProfile::instance()->profile()->downloadPath();
+  return path.isEmpty() ? QStandardPaths::writableLocation(QStandardPaths::DownloadLocation) : path;
+}
+
+void DownloadManager::syncCookies() {
+  // Mirror WebEngine's cookies so downloads behind a login keep working
+  QWebEngineCookieStore *cookieStore = BrowserProfile::instance()->profile()->cookieStore();
+  QNetworkCookieJar *jar = network->cookieJar();
+  connect(cookieStore, &QWebEngineCookieStore::cookieAdded, jar,
+          [jar](const QNetworkCookie &cookie) { jar->insertCookie(cookie); });
+  connect(cookieStore, &QWebEngineCookieStore::cookieRemoved, jar,
+          [jar](const QNetworkCookie &cookie) { jar->deleteCookie(cookie); });
+  cookieStore->loadAllCookies();
+}
+
+void DownloadManager::onDownloadRequested(QWebEngineDownloadRequest *request) {
+  // Background tab snapshots are handled by their store
+  if (TabSnapshotStore::instance()->ownsDownload(request))
+    return;
+
+  const QUrl url = request->url();
+
+  // Local content and saved pages have nothing to fetch in ranges
+  if (request->isSavePageDownload() || (url.scheme() != "http" && url.scheme() != "https")) {
+    acceptNative(request);
+    return;
+  }
+
+  // Some servers only serve files to their own pages
+  QByteArray referrer;
+  if (QWebEnginePage *page = request->page()) {
+    referrer = page->url().toEncoded(QUrl::RemoveFragment | QUrl::RemoveUserInfo);
+  }
+
+  // WebEngine's request stays pending until the probe says whether fetching again is safe
+  QNetworkRequest probe(url);
+  probe.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+  probe.setHeader(QNetworkRequest::UserAgentHeader, BrowserProfile::instance()->profile()->httpUserAgent());
+  probe.setRawHeader("Accept-Encoding", "identity");
+  if (!referrer.isEmpty()) {
+    probe.setRawHeader("Referer", referrer);
+  }
+  probe.setTransferTimeout(PROBE_TIMEOUT_MS);
+
+  QNetworkReply *reply = network->head(probe);
+  QPointer<QWebEngineDownloadRequest> pending(request);
+  connect(reply, &QNetworkReply::finished, this, [this, reply, pending, referrer]() {
+    reply->deleteLater();
+    if (!pending || pending->state() != QWebEngineDownloadRequest::DownloadRequested)
+      return;
+
+    // WebEngine doesn't tell the method: a POST result, a Referer check or a used one-time URL shows up
+    // as a failed probe or as a different type or size than the response WebEngine already has
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const qint64 length = reply->header(QNetworkRequest::ContentLengthHeader).toLongLong();
+    const QByteArray probedType = mimeTypeOf(reply->header(QNetworkRequest::ContentTypeHeader).toByteArray());
+    const QByteArray expectedType = mimeTypeOf(pending->mimeType().toUtf8());
+    const bool sameResponse = (pending->totalBytes() <= 0 || pending->totalBytes() == length) &&
+                              (expectedType.isEmpty() || probedType.isEmpty() || probedType == expectedType);
+    const bool splittable = reply->error() == QNetworkReply::NoError && status >= 200 && status < 300 &&
+                            reply->rawHeader("Accept-Ranges").toLower().contains("bytes") &&
+                            length >= 2 * SegmentedDownload::MIN_SEGMENT_SIZE;
+
+    if (splittable && sameResponse) {
+      takeOver(pending, referrer);
+    } else {
+      acceptNative(pending);
+    }
+  });
+}
+
+void DownloadManager::acceptNative(QWebEngineDownloadRequest *request) {
+  connect(request, &QWebEngineDownloadRequest::isFinishedChanged, this, [this, request]() {
+    if (request->state() == QWebEngineDownloadRequest::DownloadCompleted) {
+      mainWindow->statusBar()->showMessage(QString("Downloaded %1").arg(request->downloadFileName()),
+                                           STATUS_MESSAGE_MS);
+    }
+  });
+  request->accept();
+}
+
+void DownloadManager::takeOver(QWebEngineDownloadRequest *request, const QByteArray &referrer) {
+  const QUrl url = request->url();
+  const QString target = QDir(request->downloadDirectory()).filePath(request->downloadFileName());
+  request->cancel();
+
+  qCDebug(lcDownloads) << "DownloadManager: taking over" << url << "->" << target;
+
+  SegmentedDownload *download = new SegmentedDownload(network, url, SegmentedDownload::uniquePath(target), this);
+  download->setUserAgent(BrowserProfile::instance()->profile()->httpUserAgent().toUtf8());
+  download->setReferrer(referrer);
+  track(download);
+  download->start();
+  showDownloads();
+}
+
+SegmentedDownload *DownloadManager::startDownload(const QUrl &url, const QString &fileName) {
+  QString name = fileName.isEmpty() ? QFileInfo(url.path()).fileName() : fileName;
+  if (name.isEmpty()) {
+    name = "download";
+  }
+
+  SegmentedDownload *download = new SegmentedDownload(
+      network, url, SegmentedDownload::uniquePath(QDir(downloadDirectory()).filePath(name)), this);
+  download->setUserAgent(BrowserProfile::instance()->profile()->httpUserAgent().toUtf8());
+  track(download);
+  download->start();
+  return download;
+}
+
+void DownloadManager::track(SegmentedDownload *download) {
+  items.append(download);
+  if (panel) {
+    panel->addDownload(download);
+  }
+
+  connect(download, &SegmentedDownload::progressChanged, this, &DownloadManager::scheduleSave);
+  connect(download, &SegmentedDownload::stateChanged, this, [this, download](SegmentedDownload::State state) {
+    if (state == SegmentedDownload::Completed) {
+      mainWindow->statusBar()->showMessage(QString("Downloaded %1").arg(download->fileName()), STATUS_MESSAGE_MS);
+    } else if (state == SegmentedDownload::Failed) {
+      mainWindow->statusBar()->showMessage(
+          QString("Download of %1 failed: %2").arg(download->fileName(), download->errorString()), STATUS_MESSAGE_MS);
+    }
+    saveState();
+  });
+}
+
+void DownloadManager::clearFinished() {
+  for (int i = items.size() - 1; i >= 0; --i) {
+    SegmentedDownload *download = items[i];
+    if (!download || !isUnfinished(download->state())) {
+      items.removeAt(i);
+      if (download) {
+        download->deleteLater();
+      }
+    }
+  }
+}
+
+void DownloadManager::scheduleSave() {
+  if (!saveTimer.isActive()) {
+    saveTimer.start();
+  }
+}
+
+void DownloadManager::saveState() {
+  saveTimer.stop();
+
+  QJsonArray array;
+  for (SegmentedDownload *download : downloads()) {
+    const SegmentedDownload::State state = download->state();
+    if (!isUnfinished(state))
+      continue;
+    QJsonObject object = download->toJson();
+    object["active"] = state == SegmentedDownload::Probing || state == SegmentedDownload::Downloading ||
+                       state == SegmentedDownload::Verifying;
+    array.append(object);
+  }
+
+  QJsonObject root;
+  root["version"] = 1;
+  root["downloads"] = array;
+
+  QSaveFile file(statePath);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qCWarning(lcDownloads) << "Failed to save downloads to" << statePath;
+    return;
+  }
+  file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+  file.commit();
+}
+
+void DownloadManager::restoreState() {
+  QFile file(statePath);
+  if (!file.open(QIODevice::ReadOnly))
+    return;
+
+  const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+  for (const QJsonValue &value : root["downloads"].toArray()) {
+    const QJsonObject object = value.toObject();
+    SegmentedDownload *download = SegmentedDownload::fromJson(network, object, this);
+    download->setUserAgent(BrowserProfile::instance()->profile()->httpUserAgent().toUtf8());
+    track(download);
+    // Downloads interrupted by quitting continue; paused ones wait for the user
+    if (object["active"].toBool()) {
+      download->resume();
+    }
+  }
+}
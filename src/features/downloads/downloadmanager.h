@@ -0,0 +1,74 @@
+#ifndef DOWNLOADMANAGER_H
+#define DOWNLOADMANAGER_H
+
+#include <QAction>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QUrl>
+
+class MainWindow;
+class QDockWidget;
+class QNetworkAccessManager;
+class QWebEngineDownloadRequest;
+class DownloadsPanel;
+class SegmentedDownload;
+
+/**
+ * @brief Takes over the profile's downloads and shows them in a dock panel
+ *
+ * An HTTP(S) download stays pending in WebEngine while a HEAD probe checks
+ * the URL. Only a plain GET of a large file on a server that accepts byte
+ * ranges is cancelled there and fetched again by a SegmentedDownload, with
+ * the profile's cookies, user agent and the page as referrer, so it can
+ * use parallel ranges. Everything else (POST results, one-time URLs,
+ * blob:, data:, saved pages) is accepted and left to WebEngine.
+ * Unfinished segmented downloads are kept in <AppData>/downloads.json and
+ * resumed on the next start.
+ */
+class DownloadManager : public QObject {
+  Q_OBJECT
+
+public:
+  explicit DownloadManager(MainWindow *parent = nullptr);
+  ~DownloadManager();
+
+  void setupActions();
+  QAction *getShowDownloadsAction() const { return showDownloadsAction; }
+
+  QDockWidget *createDownloadsDock(QWidget *parent);
+
+  // Starts a download directly, e.g. from the local test server
+  SegmentedDownload *startDownload(const QUrl &url, const QString &fileName = QString());
+
+  QList<SegmentedDownload *> downloads() const;
+
+public slots:
+  void showDownloads();
+  void clearFinished();
+
+private slots:
+  void onDownloadRequested(QWebEngineDownloadRequest *request);
+  void saveState();
+
+private:
+  void acceptNative(QWebEngineDownloadRequest *request);
+  void takeOver(QWebEngineDownloadRequest *request, const QByteArray &referrer);
+  void track(SegmentedDownload *download);
+  void syncCookies();
+  void restoreState();
+  void scheduleSave();
+  QString downloadDirectory() const;
+
+  MainWindow *mainWindow;
+  QNetworkAccessManager *network;
+  QList<QPointer<SegmentedDownload>> items;
+  DownloadsPanel *panel;
+  QDockWidget *dockWidget;
+  QAction *showDownloadsAction;
+  QString statePath;
+  QTimer saveTimer;
+};
+
+#endif // DOWNLOADMANAGER_H
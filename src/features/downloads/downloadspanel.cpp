@@ -0,0 +1,261 @@
+#include "downloadspanel.h"
+#include "segmenteddownload.h"
+#include <QDesktopServices>
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QInputDialog>
+#include <QLabel>
+#include <QLineEdit>
+#include <QLocale>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QScrollArea>
+#include <QToolButton>
+#include <QUrl>
+#include <QVBoxLayout>
+
+/**
+ * @brief One row of the downloads panel
+ */
+class DownloadItemWidget : public QWidget {
+public:
+  DownloadItemWidget(SegmentedDownload *download, QWidget *parent = nullptr);
+
+  void refresh();
+
+private:
+  QString statusText() const;
+  void primaryClicked();
+  void secondaryClicked();
+  void verifyChecksum();
+
+  SegmentedDownload *download;
+  QLabel *nameLabel;
+  QLabel *statusLabel;
+  QProgressBar *progressBar;
+  QToolButton *primaryButton;   // Pause / Resume / Retry / Open
+  QToolButton *secondaryButton; // Cancel / Show in Folder
+  QToolButton *verifyButton;
+};
+
+DownloadItemWidget::DownloadItemWidget(SegmentedDownload *download, QWidget *parent)
+    : QWidget(parent), download(download) {
+  QVBoxLayout *layout = new QVBoxLayout(this);
+  layout->setContentsMargins(8, 6, 8, 6);
+  layout->setSpacing(4);
+
+  QHBoxLayout *topRow = new QHBoxLayout();
+  nameLabel = new QLabel(this);
+  nameLabel->setObjectName("downloadName");
+  nameLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+  primaryButton = new QToolButton(this);
+  secondaryButton = new QToolButton(this);
+  verifyButton = new QToolButton(this);
+  verifyButton->setText("Verify…");
+  verifyButton->setToolTip("Compare the file with a SHA-256 checksum");
+  topRow->addWidget(nameLabel, 1);
+  topRow->addWidget(verifyButton);
+  topRow->addWidget(primaryButton);
+  topRow->addWidget(secondaryButton);
+  layout->addLayout(topRow);
+
+  progressBar = new QProgressBar(this);
+  progressBar->setTextVisible(false);
+  progressBar->setMaximumHeight(6);
+  layout->addWidget(progressBar);
+
+  statusLabel = new QLabel(this);
+  statusLabel->setObjectName("downloadStatus");
+  layout->addWidget(statusLabel);
+
+  connect(primaryButton, &QToolButton::clicked, this, [this]() { primaryClicked(); });
+  connect(secondaryButton, &QToolButton::clicked, this, [this]() { secondaryClicked(); });
+  connect(verifyButton, &QToolButton::clicked, this, [this]() { verifyChecksum(); });
+  connect(download, &SegmentedDownload::progressChanged, this, [this]() { refresh(); });
+
+  refresh();
+}
+
+void DownloadItemWidget::refresh() {
+  const SegmentedDownload::State state = download->state();
+  nameLabel->setText(download->fileName());
+  nameLabel->setToolTip(download->url().toString());
+  statusLabel->setText(statusText());
+
+  const qint64 total = download->totalBytes();
+  if (state == SegmentedDownload::Completed) {
+    progressBar->setRange(0, 1);
+    progressBar->setValue(1);
+  } else if (total > 0) {
+    // Per mille keeps the value inside an int for multi-gigabyte files
+    progressBar->setRange(0, 1000);
+    progressBar->setValue(int(download->receivedBytes() * 1000 / total));
+  } else {
+    progressBar->setRange(0, state == SegmentedDownload::Downloading ? 0 : 1); // Busy indicator
+    progressBar->setValue(0);
+  }
+
+  switch (state) {
+  case SegmentedDownload::Probing:
+  case SegmentedDownload::Downloading:
+    primaryButton->setText("Pause");
+    secondaryButton->setText("Cancel");
+    break;
+  case SegmentedDownload::Paused:
+    primaryButton->setText("Resume");
+    secondaryButton->setText("Cancel");
+    break;
+  case SegmentedDownload::Failed:
+    primaryButton->setText("Retry");
+    secondaryButton->setText("Cancel");
+    break;
+  case SegmentedDownload::Completed:
+    primaryButton->setText("Open");
+    secondaryButton->setText("Show in Folder");
+    break;
+  case SegmentedDownload::Verifying:
+  case SegmentedDownload::Cancelled:
+    break;
+  }
+
+  const bool busy = state == SegmentedDownload::Verifying || state == SegmentedDownload::Cancelled;
+  primaryButton->setVisible(!busy);
+  secondaryButton->setVisible(!busy);
+  verifyButton->setVisible(state == SegmentedDownload::Completed);
+}
+
+QString DownloadItemWidget::statusText() const {
+  const QLocale locale;
+  const qint64 received = download->receivedBytes();
+  const qint64 total = download->totalBytes();
+  QString size = locale.formattedDataSize(received);
+  if (total > 0) {
+    size = QString("%1 of %2").arg(size, locale.formattedDataSize(total));
+  }
+
+  switch (download->state()) {
+  case SegmentedDownload::Probing:
+    return "Connecting…";
+  case SegmentedDownload::Downloading: {
+    QString text = QString("%1 · %2/s").arg(size, locale.formattedDataSize(qint64(download->bytesPerSecond())));
+    if (download->isSegmented()) {
+      text += QString(" · %1 of %2 segments active")
+                  .arg(download->activeSegments())
+                  .arg(download->segmentCount());
+    }
+    if (total > 0 && download->bytesPerSecond() > 0) {
+      const qint64 seconds = qint64((total - received) / download->bytesPerSecond());
+      text += seconds >= 60 ? QString(" · %1 min left").arg(seconds / 60) : QString(" · %1 s left").arg(seconds);
+    }
+    return text;
+  }
+  case SegmentedDownload::Paused:
+    return QString("Paused · %1").arg(size);
+  case SegmentedDownload::Verifying:
+    return "Verifying checksum…";
+  case SegmentedDownload::Completed:
+    switch (download->checksumStatus()) {
+    case SegmentedDownload::ChecksumMatched:
+      return QString("%1 · SHA-256 verified").arg(locale.formattedDataSize(total));
+    case SegmentedDownload::ChecksumMismatched:
+      return QString("%1 · SHA-256 does not match").arg(locale.formattedDataSize(total));
+    case SegmentedDownload::ChecksumUnknown:
+      break;
+    }
+    return QString("%1 · SHA-256 %2").arg(locale.formattedDataSize(total), QString(download->checksum().left(16)));
+  case SegmentedDownload::Failed:
+    return QString("Failed: %1").arg(download->errorString());
+  case SegmentedDownload::Cancelled:
+    return "Cancelled";
+  }
+  return QString();
+}
+
+void DownloadItemWidget::primaryClicked() {
+  switch (download->state()) {
+  case SegmentedDownload::Probing:
+  case SegmentedDownload::Downloading:
+    download->pause();
+    break;
+  case SegmentedDownload::Paused:
+    download->resume();
+    break;
+  case SegmentedDownload::Failed:
+    // A checksum failure already reset the segments, so resume refetches them
+    download->resume();
+    break;
+  case SegmentedDownload::Completed:
+    QDesktopServices::openUrl(QUrl::fromLocalFile(download->targetPath()));
+    break;
+  default:
+    break;
+  }
+}
+
+void DownloadItemWidget::secondaryClicked() {
+  if (download->state() == SegmentedDownload::Completed) {
+    QDesktopServices::openUrl(QUrl::fromLocalFile(QFileInfo(download->targetPath()).absolutePath()));
+  } else {
+    download->cancel();
+  }
+}
+
+void DownloadItemWidget::verifyChecksum() {
+  bool ok = false;
+  const QString expected = QInputDialog::getText(this, "Verify Download",
+                                                 QString("SHA-256 of %1:").arg(download->fileName()),
+                                                 QLineEdit::Normal, QString(download->expectedChecksum()), &ok);
+  if (ok) {
+    download->setExpectedChecksum(expected.toLatin1());
+  }
+}
+
+DownloadsPanel::DownloadsPanel(QWidget *parent) : QWidget(parent) {
+  QVBoxLayout *layout = new QVBoxLayout(this);
+
+  QHBoxLayout *buttonLayout = new QHBoxLayout();
+  QPushButton *clearButton = new QPushButton("Clear Finished", this);
+  clearButton->setToolTip("Remove completed and cancelled downloads from the list");
+  buttonLayout->addStretch();
+  buttonLayout->addWidget(clearButton);
+  layout->addLayout(buttonLayout);
+  connect(clearButton, &QPushButton::clicked, this, &DownloadsPanel::clearFinishedRequested);
+
+  QWidget *listWidget = new QWidget();
+  listLayout = new QVBoxLayout(listWidget);
+  listLayout->setContentsMargins(0, 0, 0, 0);
+  listLayout->setSpacing(2);
+  emptyLabel = new QLabel("No downloads", listWidget);
+  emptyLabel->setAlignment(Qt::AlignCenter);
+  emptyLabel->setObjectName("downloadsEmpty");
+  listLayout->addWidget(emptyLabel);
+  listLayout->addStretch();
+
+  QScrollArea *scrollArea = new QScrollArea(this);
+  scrollArea->setWidgetResizable(true);
+  scrollArea->setFrameShape(QFrame::NoFrame);
+  scrollArea->setWidget(listWidget);
+  layout->addWidget(scrollArea);
+}
+
+void DownloadsPanel::addDownload(SegmentedDownload *download) {
+  if (rows.contains(download))
+    return;
+
+  DownloadItemWidget *row = new DownloadItemWidget(download);
+  // Newest first, below the empty label
+  listLayout->insertWidget(1, row);
+  rows.insert(download, row);
+
+  connect(download, &QObject::destroyed, this, [this, download]() {
+    if (DownloadItemWidget *removed = rows.take(download)) {
+      removed->deleteLater();
+    }
+    updateEmptyState();
+  });
+  updateEmptyState();
+}
+
+void DownloadsPanel::updateEmptyState() {
+  emptyLabel->setVisible(rows.isEmpty());
+}
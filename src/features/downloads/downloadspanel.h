@@ -0,0 +1,38 @@
+#ifndef DOWNLOADSPANEL_H
+#define DOWNLOADSPANEL_H
+
+#include <QHash>
+#include <QWidget>
+
+class QVBoxLayout;
+class QLabel;
+class SegmentedDownload;
+class DownloadItemWidget;
+
+/**
+ * @brief List of downloads with progress, throughput and per-item controls
+ *
+ * Rows refresh from SegmentedDownload::progressChanged, which is already
+ * throttled, so a fast download does not repaint the panel per packet.
+ */
+class DownloadsPanel : public QWidget {
+  Q_OBJECT
+
+public:
+  explicit DownloadsPanel(QWidget *parent = nullptr);
+
+  // The row goes away when the download object is destroyed
+  void addDownload(SegmentedDownload *download);
+
+signals:
+  void clearFinishedRequested();
+
+private:
+  void updateEmptyState();
+
+  QVBoxLayout *listLayout;
+  QLabel *emptyLabel;
+  QHash<SegmentedDownload *, DownloadItemWidget *> rows;
+};
+
+#endif // DOWNLOADSPANEL_H
@@ -0,0 +1,649 @@
+#include "segmenteddownload.h"
+#include "../logging/logcategories.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTimer>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+const int MAX_RETRIES = 3;
+const int RETRY_DELAY_MS = 1000; // Multiplied by the attempt number
+const int SAMPLE_INTERVAL_MS = 500;
+const double THROUGHPUT_SMOOTHING = 0.3;
+const int HASH_CHUNK_SIZE = 1024 * 1024;
+
+// Value of "sha-256=..." in a comma separated digest list, as hex
+QByteArray sha256FromDigestList(const QByteArray &header) {
+  for (QByteArray entry : header.split(',')) {
+    entry = entry.trimmed();
+    if (!entry.toLower().startsWith("sha-256="))
+      continue;
+    QByteArray value = entry.mid(8);
+    // Repr-Digest wraps the value in colons (RFC 9530), Digest does not (RFC 3230)
+    if (value.startsWith(':') && value.endsWith(':') && value.size() > 1) {
+      value = value.mid(1, value.size() - 2);
+    }
+    const QByteArray raw = QByteArray::fromBase64(value);
+    if (raw.size() == 32)
+      return raw.toHex();
+  }
+  return QByteArray();
+}
+
+int httpStatus(QNetworkReply *reply) {
+  return reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+}
+} // namespace
+
+SegmentedDownload::SegmentedDownload(QNetworkAccessManager *network, const QUrl &url, const QString &targetPath,
+                                     QObject *parent)
+    : QObject(parent), network(network), sourceUrl(url), target(targetPath), currentState(Paused), total(-1),
+      rangesSupported(false), sampleTimer(new QTimer(this)), lastSampleBytes(0), throughput(0.0) {
+  sampleTimer->setInterval(SAMPLE_INTERVAL_MS);
+  connect(sampleTimer, &QTimer::timeout, this, &SegmentedDownload::sampleThroughput);
+}
+
+SegmentedDownload::~SegmentedDownload() {
+  hashJob.cancel();
+  abortSegments();
+  if (probeReply) {
+    probeReply->abort();
+  }
+}
+
+QString SegmentedDownload::uniquePath(const QString &path) {
+  if (!QFileInfo::exists(path) && !QFileInfo::exists(path + ".part"))
+    return path;
+
+  const QFileInfo info(path);
+  const QString base = info.completeBaseName();
+  const QString suffix = info.suffix().isEmpty() ? QString() : "." + info.suffix();
+  for (int i = 1;; ++i) {
+    const QString candidate = info.dir().filePath(QString("%1 (%2)%3").arg(base).arg(i).arg(suffix));
+    if (!QFileInfo::exists(candidate) && !QFileInfo::exists(candidate + ".part"))
+      return candidate;
+  }
+}
+
+SegmentedDownload *SegmentedDownload::fromJson(QNetworkAccessManager *network, const QJsonObject &json,
+                                               QObject *parent) {
+  SegmentedDownload *download =
+      new SegmentedDownload(network, QUrl(json["url"].toString()), json["target"].toString(), parent);
+  download->total = json["total"].toInteger();
+  download->rangesSupported = json["ranges"].toBool();
+  download->validator = json["validator"].toString().toUtf8();
+  download->referrer = json["referrer"].toString().toUtf8();
+  download->serverSha256 = json["serverSha256"].toString().toLatin1();
+  download->expectedSha256 = json["expectedSha256"].toString().toLatin1();
+
+  // A missing or truncated part file means nothing on disk can be trusted
+  const QFileInfo part(download->partPath());
+  const bool partValid = part.exists() && (download->total <= 0 || part.size() == download->total);
+
+  for (const QJsonValue &value : json["segments"].toArray()) {
+    const QJsonObject object = value.toObject();
+    DownloadSegment segment;
+    segment.start = object["start"].toInteger();
+    segment.end = object["end"].toInteger();
+    segment.received = partValid ? object["received"].toInteger() : 0;
+    download->segments.append(segment);
+  }
+
+  // Without ranges a stream can only start over
+  if (!download->rangesSupported) {
+    for (DownloadSegment &segment : download->segments) {
+      segment.received = 0;
+    }
+  }
+  return download;
+}
+
+QJsonObject SegmentedDownload::toJson() const {
+  QJsonArray segmentArray;
+  for (const DownloadSegment &segment : segments) {
+    QJsonObject object;
+    object["start"] = segment.start;
+    object["end"] = segment.end;
+    object["received"] = segment.received;
+    segmentArray.append(object);
+  }
+
+  QJsonObject json;
+  json["url"] = sourceUrl.toString();
+  json["target"] = target;
+  json["total"] = total;
+  json["ranges"] = rangesSupported;
+  json["validator"] = QString::fromUtf8(validator);
+  json["referrer"] = QString::fromUtf8(referrer);
+  json["serverSha256"] = QString::fromLatin1(serverSha256);
+  json["expectedSha256"] = QString::fromLatin1(expectedSha256);
+  json["segments"] = segmentArray;
+  return json;
+}
+
+QString SegmentedDownload::fileName() const {
+  return QFileInfo(target).fileName();
+}
+
+qint64 SegmentedDownload::receivedBytes() const {
+  qint64 received = 0;
+  for (const DownloadSegment &segment : segments) {
+    received += segment.received;
+  }
+  return received;
+}
+
+int SegmentedDownload::activeSegments() const {
+  int active = 0;
+  for (const DownloadSegment &segment : segments) {
+    if (segment.reply)
+      ++active;
+  }
+  return active;
+}
+
+void SegmentedDownload::setExpectedChecksum(const QByteArray &sha256Hex) {
+  expectedSha256 = sha256Hex.trimmed().toLower();
+  emit progressChanged();
+}
+
+SegmentedDownload::ChecksumStatus SegmentedDownload::checksumStatus() const {
+  const QByteArray expected = expectedSha256.isEmpty() ? serverSha256 : expectedSha256;
+  if (actualSha256.isEmpty() || expected.isEmpty())
+    return ChecksumUnknown;
+  return actualSha256 == expected ? ChecksumMatched : ChecksumMismatched;
+}
+
+void SegmentedDownload::setState(State state, const QString &message) {
+  currentState = state;
+  error = message;
+
+  if (state == Downloading) {
+    lastSampleBytes = receivedBytes();
+    sampleClock.restart();
+    sampleTimer->start();
+  } else {
+    sampleTimer->stop();
+    throughput = 0.0;
+  }
+
+  qCDebug(lcDownloads) << "SegmentedDownload:" << fileName() << state << message;
+
+  emit stateChanged(state);
+  emit progressChanged();
+}
+
+void SegmentedDownload::start() {
+  if (probeReply || currentState == Downloading || currentState == Verifying)
+    return;
+
+  setState(Probing);
+
+  QNetworkRequest request(sourceUrl);
+  applyHeaders(request);
+
+  probeReply = network->head(request);
+  connect(probeReply, &QNetworkReply::finished, this, &SegmentedDownload::onProbeFinished);
+}
+
+void SegmentedDownload::onProbeFinished() {
+  QNetworkReply *reply = probeReply;
+  probeReply = nullptr;
+  if (!reply)
+    return;
+  reply->deleteLater();
+
+  if (currentState != Probing)
+    return;
+
+  const int status = httpStatus(reply);
+  if (reply->error() == QNetworkReply::NoError && status >= 200 && status < 300) {
+    sourceUrl = reply->url(); // After redirects
+    const QVariant length = reply->header(QNetworkRequest::ContentLengthHeader);
+    total = length.isValid() ? length.toLongLong() : -1;
+    rangesSupported = total > 0 && reply->rawHeader("Accept-Ranges").toLower().contains("bytes");
+
+    // Weak ETags cannot be used with If-Range
+    const QByteArray etag = reply->rawHeader("ETag");
+    validator = (!etag.isEmpty() && !etag.startsWith("W/")) ? etag : reply->rawHeader("Last-Modified");
+    readDigestHeaders(reply);
+  } else {
+    // Some servers refuse HEAD; fall back to one stream of unknown size
+    total = -1;
+    rangesSupported = false;
+    validator.clear();
+  }
+
+  planSegments();
+  if (!openPartFile())
+    return;
+
+  setState(Downloading);
+  startSegments();
+}
+
+void SegmentedDownload::applyHeaders(QNetworkRequest &request) const {
+  request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+  if (!userAgent.isEmpty()) {
+    request.setHeader(QNetworkRequest::UserAgentHeader, userAgent);
+  }
+  if (!referrer.isEmpty()) {
+    request.setRawHeader("Referer", referrer);
+  }
+  // Byte ranges refer to the encoded body; ask for the file as stored
+  request.setRawHeader("Accept-Encoding", "identity");
+}
+
+bool SegmentedDownload::rangeMatches(QNetworkReply *reply, qint64 from) const {
+  // "bytes <first>-<last>/<complete length or *>"
+  const QByteArray value = reply->rawHeader("Content-Range").trimmed();
+  if (!value.toLower().startsWith("bytes "))
+    return false;
+  const QList<QByteArray> parts = value.mid(6).split('/');
+  if (parts.size() != 2)
+    return false;
+
+  bool ok = false;
+  const qint64 first = parts[0].split('-').first().trimmed().toLongLong(&ok);
+  if (!ok || first != from)
+    return false;
+
+  const QByteArray complete = parts[1].trimmed();
+  return complete == "*" || total <= 0 || complete.toLongLong() == total;
+}
+
+void SegmentedDownload::readDigestHeaders(QNetworkReply *reply) {
+  QByteArray sha256 = sha256FromDigestList(reply->rawHeader("Repr-Digest"));
+  if (sha256.isEmpty()) {
+    sha256 = sha256FromDigestList(reply->rawHeader("Digest"));
+  }
+  if (sha256.isEmpty()) {
+    const QByteArray hex = reply->rawHeader("X-Checksum-Sha256").trimmed().toLower();
+    if (hex.size() == 64)
+      sha256 = hex;
+  }
+  serverSha256 = sha256;
+}
+
+void SegmentedDownload::planSegments() {
+  segments.clear();
+
+  int count = 1;
+  if (rangesSupported && total >= 2 * MIN_SEGMENT_SIZE) {
+    count = int(qMin<qint64>(MAX_SEGMENTS, total / MIN_SEGMENT_SIZE));
+  }
+
+  const qint64 chunk = total > 0 ? total / count : 0;
+  for (int i = 0; i < count; ++i) {
+    DownloadSegment segment;
+    segment.start = i * chunk;
+    segment.end = total > 0 ? (i == count - 1 ? total - 1 : (i + 1) * chunk - 1) : -1;
+    segments.append(segment);
+  }
+}
+
+bool SegmentedDownload::openPartFile() {
+  if (partFile.isOpen())
+    return true;
+
+  QDir().mkpath(QFileInfo(target).absolutePath());
+  partFile.setFileName(partPath());
+  // Unbuffered: segments write with pwrite() and never go through QFile's buffer
+  if (!partFile.open(QIODevice::ReadWrite | QIODevice::Unbuffered)) {
+    setState(Failed, partFile.errorString());
+    return false;
+  }
+
+  if (total > 0 && partFile.size() != total) {
+#ifdef Q_OS_LINUX
+    // Reserve the blocks up front so parallel segments do not fragment the file
+    posix_fallocate(partFile.handle(), 0, total);
+#endif
+    if (!partFile.resize(total)) {
+      setState(Failed, partFile.errorString());
+      partFile.close();
+      return false;
+    }
+  } else if (total < 0 && receivedBytes() == 0) {
+    partFile.resize(0);
+  }
+  return true;
+}
+
+bool SegmentedDownload::writeAt(qint64 offset, const QByteArray &data) {
+#ifdef Q_OS_UNIX
+  const char *bytes = data.constData();
+  qint64 remaining = data.size();
+  while (remaining > 0) {
+    const ssize_t written = ::pwrite(partFile.handle(), bytes, size_t(remaining), off_t(offset));
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    bytes += written;
+    remaining -= written;
+    offset += written;
+  }
+  return true;
+#else
+  return partFile.seek(offset) && partFile.write(data) == data.size();
+#endif
+}
+
+void SegmentedDownload::startSegments() {
+  for (int i = 0; i < segments.size(); ++i) {
+    startSegment(i);
+  }
+  // Everything may already be on disk when resuming
+  checkCompletion();
+}
+
+void SegmentedDownload::startSegment(int index) {
+  DownloadSegment &segment = segments[index];
+  if (segment.reply || segment.isComplete())
+    return;
+  if (!rangesSupported) {
+    segment.received = 0;
+  }
+
+  QNetworkRequest request(sourceUrl);
+  applyHeaders(request);
+
+  const qint64 from = segment.start + segment.received;
+  if (rangesSupported) {
+    QByteArray range = "bytes=" + QByteArray::number(from) + "-";
+    if (segment.end >= 0) {
+      range += QByteArray::number(segment.end);
+    }
+    request.setRawHeader("Range", range);
+    // The server answers 200 with the whole file if it changed since
+    if (!validator.isEmpty()) {
+      request.setRawHeader("If-Range", validator);
+    }
+  }
+
+  QNetworkReply *reply = network->get(request);
+  segment.reply = reply;
+  if (rangesSupported) {
+    // Writing a range at the wrong offset would corrupt the file without any error
+    connect(reply, &QNetworkReply::metaDataChanged, this, [this, reply, from]() {
+      if (currentState != Downloading || httpStatus(reply) != 206 || rangeMatches(reply, from))
+        return;
+      abortSegments();
+      setState(Failed, "Server sent the wrong range");
+    });
+  }
+  connect(reply, &QNetworkReply::readyRead, this, [this, index]() { onSegmentData(index); });
+  connect(reply, &QNetworkReply::finished, this, [this, index]() { onSegmentFinished(index); });
+}
+
+void SegmentedDownload::onSegmentData(int index) {
+  DownloadSegment &segment = segments[index];
+  QNetworkReply *reply = segment.reply;
+  if (!reply || currentState != Downloading)
+    return;
+
+  const int status = httpStatus(reply);
+  if (status >= 300) {
+    reply->readAll(); // Error page; the status is handled when it finishes
+    return;
+  }
+  if (rangesSupported && status == 200) {
+    // Range ignored, or the file changed under If-Range
+    fallBackToSingleStream(reply);
+    return;
+  }
+
+  QByteArray data = reply->readAll();
+  if (segment.end >= 0) {
+    const qint64 remaining = segment.length() - segment.received;
+    if (data.size() > remaining) {
+      data.truncate(int(remaining));
+    }
+  }
+  if (data.isEmpty())
+    return;
+
+  if (!writeAt(segment.start + segment.received, data)) {
+    abortSegments();
+    setState(Failed, QString("Could not write to %1").arg(partPath()));
+    return;
+  }
+  segment.received += data.size();
+}
+
+void SegmentedDownload::onSegmentFinished(int index) {
+  QNetworkReply *reply = segments[index].reply;
+  if (!reply)
+    return;
+  if (reply->bytesAvailable() > 0) {
+    onSegmentData(index);
+  }
+  // The last read may have failed or restarted the download
+  if (currentState != Downloading || index >= segments.size() || segments[index].reply != reply)
+    return;
+
+  DownloadSegment &segment = segments[index];
+  segment.reply = nullptr;
+  reply->deleteLater();
+
+  const int status = httpStatus(reply);
+  if (reply->error() == QNetworkReply::NoError && status < 300) {
+    if (total < 0) {
+      // Stream of unknown length: whatever arrived is the file
+      total = segment.received;
+      segment.end = segment.received - 1;
+      partFile.resize(total);
+    }
+    if (segment.isComplete() || total == 0) {
+      checkCompletion();
+      return;
+    }
+    // Connection closed early; continue from the last written byte
+  } else if (status >= 400 && status < 500 && status != 408 && status != 429) {
+    abortSegments();
+    setState(Failed, QString("HTTP %1 %2")
+                         .arg(status)
+                         .arg(reply->attribute(QNetworkRequest::HttpReasonPhraseAttribute).toString()));
+    return;
+  }
+
+  if (++segment.retries > MAX_RETRIES) {
+    abortSegments();
+    setState(Failed, reply->error() != QNetworkReply::NoError ? reply->errorString() : "Connection closed early");
+    return;
+  }
+
+  QTimer::singleShot(RETRY_DELAY_MS * segment.retries, this, [this, index]() {
+    if (currentState == Downloading && index < segments.size()) {
+      startSegment(index);
+    }
+  });
+}
+
+void SegmentedDownload::fallBackToSingleStream(QNetworkReply *fullResponse) {
+  const QVariant length = fullResponse->header(QNetworkRequest::ContentLengthHeader);
+
+  abortSegments();
+  rangesSupported = false;
+  validator.clear();
+  total = length.isValid() ? length.toLongLong() : -1;
+
+  segments.clear();
+  DownloadSegment segment;
+  segment.end = total > 0 ? total - 1 : -1;
+  segments.append(segment);
+  partFile.resize(qMax<qint64>(total, 0));
+
+  qCDebug(lcDownloads) << "SegmentedDownload: server ignored the range request, restarting" << fileName();
+  startSegment(0);
+}
+
+void SegmentedDownload::abortSegments() {
+  for (DownloadSegment &segment : segments) {
+    if (QNetworkReply *reply = segment.reply) {
+      disconnect(reply, nullptr, this, nullptr);
+      reply->abort();
+      reply->deleteLater();
+      segment.reply = nullptr;
+    }
+  }
+}
+
+void SegmentedDownload::checkCompletion() {
+  if (currentState != Downloading)
+    return;
+  for (const DownloadSegment &segment : segments) {
+    if (segment.reply || (total > 0 && !segment.isComplete()))
+      return;
+  }
+  if (total < 0)
+    return;
+  verifyAndFinish();
+}
+
+void SegmentedDownload::verifyAndFinish() {
+  setState(Verifying);
+  partFile.close();
+
+  // Hash on a worker thread; large files would otherwise stall the UI
+  const QString path = partPath();
+  QPointer<SegmentedDownload> self(this);
+  hashJob.cancel();
+  hashJob = JobScheduler::instance()->submit(JobScheduler::Normal, [self, path](const JobToken &token) {
+    QByteArray sha256Hex;
+    QFile file(path);
+    if (file.open(QIODevice::ReadOnly)) {
+      QCryptographicHash hash(QCryptographicHash::Sha256);
+      QByteArray chunk(HASH_CHUNK_SIZE, Qt::Uninitialized);
+      qint64 read = 0;
+      while (!token.isCancelled() && (read = file.read(chunk.data(), chunk.size())) > 0) {
+        hash.addData(QByteArrayView(chunk.constData(), read));
+      }
+      if (read == 0 && !token.isCancelled()) {
+        sha256Hex = hash.result().toHex();
+      }
+    }
+    QMetaObject::invokeMethod(
+        QCoreApplication::instance(),
+        [self, sha256Hex]() {
+          if (self) {
+            self->onHashed(sha256Hex);
+          }
+        },
+        Qt::QueuedConnection);
+  });
+}
+
+void SegmentedDownload::onHashed(const QByteArray &sha256Hex) {
+  if (currentState != Verifying)
+    return;
+
+  actualSha256 = sha256Hex;
+  if (actualSha256.isEmpty()) {
+    setState(Failed, QString("Could not read %1").arg(partPath()));
+    return;
+  }
+
+  if (checksumStatus() == ChecksumMismatched) {
+    // The bytes on disk are wrong; a resume has to fetch everything again
+    for (DownloadSegment &segment : segments) {
+      segment.received = 0;
+    }
+    setState(Failed, "Checksum mismatch");
+    return;
+  }
+
+  const QString finalPath = QFileInfo::exists(target) ? uniquePath(target) : target;
+  if (!QFile::rename(partPath(), finalPath)) {
+    setState(Failed, QString("Could not rename %1").arg(partPath()));
+    return;
+  }
+  target = finalPath;
+  setState(Completed);
+}
+
+void SegmentedDownload::pause() {
+  if (currentState == Probing) {
+    if (probeReply) {
+      disconnect(probeReply, nullptr, this, nullptr);
+      probeReply->abort();
+      probeReply->deleteLater();
+      probeReply = nullptr;
+    }
+    setState(Paused);
+  } else if (currentState == Downloading) {
+    abortSegments();
+    setState(Paused);
+  }
+}
+
+void SegmentedDownload::resume() {
+  if (currentState != Paused && currentState != Failed)
+    return;
+
+  // Never probed (or paused while probing)
+  if (segments.isEmpty()) {
+    start();
+    return;
+  }
+
+  for (DownloadSegment &segment : segments) {
+    segment.retries = 0;
+  }
+  actualSha256.clear();
+  if (!openPartFile())
+    return;
+
+  setState(Downloading);
+  startSegments();
+}
+
+void SegmentedDownload::retry() {
+  if (currentState == Downloading || currentState == Probing) {
+    pause();
+  }
+  hashJob.cancel();
+  segments.clear();
+  total = -1;
+  actualSha256.clear();
+  partFile.close();
+  QFile::remove(partPath());
+  start();
+}
+
+void SegmentedDownload::cancel() {
+  if (currentState == Completed || currentState == Cancelled)
+    return;
+
+  pause();
+  hashJob.cancel();
+  partFile.close();
+  QFile::remove(partPath());
+  segments.clear();
+  setState(Cancelled);
+}
+
+void SegmentedDownload::sampleThroughput() {
+  const qint64 received = receivedBytes();
+  const qint64 elapsed = sampleClock.restart();
+  if (elapsed > 0) {
+    const double instant = double(received - lastSampleBytes) * 1000.0 / double(elapsed);
+    throughput = throughput <= 0.0 ? instant
+                                   : THROUGHPUT_SMOOTHING * instant + (1.0 - THROUGHPUT_SMOOTHING) * throughput;
+  }
+  lastSampleBytes = received;
+  emit progressChanged();
+}
@@ -0,0 +1,153 @@
+#ifndef SEGMENTEDDOWNLOAD_H
+#define SEGMENTEDDOWNLOAD_H
+
+#include "../jobs/jobscheduler.h"
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QUrl>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QNetworkRequest;
+class QTimer;
+
+/**
+ * @brief One byte range of a download; end is inclusive, -1 if unknown
+ */
+struct DownloadSegment {
+  qint64 start = 0;
+  qint64 end = -1;
+  qint64 received = 0;
+  int retries = 0;
+  QPointer<QNetworkReply> reply;
+
+  qint64 length() const { return end < 0 ? -1 : end - start + 1; }
+  bool isComplete() const { return end >= 0 && received >= length(); }
+};
+
+/**
+ * @brief Fetches one URL into <target>.part, in parallel ranges when possible
+ *
+ * A HEAD probe decides the layout: large files on servers that accept byte
+ * ranges are split into several segments fetched concurrently, everything
+ * else is a single stream. The part file is preallocated and each segment
+ * writes at its own offset. Segment progress is exported with toJson() so
+ * an interrupted download resumes where it stopped (validated with If-Range).
+ * When the transfer completes the file is hashed with SHA-256 off the GUI
+ * thread and checked against the server's digest headers, if any.
+ */
+class SegmentedDownload : public QObject {
+  Q_OBJECT
+
+public:
+  enum State { Probing, Downloading, Paused, Verifying, Completed, Failed, Cancelled };
+  Q_ENUM(State)
+
+  enum ChecksumStatus { ChecksumUnknown, ChecksumMatched, ChecksumMismatched };
+
+  SegmentedDownload(QNetworkAccessManager *network, const QUrl &url, const QString &targetPath,
+                    QObject *parent = nullptr);
+  ~SegmentedDownload();
+
+  // Rebuilds an interrupted download; it starts Paused
+  static SegmentedDownload *fromJson(QNetworkAccessManager *network, const QJsonObject &json,
+                                     QObject *parent = nullptr);
+  QJsonObject toJson() const;
+
+  // Sent with every request so servers see the browser's user agent
+  void setUserAgent(const QByteArray &agent) { userAgent = agent; }
+  // Sent as Referer, for servers that only hand files to their own pages
+  void setReferrer(const QByteArray &url) { referrer = url; }
+
+  void start();
+  void pause();
+  void resume();
+  void cancel();
+  void retry();
+
+  // Hex SHA-256 to verify against, overriding the server's digest
+  void setExpectedChecksum(const QByteArray &sha256Hex);
+  QByteArray expectedChecksum() const { return expectedSha256; }
+  QByteArray checksum() const { return actualSha256; }
+  ChecksumStatus checksumStatus() const;
+
+  QUrl url() const { return sourceUrl; }
+  QString targetPath() const { return target; }
+  QString fileName() const;
+  State state() const { return currentState; }
+  QString errorString() const { return error; }
+
+  qint64 totalBytes() const { return total; }
+  qint64 receivedBytes() const;
+  double bytesPerSecond() const { return throughput; }
+  int segmentCount() const { return segments.size(); }
+  int activeSegments() const;
+  bool isSegmented() const { return rangesSupported && segments.size() > 1; }
+
+  // path, or "name (1).ext" etc. if it is already taken
+  static QString uniquePath(const QString &path);
+
+  static constexpr int MAX_SEGMENTS = 6;
+  static constexpr qint64 MIN_SEGMENT_SIZE = 2 * 1024 * 1024;
+
+signals:
+  void stateChanged(SegmentedDownload::State state);
+  // Throttled; at most a few times per second
+  void progressChanged();
+
+private slots:
+  void onProbeFinished();
+  void sampleThroughput();
+
+private:
+  void setState(State state, const QString &message = QString());
+  void planSegments();
+  bool openPartFile();
+  void startSegment(int index);
+  void onSegmentData(int index);
+  void onSegmentFinished(int index);
+  void startSegments();
+  void fallBackToSingleStream(QNetworkReply *fullResponse);
+  void abortSegments();
+  void checkCompletion();
+  void verifyAndFinish();
+  void onHashed(const QByteArray &sha256Hex);
+  bool writeAt(qint64 offset, const QByteArray &data);
+  QString partPath() const { return target + ".part"; }
+  void readDigestHeaders(QNetworkReply *reply);
+  void applyHeaders(QNetworkRequest &request) const;
+  bool rangeMatches(QNetworkReply *reply, qint64 from) const;
+
+  QNetworkAccessManager *network;
+  QUrl sourceUrl;
+  QString target;
+  QByteArray userAgent;
+  QByteArray referrer;
+  State currentState;
+  QString error;
+
+  qint64 total;
+  bool rangesSupported;
+  QByteArray validator; // ETag or Last-Modified, sent as If-Range
+  QByteArray serverSha256;
+  QByteArray expectedSha256;
+  QByteArray actualSha256;
+
+  QList<DownloadSegment> segments;
+  QFile partFile;
+  QPointer<QNetworkReply> probeReply;
+  JobToken hashJob; // Cancelled when the download goes away mid-hash
+
+  QTimer *sampleTimer;
+  QElapsedTimer sampleClock;
+  qint64 lastSampleBytes;
+  double throughput;
+};
+
+#endif // SEGMENTEDDOWNLOAD_H
@@ -0,0 +1,359 @@
+#include "faviconstore.h"
+#include "../logging/logcategories.h"
+#include "../webview/webview.h"
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPixmapCache>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QtEndian>
+#include <algorithm>
+
+namespace {
+const QByteArray BLOB_MAGIC = "MBFAVIC1";
+const int HASH_SIZE = 20;                    // SHA-1
+const int RECORD_HEADER = HASH_SIZE + 4;     // Hash, then big-endian PNG size
+const quint32 MAX_BLOB_SIZE = 512 * 1024;    // Anything larger is a corrupt record
+const int MAX_ICON_SIZE = 64;                // Larger icons are scaled down before storing
+const int MAX_PAGES = 4000;                  // Least recently seen pages are dropped beyond this
+const qint64 COMPACT_MIN_DEAD_BYTES = 256 * 1024;
+const int SAVE_DELAY_MS = 2000;
+const QString CACHE_PREFIX = "favicon:";
+} // namespace
+
+FaviconStore *FaviconStore::instance() {
+  // Parented to the application so it outlives every window
+  static FaviconStore *store = new FaviconStore(QCoreApplication::instance());
+  return store;
+}
+
+FaviconStore::FaviconStore(QObject *parent) : QObject(parent), mapped(nullptr), mappedSize(0) {
+  directory = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/favicons";
+  QDir().mkpath(directory);
+
+  saveTimer.setSingleShot(true);
+  saveTimer.setInterval(SAVE_DELAY_MS);
+  connect(&saveTimer, &QTimer::timeout, this, &FaviconStore::save);
+
+  load();
+}
+
+FaviconStore::~FaviconStore() {
+  if (saveTimer.isActive()) {
+    save();
+  }
+  if (mapped) {
+    blobFile.unmap(mapped);
+  }
+}
+
+void FaviconStore::attach(WebView *view) {
+  if (!view)
+    return;
+
+  // The view re-emits QWebEnginePage::iconChanged and keeps doing so if the page is replaced
+  connect(view, &WebView::iconChanged, this, [this, view](const QIcon &icon) {
+    const QUrl url = view->url();
+    if (!icon.isNull() && (url.scheme() == "http" || url.scheme() == "https")) {
+      store(url, icon);
+    }
+  });
+}
+
+QIcon FaviconStore::icon(const QUrl &url) {
+  const QPixmap pm = pixmap(url);
+  return pm.isNull() ? QIcon() : QIcon(pm);
+}
+
+QPixmap FaviconStore::pixmap(const QUrl &url) {
+  const QByteArray hash = hashFor(url);
+  if (hash.isEmpty())
+    return QPixmap();
+
+  const QString cacheKey = CACHE_PREFIX + QString::fromLatin1(hash.toHex());
+  QPixmap pm;
+  if (QPixmapCache::find(cacheKey, &pm))
+    return pm;
+
+  // Cache miss: decode straight from the mapped blob file
+  const auto it = blobs.constFind(hash);
+  if (it == blobs.constEnd() || !mapped || it->offset + it->size > mappedSize)
+    return QPixmap();
+  if (pm.loadFromData(mapped + it->offset, it->size, "PNG")) {
+    QPixmapCache::insert(cacheKey, pm);
+  }
+  return pm;
+}
+
+QByteArray FaviconStore::hashFor(const QUrl &url) const {
+  const auto page = pages.constFind(pageKey(url));
+  if (page != pages.constEnd())
+    return page->hash;
+  return hosts.value(url.host());
+}
+
+QString FaviconStore::pageKey(const QUrl &url) {
+  return url.adjusted(QUrl::RemoveFragment).toString();
+}
+
+void FaviconStore::store(const QUrl &pageUrl, const QIcon &icon) {
+  // Keep the largest variant that is still small; most sites ship 16, 32 and 180px
+  QSize size;
+  for (const QSize &available : icon.availableSizes()) {
+    if (available.width() <= MAX_ICON_SIZE && available.width() > size.width()) {
+      size = available;
+    }
+  }
+  if (!size.isValid()) {
+    size = QSize(32, 32);
+  }
+  const QPixmap pm = icon.pixmap(size);
+  if (pm.isNull())
+    return;
+
+  QByteArray png;
+  QBuffer buffer(&png);
+  buffer.open(QIODevice::WriteOnly);
+  if (!pm.save(&buffer, "PNG"))
+    return;
+
+  const QByteArray hash = QCryptographicHash::hash(png, QCryptographicHash::Sha1);
+  if (!blobs.contains(hash) && !appendBlob(hash, png))
+    return;
+
+  // Already decoded; spare the first lookup a round trip through PNG
+  QPixmapCache::insert(CACHE_PREFIX + QString::fromLatin1(hash.toHex()), pm);
+
+  const QString key = pageKey(pageUrl);
+  PageEntry &entry = pages[key];
+  const bool changed = entry.hash != hash || hosts.value(pageUrl.host()) != hash;
+  entry.hash = hash;
+  entry.lastSeen = QDateTime::currentMSecsSinceEpoch();
+  hosts[pageUrl.host()] = hash;
+
+  scheduleSave();
+  if (changed) {
+    emit iconChanged(pageUrl);
+  }
+}
+
+bool FaviconStore::appendBlob(const QByteArray &hash, const QByteArray &png) {
+  if (!blobFile.isOpen())
+    return false;
+
+  QByteArray record = hash;
+  char size[4];
+  qToBigEndian<quint32>(png.size(), size);
+  record.append(size, sizeof(size));
+  record.append(png);
+
+  // New icons are rare compared with lookups, so remapping after each one is cheap enough
+  const qint64 offset = blobFile.size();
+  if (!blobFile.seek(offset) || blobFile.write(record) != record.size() || !blobFile.flush()) {
+    blobFile.resize(offset);
+    remap();
+    return false;
+  }
+
+  blobs.insert(hash, {offset + RECORD_HEADER, quint32(png.size())});
+  remap();
+  return true;
+}
+
+void FaviconStore::remap() {
+  if (mapped) {
+    blobFile.unmap(mapped);
+    mapped = nullptr;
+  }
+  mappedSize = blobFile.size();
+  if (mappedSize > 0) {
+    mapped = blobFile.map(0, mappedSize);
+  }
+  if (!mapped) {
+    mappedSize = 0;
+  }
+}
+
+void FaviconStore::load() {
+  QFile indexFile(directory + "/index.json");
+  if (indexFile.open(QIODevice::ReadOnly)) {
+    const QJsonObject root = QJsonDocument::fromJson(indexFile.readAll()).object();
+    const QJsonObject pageObject = root["pages"].toObject();
+    for (auto it = pageObject.begin(); it != pageObject.end(); ++it) {
+      const QJsonObject obj = it.value().toObject();
+      PageEntry entry;
+      entry.hash = QByteArray::fromHex(obj["icon"].toString().toLatin1());
+      entry.lastSeen = qint64(obj["lastSeen"].toDouble());
+      if (entry.hash.size() == HASH_SIZE) {
+        pages.insert(it.key(), entry);
+      }
+    }
+    const QJsonObject hostObject = root["hosts"].toObject();
+    for (auto it = hostObject.begin(); it != hostObject.end(); ++it) {
+      const QByteArray hash = QByteArray::fromHex(it.value().toString().toLatin1());
+      if (hash.size() == HASH_SIZE) {
+        hosts.insert(it.key(), hash);
+      }
+    }
+  }
+
+  blobFile.setFileName(directory + "/icons.dat");
+  if (!blobFile.open(QIODevice::ReadWrite)) {
+    qCWarning(lcFavicons) << "FaviconStore: cannot open" << blobFile.fileName();
+    return;
+  }
+  scanBlobs();
+  compactBlobs();
+  remap();
+
+  qCDebug(lcFavicons) << "FaviconStore:" << blobs.size() << "icons for" << pages.size() << "pages," << hosts.size()
+                      << "hosts";
+}
+
+void FaviconStore::scanBlobs() {
+  blobs.clear();
+
+  if (blobFile.size() < BLOB_MAGIC.size() || blobFile.peek(BLOB_MAGIC.size()) != BLOB_MAGIC) {
+    // New or unreadable: start over (the index entries then simply miss)
+    blobFile.resize(0);
+    blobFile.seek(0);
+    blobFile.write(BLOB_MAGIC);
+    blobFile.flush();
+    return;
+  }
+
+  const qint64 fileSize = blobFile.size();
+  uchar *data = blobFile.map(0, fileSize);
+  if (!data)
+    return;
+
+  qint64 position = BLOB_MAGIC.size();
+  while (position + RECORD_HEADER <= fileSize) {
+    const QByteArray hash(reinterpret_cast<const char *>(data + position), HASH_SIZE);
+    const quint32 size = qFromBigEndian<quint32>(data + position + HASH_SIZE);
+    if (size == 0 || size > MAX_BLOB_SIZE || position + RECORD_HEADER + size > fileSize)
+      break;
+    blobs.insert(hash, {position + RECORD_HEADER, size});
+    position += RECORD_HEADER + size;
+  }
+  blobFile.unmap(data);
+
+  // Drop a record cut short by a crash during append
+  if (position < fileSize) {
+    blobFile.resize(position);
+  }
+}
+
+void FaviconStore::compactBlobs() {
+  QSet<QByteArray> live;
+  for (const PageEntry &entry : std::as_const(pages)) {
+    live.insert(entry.hash);
+  }
+  for (const QByteArray &hash : std::as_const(hosts)) {
+    live.insert(hash);
+  }
+
+  qint64 deadBytes = 0;
+  for (auto it = blobs.cbegin(); it != blobs.cend(); ++it) {
+    if (!live.contains(it.key())) {
+      deadBytes += RECORD_HEADER + it->size;
+    }
+  }
+  if (deadBytes < COMPACT_MIN_DEAD_BYTES || deadBytes * 2 < blobFile.size())
+    return;
+
+  // Rewrite with only the referenced icons; the old file stays valid until the commit
+  QSaveFile out(blobFile.fileName());
+  if (!out.open(QIODevice::WriteOnly))
+    return;
+  out.write(BLOB_MAGIC);
+
+  QHash<QByteArray, Blob> kept;
+  for (auto it = blobs.cbegin(); it != blobs.cend(); ++it) {
+    if (!live.contains(it.key()))
+      continue;
+    blobFile.seek(it->offset - RECORD_HEADER);
+    const QByteArray record = blobFile.read(RECORD_HEADER + it->size);
+    kept.insert(it.key(), {out.pos() + RECORD_HEADER, it->size});
+    out.write(record);
+  }
+
+  blobFile.close();
+  if (out.commit()) {
+    blobs = kept;
+  }
+  if (!blobFile.open(QIODevice::ReadWrite)) {
+    qCWarning(lcFavicons) << "FaviconStore: cannot reopen" << blobFile.fileName();
+    blobs.clear();
+  }
+}
+
+void FaviconStore::prunePages() {
+  if (pages.size() <= MAX_PAGES)
+    return;
+
+  QList<qint64> seen;
+  seen.reserve(pages.size());
+  for (const PageEntry &entry : std::as_const(pages)) {
+    seen.append(entry.lastSeen);
+  }
+  std::nth_element(seen.begin(), seen.begin() + (pages.size() - MAX_PAGES), seen.end());
+  const qint64 cutoff = seen.at(pages.size() - MAX_PAGES);
+
+  QSet<QString> liveHosts;
+  for (auto it = pages.begin(); it != pages.end();) {
+    if (it->lastSeen < cutoff) {
+      it = pages.erase(it);
+    } else {
+      liveHosts.insert(QUrl(it.key()).host());
+      ++it;
+    }
+  }
+  // Orphaned icons are reclaimed by the next start-up compaction
+  for (auto it = hosts.begin(); it != hosts.end();) {
+    if (liveHosts.contains(it.key())) {
+      ++it;
+    } else {
+      it = hosts.erase(it);
+    }
+  }
+}
+
+void FaviconStore::scheduleSave() {
+  if (!saveTimer.isActive()) {
+    saveTimer.start();
+  }
+}
+
+void FaviconStore::save() {
+  saveTimer.stop();
+  prunePages();
+
+  QJsonObject pageObject;
+  for (auto it = pages.cbegin(); it != pages.cend(); ++it) {
+    QJsonObject obj;
+    obj["icon"] = QString::fromLatin1(it->hash.toHex());
+    obj["lastSeen"] = double(it->lastSeen);
+    pageObject[it.key()] = obj;
+  }
+  QJsonObject hostObject;
+  for (auto it = hosts.cbegin(); it != hosts.cend(); ++it) {
+    hostObject[it.key()] = QString::fromLatin1(it->toHex());
+  }
+
+  QJsonObject root;
+  root["pages"] = pageObject;
+  root["hosts"] = hostObject;
+
+  QSaveFile file(directory + "/index.json");
+  if (file.open(QIODevice::WriteOnly)) {
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    file.commit();
+  }
+}
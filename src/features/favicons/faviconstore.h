@@ -0,0 +1,83 @@
+#ifndef FAVICONSTORE_H
+#define FAVICONSTORE_H
+
+#include <QFile>
+#include <QHash>
+#include <QIcon>
+#include <QObject>
+#include <QPixmap>
+#include <QString>
+#include <QTimer>
+#include <QUrl>
+
+class WebView;
+
+/**
+ * @brief Favicons for every view, deduplicated by content
+ *
+ * Icons reported by QWebEnginePage::iconChanged are encoded once as PNG and
+ * stored under their SHA-1 in a single append-only blob file that is
+ * memory-mapped for reads. index.json maps page URLs and hosts to those
+ * hashes, so the many pages of a site share one blob. Decoded pixmaps are
+ * kept in QPixmapCache (bounded by its cache limit); a miss decodes straight
+ * from the mapping.
+ *
+ * Lookups fall back from the exact page URL to the host, so bookmarks and
+ * history rows get an icon even for pages that were never opened.
+ */
+class FaviconStore : public QObject {
+  Q_OBJECT
+
+public:
+  static FaviconStore *instance();
+
+  // Records the icon of every page this view shows
+  void attach(WebView *view);
+
+  QIcon icon(const QUrl &url);
+  QPixmap pixmap(const QUrl &url);
+
+  void save();
+
+signals:
+  // A page (and its host) has a new icon
+  void iconChanged(const QUrl &pageUrl);
+
+private:
+  struct Blob {
+    qint64 offset = 0; // Of the PNG data, past the record header
+    quint32 size = 0;
+  };
+
+  struct PageEntry {
+    QByteArray hash;
+    qint64 lastSeen = 0;
+  };
+
+  explicit FaviconStore(QObject *parent = nullptr);
+  ~FaviconStore();
+
+  void load();
+  void scanBlobs();
+  void compactBlobs();
+  bool appendBlob(const QByteArray &hash, const QByteArray &png);
+  void remap();
+  void store(const QUrl &pageUrl, const QIcon &icon);
+  void prunePages();
+  QByteArray hashFor(const QUrl &url) const;
+  void scheduleSave();
+
+  static QString pageKey(const QUrl &url);
+
+  QString directory;
+  QFile blobFile;
+  uchar *mapped;
+  qint64 mappedSize;
+  QHash<QByteArray, Blob> blobs; // SHA-1 -> location in the blob file
+
+  QHash<QString, PageEntry> pages;
+  QHash<QString, QByteArray> hosts;
+  QTimer saveTimer;
+};
+
+#endif // FAVICONSTORE_H
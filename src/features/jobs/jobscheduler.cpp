@@ -0,0 +1,395 @@
+#include "jobscheduler.h"
+#include "../logging/logcategories.h"
+#include "../webview/webview.h"
+#include <QCoreApplication>
+#include <QEvent>
+#include <QThread>
+#include <algorithm>
+
+namespace {
+const int MAX_WORKERS = 8;
+const int INPUT_QUIET_MS = 400;           // Background jobs resume this long after the last input event
+const qint64 LOAD_PAUSE_LIMIT_MS = 10000; // A longer load stops holding Background jobs back
+const char *const CLASS_NAMES[] = {"interactive", "normal", "background"};
+
+thread_local int currentWorker = -1; // Index of the worker running on this thread
+} // namespace
+
+JobToken::JobToken() : cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+JobScheduler *JobScheduler::instance() {
+  static JobScheduler *scheduler = new JobScheduler(QCoreApplication::instance());
+  return scheduler;
+}
+
+JobScheduler::JobScheduler(QObject *parent) : QObject(parent), lastInputMs(0), inputActive(false) {
+  clock.start();
+
+  const int count = qBound(2, QThread::idealThreadCount() - 1, MAX_WORKERS);
+  pool.setMaxThreadCount(count);
+  pool.setExpiryTimeout(-1);
+  for (int i = 0; i < count; ++i) {
+    workers.append(new WorkerQueue);
+  }
+  for (int i = 0; i < count; ++i) {
+    pool.start([this, i]() { runWorker(i); });
+  }
+
+  inputTimer.setSingleShot(true);
+  connect(&inputTimer, &QTimer::timeout, this, &JobScheduler::onInputQuiet);
+  loadTimer.setSingleShot(true);
+  connect(&loadTimer, &QTimer::timeout, this, &JobScheduler::updatePause);
+  QCoreApplication::instance()->installEventFilter(this);
+
+  qCDebug(lcJobs) << "JobScheduler: started" << count << "workers";
+}
+
+JobScheduler::~JobScheduler() {
+  shutdown();
+  qDeleteAll(workers);
+}
+
+JobToken JobScheduler::submit(Priority priority, Work work, const QString &coalesceKey) {
+  ClassCounters &counter = counters[priority];
+  counter.submitted.fetch_add(1, std::memory_order_relaxed);
+
+  if (stopping.load()) {
+    JobToken token;
+    token.cancel();
+    counter.cancelled.fetch_add(1, std::memory_order_relaxed);
+    return token;
+  }
+
+  auto job = std::make_shared<Job>();
+  job->priority = priority;
+  job->key = coalesceKey;
+  job->queue = currentWorker >= 0 ? workers.at(currentWorker) : &shared;
+  job->queuedAt = clock.nsecsElapsed();
+  job->work = std::move(work);
+
+  if (!coalesceKey.isEmpty()) {
+    // Keyed jobs are queued under keysMutex, so a coalescing submit always finds them in their deque
+    QMutexLocker locker(&keysMutex);
+    const auto it = queuedKeys.constFind(coalesceKey);
+    if (it != queuedKeys.constEnd() && !(*it)->token.isCancelled()) {
+      // Still queued: run the newer work in its place. Workers take it under keysMutex
+      const JobPtr queued = *it;
+      queued->work = std::move(job->work);
+      counter.coalesced.fetch_add(1, std::memory_order_relaxed);
+      const bool raised = priority < queued->priority && raisePriority(queued, priority);
+      locker.unlock();
+      if (raised) {
+        wakeWorkers(false);
+      }
+      return queued->token;
+    }
+    queuedKeys.insert(coalesceKey, job);
+    enqueue(job);
+  } else {
+    enqueue(job);
+  }
+  wakeWorkers(false);
+  return job->token;
+}
+
+void JobScheduler::enqueue(const JobPtr &job) {
+  // Counted before it is visible, so a worker that sees the job never drives the count below zero
+  counters[job->priority].queued.fetch_add(1);
+  QMutexLocker locker(&job->queue->mutex);
+  job->queue->jobs[job->priority].push_back(job);
+}
+
+bool JobScheduler::raisePriority(const JobPtr &job, int priority) {
+  WorkerQueue *queue = job->queue;
+  QMutexLocker locker(&queue->mutex);
+  std::deque<JobPtr> &from = queue->jobs[job->priority];
+  const auto found = std::find(from.begin(), from.end(), job);
+  if (found == from.end()) {
+    return false; // A worker has taken it already
+  }
+  from.erase(found);
+  counters[job->priority].queued.fetch_sub(1);
+  counters[priority].queued.fetch_add(1);
+  job->priority = priority;
+  queue->jobs[priority].push_back(job);
+  return true;
+}
+
+void JobScheduler::runWorker(int index) {
+  currentWorker = index;
+  while (true) {
+    if (JobPtr job = takeJob(index)) {
+      runJob(job);
+      continue;
+    }
+
+    QMutexLocker locker(&sleepMutex);
+    if (stopping.load()) {
+      break;
+    }
+    if (!hasRunnableJobs()) {
+      wakeCondition.wait(&sleepMutex);
+    }
+  }
+  currentWorker = -1;
+}
+
+JobScheduler::JobPtr JobScheduler::takeJob(int index) {
+  const auto pop = [this](WorkerQueue *queue, int priority, bool newest) -> JobPtr {
+    QMutexLocker locker(&queue->mutex);
+    std::deque<JobPtr> &jobs = queue->jobs[priority];
+    if (jobs.empty()) {
+      return nullptr;
+    }
+    JobPtr job;
+    if (newest) {
+      job = std::move(jobs.back());
+      jobs.pop_back();
+    } else {
+      job = std::move(jobs.front());
+      jobs.pop_front();
+    }
+    counters[priority].queued.fetch_sub(1);
+    return job;
+  };
+
+  const bool paused = backgroundPaused.load();
+  for (int priority = 0; priority < PRIORITY_COUNT; ++priority) {
+    if (priority == Background && paused) {
+      break;
+    }
+    if (counters[priority].queued.load() <= 0) {
+      continue;
+    }
+
+    // Own jobs newest first (their data is still warm), everyone else's oldest first
+    if (JobPtr job = pop(workers.at(index), priority, true)) {
+      return job;
+    }
+    if (JobPtr job = pop(&shared, priority, false)) {
+      return job;
+    }
+    const int count = workers.size();
+    const unsigned start = nextVictim.fetch_add(1, std::memory_order_relaxed);
+    for (int i = 0; i < count; ++i) {
+      const int victim = (start + i) % count;
+      if (victim == index) {
+        continue;
+      }
+      if (JobPtr job = pop(workers.at(victim), priority, false)) {
+        return job;
+      }
+    }
+  }
+  return nullptr;
+}
+
+void JobScheduler::runJob(const JobPtr &job) {
+  ClassCounters &counter = counters[job->priority];
+
+  Work work;
+  if (!job->key.isEmpty()) {
+    QMutexLocker locker(&keysMutex);
+    if (queuedKeys.value(job->key) == job) {
+      queuedKeys.remove(job->key);
+    }
+    work = std::move(job->work);
+  } else {
+    work = std::move(job->work);
+  }
+
+  if (job->token.isCancelled() || !work) {
+    counter.cancelled.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  {
+    QMutexLocker locker(&runningMutex);
+    runningJobs.insert(job.get(), job->token);
+    // shutdown() may have cancelled the running jobs just before this one was added
+    if (stopping.load()) {
+      job->token.cancel();
+    }
+  }
+
+  const qint64 started = clock.nsecsElapsed();
+  const qint64 wait = started - job->queuedAt;
+  counter.waitNanos.fetch_add(wait, std::memory_order_relaxed);
+  qint64 maxWait = counter.maxWaitNanos.load(std::memory_order_relaxed);
+  while (wait > maxWait && !counter.maxWaitNanos.compare_exchange_weak(maxWait, wait, std::memory_order_relaxed)) {
+  }
+
+  work(job->token);
+
+  {
+    QMutexLocker locker(&runningMutex);
+    runningJobs.remove(job.get());
+  }
+  counter.runNanos.fetch_add(clock.nsecsElapsed() - started, std::memory_order_relaxed);
+  counter.completed.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool JobScheduler::hasRunnableJobs() const {
+  if (counters[Interactive].queued.load() > 0 || counters[Normal].queued.load() > 0) {
+    return true;
+  }
+  return !backgroundPaused.load() && counters[Background].queued.load() > 0;
+}
+
+void JobScheduler::wakeWorkers(bool all) {
+  // Taking the lock orders this after a worker's check in runWorker, so the wakeup isn't lost
+  QMutexLocker locker(&sleepMutex);
+  if (all) {
+    wakeCondition.wakeAll();
+  } else {
+    wakeCondition.wakeOne();
+  }
+}
+
+QList<JobClassStats> JobScheduler::stats() const {
+  QList<JobClassStats> list;
+  for (int priority = 0; priority < PRIORITY_COUNT; ++priority) {
+    const ClassCounters &counter = counters[priority];
+    JobClassStats stats;
+    stats.name = QString::fromLatin1(CLASS_NAMES[priority]);
+    stats.queued = std::max(0, counter.queued.load());
+    stats.submitted = counter.submitted.load(std::memory_order_relaxed);
+    stats.completed = counter.completed.load(std::memory_order_relaxed);
+    stats.cancelled = counter.cancelled.load(std::memory_order_relaxed);
+    stats.coalesced = counter.coalesced.load(std::memory_order_relaxed);
+    stats.maxWaitMs = counter.maxWaitNanos.load(std::memory_order_relaxed) / 1e6;
+    if (stats.completed > 0) {
+      stats.averageWaitMs = counter.waitNanos.load(std::memory_order_relaxed) / 1e6 / stats.completed;
+      stats.averageRunMs = counter.runNanos.load(std::memory_order_relaxed) / 1e6 / stats.completed;
+    }
+    list.append(stats);
+  }
+  return list;
+}
+
+void JobScheduler::shutdown() {
+  if (stopping.exchange(true)) {
+    return;
+  }
+
+  if (QCoreApplication *app = QCoreApplication::instance()) {
+    app->removeEventFilter(this);
+  }
+  inputTimer.stop();
+  loadTimer.stop();
+
+  const auto drain = [this](WorkerQueue *queue) {
+    QMutexLocker locker(&queue->mutex);
+    for (int priority = 0; priority < PRIORITY_COUNT; ++priority) {
+      for (const JobPtr &job : queue->jobs[priority]) {
+        job->token.cancel();
+        counters[priority].queued.fetch_sub(1);
+        counters[priority].cancelled.fetch_add(1, std::memory_order_relaxed);
+      }
+      queue->jobs[priority].clear();
+    }
+  };
+  drain(&shared);
+  for (WorkerQueue *queue : workers) {
+    drain(queue);
+  }
+  {
+    QMutexLocker locker(&keysMutex);
+    queuedKeys.clear();
+  }
+  {
+    // A long hash of a finished download shouldn't hold up exit
+    QMutexLocker locker(&runningMutex);
+    for (const JobToken &token : std::as_const(runningJobs)) {
+      token.cancel();
+    }
+  }
+
+  wakeWorkers(true);
+  pool.waitForDone();
+
+  for (const JobClassStats &stats : this->stats()) {
+    qCInfo(lcJobs).nospace() << "JobScheduler: " << stats.name << " " << stats.completed << " done, "
+                             << stats.cancelled << " cancelled, " << stats.coalesced << " coalesced, wait avg "
+                             << stats.averageWaitMs << " ms max " << stats.maxWaitMs << " ms, run avg "
+                             << stats.averageRunMs << " ms";
+  }
+}
+
+void JobScheduler::attach(WebView *view) {
+  connect(view, &WebView::loadStarted, this, [this, view]() {
+    loadingViews.insert(view, clock.elapsed());
+    updatePause();
+  });
+  connect(view, &WebView::loadFinished, this, [this, view]() {
+    loadingViews.remove(view);
+    updatePause();
+  });
+  connect(view, &QObject::destroyed, this, [this, view]() {
+    loadingViews.remove(view);
+    updatePause();
+  });
+}
+
+bool JobScheduler::eventFilter(QObject *watched, QEvent *event) {
+  switch (event->type()) {
+  case QEvent::KeyPress:
+  case QEvent::MouseButtonPress:
+  case QEvent::Wheel:
+  case QEvent::TouchBegin:
+  case QEvent::TouchUpdate:
+    lastInputMs = clock.elapsed();
+    if (!inputActive) {
+      inputActive = true;
+      updatePause();
+    }
+    if (!inputTimer.isActive()) {
+      inputTimer.start(INPUT_QUIET_MS);
+    }
+    break;
+  default:
+    break;
+  }
+  return QObject::eventFilter(watched, event);
+}
+
+void JobScheduler::updatePause() {
+  if (stopping.load()) {
+    return;
+  }
+
+  const qint64 now = clock.elapsed();
+  qint64 loadRemaining = -1;
+  for (auto it = loadingViews.cbegin(); it != loadingViews.cend(); ++it) {
+    const qint64 remaining = LOAD_PAUSE_LIMIT_MS - (now - it.value());
+    if (remaining > 0 && (loadRemaining < 0 || remaining < loadRemaining)) {
+      loadRemaining = remaining;
+    }
+  }
+
+  // Check again when the oldest counted load runs over the limit
+  if (loadRemaining > 0) {
+    loadTimer.start(int(loadRemaining));
+  } else {
+    loadTimer.stop();
+  }
+
+  const bool paused = inputActive || loadRemaining > 0;
+  const bool wasPaused = backgroundPaused.exchange(paused);
+  if (wasPaused != paused) {
+    qCDebug(lcJobs) << "JobScheduler: background jobs" << (paused ? "paused" : "resumed");
+    if (!paused) {
+      wakeWorkers(true);
+    }
+  }
+}
+
+void JobScheduler::onInputQuiet() {
+  const qint64 quiet = clock.elapsed() - lastInputMs;
+  if (inputActive && quiet < INPUT_QUIET_MS) {
+    inputTimer.start(int(INPUT_QUIET_MS - quiet));
+    return;
+  }
+  inputActive = false;
+  updatePause();
+}
@@ -0,0 +1,162 @@
+#ifndef JOBSCHEDULER_H
+#define JOBSCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+#include <QWaitCondition>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+
+class WebView;
+
+/**
+ * @brief Cancels a submitted job
+ *
+ * Copies share one flag. A job that is still queued when cancelled never
+ * runs; a running job sees isCancelled() and is expected to return early.
+ */
+class JobToken {
+public:
+  JobToken();
+
+  void cancel() const { cancelled->store(true, std::memory_order_relaxed); }
+  bool isCancelled() const { return cancelled->load(std::memory_order_relaxed); }
+
+private:
+  std::shared_ptr<std::atomic<bool>> cancelled;
+};
+
+/**
+ * @brief Queue depth and latency of one priority class
+ */
+struct JobClassStats {
+  QString name;
+  int queued = 0;
+  quint64 submitted = 0;
+  quint64 completed = 0;
+  quint64 cancelled = 0;
+  quint64 coalesced = 0; // Submissions folded into a job that was still queued
+  double averageWaitMs = 0;
+  double maxWaitMs = 0;
+  double averageRunMs = 0;
+};
+
+/**
+ * @brief Application-wide background job scheduler
+ *
+ * Long-lived workers run on a private QThreadPool, each with its own deque
+ * per priority class. Jobs submitted from a worker go to that worker's deque
+ * and are taken newest first; jobs from other threads go to a shared FIFO.
+ * An idle worker takes, in priority order, from its own deque, the shared
+ * queue, and the oldest end of the other workers' deques.
+ *
+ * Jobs with a coalesce key replace a queued job with the same key instead
+ * of queuing twice; the queued job takes the higher of the two priorities. Background jobs wait while the user is typing, clicking
+ * or scrolling and while pages are loading (up to a limit, so they can't
+ * starve). Results go back to the GUI thread the usual way, with
+ * QMetaObject::invokeMethod.
+ */
+class JobScheduler : public QObject {
+  Q_OBJECT
+
+public:
+  enum Priority { Interactive, Normal, Background };
+  static const int PRIORITY_COUNT = 3;
+
+  using Work = std::function<void(const JobToken &token)>;
+
+  static JobScheduler *instance();
+
+  JobToken submit(Priority priority, Work work, const QString &coalesceKey = QString());
+
+  // Background jobs wait while this view loads
+  void attach(WebView *view);
+
+  bool isBackgroundPaused() const { return backgroundPaused.load(std::memory_order_relaxed); }
+  QList<JobClassStats> stats() const;
+
+  // Drops queued jobs, cancels running ones and waits for them; later submissions are cancelled at once
+  void shutdown();
+
+protected:
+  bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+  struct WorkerQueue;
+
+  struct Job {
+    Work work;
+    JobToken token;
+    QString key;
+    int priority = Normal;
+    WorkerQueue *queue = nullptr; // Where it was queued; keyed jobs move there when raised
+    qint64 queuedAt = 0;          // clock nanoseconds
+  };
+  using JobPtr = std::shared_ptr<Job>;
+
+  struct WorkerQueue {
+    QMutex mutex;
+    std::deque<JobPtr> jobs[PRIORITY_COUNT];
+  };
+
+  struct ClassCounters {
+    std::atomic<int> queued{0};
+    std::atomic<quint64> submitted{0};
+    std::atomic<quint64> completed{0};
+    std::atomic<quint64> cancelled{0};
+    std::atomic<quint64> coalesced{0};
+    std::atomic<qint64> waitNanos{0};
+    std::atomic<qint64> maxWaitNanos{0};
+    std::atomic<qint64> runNanos{0};
+  };
+
+  explicit JobScheduler(QObject *parent = nullptr);
+  ~JobScheduler();
+
+  void enqueue(const JobPtr &job);
+  bool raisePriority(const JobPtr &job, int priority);
+  void runWorker(int index);
+  JobPtr takeJob(int index);
+  void runJob(const JobPtr &job);
+  bool hasRunnableJobs() const;
+  void wakeWorkers(bool all);
+
+  void updatePause();
+  void onInputQuiet();
+
+  QThreadPool pool;
+  QList<WorkerQueue *> workers;
+  WorkerQueue shared; // Submissions from threads that are not workers
+  std::atomic<unsigned> nextVictim{0};
+
+  QMutex keysMutex;
+  QHash<QString, JobPtr> queuedKeys;
+
+  QMutex runningMutex;
+  QHash<Job *, JobToken> runningJobs; // Cancelled by shutdown() so exit doesn't wait for them
+
+  QMutex sleepMutex;
+  QWaitCondition wakeCondition;
+  std::atomic<bool> stopping{false};
+  std::atomic<bool> backgroundPaused{false};
+
+  ClassCounters counters[PRIORITY_COUNT];
+  QElapsedTimer clock;
+
+  // GUI side: recent input and loading tabs pause Background jobs
+  QHash<WebView *, qint64> loadingViews; // View -> clock milliseconds when its load started
+  qint64 lastInputMs;
+  bool inputActive;
+  QTimer inputTimer; // Fires INPUT_QUIET_MS after input stops
+  QTimer loadTimer;  // Fires when the oldest counted load runs over LOAD_PAUSE_LIMIT_MS
+};
+
+#endif // JOBSCHEDULER_H
@@ -0,0 +1,23 @@
+#include "logcategories.h"
+
+Q_LOGGING_CATEGORY(lcApp, "mybrowser.app")
+Q_LOGGING_CATEGORY(lcInput, "mybrowser.input", QtWarningMsg)
+Q_LOGGING_CATEGORY(lcNavigation, "mybrowser.navigation")
+Q_LOGGING_CATEGORY(lcConsole, "mybrowser.console", QtWarningMsg)
+Q_LOGGING_CATEGORY(lcWebView, "mybrowser.webview")
+Q_LOGGING_CATEGORY(lcPiP, "mybrowser.pip")
+Q_LOGGING_CATEGORY(lcPalette, "mybrowser.palette")
+Q_LOGGING_CATEGORY(lcWorkspace, "mybrowser.workspace")
+Q_LOGGING_CATEGORY(lcContentBlocking, "mybrowser.contentblocking")
+Q_LOGGING_CATEGORY(lcDownloads, "mybrowser.downloads")
+Q_LOGGING_CATEGORY(lcPageSearch, "mybrowser.pagesearch")
+Q_LOGGING_CATEGORY(lcFavicons, "mybrowser.favicons")
+Q_LOGGING_CATEGORY(lcPageEvents, "mybrowser.pageevents")
+Q_LOGGING_CATEGORY(lcPerformanceHud, "mybrowser.performancehud")
+Q_LOGGING_CATEGORY(lcNewTab, "mybrowser.newtab")
+Q_LOGGING_CATEGORY(lcProfile, "mybrowser.profile")
+Q_LOGGING_CATEGORY(lcNetwork, "mybrowser.network")
+Q_LOGGING_CATEGORY(lcSnapshots, "mybrowser.snapshots")
+Q_LOGGING_CATEGORY(lcAutomation, "mybrowser.automation")
+Q_LOGGING_CATEGORY(lcJobs, "mybrowser.jobs")
+Q_LOGGING_CATEGORY(lcMedia, "mybrowser.media")
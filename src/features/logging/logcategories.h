@@ -0,0 +1,39 @@
+#ifndef LOGCATEGORIES_H
+#define LOGCATEGORIES_H
+
+#include <QLoggingCategory>
+
+/**
+ * Logging categories, one per feature.
+ *
+ * Use qCDebug(lcFoo) / qCWarning(lcFoo) instead of qDebug(). A category that
+ * is disabled at run time costs one flag check: the message is never
+ * formatted. Release builds define QT_NO_DEBUG_OUTPUT, so qCDebug compiles to
+ * nothing there. Categories can be switched on at run time, for example
+ *   QT_LOGGING_RULES="mybrowser.input.debug=true"
+ * The input and console categories log only warnings unless enabled like
+ * this, because they fire for every mouse event or console line.
+ */
+Q_DECLARE_LOGGING_CATEGORY(lcApp)
+Q_DECLARE_LOGGING_CATEGORY(lcInput)
+Q_DECLARE_LOGGING_CATEGORY(lcNavigation)
+Q_DECLARE_LOGGING_CATEGORY(lcConsole)
+Q_DECLARE_LOGGING_CATEGORY(lcWebView)
+Q_DECLARE_LOGGING_CATEGORY(lcPiP)
+Q_DECLARE_LOGGING_CATEGORY(lcPalette)
+Q_DECLARE_LOGGING_CATEGORY(lcWorkspace)
+Q_DECLARE_LOGGING_CATEGORY(lcContentBlocking)
+Q_DECLARE_LOGGING_CATEGORY(lcDownloads)
+Q_DECLARE_LOGGING_CATEGORY(lcPageSearch)
+Q_DECLARE_LOGGING_CATEGORY(lcFavicons)
+Q_DECLARE_LOGGING_CATEGORY(lcPageEvents)
+Q_DECLARE_LOGGING_CATEGORY(lcPerformanceHud)
+Q_DECLARE_LOGGING_CATEGORY(lcNewTab)
+Q_DECLARE_LOGGING_CATEGORY(lcProfile)
+Q_DECLARE_LOGGING_CATEGORY(lcNetwork)
+Q_DECLARE_LOGGING_CATEGORY(lcSnapshots)
+Q_DECLARE_LOGGING_CATEGORY(lcAutomation)
+Q_DECLARE_LOGGING_CATEGORY(lcJobs)
+Q_DECLARE_LOGGING_CATEGORY(lcMedia)
+
+#endif // LOGCATEGORIES_H
@@ -0,0 +1,251 @@
+#include "logsink.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QStandardPaths>
+#include <QThread>
+#include <QWaitCondition>
+#include <atomic>
+#include <cstdio>
+
+namespace {
+const quint64 RING_CAPACITY = 4096;        // Power of two
+const qint64 MAX_FILE_BYTES = 4 * 1024 * 1024;
+const int KEPT_FILES = 3;                  // mybrowser.log.1 .. .3
+const unsigned long IDLE_WAIT_MS = 250;    // Debug lines wait at most this long
+
+/**
+ * Bounded multi-producer, single-consumer queue. Each slot carries a sequence
+ * number telling whether it is free for the producer at that position or
+ * filled for the consumer, so producers only compete on one atomic counter.
+ */
+class LogRing {
+public:
+  LogRing() {
+    for (quint64 i = 0; i < RING_CAPACITY; ++i) {
+      slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  bool push(QByteArray &&line) {
+    quint64 pos = head.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot &slot = slots[pos & (RING_CAPACITY - 1)];
+      const quint64 sequence = slot.sequence.load(std::memory_order_acquire);
+      const qint64 diff = qint64(sequence) - qint64(pos);
+      if (diff == 0) {
+        if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          slot.line = std::move(line);
+          slot.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false; // Full
+      } else {
+        pos = head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Consumer thread only
+  bool pop(QByteArray &line) {
+    const quint64 pos = tail.load(std::memory_order_relaxed);
+    Slot &slot = slots[pos & (RING_CAPACITY - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != pos + 1)
+      return false;
+
+    line = std::move(slot.line);
+    slot.line = QByteArray();
+    slot.sequence.store(pos + RING_CAPACITY, std::memory_order_release);
+    tail.store(pos + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Approximate when called from a producer
+  quint64 size() const { return head.load(std::memory_order_relaxed) - tail.load(std::memory_order_relaxed); }
+
+private:
+  struct Slot {
+    std::atomic<quint64> sequence;
+    QByteArray line;
+  };
+
+  Slot slots[RING_CAPACITY];
+  std::atomic<quint64> head{0};
+  std::atomic<quint64> tail{0}; // Written by the consumer only
+};
+
+class LogWriter : public QThread {
+public:
+  explicit LogWriter(const QString &path) : path(path) { setObjectName("LogWriter"); }
+
+  void wake() { condition.wakeOne(); }
+
+  void stop() {
+    stopping.store(true, std::memory_order_release);
+    wake();
+    wait();
+  }
+
+  LogRing ring;
+  std::atomic<quint64> dropped{0};
+
+protected:
+  void run() override {
+    file.setFileName(path);
+    open();
+
+    quint64 reportedDrops = 0;
+    while (true) {
+      const bool last = stopping.load(std::memory_order_acquire);
+      QByteArray line;
+      bool wrote = false;
+      while (ring.pop(line)) {
+        write(line);
+        wrote = true;
+      }
+
+      const quint64 drops = dropped.load(std::memory_order_relaxed);
+      if (drops != reportedDrops) {
+        write(QByteArray::number(drops - reportedDrops) + " log message(s) dropped, the queue was full\n");
+        reportedDrops = drops;
+        wrote = true;
+      }
+
+      if (wrote) {
+        file.flush();
+#ifdef DEBUG_MODE
+        fflush(stderr);
+#endif
+      }
+      if (last)
+        break;
+
+      mutex.lock();
+      condition.wait(&mutex, IDLE_WAIT_MS);
+      mutex.unlock();
+    }
+    file.close();
+  }
+
+private:
+  void write(const QByteArray &line) {
+#ifdef DEBUG_MODE
+    fwrite(line.constData(), 1, line.size(), stderr);
+#endif
+    if (!file.isOpen())
+      return;
+
+    file.write(line);
+    fileBytes += line.size();
+    if (fileBytes > MAX_FILE_BYTES) {
+      rotate();
+    }
+  }
+
+  void rotate() {
+    file.close();
+    QFile::remove(path + "." + QString::number(KEPT_FILES));
+    for (int i = KEPT_FILES - 1; i >= 1; --i) {
+      QFile::rename(path + "." + QString::number(i), path + "." + QString::number(i + 1));
+    }
+    QFile::rename(path, path + ".1");
+    open();
+  }
+
+  void open() {
+    file.open(QIODevice::WriteOnly | QIODevice::Append);
+    fileBytes = file.size();
+  }
+
+  QString path;
+  QFile file;
+  qint64 fileBytes = 0; // Tracked here instead of asking the file system after every line
+  QMutex mutex;
+  QWaitCondition condition;
+  std::atomic<bool> stopping{false};
+};
+
+LogWriter *writer = nullptr;
+QtMessageHandler previousHandler = nullptr;
+
+char levelTag(QtMsgType type) {
+  switch (type) {
+  case QtDebugMsg:
+    return 'D';
+  case QtInfoMsg:
+    return 'I';
+  case QtWarningMsg:
+    return 'W';
+  case QtCriticalMsg:
+    return 'C';
+  case QtFatalMsg:
+    return 'F';
+  }
+  return '?';
+}
+
+void messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message) {
+  QByteArray line = QTime::currentTime().toString("HH:mm:ss.zzz").toLatin1();
+  line += ' ';
+  line += levelTag(type);
+  line += ' ';
+  line += context.category ? context.category : "default";
+  line += ": ";
+  line += message.toUtf8();
+  line += '\n';
+
+  if (type == QtFatalMsg) {
+    // The process aborts right after this: let the writer drain the queue and close the file first, so the
+    // lines leading up to the failure are kept and the fatal one comes last (unless the writer itself failed)
+    if (QThread::currentThread() != writer) {
+      writer->stop();
+    }
+    fwrite(line.constData(), 1, line.size(), stderr);
+    QFile file(LogSink::logFilePath());
+    if (file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+      file.write(line);
+    }
+    return;
+  }
+
+  if (!writer->ring.push(std::move(line))) {
+    writer->dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  // Debug lines are picked up on the writer's next round; anything louder, or a filling ring, wakes it now
+  if (type != QtDebugMsg || writer->ring.size() > RING_CAPACITY / 2) {
+    writer->wake();
+  }
+}
+} // namespace
+
+void LogSink::install() {
+  if (writer)
+    return;
+
+  QDir().mkpath(QFileInfo(logFilePath()).absolutePath());
+  writer = new LogWriter(logFilePath());
+  writer->start(QThread::LowPriority);
+  previousHandler = qInstallMessageHandler(messageHandler);
+}
+
+void LogSink::shutdown() {
+  if (!writer)
+    return;
+
+  qInstallMessageHandler(previousHandler);
+  writer->stop();
+  delete writer;
+  writer = nullptr;
+}
+
+QString LogSink::logFilePath() {
+  return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/logs/mybrowser.log";
+}
+
+quint64 LogSink::droppedCount() {
+  return writer ? writer->dropped.load(std::memory_order_relaxed) : 0;
+}
@@ -0,0 +1,29 @@
+#ifndef LOGSINK_H
+#define LOGSINK_H
+
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * @brief Asynchronous destination for every Qt log message
+ *
+ * The installed message handler formats the line and pushes it into a
+ * fixed-size lock-free ring. It never touches a file or a mutex, so logging
+ * from input handlers or page callbacks cannot stall them on I/O. A writer
+ * thread drains the ring into <AppData>/logs/mybrowser.log, rotating the file
+ * by size, and echoes to stderr in debug builds. When the ring is full,
+ * messages are dropped and counted rather than blocking the caller.
+ */
+class LogSink {
+public:
+  // Call once after QApplication exists (the log directory needs the app name)
+  static void install();
+
+  // Writes out what is still queued and restores the previous handler
+  static void shutdown();
+
+  static QString logFilePath();
+  static quint64 droppedCount();
+};
+
+#endif // LOGSINK_H
@@ -1,10 +1,28 @@
 #include "mainwindow.h"
 #include "../bookmark/bookmarkmanager.h"
 #include "../command-palette/commandpalettemanager.h"
+#include "../content-blocking/contentblockingmanager.h"
+#include "../downloads/downloadmanager.h"
+#include "../favicons/faviconstore.h"
+#include "../jobs/jobscheduler.h"
+#include "../logging/logcategories.h"
+#include "../media-governor/mediagovernor.h"
+#include "../network-recorder/networkrecorder.h"
+#include "../new-tab/newtabmanager.h"
+#include "../page-events/pageeventbus.h"
+#include "../page-events/pagescriptrunner.h"
+#include "../page-search/pagesearchservice.h"
+#include "../performance-hud/performancehudmanager.h"
+#include "../performance-hud/performancestore.h"
 #include "../picture-in-picture/pictureinpicturemanager.h"
+#include "../profile/browserprofile.h"
+#include "../tab-snapshots/tabsnapshotmanager.h"
 #include "../tab-widget/verticaltabwidget.h"
+#include "../theme/theme.h"
 #include "../webview/webview.h"
 #include "../workspace/workspacemanager.h"
+#include "tabupdatecoalescer.h"
+#include <QApplication>
 #include <QCoreApplication>
 #include <QCursor>
 #include <QDir>
@@ -16,7 +34,6 @@
 #include <QMenuBar>
 #include <QMessageBox>
 #include <QTabBar>
-#include <QTextStream>
 #include <QToolButton>
 #include <QVBoxLayout>
 #include <QWebChannel>
@@ -24,23 +41,36 @@
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), workspaceManager(nullptr), bookmarkManager(nullptr),
-      pictureInPictureManager(nullptr), commandPaletteManager(nullptr), webChannel(nullptr) {
-  // Debug output for homepage URL setting
-#ifdef DEBUG_MODE
-  qDebug() << "DEBUG_MODE active - Homepage URL:" << homePageUrl;
-#else
-  qDebug() << "RELEASE_MODE active - Homepage URL:" << homePageUrl;
-#endif
+      pictureInPictureManager(nullptr), commandPaletteManager(nullptr), performanceHudManager(nullptr),
+      contentBlockingManager(nullptr), newTabManager(nullptr), downloadManager(nullptr), networkRecorder(nullptr),
+      tabSnapshotManager(nullptr), mediaGovernor(nullptr), pageEventBus(nullptr), pageScriptRunner(nullptr),
+      tabUpdateCoalescer(nullptr) {
+  // Allow launchers (e.g. the benchmark harness) to override the home page
+  if (qEnvironmentVariableIsSet("MYBROWSER_HOME_URL")) {
+    homePageUrl = qEnvironmentVariable("MYBROWSER_HOME_URL");
+  }
+
+  qCDebug(lcApp) << "Homepage URL:" << homePageUrl;
 
   // Initialize WebChannel for JavaScript communication
-  webChannel = new QWebChannel(this);
-  webChannel->registerObject("mainWindow", this);
+  pageEventBus = new PageEventBus(this);
+  pageScriptRunner = new PageScriptRunner(pageEventBus, this);
 
   // Initialize managers FIRST before setupUI
   pictureInPictureManager = new PictureInPictureManager(this);
   commandPaletteManager = new CommandPaletteManager(this);
-
-  loadStyleSheet();
+  performanceHudManager = new PerformanceHudManager(this);
+  contentBlockingManager = new ContentBlockingManager(this);
+  newTabManager = new NewTabManager(this);
+  downloadManager = new DownloadManager(this);
+  networkRecorder = new NetworkRecorder(this);
+  tabSnapshotManager = new TabSnapshotManager(this);
+  mediaGovernor = new MediaGovernor(this);
+
+  tabUpdateCoalescer = new TabUpdateCoalescer(this);
+  connect(tabUpdateCoalescer, &TabUpdateCoalescer::tabStateChanged, this, &MainWindow::applyTabUpdate);
+
+  Theme::apply(this);
   setupUI();
   setupConnections();
   newTab(); // Open a default tab
@@ -63,59 +93,11 @@ void MainWindow::setupUI() {
 
   addressBar = new QLineEdit(this);
   addressBar->setPlaceholderText("Enter URL or search query");
-  addressBar->setStyleSheet(
-      "QLineEdit { "
-      "  padding: 10px 15px; "
-      "  margin: 5px; "
-      "  background-color: white; "
-      "  border: 2px solid #d1d5db; "
-      "  border-radius: 8px; "
-      "  font-size: 14px; "
-      "} "
-      "QLineEdit:focus { "
-      "  border-color: #007ACC; "
-      "  outline: none; "
-      "}");
 
   createActions();
   createToolbars();
   createMenus();
 
-  // Style the menu bar
-  menuBar()->setStyleSheet(
-      "QMenuBar { "
-      "  background-color: #2d2d30; "
-      "  color: white; "
-      "  padding: 4px; "
-      "  font-size: 13px; "
-      "} "
-      "QMenuBar::item { "
-      "  background-color: transparent; "
-      "  padding: 8px 12px; "
-      "  border-radius: 4px; "
-      "} "
-      "QMenuBar::item:selected { "
-      "  background-color: #007ACC; "
-      "} "
-      "QMenu { "
-      "  background-color: #2d2d30; "
-      "  color: white; "
-      "  border: 1px solid #3e3e42; "
-      "  padding: 4px; "
-      "} "
-      "QMenu::item { "
-      "  padding: 8px 20px; "
-      "  border-radius: 4px; "
-      "} "
-      "QMenu::item:selected { "
-      "  background-color: #007ACC; "
-      "} "
-      "QMenu::separator { "
-      "  height: 1px; "
-      "  background-color: #3e3e42; "
-      "  margin: 4px 8px; "
-      "}");
-
   // Configure tab widget for overlay mode
   tabWidget->setWorkspaceManager(workspaceManager);
   tabWidget->setBookmarkManager(bookmarkManager);
@@ -133,21 +115,17 @@ void MainWindow::setupUI() {
   addDockWidget(Qt::RightDockWidgetArea, bookmarkDock);
   bookmarkDock->hide();
 
+  downloadsDock = downloadManager->createDownloadsDock(this);
+  addDockWidget(Qt::RightDockWidgetArea, downloadsDock);
+  downloadsDock->hide();
+
+  networkDock = networkRecorder->createWaterfallDock(this);
+  addDockWidget(Qt::BottomDockWidgetArea, networkDock);
+  networkDock->hide();
+
   // Create status widgets directly as children of MainWindow
   progressBar = new QProgressBar(this);
-  progressBar->setStyleSheet(
-      "QProgressBar { "
-      "  border: 1px solid black; "
-      "  border-radius: 3px; "
-      "  text-align: center; "
-      "  font-size: 10px; "
-      "  background-color: white; "
-      "  color: black; "
-      "} "
-      "QProgressBar::chunk { "
-      "  background-color: black; "
-      "  width: 10px; " // Adjust chunk appearance if needed
-      "}");
+  progressBar->setObjectName("pageProgress");
   progressBar->setVisible(false);
   progressBar->setMaximumHeight(15);
   progressBar->setTextVisible(false);
@@ -190,6 +168,13 @@ void MainWindow::createActions() {
   devToolsAction = new QAction("Developer Tools", this);
   devToolsAction->setShortcut(QKeySequence("Ctrl+Shift+I"));
 
+  // HTTP cache (kept across restarts, see BrowserProfile)
+  cacheStatisticsAction = new QAction("Cache Statistics", this);
+  clearCacheAction = new QAction("Clear Cache", this);
+  clearCacheOnExitAction = new QAction("Clear Cache on Exit", this);
+  clearCacheOnExitAction->setCheckable(true);
+  clearCacheOnExitAction->setChecked(BrowserProfile::instance()->cachePolicy().clearOnExit);
+
   // Toggle panel actions - only keep tab bar toggle with Cmd+S
   toggleTabBarAction = new QAction("Toggle Sidebar", this);
   toggleTabBarAction->setShortcut(QKeySequence("Ctrl+S"));
@@ -206,63 +191,58 @@ void MainWindow::createActions() {
     QAction *imagePiPAction = pictureInPictureManager->getImagePiPAction();
     if (imagePiPAction) {
       this->addAction(imagePiPAction);
-      qDebug() << "PiP action added with shortcut:" << imagePiPAction->shortcut().toString();
+      qCDebug(lcApp) << "PiP action added with shortcut:" << imagePiPAction->shortcut().toString();
     }
   }
   if (commandPaletteManager) {
-    qDebug() << "Setting up command palette manager actions...";
+    qCDebug(lcApp) << "Setting up command palette manager actions...";
     commandPaletteManager->setupActions();
 
     QAction *cmdAction = commandPaletteManager->getCommandPaletteAction();
     if (cmdAction) {
-      qDebug() << "Adding command palette action to MainWindow with shortcuts:";
+      qCDebug(lcApp) << "Adding command palette action to MainWindow with shortcuts:";
       for (const QKeySequence &shortcut : cmdAction->shortcuts()) {
-        qDebug() << "  -" << shortcut.toString();
+        qCDebug(lcApp) << "  -" << shortcut.toString();
       }
       this->addAction(cmdAction);
-      qDebug() << "Action added successfully. MainWindow actions count:" << this->actions().size();
+      qCDebug(lcApp) << "Action added successfully. MainWindow actions count:" << this->actions().size();
     } else {
-      qDebug() << "ERROR: commandPaletteAction is null!";
+      qCWarning(lcApp) << "commandPaletteAction is null!";
     }
 
 #ifdef QT_DEBUG
     QAction *testAction = commandPaletteManager->getOpenTestPageAction();
     if (testAction) {
-      qDebug() << "Adding test page action with shortcut:" << testAction->shortcut().toString();
+      qCDebug(lcApp) << "Adding test page action with shortcut:" << testAction->shortcut().toString();
       this->addAction(testAction);
     }
 #endif
   }
+  if (performanceHudManager) {
+    performanceHudManager->setupActions();
+    this->addAction(performanceHudManager->getToggleAction());
+  }
+  if (contentBlockingManager) {
+    contentBlockingManager->setupActions();
+    this->addAction(contentBlockingManager->getToggleAction());
+  }
+  if (mediaGovernor) {
+    mediaGovernor->setupActions();
+    this->addAction(mediaGovernor->getToggleAction());
+  }
+  if (downloadManager) {
+    downloadManager->setupActions();
+    this->addAction(downloadManager->getShowDownloadsAction());
+  }
+  if (networkRecorder) {
+    networkRecorder->setupActions();
+    this->addAction(networkRecorder->getRecordAction());
+    this->addAction(networkRecorder->getShowWaterfallAction());
+  }
 }
 
 void MainWindow::createToolbars() {
   navigationToolBar = addToolBar("Navigation");
-  navigationToolBar->setStyleSheet(
-      "QToolBar { "
-      "  background: qlineargradient(x1: 0, y1: 0, x2: 0, y2: 1, "
-      "    stop: 0 #f8f9fa, stop: 1 #e9ecef); "
-      "  border-bottom: 1px solid #d1d5db; "
-      "  spacing: 8px; "
-      "  padding: 5px; "
-      "} "
-      "QToolButton { "
-      "  background-color: #007ACC; "
-      "  border: none; "
-      "  border-radius: 6px; "
-      "  padding: 8px; "
-      "  margin: 2px; "
-      "  color: white; "
-      "} "
-      "QToolButton:hover { "
-      "  background-color: #005a9e; "
-      "} "
-      "QToolButton:pressed { "
-      "  background-color: #004578; "
-      "} "
-      "QToolButton:disabled { "
-      "  background-color: #6c757d; "
-      "  color: #adb5bd; "
-      "}");
   navigationToolBar->addAction(backAction);
   navigationToolBar->addAction(forwardAction);
   navigationToolBar->addAction(reloadAction);
@@ -275,7 +255,7 @@ void MainWindow::createMenus() {
   fileMenu->addAction(newTabAction);
   fileMenu->addAction(closeTabAction);
   fileMenu->addSeparator();
-  fileMenu->addAction("E&xit", this, &QWidget::close);
+  fileMenu->addAction("E&xit", this, &MainWindow::quitApplication);
 
   QMenu *editMenu = menuBar()->addMenu("&Edit");
   QAction *copyAction = editMenu->addAction("&Copy");
@@ -339,10 +319,24 @@ void MainWindow::createMenus() {
   if (pictureInPictureManager) {
     pictureInPictureManager->addToMenu(viewMenu);
   }
+  if (performanceHudManager) {
+    viewMenu->addAction(performanceHudManager->getToggleAction());
+  }
+  if (contentBlockingManager) {
+    viewMenu->addAction(contentBlockingManager->getToggleAction());
+    viewMenu->addAction(contentBlockingManager->getReloadAction());
+  }
+  if (mediaGovernor) {
+    viewMenu->addAction(mediaGovernor->getToggleAction());
+  }
 
   QMenu *historyMenu = menuBar()->addMenu("&History");
   historyMenu->addAction(viewHistoryAction);
   // Dynamically populate history items or show a dialog
+  historyMenu->addSeparator();
+  historyMenu->addAction(cacheStatisticsAction);
+  historyMenu->addAction(clearCacheAction);
+  historyMenu->addAction(clearCacheOnExitAction);
 
   QMenu *bookmarksMenu = menuBar()->addMenu("&Bookmarks");
   bookmarksMenu->addAction(addBookmarkAction);
@@ -358,6 +352,14 @@ void MainWindow::createMenus() {
     toolsMenu->addAction(commandPaletteManager->getOpenTestPageAction());
   }
 #endif
+  if (downloadManager) {
+    toolsMenu->addAction(downloadManager->getShowDownloadsAction());
+  }
+  if (networkRecorder) {
+    toolsMenu->addAction(networkRecorder->getRecordAction());
+    toolsMenu->addAction(networkRecorder->getShowWaterfallAction());
+    toolsMenu->addAction(networkRecorder->getExportHarAction());
+  }
   toolsMenu->addSeparator();
   toolsMenu->addAction(settingsAction);
   toolsMenu->addSeparator();
@@ -422,28 +424,42 @@ void MainWindow::setupConnections() {
     if (index != -1) {
       WebView *view = qobject_cast<WebView *>(tabWidget->widget(index));
       if (view) {
+        // Updates for background tabs were skipped: show this tab's real load state
+        const bool loading = tabUpdateCoalescer->isLoading(view);
         updateAddressBar(view->url());
-        updateWindowTitle(view->title());
+        handleLoadProgress(loading ? tabUpdateCoalescer->progress(view) : 100);
+        stopAction->setEnabled(loading);
+        reloadAction->setEnabled(!loading);
         backAction->setEnabled(view->page()->history()->canGoBack());
         forwardAction->setEnabled(view->page()->history()->canGoForward());
       }
     } else {
       updateAddressBar(QUrl());
-      updateWindowTitle("");
       backAction->setEnabled(false);
       forwardAction->setEnabled(false);
     }
   });
 
-  connect(tabWidget, &VerticalTabWidget::tabCloseRequested, this, [this](int index) {
-    if (tabWidget->count() > 1) {
-      QWidget *widget = tabWidget->widget(index);
-      tabWidget->removeTab(index);
+  connect(tabWidget, &VerticalTabWidget::tabCloseRequested, this, &MainWindow::closeTab);
+
+  connect(tabWidget, &VerticalTabWidget::newTabRequested, this, &MainWindow::newTab);
+
+  // Workspace switching replaces the open tabs
+  connect(workspaceManager, &WorkspaceManager::requestCloseAllTabs, this, [this]() {
+    while (tabWidget->count() > 0) {
+      QWidget *widget = tabWidget->widget(0);
+      tabWidget->removeTab(0);
       widget->deleteLater();
     }
   });
-
-  connect(tabWidget, &VerticalTabWidget::newTabRequested, this, &MainWindow::newTab);
+  connect(workspaceManager, &WorkspaceManager::requestNewTab, this, [this](const QString &url) {
+    if (url.isEmpty()) {
+      openTab(QUrl()); // Keeps the home page
+      return;
+    }
+    // Shows the tab's last snapshot while the live page loads
+    tabSnapshotManager->restore(createTab(), QUrl(url));
+  });
 
   // Connect address bar and integrated address bar
   connect(addressBar, &QLineEdit::returnPressed, this, &MainWindow::goToUrl);
@@ -461,6 +477,13 @@ void MainWindow::setupConnections() {
   connect(viewHistoryAction, &QAction::triggered, this, &MainWindow::showHistory);
   connect(settingsAction, &QAction::triggered, this, &MainWindow::showSettings);
   connect(devToolsAction, &QAction::triggered, this, &MainWindow::showDevTools);
+  connect(cacheStatisticsAction, &QAction::triggered, this, &MainWindow::showCacheStatistics);
+  connect(clearCacheAction, &QAction::triggered, this, &MainWindow::clearCache);
+  connect(clearCacheOnExitAction, &QAction::toggled, this, [](bool checked) {
+    CachePolicy policy = BrowserProfile::instance()->cachePolicy();
+    policy.clearOnExit = checked;
+    BrowserProfile::instance()->setCachePolicy(policy);
+  });
 
   connect(toggleTabBarAction, &QAction::triggered, this, &MainWindow::toggleTabBar);
 
@@ -473,12 +496,7 @@ void MainWindow::setupConnections() {
     }
   });
 
-  connect(bookmarkManager, &BookmarkManager::openBookmarkInNewTab, this, [this](const QUrl &url) {
-    newTab();
-    if (WebView *view = currentWebView()) {
-      view->load(url);
-    }
-  });
+  connect(bookmarkManager, &BookmarkManager::openBookmarkInNewTab, this, [this](const QUrl &url) { openTab(url); });
 }
 
 WebView *MainWindow::currentWebView() const {
@@ -486,30 +504,58 @@ WebView *MainWindow::currentWebView() const {
 }
 
 void MainWindow::newTab() {
+  openTab(QUrl());
+  addressBar->setFocus();
+}
+
+WebView *MainWindow::openTab(const QUrl &url, TabPlacement placement) {
+  WebView *webView = createTab(placement);
+  webView->load(url.isEmpty() ? QUrl(homePageUrl) : url);
+  return webView;
+}
+
+WebView *MainWindow::createTab(TabPlacement placement) {
   WebView *webView = new WebView(this);
 
-  // WebChannelを設定
-  if (webChannel) {
-    webView->page()->setWebChannel(webChannel);
-  }
+  // One web channel per tab: the page event bus tells the tabs apart by their channel
+  QWebChannel *webChannel = new QWebChannel(webView->page());
+  webChannel->registerObject("mainWindow", this);
+  webView->page()->setWebChannel(webChannel);
 
+  // The first tab is always current
+  const bool select = placement == ForegroundTab || !currentWebView();
   int index = tabWidget->addTab(webView, "New Tab");
-  tabWidget->setCurrentIndex(index);
-
-  connect(webView, &WebView::urlChanged, this, &MainWindow::updateAddressBar);
-  connect(webView, &WebView::titleChanged, this, &MainWindow::updateWindowTitle);
-  connect(webView, &WebView::loadProgress, this, &MainWindow::handleLoadProgress);
+  if (select) {
+    tabWidget->setCurrentIndex(index);
+  }
+
+  // Title, URL and progress go through the coalescer instead of straight to the UI
+  FaviconStore::instance()->attach(webView); // Before the coalescer, so the store has the icon when the tab asks
+  tabUpdateCoalescer->watch(webView);
+  pageEventBus->attach(webView); // Before any feature script that emits events
+  performanceHudManager->attach(webView);
+  contentBlockingManager->attach(webView);
+  networkRecorder->attach(webView);
+  tabSnapshotManager->attach(webView);
+  mediaGovernor->attach(webView);
+  newTabManager->attach(webView);
+  PageSearchService::instance()->attach(webView);
+  JobScheduler::instance()->attach(webView);
   connect(webView, &WebView::loadFinished, this, [this, webView](bool ok) {
-    stopAction->setEnabled(false);
-    reloadAction->setEnabled(true);
     if (ok) {
       history.prepend({webView->title(), webView->url()});
       // Limit history size if needed
     }
+    if (webView != currentWebView())
+      return;
+    stopAction->setEnabled(false);
+    reloadAction->setEnabled(true);
     backAction->setEnabled(webView->page()->history()->canGoBack());
     forwardAction->setEnabled(webView->page()->history()->canGoForward());
   });
-  connect(webView, &WebView::loadStarted, this, [this]() {
+  connect(webView, &WebView::loadStarted, this, [this, webView]() {
+    if (webView != currentWebView())
+      return;
     stopAction->setEnabled(true);
     reloadAction->setEnabled(false);
   });
@@ -517,8 +563,16 @@ void MainWindow::newTab() {
   webView->setContextMenuPolicy(Qt::CustomContextMenu);
   connect(webView, &WebView::customContextMenuRequested, this, &MainWindow::handleContextMenuRequested);
 
-  webView->load(homePageUrl); // Load home page in new tab
-  addressBar->setFocus();
+  emit tabCreated(webView);
+  return webView;
+}
+
+void MainWindow::closeTab(int index) {
+  if (tabWidget->count() <= 1 || index < 0 || index >= tabWidget->count())
+    return;
+  QWidget *widget = tabWidget->widget(index);
+  tabWidget->removeTab(index);
+  widget->deleteLater();
 }
 
 void MainWindow::closeCurrentTab() {
@@ -591,31 +645,62 @@ void MainWindow::stopLoading() {
   }
 }
 
+void MainWindow::applyTabUpdate(WebView *view, int dirtyFlags, int progress) {
+  int index = tabWidget->indexOf(view);
+  if (index == -1)
+    return;
+
+  // Tab titles are visible in the sidebar list, so they are applied for every tab
+  if (dirtyFlags & TabUpdateCoalescer::TitleDirty) {
+    updateTabTitle(index, view->title());
+    tabUpdateCoalescer->noteUpdateApplied();
+  }
+  if (dirtyFlags & TabUpdateCoalescer::IconDirty) {
+    tabWidget->setTabIcon(index, FaviconStore::instance()->icon(view->url()));
+    tabUpdateCoalescer->noteUpdateApplied();
+  }
+
+  // Address bar and progress only reflect the current tab; background tabs are
+  // picked up again by the currentChanged handler when they are activated
+  if (view != currentWebView())
+    return;
+
+  if (dirtyFlags & TabUpdateCoalescer::UrlDirty) {
+    updateAddressBar(view->url());
+    tabUpdateCoalescer->noteUpdateApplied();
+  }
+  if (dirtyFlags & TabUpdateCoalescer::ProgressDirty) {
+    handleLoadProgress(progress);
+    tabUpdateCoalescer->noteUpdateApplied();
+  }
+}
+
 void MainWindow::updateAddressBar(const QUrl &url) {
-  if (tabWidget->currentWidget() == sender() || (currentWebView() && currentWebView()->url() == url)) {
-    // Update both address bars
-    addressBar->setText(url.toString());
+  // Leave the address bar empty on the new tab page, ready for typing
+  const QString text = url == NewTabManager::newTabUrl() ? QString() : url.toString();
 
-    QLineEdit *integratedBar = tabWidget->getIntegratedAddressBar();
-    if (integratedBar) {
-      integratedBar->setText(url.toString());
-    }
+  // Update both address bars, skipping no-op writes
+  if (addressBar->text() != text) {
+    addressBar->setText(text);
+  }
+
+  QLineEdit *integratedBar = tabWidget->getIntegratedAddressBar();
+  if (integratedBar && integratedBar->text() != text) {
+    integratedBar->setText(text);
   }
+
   if (WebView *view = currentWebView()) { // Update history navigation buttons
     backAction->setEnabled(view->page()->history()->canGoBack());
     forwardAction->setEnabled(view->page()->history()->canGoForward());
   }
 }
 
-void MainWindow::updateWindowTitle(const QString &title) {
-  if (tabWidget->currentWidget() == sender()) {
-    int index = tabWidget->currentIndex();
-    if (index != -1) {
-      if (title.isEmpty()) {
-        tabWidget->setTabText(index, "Loading...");
-      } else {
-        tabWidget->setTabText(index, title.left(20)); // Truncate for tab
-      }
+void MainWindow::updateTabTitle(int index, const QString &title) {
+  if (index != -1) {
+    if (title.isEmpty()) {
+      tabWidget->setTabText(index, "Loading...");
+    } else {
+      tabWidget->setTabText(index, title.left(20)); // Truncate for tab
     }
   }
   // Optionally set main window title to active tab title
@@ -623,21 +708,17 @@ void MainWindow::updateWindowTitle(const QString &title) {
 }
 
 void MainWindow::handleLoadProgress(int progress) {
-  if (tabWidget->currentWidget() == sender()) {
-    if (progress > 0 && progress < 100) {
-      // statusLabel->setText(QString("Loading... %1%").arg(progress)); // 削除
-      progressBar->setValue(progress);
-      // statusLabel->setVisible(true); // 削除
-      progressBar->setVisible(true);
-    } else if (progress == 100) {
-      // statusLabel->setText("Ready"); // 削除
-      progressBar->setVisible(false);
-      // statusLabel->setVisible(false); // 削除
-    } else { // progress == 0 or other cases
-      // statusLabel->setVisible(false); // 削除
-      progressBar->setVisible(false);
-    }
-    adjustStatusWidgetsGeometry(); // Adjust geometry when visibility changes
+  const bool wasVisible = progressBar->isVisible();
+  const bool loading = progress > 0 && progress < 100;
+
+  if (loading) {
+    progressBar->setValue(progress);
+  }
+  progressBar->setVisible(loading);
+
+  // Geometry only depends on visibility, not on the progress value
+  if (loading && !wasVisible) {
+    adjustStatusWidgetsGeometry();
   }
 }
 
@@ -695,10 +776,7 @@ void MainWindow::openLinkInNewTab() {
   if (action) {
     QUrl url = action->data().toUrl();
     if (url.isValid()) {
-      newTab(); // Creates a new tab and sets it as current
-      if (WebView *newView = currentWebView()) {
-        newView->load(url);
-      }
+      openTab(url);
     }
   }
 }
@@ -732,9 +810,7 @@ void MainWindow::showBookmarks() {
       if (WebView *view = currentWebView()) {
         view->load(url);
       } else {
-        newTab();
-        if (WebView *newView = currentWebView())
-          newView->load(url);
+        openTab(url);
       }
     }
   });
@@ -749,7 +825,9 @@ void MainWindow::showHistory() {
   }
   QMenu historyMenu(this);
   for (const auto &item : history) {
-    QAction *action = historyMenu.addAction(item.first.left(50) + (item.first.length() > 50 ? "..." : "") + " (" + item.second.host() + ")");
+    QAction *action = historyMenu.addAction(FaviconStore::instance()->icon(item.second),
+                                            item.first.left(50) + (item.first.length() > 50 ? "..." : "") +
+                                                " (" + item.second.host() + ")");
     action->setData(item.second);
   }
   connect(&historyMenu, &QMenu::triggered, this, [this](QAction *action) {
@@ -758,9 +836,7 @@ void MainWindow::showHistory() {
       if (WebView *view = currentWebView()) {
         view->load(url);
       } else {
-        newTab();
-        if (WebView *newView = currentWebView())
-          newView->load(url);
+        openTab(url);
       }
     }
   });
@@ -789,6 +865,51 @@ void MainWindow::showSettings() {
   } else if (ok && !newSearchEngine.contains("%s")) {
     QMessageBox::warning(this, "Settings", "Search engine URL must contain '%s' for the query placeholder.");
   }
+
+  CachePolicy policy = BrowserProfile::instance()->cachePolicy();
+  const int cacheSize = QInputDialog::getInt(this, "Settings", "HTTP disk cache size (MB):",
+                                             policy.maximumSizeMB, 16, 2047, 64, &ok);
+  if (ok && cacheSize != policy.maximumSizeMB) {
+    policy.maximumSizeMB = cacheSize;
+    BrowserProfile::instance()->setCachePolicy(policy);
+  }
+}
+
+void MainWindow::showCacheStatistics() {
+  const CacheReport report = BrowserProfile::instance()->cacheReport();
+  const double mb = 1024.0 * 1024.0;
+
+  // Hit ratio comes from Resource Timing, collected while the Performance HUD is on
+  int resources = 0;
+  int cacheHits = 0;
+  for (const OriginMetrics &origin : performanceHudManager->getStore()->allOrigins()) {
+    resources += origin.resourceCount;
+    cacheHits += origin.cacheHits;
+  }
+  const QString hitRatio = resources > 0
+                               ? QString("%1% (%2 of %3 resources)").arg(100.0 * cacheHits / resources, 0, 'f', 1).arg(cacheHits).arg(resources)
+                               : QString("not measured (enable the Performance HUD)");
+
+  QStringList lines;
+  lines << QString("Location: %1").arg(report.path);
+  lines << QString("Size: %1 MB of %2 MB (%3 entries)")
+               .arg(report.sizeBytes / mb, 0, 'f', 1)
+               .arg(report.limitBytes / mb, 0, 'f', 0)
+               .arg(report.entries);
+  lines << QString("Evicted this session: %1 entries (%2 MB)%3")
+               .arg(report.evictedEntries)
+               .arg(report.evictedBytes / mb, 0, 'f', 1)
+               .arg(report.baselineReady ? QString() : QString(" — start-up scan still running"));
+  lines << QString("Cache hit ratio: %1").arg(hitRatio);
+  lines << QString("Clear on exit: %1").arg(BrowserProfile::instance()->cachePolicy().clearOnExit ? "yes" : "no");
+
+  QMessageBox::information(this, "Cache Statistics", lines.join('\n'));
+}
+
+void MainWindow::clearCache() {
+  if (QMessageBox::question(this, "Clear Cache", "Remove all cached pages and resources?") == QMessageBox::Yes) {
+    BrowserProfile::instance()->clearCache();
+  }
 }
 
 void MainWindow::showDevTools() {
@@ -798,23 +919,25 @@ void MainWindow::showDevTools() {
 }
 
 void MainWindow::closeEvent(QCloseEvent *event) {
+  if (runInBackground && !quitting) {
+    // The next launch shows the window again without starting a new engine
+    hide();
+    event->ignore();
+    return;
+  }
   // Save bookmarks, history, settings here before closing
   QMainWindow::closeEvent(event);
 }
 
-void MainWindow::loadStyleSheet() {
-  QFile file(":/src/features/main-window/styles.qss");
-  if (!file.exists()) {
-    // Fallback to file system
-    file.setFileName(QDir::currentPath() + "/src/features/main-window/styles.qss");
-  }
+void MainWindow::setRunInBackground(bool enabled) {
+  runInBackground = enabled;
+  QApplication::setQuitOnLastWindowClosed(!enabled);
+}
 
-  if (file.open(QFile::ReadOnly | QFile::Text)) {
-    QTextStream stream(&file);
-    QString styleSheet = stream.readAll();
-    setStyleSheet(styleSheet);
-    file.close();
-  }
+void MainWindow::quitApplication() {
+  quitting = true;
+  close();
+  QCoreApplication::quit();
 }
 
 void MainWindow::toggleTabBar() {
@@ -863,28 +986,10 @@ void MainWindow::openTestPage(const QString &fileName) {
   QUrl fileUrl = QUrl::fromLocalFile(testsPath);
 
   if (QFile::exists(testsPath)) {
-    newTab();
-    if (WebView *view = currentWebView()) {
-      view->load(fileUrl);
-    }
+    openTab(fileUrl);
   } else {
     QMessageBox::warning(this, "Test Page Not Found",
                          QString("Could not find test file: %1").arg(testsPath));
   }
 }
 #endif
-
-// WebChannel invokable methods for JavaScript swipe gesture handling
-void MainWindow::handleSwipeBack() {
-#ifdef DEBUG_MODE
-  qDebug() << "MainWindow::handleSwipeBack called from JavaScript";
-#endif
-  goBack();
-}
-
-void MainWindow::handleSwipeForward() {
-#ifdef DEBUG_MODE
-  qDebug() << "MainWindow::handleSwipeForward called from JavaScript";
-#endif
-  goForward();
-}
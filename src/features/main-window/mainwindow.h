@@ -13,7 +13,6 @@
 #include <QTabWidget>
 #include <QToolBar>
 #include <QUrl>
-#include <QWebChannel>
 
 class WebView;
 class VerticalTabWidget;
@@ -21,6 +20,16 @@ class WorkspaceManager;
 class BookmarkManager;
 class PictureInPictureManager;
 class CommandPaletteManager;
+class TabUpdateCoalescer;
+class PerformanceHudManager;
+class ContentBlockingManager;
+class NewTabManager;
+class DownloadManager;
+class PageEventBus;
+class PageScriptRunner;
+class NetworkRecorder;
+class TabSnapshotManager;
+class MediaGovernor;
 
 class MainWindow : public QMainWindow {
   Q_OBJECT
@@ -29,14 +38,42 @@ public:
   MainWindow(QWidget *parent = nullptr);
   ~MainWindow();
 
-  void newTab();                   // Make this public so WebView can access it
+  enum TabPlacement { ForegroundTab, BackgroundTab }; // Background tabs leave the current tab and focus alone
+
+  void newTab(); // Opens the home page and focuses the address bar
+  // Loads url (the home page when empty) straight into a new tab, with no page before it
+  WebView *openTab(const QUrl &url, TabPlacement placement = ForegroundTab);
+  WebView *createTab(TabPlacement placement = ForegroundTab); // Adds an empty tab (pop-ups navigate it themselves)
+  void closeTab(int index);        // Keeps the last tab open
   WebView *currentWebView() const; // Make this public too
 
+  // Closing the window only hides it; the engine stays warm until Exit
+  void setRunInBackground(bool enabled);
+  bool runsInBackground() const { return runInBackground; }
+
+  QString getHomePageUrl() const { return homePageUrl; }
+  void setHomePageUrl(const QString &url) { homePageUrl = url; }
+
   // Manager accessors
   WorkspaceManager *getWorkspaceManager() const { return workspaceManager; }
   VerticalTabWidget *getTabWidget() const { return tabWidget; }
   PictureInPictureManager *getPictureInPictureManager() const { return pictureInPictureManager; }
   CommandPaletteManager *getCommandPaletteManager() const { return commandPaletteManager; }
+  TabUpdateCoalescer *getTabUpdateCoalescer() const { return tabUpdateCoalescer; }
+  PerformanceHudManager *getPerformanceHudManager() const { return performanceHudManager; }
+  ContentBlockingManager *getContentBlockingManager() const { return contentBlockingManager; }
+  BookmarkManager *getBookmarkManager() const { return bookmarkManager; }
+  NewTabManager *getNewTabManager() const { return newTabManager; }
+  DownloadManager *getDownloadManager() const { return downloadManager; }
+  PageEventBus *getPageEventBus() const { return pageEventBus; }
+  PageScriptRunner *getPageScriptRunner() const { return pageScriptRunner; }
+  NetworkRecorder *getNetworkRecorder() const { return networkRecorder; }
+  TabSnapshotManager *getTabSnapshotManager() const { return tabSnapshotManager; }
+  MediaGovernor *getMediaGovernor() const { return mediaGovernor; }
+
+signals:
+  // Every tab, after the features are attached and before its first load
+  void tabCreated(WebView *view);
 
 protected:
   void closeEvent(QCloseEvent *event) override;
@@ -55,18 +92,18 @@ public slots:
   void showHistory();
   void showSettings();
   void showDevTools();
-
-  // WebChannel invokable methods for JavaScript communication
-  Q_INVOKABLE void handleSwipeBack();    // スワイプで戻る
-  Q_INVOKABLE void handleSwipeForward(); // スワイプで進む
+  void showCacheStatistics();
+  void clearCache();
+  void quitApplication();
 
 #ifdef DEBUG_MODE
   void openTestPage(const QString &fileName);
 #endif
 
 private slots:
+  void applyTabUpdate(WebView *view, int dirtyFlags, int progress);
   void updateAddressBar(const QUrl &url);
-  void updateWindowTitle(const QString &title);
+  void updateTabTitle(int index, const QString &title);
   void handleLoadProgress(int progress);
   void handleContextMenuRequested(const QPoint &pos);
   void openLinkInNewTab();
@@ -76,7 +113,6 @@ private slots:
 private:
   void setupUI();
   void setupConnections();
-  void loadStyleSheet();
   void createActions();
   void createMenus();
   void createToolbars();
@@ -91,9 +127,26 @@ private:
   BookmarkManager *bookmarkManager;
   PictureInPictureManager *pictureInPictureManager;
   CommandPaletteManager *commandPaletteManager;
+  PerformanceHudManager *performanceHudManager;
+  ContentBlockingManager *contentBlockingManager;
+  NewTabManager *newTabManager;
+  DownloadManager *downloadManager;
+  NetworkRecorder *networkRecorder;
+  TabSnapshotManager *tabSnapshotManager;
+  MediaGovernor *mediaGovernor;
+
+  // Batched events from page scripts, registered on the web channel as "pageEvents"
+  PageEventBus *pageEventBus;
+  // Awaitable page scripts; Promise results come back over pageEventBus
+  PageScriptRunner *pageScriptRunner;
+
+  // Batches per-tab title/URL/progress signals into one UI update per frame
+  TabUpdateCoalescer *tabUpdateCoalescer;
 
   // Dock widgets for panels
   QDockWidget *bookmarkDock;
+  QDockWidget *downloadsDock;
+  QDockWidget *networkDock;
 
   // Status bar components
   QProgressBar *progressBar;
@@ -109,6 +162,9 @@ private:
   QAction *viewHistoryAction;
   QAction *settingsAction;
   QAction *devToolsAction;
+  QAction *cacheStatisticsAction;
+  QAction *clearCacheAction;
+  QAction *clearCacheOnExitAction;
 
   // Toggle actions for panels
   QAction *toggleTabBarAction;
@@ -116,14 +172,14 @@ private:
   // For context menu
   QAction *openLinkInNewTabAction;
 
-  // WebChannel for JavaScript communication
-  QWebChannel *webChannel;
+  bool runInBackground = false;
+  bool quitting = false;
 
   // Placeholder for settings
 #ifdef DEBUG_MODE
   QString homePageUrl = "file:///Users/user/Documents/03_app/mybrowser/tests/pip_test_frame_capture_true.html";
 #else
-  QString homePageUrl = "https://www.google.com";
+  QString homePageUrl = "mybrowser://newtab";
 #endif
   QString defaultSearchEngineUrl = "https://www.google.com/search?q=%1";
 
@@ -0,0 +1,80 @@
+#include "tabupdatecoalescer.h"
+#include "../webview/webview.h"
+
+namespace {
+const int FRAME_INTERVAL_MS = 16;
+}
+
+TabUpdateCoalescer::TabUpdateCoalescer(QObject *parent)
+    : QObject(parent) {
+  frameTimer.setSingleShot(true);
+  frameTimer.setTimerType(Qt::PreciseTimer);
+  frameTimer.setInterval(FRAME_INTERVAL_MS);
+  connect(&frameTimer, &QTimer::timeout, this, &TabUpdateCoalescer::flush);
+}
+
+void TabUpdateCoalescer::watch(WebView *view) {
+  if (!view)
+    return;
+
+  connect(view, &WebView::titleChanged, this, [this, view]() {
+    markDirty(view, TitleDirty);
+  });
+  connect(view, &WebView::urlChanged, this, [this, view]() {
+    markDirty(view, UrlDirty);
+  });
+  connect(view, &WebView::loadStarted, this, [this, view]() {
+    loads[view] = {true, 0};
+  });
+  connect(view, &WebView::loadProgress, this, [this, view](int progress) {
+    loads[view].progress = progress;
+    markDirty(view, ProgressDirty, progress);
+  });
+  connect(view, &WebView::loadFinished, this, [this, view]() {
+    loads[view] = {false, 100};
+  });
+  connect(view, &WebView::iconChanged, this, [this, view]() {
+    markDirty(view, IconDirty);
+  });
+  connect(view, &QObject::destroyed, this, [this, view]() {
+    pending.remove(view);
+    loads.remove(view);
+  });
+}
+
+void TabUpdateCoalescer::markDirty(WebView *view, int flag, int progress) {
+  ++counters.signalsReceived;
+
+  PendingState &state = pending[view];
+  state.view = view;
+  state.flags |= flag;
+  if (flag == ProgressDirty) {
+    state.progress = progress; // Only the latest value matters
+  }
+
+  if (!frameTimer.isActive()) {
+    frameTimer.start();
+  }
+}
+
+void TabUpdateCoalescer::flushNow() {
+  frameTimer.stop();
+  flush();
+}
+
+void TabUpdateCoalescer::flush() {
+  if (pending.isEmpty())
+    return;
+
+  ++counters.flushes;
+
+  // Swap out first: receivers may trigger new signals while applying
+  QHash<WebView *, PendingState> batch;
+  batch.swap(pending);
+
+  for (const PendingState &state : std::as_const(batch)) {
+    if (state.view) {
+      emit tabStateChanged(state.view, state.flags, state.progress);
+    }
+  }
+}
@@ -0,0 +1,76 @@
+#ifndef TABUPDATECOALESCER_H
+#define TABUPDATECOALESCER_H
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+class WebView;
+
+/**
+ * @brief Collapses per-tab title/URL/progress/icon signals into frame-rate UI updates
+ *
+ * WebView signals only mark a tab dirty. At most once per frame the
+ * accumulated state is handed to MainWindow through tabStateChanged().
+ * The load state of every tab is kept, so a tab that becomes current can
+ * show its real progress right away.
+ */
+class TabUpdateCoalescer : public QObject {
+  Q_OBJECT
+
+public:
+  enum DirtyFlag {
+    TitleDirty = 0x1,
+    UrlDirty = 0x2,
+    ProgressDirty = 0x4,
+    IconDirty = 0x8
+  };
+
+  struct Stats {
+    quint64 signalsReceived = 0;
+    quint64 uiUpdatesApplied = 0;
+    quint64 flushes = 0;
+  };
+
+  explicit TabUpdateCoalescer(QObject *parent = nullptr);
+
+  void watch(WebView *view);
+  void flushNow();
+
+  bool isLoading(WebView *view) const { return loads.value(view).loading; }
+  int progress(WebView *view) const { return loads.value(view).progress; }
+
+  Stats stats() const { return counters; }
+  void resetStats() { counters = Stats(); }
+
+  // Called by the receiver for every update it actually applied
+  void noteUpdateApplied() { ++counters.uiUpdatesApplied; }
+
+signals:
+  void tabStateChanged(WebView *view, int dirtyFlags, int progress);
+
+private slots:
+  void flush();
+
+private:
+  struct PendingState {
+    QPointer<WebView> view;
+    int flags = 0;
+    int progress = 0;
+  };
+
+  struct LoadState {
+    bool loading = false;
+    int progress = 100;
+  };
+
+  void markDirty(WebView *view, int flag, int progress = 0);
+
+  QHash<WebView *, PendingState> pending;
+  QHash<WebView *, LoadState> loads;
+  QTimer frameTimer;
+  Stats counters;
+};
+
+#endif // TABUPDATECOALESCER_H
@@ -0,0 +1,294 @@
+// Background media governor
+// Injected into every tab by MediaGovernor while it is enabled. The host calls
+// setForeground() when the tab becomes or stops being the current one. In a
+// background tab, media the page starts on its own is paused at once and
+// media that is playing is paused; both resume when the tab comes to the
+// foreground. Audible media the user started keeps playing. The media state
+// goes to the host as "media.state" events on the page event bus.
+//
+// The script also runs in iframes. The host can only reach the top document,
+// so each frame passes start(), stop() and setForeground() on to its child
+// frames with postMessage; only the top document reports. Media that never enters the
+// document (new Audio()) is found through a wrapped HTMLMediaElement.play().
+
+(function () {
+  if (window.__mybrowserMedia) {
+    window.__mybrowserMedia.start();
+    return;
+  }
+
+  const MIN_RATE_SAMPLE = 500; // これより短い再生区間ではフレームレートを測らない
+  const FRAME_MESSAGE = "__mybrowserMedia"; // 親フレームから子フレームへの指示
+  const isTop = window.top === window;
+
+  let running = false;
+  let foreground = document.visibilityState === "visible";
+  const userStarted = new WeakSet(); // ユーザー操作で再生が始まったメディア
+  const playbackStarts = new WeakMap(); // メディア -> { time, frames }（フレームレート計測用）
+  const held = new Map(); // 背景にある間こちらで止めたメディア -> { since, fps }
+  const detached = new Set(); // ドキュメント外で再生中のメディア（new Audio() など）
+  let blocked = 0; // 背景で止めた自動再生の数
+  let savedMs = 0; // 止めていた動画の再生時間（デコードしなかった時間）
+  let framesSaved = 0;
+
+  function isMedia(target) {
+    return target instanceof HTMLMediaElement;
+  }
+
+  function allMedia() {
+    const media = Array.from(document.querySelectorAll("video, audio"));
+    detached.forEach(function (element) {
+      if (!element.isConnected) {
+        media.push(element);
+      }
+    });
+    return media;
+  }
+
+  function audible(media) {
+    return !media.muted && media.volume > 0;
+  }
+
+  // The user's own audible playback is left alone
+  function keepsPlaying(media) {
+    return userStarted.has(media) && audible(media);
+  }
+
+  function frameRate(media) {
+    const start = playbackStarts.get(media);
+    if (!start || !media.getVideoPlaybackQuality) {
+      return 0;
+    }
+    const elapsed = performance.now() - start.time;
+    const frames = media.getVideoPlaybackQuality().totalVideoFrames - start.frames;
+    return elapsed >= MIN_RATE_SAMPLE && frames > 0 ? (frames * 1000) / elapsed : 0;
+  }
+
+  function hold(media) {
+    if (held.has(media)) {
+      return;
+    }
+    held.set(media, { since: performance.now(), fps: frameRate(media) });
+    media.pause();
+  }
+
+  function release(media, resume) {
+    const entry = held.get(media);
+    if (!entry) {
+      return;
+    }
+    held.delete(media);
+    if (media instanceof HTMLVideoElement) {
+      const elapsed = performance.now() - entry.since;
+      savedMs += elapsed;
+      framesSaved += Math.round((entry.fps * elapsed) / 1000);
+    }
+    if (resume && (media.isConnected || detached.has(media))) {
+      media.play().catch(function () {});
+    }
+  }
+
+  function report() {
+    const bus = window.__mybrowserEvents;
+    if (!isTop || !bus) {
+      return;
+    }
+    let playing = 0;
+    let audibleCount = 0;
+    allMedia().forEach(function (media) {
+      if (!media.paused) {
+        playing++;
+        if (audible(media)) {
+          audibleCount++;
+        }
+      }
+    });
+    // 止めている最中の動画の分も含める
+    const now = performance.now();
+    let heldMs = 0;
+    held.forEach(function (entry, media) {
+      if (media instanceof HTMLVideoElement) {
+        heldMs += now - entry.since;
+      }
+    });
+    bus.emit("media.state", {
+      document: performance.timeOrigin,
+      foreground: foreground,
+      playing: playing,
+      audible: audibleCount,
+      held: held.size,
+      blocked: blocked,
+      savedMs: Math.round(savedMs + heldMs),
+      framesSaved: framesSaved,
+    });
+  }
+
+  function onPlay(event) {
+    const media = event.target;
+    if (!isMedia(media)) {
+      return;
+    }
+    // The page tried again to play media we hold in the background
+    if (held.has(media)) {
+      if (!foreground) {
+        media.pause();
+      }
+      return;
+    }
+    if (navigator.userActivation && navigator.userActivation.isActive) {
+      userStarted.add(media);
+    }
+    if (!foreground && !keepsPlaying(media)) {
+      blocked++;
+      hold(media);
+    }
+    report();
+  }
+
+  function onPlaying(event) {
+    const media = event.target;
+    if (!isMedia(media)) {
+      return;
+    }
+    const quality = media.getVideoPlaybackQuality ? media.getVideoPlaybackQuality() : null;
+    playbackStarts.set(media, { time: performance.now(), frames: quality ? quality.totalVideoFrames : 0 });
+  }
+
+  function onPause(event) {
+    if (isMedia(event.target) && !held.has(event.target)) {
+      detached.delete(event.target);
+      report();
+    }
+  }
+
+  // Muting the user's audio in the background turns it into media nobody hears
+  function onVolumeChange(event) {
+    const media = event.target;
+    if (isMedia(media) && !foreground && !media.paused && !keepsPlaying(media)) {
+      hold(media);
+      report();
+    }
+  }
+
+  function onEnded(event) {
+    if (isMedia(event.target)) {
+      release(event.target, false);
+      detached.delete(event.target);
+    }
+  }
+
+  function tellChildFrames(command) {
+    const message = {};
+    message[FRAME_MESSAGE] = command;
+    for (let i = 0; i < window.frames.length; i++) {
+      window.frames[i].postMessage(message, "*");
+    }
+  }
+
+  // Only the parent frame speaks for the host
+  function onMessage(event) {
+    const command = event.source === window.parent && event.data ? event.data[FRAME_MESSAGE] : undefined;
+    if (command === "start") {
+      start();
+    } else if (command === "stop") {
+      stop();
+    } else if (command === "foreground" || command === "background") {
+      setForeground(command === "foreground");
+    }
+  }
+
+  function setForeground(value) {
+    // Frames loaded since the last change get the state as well
+    tellChildFrames(value ? "foreground" : "background");
+    if (foreground === value) {
+      return;
+    }
+    foreground = value;
+    if (!running) {
+      return;
+    }
+    if (foreground) {
+      Array.from(held.keys()).forEach(function (media) {
+        release(media, true);
+      });
+    } else {
+      holdPlaying();
+    }
+    report();
+  }
+
+  function holdPlaying() {
+    allMedia().forEach(function (media) {
+      if (!media.paused && !keepsPlaying(media)) {
+        hold(media);
+      }
+    });
+  }
+
+  // Media events don't bubble: listen in the capture phase
+  const listeners = [
+    ["play", onPlay],
+    ["playing", onPlaying],
+    ["pause", onPause],
+    ["volumechange", onVolumeChange],
+    ["ended", onEnded],
+    ["emptied", onEnded],
+  ];
+
+  function listen(target, add) {
+    listeners.forEach(function (listener) {
+      if (add) {
+        target.addEventListener(listener[0], listener[1], true);
+      } else {
+        target.removeEventListener(listener[0], listener[1], true);
+      }
+    });
+  }
+
+  // Events of media outside the document never reach the document listeners
+  const nativePlay = HTMLMediaElement.prototype.play;
+  HTMLMediaElement.prototype.play = function () {
+    if (running && !this.isConnected && !detached.has(this)) {
+      detached.add(this);
+      listen(this, true);
+    }
+    return nativePlay.apply(this, arguments);
+  };
+
+  function start() {
+    if (running) {
+      return;
+    }
+    running = true;
+    listen(document, true);
+    tellChildFrames("start");
+    if (!foreground) {
+      holdPlaying();
+      report();
+    }
+  }
+
+  function stop() {
+    if (!running) {
+      return;
+    }
+    running = false;
+    listen(document, false);
+    tellChildFrames("stop");
+    Array.from(held.keys()).forEach(function (media) {
+      release(media, true);
+    });
+    detached.forEach(function (media) {
+      listen(media, false);
+    });
+    detached.clear();
+    report();
+  }
+
+  window.__mybrowserMedia = { start: start, stop: stop, setForeground: setForeground };
+  if (!isTop) {
+    window.addEventListener("message", onMessage);
+  }
+
+  start();
+})();
@@ -0,0 +1,195 @@
+#include "mediagovernor.h"
+#include "../logging/logcategories.h"
+#include "../main-window/mainwindow.h"
+#include "../page-events/pageeventbus.h"
+#include "../tab-widget/verticaltabwidget.h"
+#include "../webview/webview.h"
+#include <QFile>
+#include <QKeySequence>
+#include <QWebEngineScript>
+#include <QWebEngineScriptCollection>
+
+namespace {
+const char *CLIENT_SCRIPT_NAME = "mybrowser-media-governor";
+
+QString readResource(const QString &path) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    qCWarning(lcMedia) << "Failed to load" << path;
+    return QString();
+  }
+  return QString::fromUtf8(file.readAll());
+}
+} // namespace
+
+MediaTabState MediaTabState::fromJson(const QJsonObject &json) {
+  MediaTabState state;
+  state.document = json["document"].toDouble();
+  state.foreground = json["foreground"].toBool();
+  state.playing = json["playing"].toInt();
+  state.audible = json["audible"].toInt();
+  state.held = json["held"].toInt();
+  state.blocked = json["blocked"].toInt();
+  state.savedMs = json["savedMs"].toInteger();
+  state.framesSaved = json["framesSaved"].toInteger();
+  return state;
+}
+
+MediaGovernor::MediaGovernor(MainWindow *parent)
+    : QObject(parent), mainWindow(parent), toggleAction(nullptr), enabled(true), closedTabsSavedMs(0) {
+  parent->getPageEventBus()->subscribe<MediaTabState>(
+      "media.state", this, [this](int tabId, const MediaTabState &state) { onStateReported(tabId, state); });
+}
+
+MediaGovernor::~MediaGovernor() {
+  const qint64 savedMs = totalSavedMs();
+  if (savedMs > 0) {
+    qCInfo(lcMedia) << "MediaGovernor: skipped" << savedMs / 1000 << "s of background video this session";
+  }
+}
+
+void MediaGovernor::setupActions() {
+  toggleAction = new QAction("Pause Media in Background Tabs", mainWindow);
+  toggleAction->setShortcut(QKeySequence("Ctrl+Alt+M"));
+  toggleAction->setCheckable(true);
+  toggleAction->setChecked(enabled);
+  toggleAction->setStatusTip("Only the current tab autoplays; media in other tabs waits until you switch to them "
+                             "(Ctrl+Alt+M)");
+  connect(toggleAction, &QAction::toggled, this, &MediaGovernor::setEnabled);
+
+  connect(mainWindow->getTabWidget(), &VerticalTabWidget::currentChanged, this, &MediaGovernor::updateForeground);
+}
+
+void MediaGovernor::attach(WebView *view) {
+  if (!view)
+    return;
+
+  // A new document starts from its own visibility; tell it where it really is
+  connect(view, &WebView::loadFinished, this, [this, view]() {
+    if (enabled) {
+      setForeground(view, view == foregroundView);
+    }
+  });
+  const int tabId = view->tabId();
+  connect(view, &QObject::destroyed, this, [this, tabId]() {
+    closedTabsSavedMs += tabState(tabId).savedMs;
+    tabs.remove(tabId);
+  });
+
+  if (enabled) {
+    injectClient(view);
+  }
+}
+
+MediaTabState MediaGovernor::tabState(int tabId) const {
+  const TabMedia tab = tabs.value(tabId);
+  MediaTabState state = tab.current;
+  state.savedMs += tab.earlierSavedMs;
+  state.framesSaved += tab.earlierFramesSaved;
+  state.blocked += tab.earlierBlocked;
+  return state;
+}
+
+qint64 MediaGovernor::totalSavedMs() const {
+  qint64 total = closedTabsSavedMs;
+  for (auto it = tabs.cbegin(); it != tabs.cend(); ++it) {
+    total += tabState(it.key()).savedMs;
+  }
+  return total;
+}
+
+void MediaGovernor::onStateReported(int tabId, const MediaTabState &state) {
+  TabMedia &tab = tabs[tabId];
+  // Each document counts from zero: keep what the previous one saved
+  if (state.document != tab.current.document) {
+    tab.earlierSavedMs += tab.current.savedMs;
+    tab.earlierFramesSaved += tab.current.framesSaved;
+    tab.earlierBlocked += tab.current.blocked;
+  }
+  if (state.blocked > tab.current.blocked && state.document == tab.current.document) {
+    qCDebug(lcMedia) << "MediaGovernor: tab" << tabId << "held back an autoplay in the background";
+  }
+  tab.current = state;
+  emit tabStateChanged(tabId);
+}
+
+void MediaGovernor::setEnabled(bool enable) {
+  if (enabled == enable)
+    return;
+
+  enabled = enable;
+  if (toggleAction && toggleAction->isChecked() != enable) {
+    toggleAction->setChecked(enable);
+  }
+
+  VerticalTabWidget *tabWidget = mainWindow->getTabWidget();
+  for (int i = 0; i < tabWidget->count(); ++i) {
+    if (WebView *view = qobject_cast<WebView *>(tabWidget->widget(i))) {
+      if (enabled) {
+        injectClient(view);
+        setForeground(view, view == foregroundView);
+      } else {
+        removeClient(view);
+      }
+    }
+  }
+}
+
+void MediaGovernor::updateForeground() {
+  WebView *current = mainWindow->currentWebView();
+  if (current == foregroundView)
+    return;
+
+  WebView *previous = foregroundView;
+  foregroundView = current;
+  if (!enabled)
+    return;
+
+  // Pause the old tab before the new one resumes, so two tabs never play at once
+  if (previous) {
+    setForeground(previous, false);
+  }
+  if (current) {
+    setForeground(current, true);
+  }
+}
+
+void MediaGovernor::injectClient(WebView *view) {
+  const QString source = clientSource();
+  if (source.isEmpty())
+    return;
+
+  QWebEngineScript script;
+  script.setName(CLIENT_SCRIPT_NAME);
+  script.setSourceCode(source);
+  script.setInjectionPoint(QWebEngineScript::DocumentCreation);
+  script.setWorldId(QWebEngineScript::MainWorld);
+  script.setRunsOnSubFrames(true); // Embedded players; the top document passes the host's calls down
+  view->page()->scripts().insert(script);
+
+  // Govern the page that is already loaded as well
+  view->page()->runJavaScript(source);
+}
+
+void MediaGovernor::removeClient(WebView *view) {
+  QWebEngineScriptCollection &scripts = view->page()->scripts();
+  const QList<QWebEngineScript> existing = scripts.find(CLIENT_SCRIPT_NAME);
+  for (const QWebEngineScript &script : existing) {
+    scripts.remove(script);
+  }
+
+  // Resumes everything the governor paused
+  view->page()->runJavaScript("if (window.__mybrowserMedia) window.__mybrowserMedia.stop();");
+}
+
+void MediaGovernor::setForeground(WebView *view, bool foreground) {
+  view->page()->runJavaScript(QString("if (window.__mybrowserMedia) window.__mybrowserMedia.setForeground(%1);")
+                                  .arg(foreground ? "true" : "false"));
+}
+
+QString MediaGovernor::clientSource() {
+  if (clientScript.isEmpty()) {
+    clientScript = readResource(":/src/features/media-governor/media-governor.js");
+  }
+  return clientScript;
+}
@@ -0,0 +1,92 @@
+#ifndef MEDIAGOVERNOR_H
+#define MEDIAGOVERNOR_H
+
+#include <QAction>
+#include <QHash>
+#include <QJsonObject>
+#include <QObject>
+#include <QPointer>
+
+class MainWindow;
+class WebView;
+
+/**
+ * @brief Media state of one tab, as reported by media-governor.js
+ */
+struct MediaTabState {
+  double document = 0; // performance.timeOrigin of the reporting document
+  bool foreground = false;
+  int playing = 0;
+  int audible = 0;
+  int held = 0;           // Paused by the governor, resumed in the foreground
+  int blocked = 0;        // Autoplays stopped while the tab was in the background
+  qint64 savedMs = 0;     // Video playback time not decoded
+  qint64 framesSaved = 0; // ...in frames, at the rate each video was playing
+
+  static MediaTabState fromJson(const QJsonObject &json);
+};
+
+/**
+ * @brief Keeps background tabs from playing media on their own
+ *
+ * Autoplay stays allowed globally (PiP relies on it); instead a client script
+ * in every tab pauses media a background tab starts by itself and media that
+ * is playing when the tab leaves the foreground, and resumes it when the tab
+ * is current again. Audible media the user started keeps playing. The script
+ * runs in iframes too and governs media outside the document (new Audio());
+ * the top document reports the tab's media state over the PageEventBus
+ * ("media.state").
+ */
+class MediaGovernor : public QObject {
+  Q_OBJECT
+
+public:
+  explicit MediaGovernor(MainWindow *parent = nullptr);
+  ~MediaGovernor();
+
+  void setupActions();
+  QAction *getToggleAction() const { return toggleAction; }
+
+  // Called for every new tab; only injects while enabled
+  void attach(WebView *view);
+
+  bool isEnabled() const { return enabled; }
+  bool hasTab(int tabId) const { return tabs.contains(tabId); }
+  MediaTabState tabState(int tabId) const; // Counters add up over the documents of the tab
+  qint64 totalSavedMs() const;
+
+public slots:
+  void setEnabled(bool enable);
+
+signals:
+  void tabStateChanged(int tabId);
+
+private slots:
+  void updateForeground();
+
+private:
+  struct TabMedia {
+    MediaTabState current; // Latest report of the current document
+    qint64 earlierSavedMs = 0;
+    qint64 earlierFramesSaved = 0;
+    int earlierBlocked = 0;
+  };
+
+  void onStateReported(int tabId, const MediaTabState &state);
+  void injectClient(WebView *view);
+  void removeClient(WebView *view);
+  void setForeground(WebView *view, bool foreground);
+  QString clientSource();
+
+  MainWindow *mainWindow;
+  QAction *toggleAction;
+  bool enabled;
+  QPointer<WebView> foregroundView;
+  QHash<int, TabMedia> tabs;
+  qint64 closedTabsSavedMs;
+
+  // media-governor.js, loaded on first use
+  QString clientScript;
+};
+
+#endif // MEDIAGOVERNOR_H
@@ -0,0 +1,141 @@
+#include "harwriter.h"
+#include "../logging/logcategories.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QSet>
+#include <QTimeZone>
+#include <QUrlQuery>
+
+namespace {
+QString isoTime(double msecsSinceEpoch) {
+  return QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(msecsSinceEpoch), QTimeZone::utc())
+      .toString(Qt::ISODateWithMs);
+}
+
+QString pageRef(int pageId) {
+  return QString("page_%1").arg(pageId);
+}
+
+// HAR wants -1 for unknown phases and 0 or more otherwise
+double harTime(double value) {
+  return value < 0 ? -1 : value;
+}
+
+QJsonArray queryString(const QUrl &url) {
+  QJsonArray result;
+  for (const auto &item : QUrlQuery(url).queryItems(QUrl::FullyDecoded)) {
+    result.append(QJsonObject{{"name", item.first}, {"value", item.second}});
+  }
+  return result;
+}
+
+QJsonObject entry(const NetworkRequest &request) {
+  const QString httpVersion = request.protocol.isEmpty() ? QString("unknown") : request.protocol;
+
+  QJsonObject harRequest{
+      {"method", QString::fromLatin1(request.method)},
+      {"url", request.url.toString()},
+      {"httpVersion", httpVersion},
+      {"cookies", QJsonArray()},
+      {"headers", QJsonArray()},
+      {"queryString", queryString(request.url)},
+      {"headersSize", -1},
+      {"bodySize", -1},
+  };
+
+  QJsonObject content{{"size", request.decodedBodySize < 0 ? 0 : request.decodedBodySize}, {"mimeType", ""}};
+  if (request.encodedBodySize >= 0 && request.decodedBodySize >= 0) {
+    content["compression"] = request.decodedBodySize - request.encodedBodySize;
+  }
+  QJsonObject harResponse{
+      {"status", request.status},
+      {"statusText", ""},
+      {"httpVersion", httpVersion},
+      {"cookies", QJsonArray()},
+      {"headers", QJsonArray()},
+      {"content", content},
+      {"redirectURL", ""},
+      {"headersSize", -1},
+      {"bodySize", request.encodedBodySize},
+  };
+  if (request.transferSize >= 0) {
+    harResponse["_transferSize"] = request.transferSize;
+  }
+
+  // send, wait and receive are required; send is not measured by Resource Timing
+  QJsonObject timings{
+      {"blocked", harTime(request.blocked)},
+      {"dns", harTime(request.dns)},
+      {"connect", harTime(request.connect)},
+      {"ssl", harTime(request.ssl)},
+      {"send", 0},
+      {"wait", qMax(0.0, request.wait)},
+      {"receive", qMax(0.0, request.receive)},
+  };
+
+  QJsonObject initiator{{"type", request.initiatorType.isEmpty() ? QString("other") : request.initiatorType}};
+  if (request.initiator.isValid()) {
+    initiator["url"] = request.initiator.toString();
+  }
+
+  QJsonObject result{
+      {"startedDateTime", isoTime(request.startTime)},
+      {"time", qMax(0.0, request.duration)},
+      {"request", harRequest},
+      {"response", harResponse},
+      {"cache", QJsonObject()},
+      {"timings", timings},
+      {"_resourceType", request.resourceType},
+      {"_initiator", initiator},
+  };
+  if (request.pageId > 0) {
+    result["pageref"] = pageRef(request.pageId);
+  }
+  return result;
+}
+} // namespace
+
+QJsonObject HarWriter::build(const QList<NetworkPage> &pages, const QList<NetworkRequest> &requests) {
+  // Pages whose requests were all overwritten in the ring are left out
+  QSet<int> referenced;
+  QJsonArray entries;
+  for (const NetworkRequest &request : requests) {
+    referenced.insert(request.pageId);
+    entries.append(entry(request));
+  }
+
+  QJsonArray harPages;
+  for (const NetworkPage &page : pages) {
+    if (!referenced.contains(page.id))
+      continue;
+    harPages.append(QJsonObject{
+        {"startedDateTime", isoTime(page.startTime)},
+        {"id", pageRef(page.id)},
+        {"title", page.title.isEmpty() ? page.url.toString() : page.title},
+        {"pageTimings", QJsonObject{{"onContentLoad", harTime(page.onContentLoad)}, {"onLoad", harTime(page.onLoad)}}},
+    });
+  }
+
+  QJsonObject creator{{"name", "MyBrowser"}, {"version", QCoreApplication::applicationVersion()}};
+  QJsonObject log{{"version", "1.2"}, {"creator", creator}, {"pages", harPages}, {"entries", entries}};
+  return QJsonObject{{"log", log}};
+}
+
+bool HarWriter::write(const QString &path, const QJsonObject &har) {
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qCWarning(lcNetwork) << "HarWriter: cannot write" << path;
+    return false;
+  }
+  file.write(QJsonDocument(har).toJson(QJsonDocument::Indented));
+  if (!file.commit()) {
+    qCWarning(lcNetwork) << "HarWriter: cannot write" << path;
+    return false;
+  }
+  qCDebug(lcNetwork) << "HarWriter: wrote" << har["log"].toObject()["entries"].toArray().size() << "entries to"
+                     << path;
+  return true;
+}
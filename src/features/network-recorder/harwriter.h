@@ -0,0 +1,24 @@
+#ifndef HARWRITER_H
+#define HARWRITER_H
+
+#include "networkrecorder.h"
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+/**
+ * @brief Builds HAR 1.2 documents from recorded requests
+ *
+ * Only what the recorder sees is exported: no headers, cookies or bodies.
+ * Phases the page did not report (cross-origin responses without
+ * Timing-Allow-Origin) are written as -1, as the format allows. The
+ * resource type and initiator go into the _resourceType and _initiator
+ * custom fields that Chrome's exporter uses as well.
+ */
+class HarWriter {
+public:
+  static QJsonObject build(const QList<NetworkPage> &pages, const QList<NetworkRequest> &requests);
+  static bool write(const QString &path, const QJsonObject &har);
+};
+
+#endif // HARWRITER_H
@@ -0,0 +1,98 @@
+// Network recorder timing collector
+// Injected only while network recording is on. Resource Timing entries go to
+// the host as "net.timing" events on the page event bus (page-event-bus.js),
+// where NetworkRecorder matches them to the intercepted requests.
+
+(function () {
+  if (window.__mybrowserNetTiming) {
+    window.__mybrowserNetTiming.start();
+    return;
+  }
+
+  let observer = null;
+
+  // Compact rows: the field order matches NetworkRecorder::recordTimings
+  function row(entry) {
+    return [
+      entry.name,
+      entry.entryType === "navigation" ? "navigation" : entry.initiatorType,
+      entry.startTime,
+      entry.domainLookupStart,
+      entry.domainLookupEnd,
+      entry.connectStart,
+      entry.secureConnectionStart,
+      entry.connectEnd,
+      entry.requestStart,
+      entry.responseStart,
+      entry.responseEnd,
+      entry.transferSize,
+      entry.encodedBodySize,
+      entry.decodedBodySize,
+      entry.nextHopProtocol || "",
+      entry.responseStatus || 0,
+    ];
+  }
+
+  function report(entries) {
+    const bus = window.__mybrowserEvents;
+    if (!bus || entries.length === 0) {
+      return;
+    }
+    bus.emit("net.timing", {
+      timeOrigin: performance.timeOrigin,
+      entries: entries.map(row),
+    });
+  }
+
+  // The document entry is only complete after the load event, so it is sent once from there
+  function reportNavigation() {
+    const bus = window.__mybrowserEvents;
+    const entries = performance.getEntriesByType("navigation");
+    const nav = entries[entries.length - 1];
+    if (!bus || !nav) {
+      return;
+    }
+    bus.emit("net.timing", {
+      timeOrigin: performance.timeOrigin,
+      domContentLoaded: nav.domContentLoadedEventEnd,
+      load: nav.loadEventEnd,
+      entries: [row(nav)],
+    });
+  }
+
+  function start() {
+    if (observer) {
+      return;
+    }
+    try {
+      observer = new PerformanceObserver(function (list) {
+        report(list.getEntries());
+      });
+      // buffered: entries from before the script ran (or before recording started) are included
+      observer.observe({ type: "resource", buffered: true });
+    } catch (e) {
+      // PerformanceObserver 未対応
+      observer = null;
+    }
+
+    // loadEventEnd is filled in after the load handlers return
+    if (document.readyState === "complete") {
+      setTimeout(reportNavigation, 0);
+    } else {
+      window.addEventListener("load", function () {
+        setTimeout(reportNavigation, 0);
+      }, { once: true });
+    }
+  }
+
+  function stop() {
+    if (observer) {
+      observer.disconnect();
+      observer = null;
+    }
+  }
+
+  window.__mybrowserNetTiming = { start: start, stop: stop };
+
+  start();
+})();
@@ -0,0 +1,498 @@
+#include "networkrecorder.h"
+#include "../logging/logcategories.h"
+#include "../main-window/mainwindow.h"
+#include "../page-events/pageeventbus.h"
+#include "../tab-widget/verticaltabwidget.h"
+#include "../webview/webview.h"
+#include "harwriter.h"
+#include "networkwaterfallpanel.h"
+#include <QDateTime>
+#include <QDir>
+#include <QDockWidget>
+#include <QFile>
+#include <QFileDialog>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QKeySequence>
+#include <QMessageBox>
+#include <QStandardPaths>
+#include <QWebEngineScript>
+#include <QWebEngineScriptCollection>
+
+namespace {
+const char *TIMING_SCRIPT_NAME = "mybrowser-net-timing";
+const int MAX_REQUESTS_PER_TAB = 1000; // Oldest requests are overwritten beyond this
+const int MAX_PAGES_PER_TAB = 50;
+const int NOTIFY_DELAY_MS = 250;
+const double SAME_ENTRY_MS = 1.0; // Timing entries reported again after a restart of the collector
+const int TIMING_ROW_SIZE = 16;   // See row() in net-timing.js
+
+QString readResource(const QString &path) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    qCWarning(lcNetwork) << "Failed to load" << path;
+    return QString();
+  }
+  return QString::fromUtf8(file.readAll());
+}
+
+QString resourceTypeName(QWebEngineUrlRequestInfo::ResourceType type) {
+  switch (type) {
+  case QWebEngineUrlRequestInfo::ResourceTypeMainFrame:
+    return "document";
+  case QWebEngineUrlRequestInfo::ResourceTypeSubFrame:
+    return "subdocument";
+  case QWebEngineUrlRequestInfo::ResourceTypeStylesheet:
+    return "stylesheet";
+  case QWebEngineUrlRequestInfo::ResourceTypeScript:
+    return "script";
+  case QWebEngineUrlRequestInfo::ResourceTypeImage:
+    return "image";
+  case QWebEngineUrlRequestInfo::ResourceTypeFontResource:
+    return "font";
+  case QWebEngineUrlRequestInfo::ResourceTypeMedia:
+    return "media";
+  case QWebEngineUrlRequestInfo::ResourceTypeXhr:
+    return "xhr";
+  case QWebEngineUrlRequestInfo::ResourceTypePing:
+    return "ping";
+  case QWebEngineUrlRequestInfo::ResourceTypeFavicon:
+    return "favicon";
+  case QWebEngineUrlRequestInfo::ResourceTypePrefetch:
+    return "prefetch";
+  case QWebEngineUrlRequestInfo::ResourceTypeWorker:
+  case QWebEngineUrlRequestInfo::ResourceTypeSharedWorker:
+  case QWebEngineUrlRequestInfo::ResourceTypeServiceWorker:
+    return "worker";
+  case QWebEngineUrlRequestInfo::ResourceTypeCspReport:
+    return "csp-report";
+  default:
+    return "other";
+  }
+}
+
+// Length of a Resource Timing phase, or -1 when it is missing (0 marks an unavailable timestamp)
+double span(double start, double end) {
+  return start >= 0 && end > 0 && end >= start ? end - start : -1;
+}
+} // namespace
+
+/**
+ * @brief Page-level interceptor that hands every request of one tab to the recorder
+ *
+ * Installed only while recording. It runs on the UI thread after the
+ * tab's content blocking interceptor and never changes the request.
+ */
+class RecordingInterceptor : public QWebEngineUrlRequestInterceptor {
+public:
+  RecordingInterceptor(NetworkRecorder *recorder, int tabId, QObject *parent)
+      : QWebEngineUrlRequestInterceptor(parent), recorder(recorder), tabId(tabId) {}
+
+  void interceptRequest(QWebEngineUrlRequestInfo &info) override { recorder->recordRequest(tabId, info); }
+
+private:
+  NetworkRecorder *recorder;
+  int tabId;
+};
+
+NetworkRecorder::NetworkRecorder(MainWindow *parent)
+    : QObject(parent), mainWindow(parent), nextRequestId(1), nextPageId(1), recording(false),
+      recordAction(nullptr), showWaterfallAction(nullptr), exportHarAction(nullptr) {
+  notifyTimer.setSingleShot(true);
+  notifyTimer.setInterval(NOTIFY_DELAY_MS);
+  connect(&notifyTimer, &QTimer::timeout, this, &NetworkRecorder::notifyChanged);
+
+  parent->getPageEventBus()->subscribe("net.timing", this, [this](const PageEvent &event) {
+    if (recording) {
+      recordTimings(event);
+    }
+  });
+}
+
+NetworkRecorder::~NetworkRecorder() {
+}
+
+void NetworkRecorder::setupActions() {
+  recordAction = new QAction("Record Network Activity", mainWindow);
+  recordAction->setShortcut(QKeySequence("Ctrl+Alt+N"));
+  recordAction->setCheckable(true);
+  recordAction->setStatusTip("Record the requests of every tab (Ctrl+Alt+N)");
+  connect(recordAction, &QAction::toggled, this, &NetworkRecorder::setRecording);
+
+  showWaterfallAction = new QAction("Network Waterfall", mainWindow);
+  showWaterfallAction->setShortcut(QKeySequence("Ctrl+Alt+W"));
+  showWaterfallAction->setStatusTip("Show the recorded requests of the current tab (Ctrl+Alt+W)");
+  connect(showWaterfallAction, &QAction::triggered, this, &NetworkRecorder::showWaterfall);
+
+  exportHarAction = new QAction("Export HAR...", mainWindow);
+  exportHarAction->setStatusTip("Save the recorded requests of the current tab as a HAR file");
+  connect(exportHarAction, &QAction::triggered, this, &NetworkRecorder::exportCurrentTab);
+}
+
+QDockWidget *NetworkRecorder::createWaterfallDock(QWidget *parent) {
+  dockWidget = new QDockWidget("Network", parent);
+  dockWidget->setFeatures(QDockWidget::DockWidgetMovable | QDockWidget::DockWidgetFloatable |
+                          QDockWidget::DockWidgetClosable);
+  dockWidget->setAllowedAreas(Qt::BottomDockWidgetArea | Qt::RightDockWidgetArea);
+
+  panel = new NetworkWaterfallPanel(recordAction, exportHarAction, dockWidget);
+  dockWidget->setWidget(panel);
+  connect(panel, &NetworkWaterfallPanel::clearRequested, this, [this]() {
+    if (WebView *view = mainWindow->currentWebView()) {
+      clear(view->tabId());
+    }
+  });
+
+  // The panel only follows the current tab while it is visible
+  connect(dockWidget, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+    if (visible) {
+      refreshPanel();
+    }
+  });
+  connect(mainWindow->getTabWidget(), &VerticalTabWidget::currentChanged, this, &NetworkRecorder::refreshPanel);
+  connect(this, &NetworkRecorder::tabRecordingChanged, this, [this](int tabId) {
+    WebView *view = mainWindow->currentWebView();
+    if (view && view->tabId() == tabId) {
+      refreshPanel();
+    }
+  });
+  return dockWidget;
+}
+
+void NetworkRecorder::attach(WebView *view) {
+  if (!view)
+    return;
+
+  const int tabId = view->tabId();
+  connect(view, &QObject::destroyed, this, [this, tabId]() {
+    logs.remove(tabId);
+    interceptors.remove(tabId);
+    changedTabs.remove(tabId);
+  });
+  connect(view, &QWebEngineView::loadFinished, this, [this, view]() {
+    if (recording) {
+      finishPage(view);
+    }
+  });
+
+  if (recording) {
+    install(view);
+  }
+}
+
+QList<NetworkRequest> NetworkRecorder::requests(int tabId) const {
+  auto it = logs.constFind(tabId);
+  if (it == logs.constEnd())
+    return {};
+
+  // Unwrap the ring: the slot at next is the oldest once it has wrapped
+  return it->ring.mid(it->next) + it->ring.mid(0, it->next);
+}
+
+QList<NetworkPage> NetworkRecorder::pages(int tabId) const {
+  return logs.value(tabId).pages;
+}
+
+quint64 NetworkRecorder::droppedCount(int tabId) const {
+  return logs.value(tabId).dropped;
+}
+
+bool NetworkRecorder::exportHar(int tabId, const QString &path) const {
+  return HarWriter::write(path, HarWriter::build(pages(tabId), requests(tabId)));
+}
+
+void NetworkRecorder::clear(int tabId) {
+  logs.remove(tabId);
+  markChanged(tabId);
+}
+
+void NetworkRecorder::setRecording(bool enable) {
+  if (recording == enable)
+    return;
+
+  recording = enable;
+  if (recordAction && recordAction->isChecked() != enable) {
+    recordAction->setChecked(enable);
+  }
+
+  VerticalTabWidget *tabWidget = mainWindow->getTabWidget();
+  for (int i = 0; i < tabWidget->count(); ++i) {
+    if (WebView *view = qobject_cast<WebView *>(tabWidget->widget(i))) {
+      if (recording) {
+        install(view);
+      } else {
+        uninstall(view);
+      }
+    }
+  }
+
+  qCDebug(lcNetwork) << "NetworkRecorder: recording" << (recording ? "started" : "stopped");
+  refreshPanel();
+}
+
+void NetworkRecorder::toggle() {
+  setRecording(!recording);
+}
+
+void NetworkRecorder::showWaterfall() {
+  if (dockWidget) {
+    dockWidget->show();
+    dockWidget->raise();
+  }
+}
+
+void NetworkRecorder::exportCurrentTab() {
+  WebView *view = mainWindow->currentWebView();
+  if (!view)
+    return;
+
+  const QString host = view->url().host().isEmpty() ? QString("page") : view->url().host();
+  const QString suggested =
+      QDir(QStandardPaths::writableLocation(QStandardPaths::DownloadLocation))
+          .filePath(QString("%1-%2.har").arg(host, QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss")));
+  const QString path = QFileDialog::getSaveFileName(mainWindow, "Export HAR", suggested, "HAR files (*.har)");
+  if (path.isEmpty())
+    return;
+
+  if (!exportHar(view->tabId(), path)) {
+    QMessageBox::warning(mainWindow, "Export HAR", QString("Could not write %1").arg(path));
+  }
+}
+
+void NetworkRecorder::notifyChanged() {
+  const QSet<int> changed = changedTabs;
+  changedTabs.clear();
+  for (int tabId : changed) {
+    emit tabRecordingChanged(tabId);
+  }
+}
+
+void NetworkRecorder::recordRequest(int tabId, const QWebEngineUrlRequestInfo &info) {
+  const double now = QDateTime::currentMSecsSinceEpoch();
+
+  // A new document starts a new HAR page; redirects stay on the page they started
+  if (info.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeMainFrame &&
+      info.navigationType() != QWebEngineUrlRequestInfo::NavigationTypeRedirect) {
+    startPage(tabId, info.requestUrl(), now);
+  }
+
+  TabLog &log = logs[tabId];
+  NetworkRequest request;
+  request.id = nextRequestId++;
+  request.pageId = log.currentPage;
+  request.url = info.requestUrl();
+  request.method = info.requestMethod();
+  request.resourceType = resourceTypeName(info.resourceType());
+  request.initiator = info.initiator();
+  request.startTime = now;
+  request.intercepted = true;
+  append(log, request);
+
+  markChanged(tabId);
+}
+
+void NetworkRecorder::recordTimings(const PageEvent &event) {
+  const QJsonObject payload = event.payload.toObject();
+  const double timeOrigin = payload["timeOrigin"].toDouble();
+  TabLog &log = logs[event.tabId];
+
+  for (const QJsonValue &value : payload["entries"].toArray()) {
+    const QJsonArray row = value.toArray();
+    if (row.size() < TIMING_ROW_SIZE)
+      continue;
+
+    const QUrl url(row.at(0).toString());
+    const QString initiatorType = row.at(1).toString();
+    const double start = row.at(2).toDouble();
+    const bool navigation = initiatorType == "navigation";
+
+    NetworkRequest *request = nullptr;
+    if (!findRequest(log, url, timeOrigin + start, navigation, &request))
+      continue; // Already recorded
+    if (!request) {
+      // Served without a network request (memory cache), or the interceptor was installed too late
+      NetworkRequest added;
+      added.id = nextRequestId++;
+      added.pageId = log.currentPage;
+      added.url = url;
+      added.method = "GET";
+      added.resourceType = navigation ? QString("document") : QString("other");
+      request = append(log, added);
+    }
+
+    const double domainLookupStart = row.at(3).toDouble();
+    const double domainLookupEnd = row.at(4).toDouble();
+    const double connectStart = row.at(5).toDouble();
+    const double secureConnectionStart = row.at(6).toDouble();
+    const double connectEnd = row.at(7).toDouble();
+    const double requestStart = row.at(8).toDouble();
+    const double responseStart = row.at(9).toDouble();
+    const double responseEnd = row.at(10).toDouble();
+
+    request->timed = true;
+    request->initiatorType = initiatorType;
+    request->startTime = timeOrigin + start;
+    request->duration = span(start, responseEnd);
+    request->blocked = span(start, domainLookupStart > 0 ? domainLookupStart
+                                   : connectStart > 0  ? connectStart
+                                                       : requestStart);
+    request->dns = span(domainLookupStart, domainLookupEnd);
+    request->connect = span(connectStart, connectEnd);
+    request->ssl = span(secureConnectionStart, connectEnd);
+    request->wait = span(requestStart, responseStart);
+    request->receive = span(responseStart, responseEnd);
+    request->transferSize = row.at(11).toInteger(-1);
+    request->encodedBodySize = row.at(12).toInteger(-1);
+    request->decodedBodySize = row.at(13).toInteger(-1);
+    request->protocol = row.at(14).toString();
+    request->status = row.at(15).toInt();
+  }
+
+  // The navigation entry carries the page timings
+  if (payload.contains("load")) {
+    for (NetworkPage &page : log.pages) {
+      if (page.id == log.currentPage) {
+        page.startTime = timeOrigin;
+        page.onContentLoad = payload["domContentLoaded"].toDouble(-1);
+        page.onLoad = payload["load"].toDouble(-1);
+      }
+    }
+  }
+
+  markChanged(event.tabId);
+}
+
+bool NetworkRecorder::findRequest(TabLog &log, const QUrl &url, double startTime, bool navigation,
+                                  NetworkRequest **match) {
+  *match = nullptr;
+  const QUrl target = url.adjusted(QUrl::RemoveFragment);
+  const int count = log.ring.size();
+  for (int i = count - 1; i >= 0; --i) {
+    NetworkRequest &request = log.ring[(log.next + i) % count];
+    if (request.pageId != log.currentPage)
+      break; // Resource Timing only covers the current document
+    if (request.url.adjusted(QUrl::RemoveFragment) != target)
+      continue;
+
+    if (navigation) {
+      if (request.resourceType == "document") {
+        *match = &request;
+        return true;
+      }
+      continue;
+    }
+    if (request.timed) {
+      if (qAbs(request.startTime - startTime) < SAME_ENTRY_MS)
+        return false;
+      continue;
+    }
+    // Keep walking back: the oldest untimed request for this URL is the one this entry describes
+    *match = &request;
+  }
+  return true;
+}
+
+NetworkRequest *NetworkRecorder::append(TabLog &log, const NetworkRequest &request) {
+  if (log.ring.size() < MAX_REQUESTS_PER_TAB) {
+    log.ring.append(request);
+    return &log.ring.last();
+  }
+
+  const int slot = log.next;
+  log.ring[slot] = request;
+  log.next = (slot + 1) % MAX_REQUESTS_PER_TAB;
+  log.dropped++;
+  return &log.ring[slot];
+}
+
+void NetworkRecorder::startPage(int tabId, const QUrl &url, double startTime) {
+  TabLog &log = logs[tabId];
+  NetworkPage page;
+  page.id = nextPageId++;
+  page.url = url;
+  page.startTime = startTime;
+  log.pages.append(page);
+  log.currentPage = page.id;
+  if (log.pages.size() > MAX_PAGES_PER_TAB) {
+    log.pages.removeFirst();
+  }
+}
+
+void NetworkRecorder::finishPage(WebView *view) {
+  auto it = logs.find(view->tabId());
+  if (it == logs.end())
+    return;
+
+  for (NetworkPage &page : it->pages) {
+    if (page.id == it->currentPage) {
+      page.title = view->title();
+    }
+  }
+  markChanged(view->tabId());
+}
+
+void NetworkRecorder::markChanged(int tabId) {
+  changedTabs.insert(tabId);
+  if (!notifyTimer.isActive()) {
+    notifyTimer.start();
+  }
+}
+
+void NetworkRecorder::refreshPanel() {
+  if (!panel || !dockWidget || !dockWidget->isVisible())
+    return;
+
+  WebView *view = mainWindow->currentWebView();
+  if (!view) {
+    panel->showRequests({}, {}, 0, recording);
+    return;
+  }
+  const int tabId = view->tabId();
+  panel->showRequests(pages(tabId), requests(tabId), droppedCount(tabId), recording);
+}
+
+void NetworkRecorder::install(WebView *view) {
+  const int tabId = view->tabId();
+  if (!interceptors.value(tabId)) {
+    // Parented to the view, so it outlives the page that uses it
+    RecordingInterceptor *interceptor = new RecordingInterceptor(this, tabId, view);
+    view->addRequestInterceptor(interceptor);
+    interceptors.insert(tabId, interceptor);
+  }
+
+  const QString source = timingScriptSource();
+  if (source.isEmpty())
+    return;
+
+  QWebEngineScript script;
+  script.setName(TIMING_SCRIPT_NAME);
+  script.setSourceCode(source);
+  script.setInjectionPoint(QWebEngineScript::DocumentCreation);
+  script.setWorldId(QWebEngineScript::MainWorld);
+  script.setRunsOnSubFrames(false);
+  view->page()->scripts().insert(script);
+
+  // Buffered entries of the page that is already loaded are reported as well
+  view->page()->runJavaScript(source);
+}
+
+void NetworkRecorder::uninstall(WebView *view) {
+  QWebEngineUrlRequestInterceptor *interceptor = interceptors.take(view->tabId());
+  view->removeRequestInterceptor(interceptor);
+  delete interceptor;
+
+  QWebEngineScriptCollection &scripts = view->page()->scripts();
+  const QList<QWebEngineScript> existing = scripts.find(TIMING_SCRIPT_NAME);
+  for (const QWebEngineScript &script : existing) {
+    scripts.remove(script);
+  }
+
+  view->page()->runJavaScript("if (window.__mybrowserNetTiming) window.__mybrowserNetTiming.stop();");
+}
+
+QString NetworkRecorder::timingScriptSource() {
+  if (timingScript.isEmpty()) {
+    timingScript = readResource(":/src/features/network-recorder/net-timing.js");
+  }
+  return timingScript;
+}
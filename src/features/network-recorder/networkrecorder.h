@@ -0,0 +1,167 @@
+#ifndef NETWORKRECORDER_H
+#define NETWORKRECORDER_H
+
+#include <QAction>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+#include <QUrl>
+#include <QWebEngineUrlRequestInterceptor>
+
+class MainWindow;
+class WebView;
+class QDockWidget;
+class NetworkWaterfallPanel;
+struct PageEvent;
+
+/**
+ * @brief One request seen by the recorder
+ *
+ * The interceptor fills in what the request looks like when it starts; the
+ * Resource Timing entry reported by the page adds the phases and sizes once
+ * the response is complete. Phases are milliseconds relative to startTime,
+ * -1 when the phase did not happen or the server did not allow cross-origin
+ * timing (Timing-Allow-Origin).
+ */
+struct NetworkRequest {
+  quint64 id = 0;
+  int pageId = 0;
+  QUrl url;
+  QByteArray method;
+  QString resourceType;     // From the interceptor: document, script, image, ...
+  QString initiatorType;    // From Resource Timing: link, img, script, fetch, xmlhttprequest, ...
+  QUrl initiator;           // Origin that caused the request
+  double startTime = 0;     // Wall clock, milliseconds since the epoch
+  bool intercepted = false; // False for entries known only from Resource Timing (memory cache hits)
+  bool timed = false;
+
+  // Resource Timing phases
+  double duration = -1;
+  double blocked = -1;
+  double dns = -1;
+  double connect = -1;
+  double ssl = -1;
+  double wait = -1;
+  double receive = -1;
+  qint64 transferSize = -1;
+  qint64 encodedBodySize = -1;
+  qint64 decodedBodySize = -1;
+  QString protocol;
+  int status = 0;
+};
+
+/**
+ * @brief One page load of a tab, the HAR "page" the requests belong to
+ */
+struct NetworkPage {
+  int id = 0;
+  QUrl url;
+  QString title;
+  double startTime = 0;      // Wall clock, milliseconds since the epoch
+  double onContentLoad = -1; // Relative to startTime
+  double onLoad = -1;
+};
+
+/**
+ * @brief Per-tab network request recorder with a waterfall and HAR export
+ *
+ * Off by default. While recording, every tab gets a page-level
+ * QWebEngineUrlRequestInterceptor (WebView::addRequestInterceptor) that
+ * attributes requests to the tab, and a small PerformanceObserver script
+ * (net-timing.js) that reports Resource Timing entries as "net.timing"
+ * events on the PageEventBus. Requests are kept in a fixed-size ring per
+ * tab, so a long session can't grow memory.
+ *
+ * Nothing is installed while recording is off: tabs have no recording
+ * interceptor and no script, and the load signal handlers return after one
+ * flag check.
+ */
+class NetworkRecorder : public QObject {
+  Q_OBJECT
+
+public:
+  explicit NetworkRecorder(MainWindow *parent = nullptr);
+  ~NetworkRecorder();
+
+  void setupActions();
+  QAction *getRecordAction() const { return recordAction; }
+  QAction *getShowWaterfallAction() const { return showWaterfallAction; }
+  QAction *getExportHarAction() const { return exportHarAction; }
+
+  QDockWidget *createWaterfallDock(QWidget *parent);
+
+  // Called for every new tab; only installs anything while recording
+  void attach(WebView *view);
+
+  bool isRecording() const { return recording; }
+
+  // Oldest first
+  QList<NetworkRequest> requests(int tabId) const;
+  QList<NetworkPage> pages(int tabId) const;
+  quint64 droppedCount(int tabId) const;
+
+  bool exportHar(int tabId, const QString &path) const;
+  void clear(int tabId);
+
+public slots:
+  void setRecording(bool enable);
+  void toggle();
+  void showWaterfall();
+  void exportCurrentTab();
+
+signals:
+  // Coalesced: at most a few times per second per tab
+  void tabRecordingChanged(int tabId);
+
+private slots:
+  void notifyChanged();
+
+private:
+  struct TabLog {
+    QList<NetworkRequest> ring;
+    int next = 0; // Slot the next request goes into once the ring is full
+    quint64 dropped = 0;
+    QList<NetworkPage> pages;
+    int currentPage = 0;
+  };
+
+  friend class RecordingInterceptor;
+
+  void recordRequest(int tabId, const QWebEngineUrlRequestInfo &info);
+  void recordTimings(const PageEvent &event);
+  // False when the entry was already recorded; otherwise match is the request it describes, if any
+  static bool findRequest(TabLog &log, const QUrl &url, double startTime, bool navigation, NetworkRequest **match);
+  static NetworkRequest *append(TabLog &log, const NetworkRequest &request);
+  void startPage(int tabId, const QUrl &url, double startTime);
+  void finishPage(WebView *view);
+  void markChanged(int tabId);
+  void refreshPanel();
+
+  void install(WebView *view);
+  void uninstall(WebView *view);
+  QString timingScriptSource();
+
+  MainWindow *mainWindow;
+  QHash<int, TabLog> logs;
+  QHash<int, QPointer<QWebEngineUrlRequestInterceptor>> interceptors;
+  QSet<int> changedTabs;
+  QTimer notifyTimer;
+  quint64 nextRequestId;
+  int nextPageId;
+  bool recording;
+
+  QPointer<QDockWidget> dockWidget;
+  QPointer<NetworkWaterfallPanel> panel;
+  QAction *recordAction;
+  QAction *showWaterfallAction;
+  QAction *exportHarAction;
+
+  // net-timing.js, loaded on first use
+  QString timingScript;
+};
+
+#endif // NETWORKRECORDER_H
@@ -0,0 +1,202 @@
+#include "networkwaterfallpanel.h"
+#include "../../core/ui_constants.h"
+#include "../theme/theme.h"
+#include <QAction>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPainter>
+#include <QPushButton>
+#include <QStyledItemDelegate>
+#include <QToolButton>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+namespace {
+enum Column { NameColumn, TypeColumn, InitiatorColumn, StatusColumn, SizeColumn, TimeColumn, WaterfallColumn };
+
+const int PhasesRole = Qt::UserRole; // QVariantList: offset, blocked, dns, connect, wait, receive, duration
+const int BAR_HEIGHT = 8;
+const int BAR_PADDING = 4;
+const int UNTIMED_MARK_WIDTH = 2;
+
+QString formatBytes(qint64 bytes) {
+  if (bytes < 1024)
+    return QString("%1 B").arg(bytes);
+  if (bytes < 1024 * 1024)
+    return QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+  return QString("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+}
+
+QString formatMs(double ms) {
+  if (ms < 0)
+    return QStringLiteral("—");
+  if (ms < 1000)
+    return QString("%1 ms").arg(ms, 0, 'f', 0);
+  return QString("%1 s").arg(ms / 1000.0, 0, 'f', 2);
+}
+
+QString sizeText(const NetworkRequest &request) {
+  if (request.transferSize == 0 && request.decodedBodySize > 0)
+    return "(cache)";
+  if (request.transferSize > 0)
+    return formatBytes(request.transferSize);
+  return QStringLiteral("—");
+}
+
+QString displayName(const QUrl &url) {
+  const QString file = url.fileName();
+  return file.isEmpty() ? url.host() + url.path() : file;
+}
+} // namespace
+
+/**
+ * @brief Paints one request's phases on the shared time axis of the page
+ */
+class WaterfallDelegate : public QStyledItemDelegate {
+public:
+  using QStyledItemDelegate::QStyledItemDelegate;
+
+  // Milliseconds covered by the column width
+  void setRange(double range) { this->range = qMax(1.0, range); }
+
+  void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override {
+    QStyledItemDelegate::paint(painter, option, index);
+
+    const QVariantList phases = index.data(PhasesRole).toList();
+    if (phases.size() < 7)
+      return;
+
+    using namespace UIConstants;
+    const QRectF area = QRectF(option.rect).adjusted(BAR_PADDING, 0, -BAR_PADDING, 0);
+    const double scale = area.width() / range;
+    const double top = area.center().y() - BAR_HEIGHT / 2.0;
+    double x = area.left() + phases.at(0).toDouble() * scale;
+
+    painter->save();
+    const double duration = phases.at(6).toDouble();
+    if (duration < 0) {
+      // Only the start is known
+      painter->fillRect(QRectF(x, top, UNTIMED_MARK_WIDTH, BAR_HEIGHT), Theme::color(NETWORK_UNTIMED));
+      painter->restore();
+      return;
+    }
+
+    const QRgb colors[] = {NETWORK_BLOCKED, NETWORK_DNS, NETWORK_CONNECT, NETWORK_WAIT, NETWORK_RECEIVE};
+    double drawn = 0;
+    for (int phase = 0; phase < 5; ++phase) {
+      const double length = phases.at(phase + 1).toDouble();
+      if (length <= 0)
+        continue;
+      painter->fillRect(QRectF(x, top, qMax(1.0, length * scale), BAR_HEIGHT), Theme::color(colors[phase]));
+      x += length * scale;
+      drawn += length;
+    }
+    // Cross-origin responses without Timing-Allow-Origin only report the total
+    if (drawn < duration) {
+      painter->fillRect(QRectF(x, top, qMax(1.0, (duration - drawn) * scale), BAR_HEIGHT),
+                        Theme::color(NETWORK_RECEIVE));
+    }
+    painter->restore();
+  }
+
+private:
+  double range = 1;
+};
+
+NetworkWaterfallPanel::NetworkWaterfallPanel(QAction *recordAction, QAction *exportAction, QWidget *parent)
+    : QWidget(parent) {
+  QVBoxLayout *layout = new QVBoxLayout(this);
+
+  QHBoxLayout *buttonLayout = new QHBoxLayout();
+  QToolButton *recordButton = new QToolButton(this);
+  recordButton->setDefaultAction(recordAction);
+  QPushButton *clearButton = new QPushButton("Clear", this);
+  clearButton->setToolTip("Forget the requests recorded for this tab");
+  QToolButton *exportButton = new QToolButton(this);
+  exportButton->setDefaultAction(exportAction);
+  summaryLabel = new QLabel(this);
+  summaryLabel->setObjectName("networkSummary");
+  buttonLayout->addWidget(recordButton);
+  buttonLayout->addWidget(summaryLabel, 1);
+  buttonLayout->addWidget(clearButton);
+  buttonLayout->addWidget(exportButton);
+  layout->addLayout(buttonLayout);
+  connect(clearButton, &QPushButton::clicked, this, &NetworkWaterfallPanel::clearRequested);
+
+  requestList = new QTreeWidget(this);
+  requestList->setObjectName("networkRequests");
+  requestList->setRootIsDecorated(false);
+  requestList->setUniformRowHeights(true);
+  requestList->setHeaderLabels({"Name", "Type", "Initiator", "Status", "Size", "Time", "Waterfall"});
+  requestList->header()->setStretchLastSection(true);
+  requestList->header()->resizeSection(NameColumn, 220);
+  waterfallDelegate = new WaterfallDelegate(requestList);
+  requestList->setItemDelegateForColumn(WaterfallColumn, waterfallDelegate);
+  layout->addWidget(requestList);
+}
+
+void NetworkWaterfallPanel::showRequests(const QList<NetworkPage> &pages, const QList<NetworkRequest> &requests,
+                                         quint64 dropped, bool recording) {
+  requestList->clear();
+
+  if (pages.isEmpty() || requests.isEmpty()) {
+    summaryLabel->setText(recording ? "Recording. Reload the page to capture its requests."
+                                    : "Not recording. Start recording, then reload the page.");
+    return;
+  }
+
+  // Only the latest page load; earlier ones are still in the HAR export
+  const NetworkPage &page = pages.last();
+  QList<const NetworkRequest *> shown;
+  double origin = page.startTime;
+  for (const NetworkRequest &request : requests) {
+    if (request.pageId == page.id) {
+      shown.append(&request);
+      origin = qMin(origin, request.startTime);
+    }
+  }
+
+  double end = origin;
+  qint64 transferred = 0;
+  for (const NetworkRequest *request : shown) {
+    end = qMax(end, request->startTime + qMax(0.0, request->duration));
+    transferred += qMax<qint64>(0, request->transferSize);
+  }
+  waterfallDelegate->setRange(end - origin);
+
+  QList<QTreeWidgetItem *> items;
+  items.reserve(shown.size());
+  for (const NetworkRequest *request : shown) {
+    QTreeWidgetItem *item = new QTreeWidgetItem();
+    item->setText(NameColumn, displayName(request->url));
+    item->setToolTip(NameColumn, request->url.toString());
+    item->setText(TypeColumn, request->resourceType);
+    const QString initiator = request->initiatorType.isEmpty() ? request->initiator.host() : request->initiatorType;
+    item->setText(InitiatorColumn, initiator);
+    item->setToolTip(InitiatorColumn, request->initiator.toString());
+    item->setText(StatusColumn, request->status > 0 ? QString::number(request->status) : QString());
+    item->setText(SizeColumn, sizeText(*request));
+    item->setText(TimeColumn, formatMs(request->duration));
+    item->setData(WaterfallColumn, PhasesRole,
+                  QVariantList{request->startTime - origin, request->blocked, request->dns, request->connect,
+                               request->wait, request->receive, request->duration});
+    items.append(item);
+  }
+  requestList->addTopLevelItems(items);
+
+  QString summary = QString("%1 requests · %2 transferred · %3")
+                        .arg(shown.size())
+                        .arg(formatBytes(transferred))
+                        .arg(formatMs(end - origin));
+  if (page.onLoad >= 0) {
+    summary += QString(" · load %1").arg(formatMs(page.onLoad));
+  }
+  if (dropped > 0) {
+    summary += QString(" · %1 older requests dropped").arg(dropped);
+  }
+  if (!recording) {
+    summary += " · not recording";
+  }
+  summaryLabel->setText(summary);
+}
@@ -0,0 +1,36 @@
+#ifndef NETWORKWATERFALLPANEL_H
+#define NETWORKWATERFALLPANEL_H
+
+#include "networkrecorder.h"
+#include <QWidget>
+
+class QAction;
+class QLabel;
+class QTreeWidget;
+class WaterfallDelegate;
+
+/**
+ * @brief Request list and timing waterfall for the latest page load of a tab
+ *
+ * Rows are rebuilt from a snapshot handed in by NetworkRecorder, which
+ * coalesces updates and only refreshes the panel while it is visible.
+ */
+class NetworkWaterfallPanel : public QWidget {
+  Q_OBJECT
+
+public:
+  NetworkWaterfallPanel(QAction *recordAction, QAction *exportAction, QWidget *parent = nullptr);
+
+  void showRequests(const QList<NetworkPage> &pages, const QList<NetworkRequest> &requests, quint64 dropped,
+                    bool recording);
+
+signals:
+  void clearRequested();
+
+private:
+  QLabel *summaryLabel;
+  QTreeWidget *requestList;
+  WaterfallDelegate *waterfallDelegate;
+};
+
+#endif // NETWORKWATERFALLPANEL_H
@@ -0,0 +1,136 @@
+#include "newtabmanager.h"
+#include "../bookmark/bookmarkmanager.h"
+#include "../main-window/mainwindow.h"
+#include "../profile/browserprofile.h"
+#include "../webview/webview.h"
+#include "topsitesstore.h"
+#include <QBuffer>
+#include <QPixmap>
+#include <QTimer>
+#include <QWebEngineProfile>
+#include <QWebEngineUrlRequestJob>
+#include <QWebEngineUrlScheme>
+#include <functional>
+
+const char *NewTabManager::SCHEME = "mybrowser";
+
+namespace {
+const int TOP_SITE_COUNT = 12;
+const int BOOKMARK_COUNT = 16;
+const int THUMBNAIL_DELAY_MS = 800; // Let the page paint before grabbing it
+const QSize THUMBNAIL_SIZE(320, 200);
+
+void replyWith(QWebEngineUrlRequestJob *job, const QByteArray &contentType, const QByteArray &data) {
+  QBuffer *buffer = new QBuffer(job);
+  buffer->setData(data);
+  buffer->open(QIODevice::ReadOnly);
+  job->reply(contentType, buffer);
+}
+} // namespace
+
+void NewTabManager::registerScheme() {
+  QWebEngineUrlScheme scheme(SCHEME);
+  scheme.setSyntax(QWebEngineUrlScheme::Syntax::Host);
+  scheme.setFlags(QWebEngineUrlScheme::SecureScheme | QWebEngineUrlScheme::LocalScheme |
+                  QWebEngineUrlScheme::LocalAccessAllowed);
+  QWebEngineUrlScheme::registerScheme(scheme);
+}
+
+NewTabManager::NewTabManager(MainWindow *parent)
+    : QWebEngineUrlSchemeHandler(parent), mainWindow(parent), store(new TopSitesStore(this)) {
+  // One handler per profile; later windows share the first one's pages
+  QWebEngineProfile *profile = BrowserProfile::instance()->profile();
+  if (!profile->urlSchemeHandler(SCHEME)) {
+    profile->installUrlSchemeHandler(SCHEME, this);
+  }
+}
+
+NewTabManager::~NewTabManager() {
+}
+
+void NewTabManager::requestStarted(QWebEngineUrlRequestJob *job) {
+  const QUrl url = job->requestUrl();
+
+  if (url.host() == "newtab") {
+    TopSitesStore *sites = store;
+    const QByteArray html = page.render(store->topSites(TOP_SITE_COUNT), collectBookmarks(BOOKMARK_COUNT),
+                                        [sites](const QString &siteUrl) { return sites->hasThumbnail(siteUrl); });
+    replyWith(job, "text/html;charset=utf-8", html);
+    return;
+  }
+
+  if (url.host() == "thumbnail") {
+    const QByteArray jpeg = store->thumbnail(url.path().mid(1));
+    if (!jpeg.isEmpty()) {
+      replyWith(job, "image/jpeg", jpeg);
+      return;
+    }
+  }
+
+  job->fail(QWebEngineUrlRequestJob::UrlNotFound);
+}
+
+void NewTabManager::attach(WebView *view) {
+  if (!view)
+    return;
+
+  connect(view, &WebView::loadFinished, this, [this, view](bool ok) {
+    if (!ok)
+      return;
+    store->recordVisit(view->url(), view->title());
+
+    const QUrl loadedUrl = view->url();
+    QTimer::singleShot(THUMBNAIL_DELAY_MS, view, [this, view, loadedUrl]() {
+      if (view->url() == loadedUrl) {
+        captureThumbnail(view);
+      }
+    });
+  });
+}
+
+void NewTabManager::captureThumbnail(WebView *view) {
+  // Background tabs are not painted, so only the visible tab can be grabbed
+  if (view != mainWindow->currentWebView() || !view->isVisible())
+    return;
+
+  const QUrl url = view->url();
+  if (url.scheme() != "http" && url.scheme() != "https")
+    return;
+
+  const QPixmap pixmap = view->grab();
+  if (pixmap.isNull())
+    return;
+
+  // Keep the top of the page at the thumbnail's aspect ratio
+  const QPixmap scaled = pixmap.scaledToWidth(THUMBNAIL_SIZE.width(), Qt::SmoothTransformation)
+                             .copy(QRect(QPoint(0, 0), THUMBNAIL_SIZE));
+
+  QByteArray jpeg;
+  QBuffer buffer(&jpeg);
+  buffer.open(QIODevice::WriteOnly);
+  if (scaled.save(&buffer, "JPG", 70)) {
+    store->setThumbnail(url.adjusted(QUrl::RemoveFragment).toString(), jpeg);
+  }
+}
+
+QList<QPair<QString, QUrl>> NewTabManager::collectBookmarks(int limit) const {
+  QList<QPair<QString, QUrl>> result;
+  BookmarkManager *bookmarkManager = mainWindow->getBookmarkManager();
+  if (!bookmarkManager || !bookmarkManager->getRootItem())
+    return result;
+
+  // Depth-first, in the order shown in the bookmark panel
+  std::function<void(const BookmarkItem *)> visit = [&](const BookmarkItem *item) {
+    for (const BookmarkItem *child : item->children) {
+      if (result.size() >= limit)
+        return;
+      if (child->isFolder) {
+        visit(child);
+      } else {
+        result.append({child->title, QUrl(child->url)});
+      }
+    }
+  };
+  visit(bookmarkManager->getRootItem());
+  return result;
+}
@@ -0,0 +1,48 @@
+#ifndef NEWTABMANAGER_H
+#define NEWTABMANAGER_H
+
+#include "newtabpage.h"
+#include <QUrl>
+#include <QWebEngineUrlSchemeHandler>
+
+class MainWindow;
+class WebView;
+class TopSitesStore;
+
+/**
+ * @brief Serves the local mybrowser:// pages
+ *
+ * mybrowser://newtab             top sites (by frecency) and bookmarks
+ * mybrowser://thumbnail/<key>    cached top site thumbnails (JPEG)
+ *
+ * The scheme must be registered with registerScheme() before the
+ * QApplication is created.
+ */
+class NewTabManager : public QWebEngineUrlSchemeHandler {
+  Q_OBJECT
+
+public:
+  static const char *SCHEME;
+  static QUrl newTabUrl() { return QUrl("mybrowser://newtab"); }
+  static void registerScheme();
+
+  explicit NewTabManager(MainWindow *parent = nullptr);
+  ~NewTabManager();
+
+  void requestStarted(QWebEngineUrlRequestJob *job) override;
+
+  // Records visits and captures thumbnails for every new tab
+  void attach(WebView *view);
+
+  TopSitesStore *getStore() const { return store; }
+
+private:
+  void captureThumbnail(WebView *view);
+  QList<QPair<QString, QUrl>> collectBookmarks(int limit) const;
+
+  MainWindow *mainWindow;
+  TopSitesStore *store;
+  NewTabPage page;
+};
+
+#endif // NEWTABMANAGER_H
@@ -0,0 +1,79 @@
+#include "newtabpage.h"
+#include "../logging/logcategories.h"
+#include "topsitesstore.h"
+#include <QFile>
+
+namespace {
+QByteArray readResource(const QString &path) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    qCWarning(lcNewTab) << "Failed to load" << path;
+    return QByteArray();
+  }
+  return file.readAll();
+}
+
+QByteArray escape(const QString &text) {
+  return text.toHtmlEscaped().toUtf8();
+}
+
+QByteArray siteMarkup(const TopSite &site, bool withThumbnail) {
+  const QUrl url(site.url);
+  const QString title = site.title.isEmpty() ? url.host() : site.title;
+
+  QByteArray html = "<a class=\"site\" href=\"" + escape(site.url) + "\" title=\"" + escape(title) + "\">";
+  if (withThumbnail) {
+    html += "<div class=\"thumb\" style=\"background-image:url('mybrowser://thumbnail/" +
+            TopSitesStore::thumbnailKey(site.url).toLatin1() + "')\"></div>";
+  } else {
+    // Letter tile instead of a network favicon
+    const QString host = url.host().startsWith("www.") ? url.host().mid(4) : url.host();
+    html += "<div class=\"thumb\">" + escape(host.left(1).toUpper()) + "</div>";
+  }
+  html += "<div class=\"title\">" + escape(title) + "</div></a>";
+  return html;
+}
+} // namespace
+
+NewTabPage::NewTabPage() {
+  QByteArray page = readResource(":/src/features/new-tab/newtab.html");
+  page.replace("{{STYLE}}", readResource(":/src/features/new-tab/newtab.css"));
+
+  const int topSitesAt = page.indexOf("{{TOP_SITES}}");
+  const int bookmarksAt = page.indexOf("{{BOOKMARKS}}");
+  if (topSitesAt < 0 || bookmarksAt < topSitesAt) {
+    qCWarning(lcNewTab) << "NewTabPage: template placeholders missing";
+    head = page;
+    return;
+  }
+
+  head = page.left(topSitesAt);
+  middle = page.mid(topSitesAt + 13, bookmarksAt - topSitesAt - 13);
+  tail = page.mid(bookmarksAt + 13);
+}
+
+QByteArray NewTabPage::render(const QList<TopSite> &topSites, const QList<QPair<QString, QUrl>> &bookmarks,
+                              const std::function<bool(const QString &)> &hasThumbnail) const {
+  QByteArray html;
+  html.reserve(head.size() + middle.size() + tail.size() + 256 * (topSites.size() + bookmarks.size()));
+
+  html += head;
+  for (const TopSite &site : topSites) {
+    html += siteMarkup(site, hasThumbnail(site.url));
+  }
+  if (topSites.isEmpty()) {
+    html += "<p class=\"empty\">Sites you visit often will appear here.</p>";
+  }
+
+  html += middle;
+  for (const auto &bookmark : bookmarks) {
+    const QString title = bookmark.first.isEmpty() ? bookmark.second.host() : bookmark.first;
+    html += "<li><a href=\"" + escape(bookmark.second.toString()) + "\">" + escape(title) + "</a></li>";
+  }
+  if (bookmarks.isEmpty()) {
+    html += "<li class=\"empty\">No bookmarks yet.</li>";
+  }
+
+  html += tail;
+  return html;
+}
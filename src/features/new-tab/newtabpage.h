@@ -0,0 +1,34 @@
+#ifndef NEWTABPAGE_H
+#define NEWTABPAGE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QPair>
+#include <QUrl>
+#include <functional>
+
+struct TopSite;
+
+/**
+ * @brief Renders mybrowser://newtab from a template prepared once
+ *
+ * newtab.html and newtab.css are read from the resources and split around
+ * their placeholders at construction, so rendering only appends the static
+ * chunks and the escaped top site / bookmark markup. No script runs on the
+ * page and nothing is fetched from the network.
+ */
+class NewTabPage {
+public:
+  NewTabPage();
+
+  // hasThumbnail(url) decides between a cached thumbnail and a letter tile
+  QByteArray render(const QList<TopSite> &topSites, const QList<QPair<QString, QUrl>> &bookmarks,
+                    const std::function<bool(const QString &)> &hasThumbnail) const;
+
+private:
+  QByteArray head;   // up to {{TOP_SITES}}
+  QByteArray middle; // between {{TOP_SITES}} and {{BOOKMARKS}}
+  QByteArray tail;   // after {{BOOKMARKS}}
+};
+
+#endif // NEWTABPAGE_H
@@ -0,0 +1,221 @@
+#include "topsitesstore.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <algorithm>
+
+namespace {
+const int MAX_RECENT_VISITS = 10;
+const int MAX_SITES = 2000;       // Lowest ranked URLs are dropped beyond this
+const int MAX_THUMBNAILS = 24;    // Only the best ranked sites keep thumbnails
+const int SAVE_DELAY_MS = 2000;
+const qint64 DAY_MS = 24 * 60 * 60 * 1000LL;
+
+// Same buckets as Firefox's frecency
+double recencyWeight(qint64 age) {
+  if (age < 4 * DAY_MS)
+    return 100;
+  if (age < 14 * DAY_MS)
+    return 70;
+  if (age < 31 * DAY_MS)
+    return 50;
+  if (age < 90 * DAY_MS)
+    return 30;
+  return 10;
+}
+} // namespace
+
+double TopSite::frecency(qint64 now) const {
+  if (recentVisits.isEmpty())
+    return 0;
+
+  double total = 0;
+  for (qint64 visit : recentVisits) {
+    total += recencyWeight(now - visit);
+  }
+  return visitCount * total / recentVisits.size();
+}
+
+TopSitesStore::TopSitesStore(QObject *parent)
+    : QObject(parent) {
+  QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+  QDir dir(appDataPath);
+  if (!dir.exists()) {
+    dir.mkpath(appDataPath);
+  }
+  storePath = appDataPath + "/topsites.json";
+  thumbnailDir = appDataPath + "/thumbnails";
+  dir.mkpath(thumbnailDir);
+
+  saveTimer.setSingleShot(true);
+  saveTimer.setInterval(SAVE_DELAY_MS);
+  connect(&saveTimer, &QTimer::timeout, this, &TopSitesStore::save);
+
+  load();
+}
+
+TopSitesStore::~TopSitesStore() {
+  if (saveTimer.isActive()) {
+    save();
+  }
+}
+
+void TopSitesStore::recordVisit(const QUrl &url, const QString &title) {
+  if (url.scheme() != "http" && url.scheme() != "https")
+    return;
+
+  const QString key = url.adjusted(QUrl::RemoveFragment).toString();
+  TopSite &site = sites[key];
+  site.url = key;
+  if (!title.isEmpty()) {
+    site.title = title;
+  }
+  ++site.visitCount;
+  site.recentVisits.prepend(QDateTime::currentMSecsSinceEpoch());
+  while (site.recentVisits.size() > MAX_RECENT_VISITS) {
+    site.recentVisits.removeLast();
+  }
+  scheduleSave();
+}
+
+QList<TopSite> TopSitesStore::topSites(int count) const {
+  const qint64 now = QDateTime::currentMSecsSinceEpoch();
+  QList<QPair<double, const TopSite *>> ranked;
+  ranked.reserve(sites.size());
+  for (const TopSite &site : sites) {
+    ranked.append({site.frecency(now), &site});
+  }
+
+  count = qMin(count, int(ranked.size()));
+  std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(),
+                    [](const auto &a, const auto &b) { return a.first > b.first; });
+
+  QList<TopSite> result;
+  result.reserve(count);
+  for (int i = 0; i < count; ++i) {
+    result.append(*ranked.at(i).second);
+  }
+  return result;
+}
+
+QString TopSitesStore::thumbnailKey(const QString &url) {
+  return QString::fromLatin1(QCryptographicHash::hash(url.toUtf8(), QCryptographicHash::Sha1).toHex().left(16));
+}
+
+QString TopSitesStore::thumbnailPath(const QString &key) const {
+  return thumbnailDir + "/" + key + ".jpg";
+}
+
+void TopSitesStore::setThumbnail(const QString &url, const QByteArray &jpeg) {
+  const QString key = thumbnailKey(url);
+  QFile file(thumbnailPath(key));
+  if (file.open(QIODevice::WriteOnly)) {
+    file.write(jpeg);
+    thumbnails.insert(key, jpeg);
+    thumbnailKeys.insert(key);
+  }
+}
+
+bool TopSitesStore::hasThumbnail(const QString &url) const {
+  return thumbnailKeys.contains(thumbnailKey(url));
+}
+
+QByteArray TopSitesStore::thumbnail(const QString &key) {
+  auto it = thumbnails.constFind(key);
+  if (it != thumbnails.constEnd())
+    return *it;
+  if (!thumbnailKeys.contains(key))
+    return QByteArray();
+
+  QFile file(thumbnailPath(key));
+  if (!file.open(QIODevice::ReadOnly))
+    return QByteArray();
+  const QByteArray jpeg = file.readAll();
+  thumbnails.insert(key, jpeg);
+  return jpeg;
+}
+
+void TopSitesStore::scheduleSave() {
+  if (!saveTimer.isActive()) {
+    saveTimer.start();
+  }
+}
+
+void TopSitesStore::prune() {
+  if (sites.size() > MAX_SITES) {
+    QSet<QString> keep;
+    for (const TopSite &site : topSites(MAX_SITES)) {
+      keep.insert(site.url);
+    }
+    for (auto it = sites.begin(); it != sites.end();) {
+      it = keep.contains(it.key()) ? std::next(it) : sites.erase(it);
+    }
+  }
+
+  // Drop thumbnails of sites that fell out of the top
+  QSet<QString> keepThumbnails;
+  for (const TopSite &site : topSites(MAX_THUMBNAILS)) {
+    keepThumbnails.insert(thumbnailKey(site.url));
+  }
+  for (auto it = thumbnailKeys.begin(); it != thumbnailKeys.end();) {
+    if (keepThumbnails.contains(*it)) {
+      ++it;
+      continue;
+    }
+    QFile::remove(thumbnailPath(*it));
+    thumbnails.remove(*it);
+    it = thumbnailKeys.erase(it);
+  }
+}
+
+void TopSitesStore::save() {
+  saveTimer.stop();
+  prune();
+
+  QJsonArray array;
+  for (const TopSite &site : sites) {
+    QJsonObject obj;
+    obj["url"] = site.url;
+    obj["title"] = site.title;
+    obj["visitCount"] = site.visitCount;
+    QJsonArray visits;
+    for (qint64 visit : site.recentVisits) {
+      visits.append(double(visit));
+    }
+    obj["recentVisits"] = visits;
+    array.append(obj);
+  }
+
+  QFile file(storePath);
+  if (file.open(QIODevice::WriteOnly)) {
+    file.write(QJsonDocument(array).toJson(QJsonDocument::Compact));
+  }
+}
+
+void TopSitesStore::load() {
+  QFile file(storePath);
+  if (file.open(QIODevice::ReadOnly)) {
+    const QJsonArray array = QJsonDocument::fromJson(file.readAll()).array();
+    for (const QJsonValue &value : array) {
+      const QJsonObject obj = value.toObject();
+      TopSite site;
+      site.url = obj["url"].toString();
+      site.title = obj["title"].toString();
+      site.visitCount = obj["visitCount"].toInt();
+      for (const QJsonValue &visit : obj["recentVisits"].toArray()) {
+        site.recentVisits.append(qint64(visit.toDouble()));
+      }
+      if (!site.url.isEmpty()) {
+        sites.insert(site.url, site);
+      }
+    }
+  }
+
+  for (const QString &name : QDir(thumbnailDir).entryList({"*.jpg"}, QDir::Files)) {
+    thumbnailKeys.insert(name.chopped(4));
+  }
+}
@@ -0,0 +1,64 @@
+#ifndef TOPSITESSTORE_H
+#define TOPSITESSTORE_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+#include <QUrl>
+
+/**
+ * @brief One visited URL with the data needed for frecency
+ */
+struct TopSite {
+  QString url;
+  QString title;
+  int visitCount = 0;
+  QList<qint64> recentVisits; // msecs since epoch, newest first, at most 10
+
+  // Visit count weighted by how recent the sampled visits are
+  double frecency(qint64 now) const;
+};
+
+/**
+ * @brief Visit history for the new tab page, ranked by frecency
+ *
+ * Persisted in <AppData>/topsites.json together with a thumbnail cache in
+ * <AppData>/thumbnails. Only the best ranked sites keep their thumbnails.
+ */
+class TopSitesStore : public QObject {
+  Q_OBJECT
+
+public:
+  explicit TopSitesStore(QObject *parent = nullptr);
+  ~TopSitesStore();
+
+  void recordVisit(const QUrl &url, const QString &title);
+  QList<TopSite> topSites(int count) const;
+
+  // Thumbnails are keyed by a hash of the URL
+  static QString thumbnailKey(const QString &url);
+  void setThumbnail(const QString &url, const QByteArray &jpeg);
+  bool hasThumbnail(const QString &url) const;
+  QByteArray thumbnail(const QString &key);
+
+  void save();
+
+private:
+  void load();
+  void scheduleSave();
+  void prune();
+  QString thumbnailPath(const QString &key) const;
+
+  QHash<QString, TopSite> sites;
+  QHash<QString, QByteArray> thumbnails; // key -> JPEG, filled lazily from disk
+  QSet<QString> thumbnailKeys;           // keys with a file on disk
+  QString storePath;
+  QString thumbnailDir;
+  QTimer saveTimer;
+};
+
+#endif // TOPSITESSTORE_H
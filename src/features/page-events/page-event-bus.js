@@ -0,0 +1,96 @@
+// Page event bus client
+// Injected into every tab by PageEventBus. Each tab has its own web channel,
+// so the host knows the tab without the page telling it. Scripts call
+//   window.__mybrowserEvents.emit(type, payload)
+// and the events reach the host in batches: one QWebChannel message per
+// flush instead of one per event.
+
+(function () {
+  if (window.__mybrowserEvents) {
+    return;
+  }
+
+  const MAX_BATCH = 64; // これ以上溜まったら待たずに送信
+  const IDLE_TIMEOUT = 1000; // アイドルにならなくても1秒以内に送信
+
+  let queue = [];
+  let bus = null;
+  let connecting = false;
+  let scheduled = 0;
+
+  function connectChannel() {
+    if (connecting) {
+      return;
+    }
+    if (typeof qt === "undefined" || !qt.webChannelTransport || typeof QWebChannel === "undefined") {
+      return;
+    }
+    connecting = true;
+    new QWebChannel(qt.webChannelTransport, function (channel) {
+      bus = channel.objects.pageEvents;
+      flush();
+    });
+  }
+
+  function cancelScheduled() {
+    if (!scheduled) {
+      return;
+    }
+    if (window.cancelIdleCallback) {
+      cancelIdleCallback(scheduled);
+    } else {
+      clearTimeout(scheduled);
+    }
+    scheduled = 0;
+  }
+
+  function schedule() {
+    if (scheduled) {
+      return;
+    }
+    if (window.requestIdleCallback) {
+      scheduled = requestIdleCallback(flush, { timeout: IDLE_TIMEOUT });
+    } else {
+      scheduled = setTimeout(flush, IDLE_TIMEOUT);
+    }
+  }
+
+  function flush() {
+    cancelScheduled();
+    if (queue.length === 0) {
+      return;
+    }
+    if (!bus) {
+      connectChannel(); // 接続後に flush される
+      return;
+    }
+
+    const events = queue;
+    queue = [];
+    const started = performance.now();
+    const body = JSON.stringify(events);
+    const serializeMicros = Math.round((performance.now() - started) * 1000);
+    bus.deliver("[" + serializeMicros + "," + body + "]");
+  }
+
+  function emit(type, payload) {
+    queue.push([type, Math.round(performance.now()), payload === undefined ? null : payload]);
+    if (queue.length >= MAX_BATCH) {
+      flush();
+    } else {
+      schedule();
+    }
+  }
+
+  // ページを離れる・隠れる前に残りを送る
+  window.addEventListener("pagehide", flush);
+  document.addEventListener("visibilitychange", function () {
+    if (document.visibilityState === "hidden") {
+      flush();
+    }
+  });
+
+  Object.defineProperty(window, "__mybrowserEvents", {
+    value: Object.freeze({ emit: emit, flush: flush }),
+  });
+})();
@@ -0,0 +1,161 @@
+#include "pageeventbus.h"
+#include "../logging/logcategories.h"
+#include "../webview/webview.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QWebChannel>
+#include <QWebEngineScript>
+#include <QWebEngineScriptCollection>
+
+namespace {
+const char *CLIENT_SCRIPT_NAME = "mybrowser-page-events";
+const qint64 RATE_WINDOW_MS = 1000;
+
+QString readResource(const QString &path) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    qCWarning(lcPageEvents) << "Failed to load" << path;
+    return QString();
+  }
+  return QString::fromUtf8(file.readAll());
+}
+} // namespace
+
+PageEventBus::PageEventBus(QObject *parent) : QObject(parent) {
+  rateWindow.start();
+}
+
+void PageEventBus::attach(WebView *view) {
+  if (!view)
+    return;
+
+  QWebChannel *channel = view->page()->webChannel();
+  if (!channel) {
+    qCWarning(lcPageEvents) << "PageEventBus: tab" << view->tabId() << "has no web channel";
+    return;
+  }
+  channel->registerObject("pageEvents", new PageEventEndpoint(this, view->tabId(), channel));
+
+  // The client only opens the QWebChannel when the page emits its first event
+  QWebEngineScript script;
+  script.setName(CLIENT_SCRIPT_NAME);
+  script.setSourceCode(clientSource());
+  script.setInjectionPoint(QWebEngineScript::DocumentCreation);
+  script.setWorldId(QWebEngineScript::MainWorld);
+  script.setRunsOnSubFrames(false);
+  view->page()->scripts().insert(script);
+}
+
+void PageEventBus::subscribe(const QString &type, QObject *context, Handler handler, int tabId) {
+  if (!context || !handler)
+    return;
+
+  subscribers[type].append({context, tabId, std::move(handler)});
+}
+
+void PageEventBus::unsubscribe(QObject *context) {
+  for (auto it = subscribers.begin(); it != subscribers.end(); ++it) {
+    it->removeIf([context](const Subscriber &subscriber) {
+      return !subscriber.context || subscriber.context == context;
+    });
+  }
+}
+
+QString PageEventBus::clientSource() {
+  static const QString source = readResource(":/qtwebchannel/qwebchannel.js") + "\n" +
+                                readResource(":/src/features/page-events/page-event-bus.js");
+  return source;
+}
+
+void PageEventBus::deliver(int tabId, const QString &batch) {
+  QElapsedTimer timer;
+  timer.start();
+
+  const QByteArray data = batch.toUtf8();
+  QJsonParseError error;
+  const QJsonDocument document = QJsonDocument::fromJson(data, &error);
+  const QJsonArray envelope = document.array();
+  if (error.error != QJsonParseError::NoError || envelope.size() != 2) {
+    qCDebug(lcPageEvents) << "PageEventBus: dropped malformed batch:" << error.errorString();
+    return;
+  }
+
+  const QJsonArray events = envelope.at(1).toArray();
+  counters.parseNanos += timer.nsecsElapsed();
+  counters.pageSerializeMicros += envelope.at(0).toInteger();
+
+  timer.restart();
+  PageEvent event;
+  event.tabId = tabId;
+  for (const QJsonValue &value : events) {
+    const QJsonArray entry = value.toArray();
+    event.type = entry.at(0).toString();
+    event.timestamp = entry.at(1).toInteger();
+    event.payload = entry.at(2);
+    dispatch(event);
+  }
+  counters.dispatchNanos += timer.nsecsElapsed();
+
+  counters.batches++;
+  counters.events += events.size();
+  counters.bytes += data.size();
+  windowBatches++;
+  windowEvents += events.size();
+  windowBytes += data.size();
+  updateRates();
+}
+
+void PageEventBus::dispatch(const PageEvent &event) {
+  auto it = subscribers.find(event.type);
+  if (it == subscribers.end())
+    return;
+
+  // Copy: a handler may subscribe or unsubscribe while we iterate
+  const QList<Subscriber> targets = *it;
+  bool stale = false;
+  for (const Subscriber &subscriber : targets) {
+    if (!subscriber.context) {
+      stale = true;
+      continue;
+    }
+    if (subscriber.tabId == ANY_TAB || subscriber.tabId == event.tabId) {
+      subscriber.handler(event);
+    }
+  }
+
+  if (stale) {
+    subscribers[event.type].removeIf([](const Subscriber &subscriber) { return !subscriber.context; });
+  }
+}
+
+void PageEventBus::updateRates() {
+  const qint64 elapsed = rateWindow.elapsed();
+  if (elapsed < RATE_WINDOW_MS)
+    return;
+
+  const double seconds = elapsed / 1000.0;
+  counters.batchesPerSecond = windowBatches / seconds;
+  counters.eventsPerSecond = windowEvents / seconds;
+  counters.bytesPerSecond = windowBytes / seconds;
+  windowBatches = 0;
+  windowEvents = 0;
+  windowBytes = 0;
+  rateWindow.restart();
+
+  qCDebug(lcPageEvents) << "PageEventBus:" << counters.batchesPerSecond << "batches/s," << counters.eventsPerSecond
+                        << "events/s," << counters.bytesPerSecond << "bytes/s; parse" << counters.parseNanos / 1000
+                        << "us, dispatch" << counters.dispatchNanos / 1000 << "us, page serialize"
+                        << counters.pageSerializeMicros << "us total";
+  emit statsUpdated();
+}
+
+PageEventEndpoint::PageEventEndpoint(PageEventBus *bus, int tabId, QObject *parent)
+    : QObject(parent), bus(bus), tabId(tabId) {}
+
+void PageEventEndpoint::deliver(const QString &batch) {
+  if (bus) {
+    bus->deliver(tabId, batch);
+  }
+}
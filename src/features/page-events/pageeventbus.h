@@ -0,0 +1,135 @@
+#ifndef PAGEEVENTBUS_H
+#define PAGEEVENTBUS_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <functional>
+
+class PageEventBus;
+class WebView;
+
+/**
+ * @brief One event emitted by a page script
+ */
+struct PageEvent {
+  int tabId = -1;
+  QString type;
+  qint64 timestamp = 0; // Page clock (performance.now() based), milliseconds
+  QJsonValue payload;
+};
+
+/**
+ * @brief Throughput and serialization cost of the page event bus
+ *
+ * Totals cover the whole session; the rates are measured over the most recent
+ * one-second window that carried traffic.
+ */
+struct PageEventStats {
+  quint64 batches = 0;
+  quint64 events = 0;
+  quint64 bytes = 0;
+  qint64 parseNanos = 0;          // Host side JSON parsing
+  qint64 dispatchNanos = 0;       // Host side subscriber calls
+  qint64 pageSerializeMicros = 0; // JSON.stringify in the pages, as reported with each batch
+  double batchesPerSecond = 0;
+  double eventsPerSecond = 0;
+  double bytesPerSecond = 0;
+};
+
+/**
+ * @brief Batched page-to-host event channel
+ *
+ * Page scripts call window.__mybrowserEvents.emit(type, payload). The client
+ * (page-event-bus.js) buffers events and sends them as one compact JSON string
+ * when the page is idle, when the buffer is full or when the page is hidden,
+ * so a busy script costs one QWebChannel message per batch instead of one per
+ * event. deliver() parses the batch once and hands each event to the
+ * subscribers of its type, optionally filtered by tab.
+ *
+ * Every tab has its own QWebChannel with its own PageEventEndpoint, so the
+ * tab of a batch is the channel it arrived on; a page cannot speak for
+ * another tab.
+ */
+class PageEventBus : public QObject {
+  Q_OBJECT
+
+public:
+  using Handler = std::function<void(const PageEvent &event)>;
+  static const int ANY_TAB = -1;
+
+  explicit PageEventBus(QObject *parent = nullptr);
+
+  // Injects the client into every document of the tab and registers the tab's
+  // endpoint on its web channel; call after setWebChannel() and before the first load
+  void attach(WebView *view);
+
+  // The handler runs until context is destroyed
+  void subscribe(const QString &type, QObject *context, Handler handler, int tabId = ANY_TAB);
+
+  // Typed variant: the payload is converted with T::fromJson(const QJsonObject &)
+  template <typename T>
+  void subscribe(const QString &type, QObject *context, std::function<void(int tabId, const T &value)> handler,
+                 int tabId = ANY_TAB) {
+    subscribe(type, context, [handler](const PageEvent &event) {
+      handler(event.tabId, T::fromJson(event.payload.toObject()));
+    }, tabId);
+  }
+
+  // Drops every subscription owned by context
+  void unsubscribe(QObject *context);
+
+  PageEventStats stats() const { return counters; }
+
+  // qwebchannel.js + page-event-bus.js
+  static QString clientSource();
+
+  // A batch from tabId's endpoint: [serializeMicros, [[type, timestamp, payload], ...]]
+  void deliver(int tabId, const QString &batch);
+
+signals:
+  void statsUpdated();
+
+private:
+  struct Subscriber {
+    QPointer<QObject> context;
+    int tabId;
+    Handler handler;
+  };
+
+  void dispatch(const PageEvent &event);
+  void updateRates();
+
+  QHash<QString, QList<Subscriber>> subscribers;
+  PageEventStats counters;
+
+  // Rolling one-second window for the rates
+  QElapsedTimer rateWindow;
+  quint64 windowBatches = 0;
+  quint64 windowEvents = 0;
+  quint64 windowBytes = 0;
+};
+
+/**
+ * @brief The page event bus as seen by one tab's web channel
+ */
+class PageEventEndpoint : public QObject {
+  Q_OBJECT
+
+public:
+  PageEventEndpoint(PageEventBus *bus, int tabId, QObject *parent = nullptr);
+
+  // Called from the page client
+  Q_INVOKABLE void deliver(const QString &batch);
+
+private:
+  QPointer<PageEventBus> bus;
+  int tabId;
+};
+
+#endif // PAGEEVENTBUS_H
@@ -0,0 +1,159 @@
+#include "pagescriptrunner.h"
+#include "../logging/logcategories.h"
+#include "../webview/webview.h"
+#include "pageeventbus.h"
+#include <QJsonObject>
+#include <QPointer>
+#include <QRandomGenerator>
+#include <QTimer>
+#include <QWebEngineScript>
+
+namespace {
+const char *SETTLED_EVENT = "script.settled";
+
+// Runs the expression; a Promise is reported through the event bus when it settles
+const char *WRAPPER_HEAD = R"(
+(function () {
+  const id = "%1";
+  let value;
+  try {
+    value = (
+)";
+
+const char *WRAPPER_TAIL = R"(
+    );
+  } catch (error) {
+    return { error: String(error) };
+  }
+  if (!value || typeof value.then !== "function") {
+    return { value: value };
+  }
+  const events = window.__mybrowserEvents;
+  if (!events) {
+    return { error: "Page event bus not available" };
+  }
+  value.then(
+    function (result) {
+      events.emit("script.settled", { id: id, value: result === undefined ? null : result });
+      events.flush();
+    },
+    function (error) {
+      events.emit("script.settled", { id: id, error: String(error) });
+      events.flush();
+    }
+  );
+  return { pending: true };
+})()
+)";
+} // namespace
+
+PageScriptRunner::PageScriptRunner(PageEventBus *bus, QObject *parent) : QObject(parent) {
+  bus->subscribe(SETTLED_EVENT, this, [this](const PageEvent &event) {
+    const QJsonObject payload = event.payload.toObject();
+    const QString id = payload["id"].toString();
+    auto it = pending.constFind(id);
+    // Only the tab the script ran in can settle it
+    if (it == pending.constEnd() || it->tabId != event.tabId)
+      return;
+
+    PageScriptResult result;
+    if (payload.contains("error")) {
+      result.status = PageScriptResult::Failed;
+      result.error = payload["error"].toString();
+    } else {
+      result.value = payload["value"].toVariant();
+    }
+    finish(id, result);
+  });
+}
+
+PageScriptRunner::~PageScriptRunner() {
+  PageScriptResult cancelled;
+  cancelled.status = PageScriptResult::Cancelled;
+  for (const QString &id : pending.keys()) {
+    finish(id, cancelled);
+  }
+}
+
+QFuture<PageScriptResult> PageScriptRunner::run(WebView *view, const QString &source, int timeoutMs) {
+  auto promise = std::make_shared<QPromise<PageScriptResult>>();
+  QFuture<PageScriptResult> future = promise->future();
+  promise->start();
+
+  if (!view) {
+    PageScriptResult cancelled;
+    cancelled.status = PageScriptResult::Cancelled;
+    promise->addResult(cancelled);
+    promise->finish();
+    return future;
+  }
+
+  // Unguessable: a page that fakes a script.settled event cannot name this run
+  const QString id = QString::number(QRandomGenerator::system()->generate64(), 16) +
+                     QString::number(QRandomGenerator::system()->generate64(), 16);
+  Pending &entry = pending[id];
+  entry.promise = promise;
+  entry.tabId = view->tabId();
+  entry.timer = new QTimer(this);
+  entry.timer->setSingleShot(true);
+  connect(entry.timer, &QTimer::timeout, this, [this, id]() {
+    PageScriptResult timedOut;
+    timedOut.status = PageScriptResult::TimedOut;
+    finish(id, timedOut);
+  });
+  entry.timer->start(timeoutMs);
+  entry.viewDestroyed = connect(view, &QObject::destroyed, this, [this, id]() {
+    PageScriptResult cancelled;
+    cancelled.status = PageScriptResult::Cancelled;
+    finish(id, cancelled);
+  });
+
+  QPointer<PageScriptRunner> self(this);
+  view->page()->runJavaScript(wrap(id, source), QWebEngineScript::MainWorld, [self, id](const QVariant &value) {
+    if (!self)
+      return;
+    const QVariantMap map = value.toMap();
+    if (map.value("pending").toBool())
+      return; // Settles through the event bus
+
+    PageScriptResult result;
+    if (!value.isValid()) {
+      // The wrapper always returns an object: the page or its renderer went away
+      result.status = PageScriptResult::Cancelled;
+    } else if (map.contains("error")) {
+      result.status = PageScriptResult::Failed;
+      result.error = map.value("error").toString();
+    } else {
+      result.value = map.value("value");
+    }
+    self->finish(id, result);
+  });
+  return future;
+}
+
+QString PageScriptRunner::wrap(const QString &nonce, const QString &source) {
+  QString expression = source.trimmed();
+  while (expression.endsWith(';')) {
+    expression.chop(1);
+  }
+  // Concatenated rather than arg()'d: the source may contain % signs
+  return QString::fromLatin1(WRAPPER_HEAD).arg(nonce) + expression + QString::fromLatin1(WRAPPER_TAIL);
+}
+
+void PageScriptRunner::finish(const QString &id, const PageScriptResult &result) {
+  auto it = pending.find(id);
+  if (it == pending.end())
+    return; // Already finished: a late reply after a timeout or a closed tab
+
+  const Pending entry = *it;
+  pending.erase(it);
+  entry.timer->deleteLater();
+  disconnect(entry.viewDestroyed);
+
+  if (result.status != PageScriptResult::Ok) {
+    qCDebug(lcPageEvents) << "PageScriptRunner: script" << id << "in tab" << entry.tabId << "ended with status"
+                          << result.status << result.error;
+  }
+  entry.promise->addResult(result);
+  entry.promise->finish();
+}
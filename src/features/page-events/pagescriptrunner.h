@@ -0,0 +1,69 @@
+#ifndef PAGESCRIPTRUNNER_H
+#define PAGESCRIPTRUNNER_H
+
+#include <QFuture>
+#include <QHash>
+#include <QMetaObject>
+#include <QObject>
+#include <QPromise>
+#include <QString>
+#include <QVariant>
+#include <memory>
+
+class PageEventBus;
+class WebView;
+class QTimer;
+
+/**
+ * @brief Outcome of one PageScriptRunner::run()
+ */
+struct PageScriptResult {
+  enum Status { Ok, Failed, TimedOut, Cancelled };
+
+  Status status = Ok;
+  QVariant value;
+  QString error; // Exception text when Failed
+
+  bool ok() const { return status == Ok; }
+};
+
+/**
+ * @brief Awaitable runJavaScript with a timeout
+ *
+ * run() returns a future that finishes with the value of a script expression;
+ * continue with future.then(context, ...). When the expression yields a
+ * Promise, the future finishes when it settles: the page reports the value as
+ * a "script.settled" event and flushes the page event bus at once, so the
+ * host goes on as soon as the page is ready rather than after a fixed sleep.
+ * The future finishes with TimedOut after timeoutMs, and with Cancelled when
+ * the tab closes first. Scripts run in the main world, where the bus client is.
+ * Each run is known to the page only by a random nonce, so a page cannot
+ * settle a script it did not get to see.
+ */
+class PageScriptRunner : public QObject {
+  Q_OBJECT
+
+public:
+  static const int DEFAULT_TIMEOUT_MS = 5000;
+
+  explicit PageScriptRunner(PageEventBus *bus, QObject *parent = nullptr);
+  ~PageScriptRunner();
+
+  // source is one expression, e.g. "(function() { ... })()"; a trailing semicolon is fine
+  QFuture<PageScriptResult> run(WebView *view, const QString &source, int timeoutMs = DEFAULT_TIMEOUT_MS);
+
+private:
+  struct Pending {
+    std::shared_ptr<QPromise<PageScriptResult>> promise;
+    int tabId = -1;
+    QTimer *timer = nullptr;
+    QMetaObject::Connection viewDestroyed;
+  };
+
+  static QString wrap(const QString &nonce, const QString &source);
+  void finish(const QString &nonce, const PageScriptResult &result);
+
+  QHash<QString, Pending> pending; // Nonce -> run
+};
+
+#endif // PAGESCRIPTRUNNER_H
@@ -0,0 +1,714 @@
+#include "pageindex.h"
+#include "../logging/logcategories.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+const quint32 SEGMENT_MAGIC = 0x4d424654; // "MBFT"
+const quint16 SEGMENT_VERSION = 1;
+const qint64 TRAILER_SIZE = 12;           // qint64 meta offset + magic
+const int FLUSH_DOCUMENTS = 16;
+const int FLUSH_DELAY_MS = 30000;
+const int MAX_SEGMENTS = 8;
+const qint64 REINDEX_INTERVAL_MS = 24 * 60 * 60 * 1000LL; // Unchanged pages at most once a day
+const int MAX_TOKEN_LENGTH = 40;
+const int PREFIX_EXPANSIONS = 32;
+const int SNIPPET_CHARS = 160;
+const int SNIPPET_LEAD_CHARS = 60;
+const double BM25_K1 = 1.2;
+const double BM25_B = 0.75;
+const double DAY_MS = 24.0 * 60 * 60 * 1000;
+
+void appendVarint(QByteArray &out, quint32 value) {
+  while (value >= 0x80) {
+    out.append(char((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.append(char(value));
+}
+
+bool readVarint(const char *&data, const char *end, quint32 &value) {
+  value = 0;
+  for (int shift = 0; data < end && shift < 35; shift += 7) {
+    const quint8 byte = quint8(*data++);
+    value |= quint32(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+// Stable across runs, unlike qHash
+quint32 fnv1a(const QString &text) {
+  quint32 hash = 2166136261u;
+  for (QChar c : text) {
+    hash = (hash ^ c.unicode()) * 16777619u;
+  }
+  return hash;
+}
+
+bool isCjk(char32_t c) {
+  return (c >= 0x3040 && c <= 0x30ff) ||  // Hiragana, Katakana
+         (c >= 0x3400 && c <= 0x4dbf) ||  // CJK extension A
+         (c >= 0x4e00 && c <= 0x9fff) ||  // CJK unified ideographs
+         (c >= 0xac00 && c <= 0xd7af) ||  // Hangul syllables
+         (c >= 0xf900 && c <= 0xfaff);    // CJK compatibility ideographs
+}
+
+QString makeSnippet(const QString &text, const QList<QByteArray> &terms) {
+  qsizetype hit = -1;
+  for (const QByteArray &term : terms) {
+    const qsizetype at = text.indexOf(QString::fromUtf8(term), 0, Qt::CaseInsensitive);
+    if (at >= 0 && (hit < 0 || at < hit))
+      hit = at;
+  }
+
+  qsizetype start = qMax<qsizetype>(0, hit - SNIPPET_LEAD_CHARS);
+  if (start > 0) {
+    // Start on a word boundary when there is one nearby
+    const qsizetype space = text.indexOf(' ', start);
+    if (space >= 0 && space < hit && space - start < 16)
+      start = space + 1;
+  }
+  QString snippet = text.mid(start, SNIPPET_CHARS);
+  if (start > 0)
+    snippet.prepend("…");
+  if (start + SNIPPET_CHARS < text.size())
+    snippet.append("…");
+  return snippet;
+}
+} // namespace
+
+PageIndex::PageIndex(const QString &directory, QObject *parent)
+    : QObject(parent), directory(directory), totalLength(0), nextId(1), nextSegment(1),
+      flushTimer(new QTimer(this)) {
+  flushTimer->setSingleShot(true);
+  flushTimer->setInterval(FLUSH_DELAY_MS);
+  connect(flushTimer, &QTimer::timeout, this, &PageIndex::flush);
+}
+
+PageIndex::~PageIndex() {
+  flush();
+}
+
+QString PageIndex::segmentPath(quint64 number) const {
+  return QString("%1/%2.seg").arg(directory).arg(number, 6, 10, QChar('0'));
+}
+
+qint64 PageIndex::diskSize() const {
+  qint64 size = 0;
+  for (const Segment &segment : segments) {
+    size += segment.size;
+  }
+  return size;
+}
+
+QList<QByteArray> PageIndex::tokenize(const QString &text) {
+  QList<QByteArray> tokens;
+  QString word;
+  QList<char32_t> cjkRun;
+
+  auto flushWord = [&]() {
+    if (word.size() >= 2 && word.size() <= MAX_TOKEN_LENGTH) {
+      tokens.append(word.toUtf8());
+    }
+    word.clear();
+  };
+  auto flushCjk = [&]() {
+    if (cjkRun.size() == 1) {
+      tokens.append(QString::fromUcs4(cjkRun.constData(), 1).toUtf8());
+    }
+    for (qsizetype i = 0; i + 1 < cjkRun.size(); ++i) {
+      tokens.append(QString::fromUcs4(cjkRun.constData() + i, 2).toUtf8());
+    }
+    cjkRun.clear();
+  };
+
+  for (char32_t c : text.toUcs4()) {
+    if (isCjk(c)) {
+      flushWord();
+      cjkRun.append(c);
+    } else if (QChar::isLetterOrNumber(c)) {
+      flushCjk();
+      const char32_t folded = QChar::toCaseFolded(c);
+      if (QChar::requiresSurrogates(folded)) {
+        word.append(QChar(QChar::highSurrogate(folded)));
+        word.append(QChar(QChar::lowSurrogate(folded)));
+      } else {
+        word.append(QChar(char16_t(folded)));
+      }
+    } else {
+      flushWord();
+      flushCjk();
+    }
+  }
+  flushWord();
+  flushCjk();
+  return tokens;
+}
+
+void PageIndex::open() {
+  QDir().mkpath(directory);
+
+  QFile manifestFile(directory + "/manifest.json");
+  QList<quint64> numbers;
+  if (manifestFile.open(QIODevice::ReadOnly)) {
+    const QJsonObject manifest = QJsonDocument::fromJson(manifestFile.readAll()).object();
+    nextId = quint32(manifest["nextId"].toInteger(1));
+    nextSegment = quint64(manifest["nextSegment"].toInteger(1));
+    for (const QJsonValue &value : manifest["segments"].toArray()) {
+      numbers.append(quint64(value.toInteger()));
+    }
+    for (const QJsonValue &value : manifest["deleted"].toArray()) {
+      deleted.insert(quint32(value.toInteger()));
+    }
+  }
+
+  QSet<QString> known;
+  for (quint64 number : numbers) {
+    Segment segment;
+    QList<Document> segmentDocuments;
+    if (!readSegment(number, &segment, &segmentDocuments)) {
+      qCWarning(lcPageSearch) << "PageIndex: skipping unreadable segment" << segmentPath(number);
+      continue;
+    }
+    known.insert(QFileInfo(segmentPath(number)).fileName());
+
+    for (const Document &document : segmentDocuments) {
+      if (deleted.contains(document.id))
+        continue;
+      // A revisit whose tombstone was not saved yet; keep the newer copy
+      const QString key = document.url.toString();
+      if (latestByUrl.contains(key)) {
+        const quint32 previous = latestByUrl.value(key);
+        if (documents.value(previous).visitedAt >= document.visitedAt) {
+          deleted.insert(document.id);
+          continue;
+        }
+        remove(previous);
+      }
+      documents.insert(document.id, document);
+      latestByUrl.insert(key, document.id);
+      totalLength += document.length;
+    }
+    segments.append(segment);
+  }
+
+  // Segments written but never recorded in the manifest (crash mid-flush)
+  for (const QString &name : QDir(directory).entryList({"*.seg"}, QDir::Files)) {
+    if (!known.contains(name)) {
+      QFile::remove(directory + "/" + name);
+    }
+  }
+
+  qCDebug(lcPageSearch) << "PageIndex: opened" << documents.size() << "pages in" << segments.size() << "segments,"
+                        << diskSize() << "bytes";
+}
+
+void PageIndex::addPage(const QUrl &url, const QString &title, const QString &text, qint64 visitedAt) {
+  const QString content = text.simplified().left(MAX_TEXT_CHARS);
+  if (content.isEmpty())
+    return;
+
+  const QUrl pageUrl = url.adjusted(QUrl::RemoveFragment);
+  const QString key = pageUrl.toString();
+  const quint32 textHash = fnv1a(content);
+
+  const auto existing = latestByUrl.constFind(key);
+  if (existing != latestByUrl.constEnd()) {
+    const Document &previous = documents[*existing];
+    if (previous.textHash == textHash && visitedAt - previous.visitedAt < REINDEX_INTERVAL_MS)
+      return;
+    remove(*existing);
+  }
+
+  Document document;
+  document.id = nextId++;
+  document.url = pageUrl;
+  document.title = title;
+  document.visitedAt = visitedAt;
+  document.textHash = textHash;
+
+  // The title is indexed with the body so title words count as matches
+  const QList<QByteArray> tokens = tokenize(title + ' ' + content);
+  document.length = quint32(tokens.size());
+
+  QHash<QByteArray, quint32> frequencies;
+  for (const QByteArray &token : tokens) {
+    ++frequencies[token];
+  }
+  for (auto it = frequencies.cbegin(); it != frequencies.cend(); ++it) {
+    pendingPostings[it.key()].append({document.id, it.value()});
+  }
+
+  pendingTexts.insert(document.id, qCompress(content.toUtf8(), 6));
+  pendingIds.append(document.id);
+  documents.insert(document.id, document);
+  latestByUrl.insert(key, document.id);
+  totalLength += document.length;
+
+  if (pendingIds.size() >= FLUSH_DOCUMENTS) {
+    flush();
+  } else {
+    scheduleFlush();
+  }
+}
+
+void PageIndex::remove(quint32 id) {
+  const auto it = documents.find(id);
+  if (it == documents.end())
+    return;
+
+  totalLength -= it->length;
+  const QString key = it->url.toString();
+  if (latestByUrl.value(key) == id) {
+    latestByUrl.remove(key);
+  }
+
+  if (it->segment) {
+    deleted.insert(id);
+  } else {
+    // Pending postings are filtered against documents at flush time
+    pendingIds.removeOne(id);
+    pendingTexts.remove(id);
+  }
+  documents.erase(it);
+}
+
+void PageIndex::scheduleFlush() {
+  if (!flushTimer->isActive()) {
+    flushTimer->start();
+  }
+}
+
+void PageIndex::flush() {
+  flushTimer->stop();
+  if (pendingIds.isEmpty())
+    return;
+
+  QMap<QByteArray, QByteArray> encoded;
+  for (auto it = pendingPostings.cbegin(); it != pendingPostings.cend(); ++it) {
+    QByteArray postings;
+    quint32 lastId = 0;
+    for (const auto &posting : it.value()) {
+      if (!documents.contains(posting.first))
+        continue;
+      appendVarint(postings, posting.first - lastId);
+      appendVarint(postings, posting.second);
+      lastId = posting.first;
+    }
+    if (!postings.isEmpty()) {
+      encoded.insert(it.key(), postings);
+    }
+  }
+
+  QList<Document> segmentDocuments;
+  for (quint32 id : pendingIds) {
+    segmentDocuments.append(documents.value(id));
+  }
+
+  Segment segment;
+  if (!writeSegment(nextSegment, segmentDocuments, pendingTexts, encoded, &segment)) {
+    // Keep the pages pending and try again later
+    qCWarning(lcPageSearch) << "PageIndex: failed to write" << segmentPath(nextSegment);
+    scheduleFlush();
+    return;
+  }
+  ++nextSegment;
+
+  for (const Document &document : segmentDocuments) {
+    documents.insert(document.id, document);
+  }
+  segments.append(segment);
+  pendingIds.clear();
+  pendingTexts.clear();
+  pendingPostings.clear();
+
+  enforceLimits();
+  maybeMerge();
+  saveManifest();
+}
+
+bool PageIndex::writeSegment(quint64 number, QList<Document> &segmentDocuments,
+                             const QHash<quint32, QByteArray> &texts, const QMap<QByteArray, QByteArray> &postings,
+                             Segment *segment) {
+  const QString path = segmentPath(number);
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+
+  QDataStream out(&file);
+  out.setVersion(QDataStream::Qt_6_0);
+  out << SEGMENT_MAGIC << SEGMENT_VERSION;
+
+  // Text blobs first; the tables at the end point back at them
+  for (Document &document : segmentDocuments) {
+    const QByteArray text = texts.value(document.id);
+    document.segment = number;
+    document.textOffset = file.pos();
+    document.textSize = quint32(text.size());
+    out.writeRawData(text.constData(), int(text.size()));
+  }
+
+  const qint64 metaOffset = file.pos();
+  out << quint32(segmentDocuments.size());
+  for (const Document &document : segmentDocuments) {
+    out << document.id << document.url.toString() << document.title << document.visitedAt << document.length
+        << document.textHash << document.textOffset << document.textSize;
+  }
+
+  QByteArray dictionary;
+  {
+    QDataStream dictionaryOut(&dictionary, QIODevice::WriteOnly);
+    dictionaryOut.setVersion(QDataStream::Qt_6_0);
+    dictionaryOut << quint32(postings.size());
+    for (auto it = postings.cbegin(); it != postings.cend(); ++it) {
+      dictionaryOut << it.key() << it.value();
+    }
+  }
+  out << qCompress(dictionary);
+  out << metaOffset << SEGMENT_MAGIC;
+
+  if (out.status() != QDataStream::Ok || !file.commit())
+    return false;
+
+  segment->number = number;
+  segment->size = QFileInfo(path).size();
+  segment->postings = postings;
+  segment->documentIds.clear();
+  for (const Document &document : segmentDocuments) {
+    segment->documentIds.append(document.id);
+  }
+  return true;
+}
+
+bool PageIndex::readSegment(quint64 number, Segment *segment, QList<Document> *segmentDocuments) const {
+  QFile file(segmentPath(number));
+  if (!file.open(QIODevice::ReadOnly) || file.size() < 6 + TRAILER_SIZE)
+    return false;
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_6_0);
+  quint32 magic = 0;
+  quint16 version = 0;
+  in >> magic >> version;
+  if (magic != SEGMENT_MAGIC || version != SEGMENT_VERSION)
+    return false;
+
+  qint64 metaOffset = 0;
+  file.seek(file.size() - TRAILER_SIZE);
+  in >> metaOffset >> magic;
+  if (magic != SEGMENT_MAGIC || metaOffset <= 0 || metaOffset >= file.size() - TRAILER_SIZE)
+    return false;
+
+  file.seek(metaOffset);
+  quint32 count = 0;
+  in >> count;
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+    Document document;
+    QString url;
+    in >> document.id >> url >> document.title >> document.visitedAt >> document.length >> document.textHash >>
+        document.textOffset >> document.textSize;
+    document.url = QUrl(url);
+    document.segment = number;
+    segmentDocuments->append(document);
+    segment->documentIds.append(document.id);
+  }
+
+  QByteArray compressed;
+  in >> compressed;
+  if (in.status() != QDataStream::Ok)
+    return false;
+
+  const QByteArray dictionary = qUncompress(compressed);
+  QDataStream dictionaryIn(dictionary);
+  dictionaryIn.setVersion(QDataStream::Qt_6_0);
+  quint32 termCount = 0;
+  dictionaryIn >> termCount;
+  for (quint32 i = 0; i < termCount && dictionaryIn.status() == QDataStream::Ok; ++i) {
+    QByteArray term;
+    QByteArray postings;
+    dictionaryIn >> term >> postings;
+    // Terms are stored sorted, so appending at the end is cheap
+    segment->postings.insert(segment->postings.cend(), term, postings);
+  }
+
+  segment->number = number;
+  segment->size = file.size();
+  return dictionaryIn.status() == QDataStream::Ok;
+}
+
+QByteArray PageIndex::readCompressedText(const Document &document) const {
+  if (!document.segment)
+    return pendingTexts.value(document.id);
+
+  QFile file(segmentPath(document.segment));
+  if (!file.open(QIODevice::ReadOnly) || !file.seek(document.textOffset))
+    return QByteArray();
+  return file.read(document.textSize);
+}
+
+template <typename Visitor>
+void PageIndex::forEachPosting(const QByteArray &term, Visitor visit) const {
+  for (const Segment &segment : segments) {
+    const auto it = segment.postings.constFind(term);
+    if (it == segment.postings.constEnd())
+      continue;
+
+    const char *data = it->constData();
+    const char *end = data + it->size();
+    quint32 id = 0;
+    quint32 delta = 0;
+    quint32 frequency = 0;
+    while (readVarint(data, end, delta) && readVarint(data, end, frequency)) {
+      id += delta;
+      if (documents.contains(id)) {
+        visit(id, frequency);
+      }
+    }
+  }
+
+  const auto pending = pendingPostings.constFind(term);
+  if (pending != pendingPostings.constEnd()) {
+    for (const auto &posting : *pending) {
+      if (documents.contains(posting.first)) {
+        visit(posting.first, posting.second);
+      }
+    }
+  }
+}
+
+QList<QByteArray> PageIndex::expandPrefix(const QByteArray &prefix, int limit) const {
+  QSet<QByteArray> terms;
+  for (const Segment &segment : segments) {
+    for (auto it = segment.postings.lowerBound(prefix);
+         it != segment.postings.constEnd() && it.key().startsWith(prefix) && terms.size() < limit; ++it) {
+      terms.insert(it.key());
+    }
+  }
+  for (auto it = pendingPostings.lowerBound(prefix);
+       it != pendingPostings.constEnd() && it.key().startsWith(prefix) && terms.size() < limit; ++it) {
+    terms.insert(it.key());
+  }
+  return terms.values();
+}
+
+QList<PageSearchHit> PageIndex::search(const QString &query, int limit) const {
+  QList<QByteArray> terms;
+  for (const QByteArray &token : tokenize(query)) {
+    if (!terms.contains(token))
+      terms.append(token);
+  }
+  if (terms.isEmpty() || documents.isEmpty() || limit <= 0)
+    return {};
+
+  // While typing, the last word is probably incomplete
+  const bool prefixLast = !query.isEmpty() && query.back().isLetterOrNumber();
+  const double documentCount = documents.size();
+  const double averageLength = qMax(1.0, double(totalLength) / documentCount);
+
+  QHash<quint32, double> scores;
+  QHash<quint32, int> matchedTerms;
+  for (int i = 0; i < terms.size(); ++i) {
+    const QList<QByteArray> variants =
+        (prefixLast && i == terms.size() - 1) ? expandPrefix(terms[i], PREFIX_EXPANSIONS) : QList<QByteArray>{terms[i]};
+
+    QHash<quint32, quint32> frequencies;
+    for (const QByteArray &variant : variants) {
+      forEachPosting(variant, [&frequencies](quint32 id, quint32 frequency) { frequencies[id] += frequency; });
+    }
+    if (frequencies.isEmpty())
+      continue;
+
+    // BM25
+    const double df = frequencies.size();
+    const double idf = std::log(1.0 + (documentCount - df + 0.5) / (df + 0.5));
+    for (auto it = frequencies.cbegin(); it != frequencies.cend(); ++it) {
+      const double tf = it.value();
+      const double length = documents.constFind(it.key())->length;
+      const double norm = BM25_K1 * (1.0 - BM25_B + BM25_B * length / averageLength);
+      scores[it.key()] += idf * tf * (BM25_K1 + 1.0) / (tf + norm);
+      ++matchedTerms[it.key()];
+    }
+  }
+
+  const qint64 now = QDateTime::currentMSecsSinceEpoch();
+  QList<QPair<double, quint32>> ranked;
+  ranked.reserve(scores.size());
+  for (auto it = scores.cbegin(); it != scores.cend(); ++it) {
+    const Document &document = documents[it.key()];
+    double score = it.value();
+    // Pages matching every word first, then a mild preference for recent visits
+    score *= std::pow(0.5, terms.size() - matchedTerms.value(it.key()));
+    score *= 1.0 + 0.3 * std::exp(-double(now - document.visitedAt) / (30.0 * DAY_MS));
+    ranked.append({score, it.key()});
+  }
+
+  const qsizetype count = qMin<qsizetype>(limit, ranked.size());
+  std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(),
+                    [](const QPair<double, quint32> &a, const QPair<double, quint32> &b) { return a.first > b.first; });
+
+  QList<PageSearchHit> hits;
+  for (qsizetype i = 0; i < count; ++i) {
+    const Document &document = documents[ranked[i].second];
+    PageSearchHit hit;
+    hit.url = document.url;
+    hit.title = document.title;
+    hit.visitedAt = document.visitedAt;
+    hit.score = ranked[i].first;
+    hit.snippet = makeSnippet(QString::fromUtf8(qUncompress(readCompressedText(document))), terms);
+    hits.append(hit);
+  }
+  return hits;
+}
+
+void PageIndex::enforceLimits() {
+  const bool overDisk = diskSize() > MAX_DISK_BYTES;
+  if (documents.size() <= MAX_DOCUMENTS && !overDisk)
+    return;
+
+  QList<QPair<qint64, quint32>> byAge;
+  byAge.reserve(documents.size());
+  for (const Document &document : documents) {
+    byAge.append({document.visitedAt, document.id});
+  }
+  std::sort(byAge.begin(), byAge.end());
+
+  // Bytes only come back when segments are rewritten, so evict a batch and merge
+  qsizetype excess = documents.size() - MAX_DOCUMENTS;
+  if (overDisk) {
+    excess = qMax(excess, documents.size() / 10);
+  }
+  for (qsizetype i = 0; i < excess && i < byAge.size(); ++i) {
+    remove(byAge[i].second);
+  }
+  if (overDisk) {
+    merge();
+  }
+}
+
+void PageIndex::maybeMerge() {
+  if (segments.size() > MAX_SEGMENTS || (deleted.size() > 64 && deleted.size() * 4 > documents.size())) {
+    merge();
+  }
+}
+
+void PageIndex::merge() {
+  if (segments.isEmpty())
+    return;
+
+  QList<Document> mergedDocuments;
+  QHash<quint32, QByteArray> texts;
+  QMap<QByteArray, QByteArray> mergedPostings;
+  QHash<QByteArray, quint32> lastIds;
+
+  // Older segments hold smaller ids, so concatenating keeps postings sorted
+  for (const Segment &segment : segments) {
+    for (quint32 id : segment.documentIds) {
+      const auto it = documents.constFind(id);
+      if (it == documents.constEnd())
+        continue;
+      // Compressed text is copied as-is
+      texts.insert(id, readCompressedText(*it));
+      mergedDocuments.append(*it);
+    }
+
+    for (auto it = segment.postings.cbegin(); it != segment.postings.cend(); ++it) {
+      const char *data = it->constData();
+      const char *end = data + it->size();
+      quint32 id = 0;
+      quint32 delta = 0;
+      quint32 frequency = 0;
+      QByteArray *postings = nullptr;
+      while (readVarint(data, end, delta) && readVarint(data, end, frequency)) {
+        id += delta;
+        if (!documents.contains(id))
+          continue;
+        if (!postings) {
+          postings = &mergedPostings[it.key()];
+        }
+        quint32 &lastId = lastIds[it.key()];
+        appendVarint(*postings, id - lastId);
+        appendVarint(*postings, frequency);
+        lastId = id;
+      }
+    }
+  }
+
+  Segment merged;
+  if (!writeSegment(nextSegment, mergedDocuments, texts, mergedPostings, &merged)) {
+    qCWarning(lcPageSearch) << "PageIndex: merge failed, keeping" << segments.size() << "segments";
+    return;
+  }
+  ++nextSegment;
+
+  for (const Document &document : mergedDocuments) {
+    documents.insert(document.id, document);
+  }
+  const QList<Segment> replaced = std::exchange(segments, {merged});
+  deleted.clear();
+
+  // Until the manifest names the merged segment, the old ones are the index on disk; if saving fails they
+  // stay, and the merged file is dropped as unknown on the next open
+  if (saveManifest()) {
+    for (const Segment &segment : replaced) {
+      QFile::remove(segmentPath(segment.number));
+    }
+  }
+
+  qCDebug(lcPageSearch) << "PageIndex: merged into" << segmentPath(merged.number) << merged.size << "bytes,"
+                        << mergedDocuments.size() << "pages";
+}
+
+bool PageIndex::saveManifest() const {
+  QJsonArray segmentNumbers;
+  for (const Segment &segment : segments) {
+    segmentNumbers.append(qint64(segment.number));
+  }
+  QJsonArray tombstones;
+  for (quint32 id : deleted) {
+    tombstones.append(qint64(id));
+  }
+
+  QJsonObject manifest;
+  manifest["version"] = 1;
+  manifest["nextId"] = qint64(nextId);
+  manifest["nextSegment"] = qint64(nextSegment);
+  manifest["segments"] = segmentNumbers;
+  manifest["deleted"] = tombstones;
+
+  QSaveFile file(directory + "/manifest.json");
+  if (!file.open(QIODevice::WriteOnly)) {
+    qCWarning(lcPageSearch) << "PageIndex: failed to save the manifest in" << directory;
+    return false;
+  }
+  file.write(QJsonDocument(manifest).toJson(QJsonDocument::Compact));
+  return file.commit();
+}
+
+void PageIndex::clear() {
+  flushTimer->stop();
+  for (const Segment &segment : segments) {
+    QFile::remove(segmentPath(segment.number));
+  }
+  segments.clear();
+  documents.clear();
+  latestByUrl.clear();
+  deleted.clear();
+  pendingIds.clear();
+  pendingTexts.clear();
+  pendingPostings.clear();
+  totalLength = 0;
+  saveManifest();
+}
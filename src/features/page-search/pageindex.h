@@ -0,0 +1,119 @@
+#ifndef PAGEINDEX_H
+#define PAGEINDEX_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QUrl>
+
+class QTimer;
+
+/**
+ * @brief One ranked result of a page content query
+ */
+struct PageSearchHit {
+  QUrl url;
+  QString title;
+  QString snippet;
+  qint64 visitedAt = 0;
+  double score = 0.0;
+};
+
+/**
+ * @brief Incremental on-disk inverted index of visited page text
+ *
+ * New pages collect in memory and are flushed as immutable segment files
+ * (compressed text blobs, a document table and a qCompress'ed term ->
+ * postings dictionary with varint doc-id deltas). Revisits and evictions
+ * become tombstones; segments are merged once there are too many or too
+ * much of them is dead. The live document count and the disk size are
+ * bounded by evicting the oldest pages.
+ *
+ * Not thread-safe: every call must come from the thread the index lives in
+ * (PageSearchService keeps it on a low-priority worker thread).
+ */
+class PageIndex : public QObject {
+  Q_OBJECT
+
+public:
+  explicit PageIndex(const QString &directory, QObject *parent = nullptr);
+  ~PageIndex();
+
+  void open();
+  void addPage(const QUrl &url, const QString &title, const QString &text, qint64 visitedAt);
+  // BM25 ranking with a recency boost; the last query word also matches as a prefix
+  QList<PageSearchHit> search(const QString &query, int limit) const;
+  void flush();
+  void clear();
+
+  int documentCount() const { return documents.size(); }
+  qint64 diskSize() const;
+
+  // Lower-cased words; CJK runs become overlapping character bigrams
+  static QList<QByteArray> tokenize(const QString &text);
+
+  static constexpr int MAX_DOCUMENTS = 5000;
+  static constexpr qint64 MAX_DISK_BYTES = 64 * 1024 * 1024;
+  static constexpr int MAX_TEXT_CHARS = 200000;
+
+private:
+  struct Document {
+    quint32 id = 0;
+    QUrl url;
+    QString title;
+    qint64 visitedAt = 0;
+    quint32 length = 0; // Tokens, for BM25 length normalisation
+    quint32 textHash = 0;
+    quint64 segment = 0; // 0 while pending
+    qint64 textOffset = 0;
+    quint32 textSize = 0;
+  };
+
+  struct Segment {
+    quint64 number = 0;
+    qint64 size = 0;
+    QList<quint32> documentIds;
+    QMap<QByteArray, QByteArray> postings; // term -> encoded (doc delta, tf) pairs
+  };
+
+  QString segmentPath(quint64 number) const;
+  bool readSegment(quint64 number, Segment *segment, QList<Document> *segmentDocuments) const;
+  // Fills in each document's segment and text offset
+  bool writeSegment(quint64 number, QList<Document> &segmentDocuments, const QHash<quint32, QByteArray> &texts,
+                    const QMap<QByteArray, QByteArray> &postings, Segment *segment);
+  QByteArray readCompressedText(const Document &document) const;
+  void remove(quint32 id);
+  void enforceLimits();
+  void maybeMerge();
+  void merge();
+  bool saveManifest() const;
+  void scheduleFlush();
+
+  // Calls visit(docId, tf) for every live posting of term
+  template <typename Visitor>
+  void forEachPosting(const QByteArray &term, Visitor visit) const;
+  QList<QByteArray> expandPrefix(const QByteArray &prefix, int limit) const;
+
+  QString directory;
+  QList<Segment> segments;
+  QHash<quint32, Document> documents; // Live documents only
+  QHash<QString, quint32> latestByUrl;
+  QSet<quint32> deleted; // Tombstones still present in segment files
+  quint64 totalLength;
+  quint32 nextId;
+  quint64 nextSegment;
+
+  // Pages added since the last flush
+  QList<quint32> pendingIds;
+  QHash<quint32, QByteArray> pendingTexts; // qCompress'ed
+  QMap<QByteArray, QList<QPair<quint32, quint32>>> pendingPostings;
+
+  QTimer *flushTimer;
+};
+
+#endif // PAGEINDEX_H
@@ -0,0 +1,115 @@
+#include "pagesearchservice.h"
+#include "../webview/webview.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QPointer>
+#include <QStandardPaths>
+#include <QThread>
+#include <QTimer>
+#include <QWebEnginePage>
+
+namespace {
+// Past the load and its first burst of scripts; late content gets picked up too
+const int CAPTURE_DELAY_MS = 3000;
+} // namespace
+
+PageSearchService *PageSearchService::instance() {
+  // Parented to the application so it outlives every window
+  static PageSearchService *service = new PageSearchService(QCoreApplication::instance());
+  return service;
+}
+
+PageSearchService::PageSearchService(QObject *parent) : QObject(parent) {
+  const QString path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/page-index";
+
+  workerThread = new QThread(this);
+  workerThread->setObjectName("PageIndex");
+  index = new PageIndex(path);
+  index->moveToThread(workerThread);
+  connect(workerThread, &QThread::finished, index, &QObject::deleteLater);
+  workerThread->start(QThread::LowestPriority);
+
+  QMetaObject::invokeMethod(index, &PageIndex::open, Qt::QueuedConnection);
+}
+
+PageSearchService::~PageSearchService() {
+  shutdown();
+}
+
+void PageSearchService::attach(WebView *view) {
+  if (!view)
+    return;
+
+  connect(view, &WebView::loadFinished, this, [this, view](bool ok) {
+    const QUrl url = view->url();
+    if (!ok || (url.scheme() != "http" && url.scheme() != "https"))
+      return;
+
+    QTimer::singleShot(CAPTURE_DELAY_MS, view, [this, view, url]() {
+      // Skip pages the user already navigated away from
+      if (view->url() == url) {
+        capture(view);
+      }
+    });
+  });
+}
+
+void PageSearchService::capture(WebView *view) {
+  if (!index)
+    return;
+
+  const QUrl url = view->url();
+  const QString title = view->title();
+  // The renderer extracts the text asynchronously; only the hand-off happens here
+  view->page()->toPlainText([this, url, title](const QString &text) {
+    if (!index || text.isEmpty())
+      return;
+    PageIndex *target = index;
+    const qint64 visitedAt = QDateTime::currentMSecsSinceEpoch();
+    QMetaObject::invokeMethod(
+        target, [target, url, title, text, visitedAt]() { target->addPage(url, title, text, visitedAt); },
+        Qt::QueuedConnection);
+  });
+}
+
+void PageSearchService::search(const QString &query, int limit, QObject *context,
+                               std::function<void(const QList<PageSearchHit> &)> callback) {
+  if (!index) {
+    callback({});
+    return;
+  }
+
+  PageIndex *target = index;
+  QPointer<QObject> guard(context);
+  QMetaObject::invokeMethod(
+      target,
+      [this, target, query, limit, guard, callback]() {
+        const QList<PageSearchHit> hits = target->search(query, limit);
+        QMetaObject::invokeMethod(
+            this,
+            [guard, callback, hits]() {
+              if (guard) {
+                callback(hits);
+              }
+            },
+            Qt::QueuedConnection);
+      },
+      Qt::QueuedConnection);
+}
+
+void PageSearchService::clear() {
+  if (index) {
+    QMetaObject::invokeMethod(index, &PageIndex::clear, Qt::QueuedConnection);
+  }
+}
+
+void PageSearchService::shutdown() {
+  if (!index)
+    return;
+
+  // Runs after every queued page, so nothing captured is lost
+  QMetaObject::invokeMethod(index, &PageIndex::flush, Qt::BlockingQueuedConnection);
+  index = nullptr;
+  workerThread->quit();
+  workerThread->wait();
+}
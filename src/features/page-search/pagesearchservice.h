@@ -0,0 +1,48 @@
+#ifndef PAGESEARCHSERVICE_H
+#define PAGESEARCHSERVICE_H
+
+#include "pageindex.h"
+#include <QObject>
+#include <functional>
+
+class QThread;
+class WebView;
+
+/**
+ * @brief Indexes visited pages in the background and answers text queries
+ *
+ * The PageIndex lives on a low-priority worker thread shared by every
+ * window. Page text is requested a little after loadFinished, once the
+ * page has settled; the renderer returns it asynchronously and everything
+ * after that (tokenizing, compression, disk I/O, queries) runs on the
+ * worker, so neither the GUI thread nor the page load waits for it.
+ */
+class PageSearchService : public QObject {
+  Q_OBJECT
+
+public:
+  static PageSearchService *instance();
+
+  // Captures the text of every page this view finishes loading
+  void attach(WebView *view);
+
+  // callback runs on the GUI thread, and only if context is still alive
+  void search(const QString &query, int limit, QObject *context,
+              std::function<void(const QList<PageSearchHit> &)> callback);
+
+  void clear();
+
+  // Flushes pending pages and stops the worker
+  void shutdown();
+
+private:
+  explicit PageSearchService(QObject *parent = nullptr);
+  ~PageSearchService();
+
+  void capture(WebView *view);
+
+  QThread *workerThread;
+  PageIndex *index;
+};
+
+#endif // PAGESEARCHSERVICE_H
@@ -0,0 +1,150 @@
+// Performance HUD collector
+// Injected only while the HUD is enabled. Metrics go to the host as
+// "perf.metrics" events on the page event bus (page-event-bus.js).
+
+(function () {
+  if (window.__mybrowserPerf) {
+    window.__mybrowserPerf.start();
+    return;
+  }
+
+  const REPORT_INTERVAL = 1000; // 1秒ごとにまとめて送信
+  const JANK_THRESHOLD = 50; // 50ms以上のフレーム間隔をジャンクとみなす
+
+  const metrics = {
+    url: location.href,
+    origin: location.origin,
+    loadId: Date.now(),
+    ttfb: -1,
+    domContentLoaded: -1,
+    loadEvent: -1,
+    lcp: -1,
+    longTaskCount: 0,
+    longTaskTotal: 0,
+    frames: 0,
+    jankFrames: 0,
+    maxFrameGap: 0,
+    resourceCount: 0,
+    cacheHits: 0,
+  };
+
+  let observers = [];
+  let reportTimer = 0;
+  let rafHandle = 0;
+  let lastFrame = 0;
+  let dirty = true;
+
+  function observe(type, callback) {
+    try {
+      const observer = new PerformanceObserver(function (list) {
+        callback(list.getEntries());
+        dirty = true;
+      });
+      observer.observe({ type: type, buffered: true });
+      observers.push(observer);
+    } catch (e) {
+      // このエントリタイプに未対応
+    }
+  }
+
+  // transferSize 0 with a non-empty body means the HTTP cache served it.
+  // Cross-origin entries without Timing-Allow-Origin report no sizes and are skipped.
+  function countCacheHit(entry) {
+    if (entry.decodedBodySize > 0) {
+      metrics.resourceCount++;
+      if (entry.transferSize === 0) {
+        metrics.cacheHits++;
+      }
+    }
+  }
+
+  function onFrame(now) {
+    if (lastFrame > 0) {
+      const gap = now - lastFrame;
+      metrics.frames++;
+      if (gap > JANK_THRESHOLD) {
+        metrics.jankFrames++;
+        dirty = true;
+      }
+      if (gap > metrics.maxFrameGap) {
+        metrics.maxFrameGap = gap;
+      }
+    }
+    lastFrame = now;
+    rafHandle = requestAnimationFrame(onFrame);
+  }
+
+  function onVisibilityChange() {
+    // 非表示タブの rAF は止まるので、復帰時の間隔をジャンクとして数えない
+    lastFrame = 0;
+    if (document.visibilityState === "hidden") {
+      flush();
+    }
+  }
+
+  function flush() {
+    const bus = window.__mybrowserEvents;
+    if (!bus || !dirty) {
+      return;
+    }
+    dirty = false;
+    // コピーを送る（バッチ送信までに metrics が更新されても混ざらない）
+    bus.emit("perf.metrics", Object.assign({}, metrics));
+    if (document.visibilityState === "hidden") {
+      bus.flush();
+    }
+  }
+
+  function start() {
+    if (observers.length > 0) {
+      return;
+    }
+
+    // buffered: true replays every entry since the page loaded, including those counted before a stop()
+    metrics.resourceCount = 0;
+    metrics.cacheHits = 0;
+    metrics.longTaskCount = 0;
+    metrics.longTaskTotal = 0;
+    dirty = true;
+
+    observe("navigation", function (entries) {
+      const nav = entries[entries.length - 1];
+      metrics.ttfb = nav.responseStart;
+      metrics.domContentLoaded = nav.domContentLoadedEventEnd;
+      metrics.loadEvent = nav.loadEventEnd;
+    });
+    observe("resource", function (entries) {
+      entries.forEach(countCacheHit);
+    });
+    observe("largest-contentful-paint", function (entries) {
+      metrics.lcp = entries[entries.length - 1].startTime;
+    });
+    observe("longtask", function (entries) {
+      entries.forEach(function (entry) {
+        metrics.longTaskCount++;
+        metrics.longTaskTotal += entry.duration;
+      });
+    });
+
+    lastFrame = 0;
+    rafHandle = requestAnimationFrame(onFrame);
+    reportTimer = setInterval(flush, REPORT_INTERVAL);
+    document.addEventListener("visibilitychange", onVisibilityChange);
+    window.addEventListener("pagehide", flush);
+  }
+
+  function stop() {
+    observers.forEach(function (observer) {
+      observer.disconnect();
+    });
+    observers = [];
+    cancelAnimationFrame(rafHandle);
+    clearInterval(reportTimer);
+    document.removeEventListener("visibilitychange", onVisibilityChange);
+    window.removeEventListener("pagehide", flush);
+  }
+
+  window.__mybrowserPerf = { start: start, stop: stop };
+
+  start();
+})();
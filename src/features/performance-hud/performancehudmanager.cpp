@@ -0,0 +1,153 @@
+#include "performancehudmanager.h"
+#include "../logging/logcategories.h"
+#include "../main-window/mainwindow.h"
+#include "../page-events/pageeventbus.h"
+#include "../tab-widget/verticaltabwidget.h"
+#include "../webview/webview.h"
+#include "performancehudoverlay.h"
+#include "performancestore.h"
+#include <QFile>
+#include <QKeySequence>
+#include <QUrl>
+#include <QWebEngineScript>
+#include <QWebEngineScriptCollection>
+
+namespace {
+const char *COLLECTOR_SCRIPT_NAME = "mybrowser-perf-collector";
+
+QString readResource(const QString &path) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    qCWarning(lcPerformanceHud) << "Failed to load" << path;
+    return QString();
+  }
+  return QString::fromUtf8(file.readAll());
+}
+} // namespace
+
+PerformanceHudManager::PerformanceHudManager(MainWindow *parent)
+    : QObject(parent), mainWindow(parent), store(new PerformanceStore(this)),
+      toggleAction(nullptr), enabled(false) {
+  connect(store, &PerformanceStore::tabMetricsChanged, this, [this](int tabId) {
+    WebView *view = mainWindow->currentWebView();
+    if (view && view->tabId() == tabId) {
+      refreshOverlay();
+    }
+  });
+
+  parent->getPageEventBus()->subscribe<PageMetrics>("perf.metrics", this, [this](int tabId, const PageMetrics &page) {
+    if (enabled) {
+      store->update(tabId, page);
+    }
+  });
+}
+
+PerformanceHudManager::~PerformanceHudManager() {
+}
+
+void PerformanceHudManager::setupActions() {
+  toggleAction = new QAction("Performance HUD", mainWindow);
+  toggleAction->setShortcut(QKeySequence("Ctrl+Alt+P"));
+  toggleAction->setCheckable(true);
+  toggleAction->setStatusTip("Show page performance metrics (Ctrl+Alt+P)");
+  toggleAction->setToolTip("Performance HUD (Ctrl+Alt+P)");
+  connect(toggleAction, &QAction::toggled, this, &PerformanceHudManager::setEnabled);
+}
+
+void PerformanceHudManager::attach(WebView *view) {
+  if (!view)
+    return;
+
+  const int tabId = view->tabId();
+  connect(view, &QObject::destroyed, store, [this, tabId]() {
+    store->removeTab(tabId);
+  });
+
+  if (enabled) {
+    injectCollector(view);
+  }
+}
+
+void PerformanceHudManager::setEnabled(bool enable) {
+  if (enabled == enable)
+    return;
+
+  enabled = enable;
+  if (toggleAction && toggleAction->isChecked() != enable) {
+    toggleAction->setChecked(enable);
+  }
+
+  VerticalTabWidget *tabWidget = mainWindow->getTabWidget();
+  for (int i = 0; i < tabWidget->count(); ++i) {
+    if (WebView *view = qobject_cast<WebView *>(tabWidget->widget(i))) {
+      if (enabled) {
+        injectCollector(view);
+      } else {
+        removeCollector(view);
+      }
+    }
+  }
+
+  if (enabled) {
+    overlay = new PerformanceHudOverlay(mainWindow);
+    overlay->show();
+    connect(tabWidget, &VerticalTabWidget::currentChanged, this, &PerformanceHudManager::refreshOverlay);
+    refreshOverlay();
+  } else {
+    disconnect(tabWidget, &VerticalTabWidget::currentChanged, this, &PerformanceHudManager::refreshOverlay);
+    delete overlay;
+  }
+}
+
+void PerformanceHudManager::toggle() {
+  setEnabled(!enabled);
+}
+
+void PerformanceHudManager::refreshOverlay() {
+  if (!overlay)
+    return;
+
+  WebView *view = mainWindow->currentWebView();
+  if (!view || !store->hasTab(view->tabId())) {
+    overlay->showEmpty();
+    return;
+  }
+
+  PageMetrics page = store->tabMetrics(view->tabId());
+  overlay->showMetrics(page, store->originMetrics(page.origin));
+}
+
+void PerformanceHudManager::injectCollector(WebView *view) {
+  const QString source = collectorSource();
+  if (source.isEmpty())
+    return;
+
+  // Persistent script for future navigations in this tab
+  QWebEngineScript script;
+  script.setName(COLLECTOR_SCRIPT_NAME);
+  script.setSourceCode(source);
+  script.setInjectionPoint(QWebEngineScript::DocumentCreation);
+  script.setWorldId(QWebEngineScript::MainWorld);
+  script.setRunsOnSubFrames(false);
+  view->page()->scripts().insert(script);
+
+  // Start collecting on the page that is already loaded as well
+  view->page()->runJavaScript(source);
+}
+
+void PerformanceHudManager::removeCollector(WebView *view) {
+  QWebEngineScriptCollection &scripts = view->page()->scripts();
+  const QList<QWebEngineScript> existing = scripts.find(COLLECTOR_SCRIPT_NAME);
+  for (const QWebEngineScript &script : existing) {
+    scripts.remove(script);
+  }
+
+  view->page()->runJavaScript("if (window.__mybrowserPerf) window.__mybrowserPerf.stop();");
+}
+
+QString PerformanceHudManager::collectorSource() {
+  if (collectorScript.isEmpty()) {
+    collectorScript = readResource(":/src/features/performance-hud/perf-collector.js");
+  }
+  return collectorScript;
+}
@@ -0,0 +1,58 @@
+#ifndef PERFORMANCEHUDMANAGER_H
+#define PERFORMANCEHUDMANAGER_H
+
+#include <QAction>
+#include <QObject>
+#include <QPointer>
+
+class MainWindow;
+class WebView;
+class PerformanceStore;
+class PerformanceHudOverlay;
+
+/**
+ * @brief Page performance HUD (Navigation Timing, LCP, long tasks, frame jank)
+ *
+ * While enabled, a PerformanceObserver based collector is injected into every
+ * tab and reports "perf.metrics" events over the PageEventBus. Nothing is
+ * injected and no observers run while the HUD is off.
+ */
+class PerformanceHudManager : public QObject {
+  Q_OBJECT
+
+public:
+  explicit PerformanceHudManager(MainWindow *parent = nullptr);
+  ~PerformanceHudManager();
+
+  void setupActions();
+  QAction *getToggleAction() const { return toggleAction; }
+
+  // Called for every new tab; only injects while the HUD is enabled
+  void attach(WebView *view);
+
+  bool isEnabled() const { return enabled; }
+  PerformanceStore *getStore() const { return store; }
+
+public slots:
+  void setEnabled(bool enable);
+  void toggle();
+
+private slots:
+  void refreshOverlay();
+
+private:
+  void injectCollector(WebView *view);
+  void removeCollector(WebView *view);
+  QString collectorSource();
+
+  MainWindow *mainWindow;
+  PerformanceStore *store;
+  QPointer<PerformanceHudOverlay> overlay;
+  QAction *toggleAction;
+  bool enabled;
+
+  // perf-collector.js, loaded on first enable
+  QString collectorScript;
+};
+
+#endif // PERFORMANCEHUDMANAGER_H
@@ -0,0 +1,89 @@
+#include "performancehudoverlay.h"
+#include "performancestore.h"
+#include <QEvent>
+#include <QFontDatabase>
+#include <QLabel>
+#include <QUrl>
+#include <QVBoxLayout>
+
+namespace {
+const int HUD_MARGIN = 12;
+const int HUD_TOP_OFFSET = 60; // Keep clear of the navigation toolbar
+
+QString formatMs(double value) {
+  return value < 0 ? QStringLiteral("—") : QString("%1 ms").arg(value, 0, 'f', 0);
+}
+
+QString formatPercent(double ratio) {
+  return ratio < 0 ? QStringLiteral("—") : QString("%1%").arg(100.0 * ratio, 0, 'f', 0);
+}
+} // namespace
+
+PerformanceHudOverlay::PerformanceHudOverlay(QWidget *parent)
+    : QFrame(parent), label(new QLabel(this)) {
+  setObjectName("performanceHudOverlay");
+  setAttribute(Qt::WA_TransparentForMouseEvents);
+
+  label->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+  label->setTextFormat(Qt::PlainText);
+
+  QVBoxLayout *layout = new QVBoxLayout(this);
+  layout->setContentsMargins(10, 8, 10, 8);
+  layout->addWidget(label);
+
+  parent->installEventFilter(this);
+  showEmpty();
+}
+
+void PerformanceHudOverlay::showMetrics(const PageMetrics &page, const OriginMetrics &origin) {
+  const double jankPercent = page.frames ? 100.0 * page.jankFrames / page.frames : 0;
+
+  QStringList lines;
+  lines << QUrl(page.url).host();
+  lines << QString("TTFB   %1").arg(formatMs(page.ttfb));
+  lines << QString("DCL    %1").arg(formatMs(page.domContentLoaded));
+  lines << QString("Load   %1").arg(formatMs(page.loadEvent));
+  lines << QString("LCP    %1").arg(formatMs(page.lcp));
+  lines << QString("Long   %1 tasks / %2").arg(page.longTaskCount).arg(formatMs(page.longTaskTotal));
+  lines << QString("Jank   %1/%2 frames (%3%), max %4")
+               .arg(page.jankFrames)
+               .arg(page.frames)
+               .arg(jankPercent, 0, 'f', 1)
+               .arg(formatMs(page.maxFrameGap));
+  lines << QString("Cache  %1/%2 resources (%3)")
+               .arg(page.cacheHits)
+               .arg(page.resourceCount)
+               .arg(formatPercent(page.resourceCount ? double(page.cacheHits) / page.resourceCount : -1));
+  lines << QString();
+  lines << QString("Origin %1 loads, avg TTFB %2, avg LCP %3, jank %4%, cache hits %5")
+               .arg(origin.pageLoads)
+               .arg(formatMs(origin.averageTtfb()))
+               .arg(formatMs(origin.averageLcp()))
+               .arg(100.0 * origin.jankRatio(), 0, 'f', 1)
+               .arg(formatPercent(origin.cacheHitRatio()));
+
+  label->setText(lines.join('\n'));
+  adjustSize();
+  reposition();
+}
+
+void PerformanceHudOverlay::showEmpty() {
+  label->setText("Performance HUD\nWaiting for metrics (reload to capture timings)");
+  adjustSize();
+  reposition();
+}
+
+bool PerformanceHudOverlay::eventFilter(QObject *obj, QEvent *event) {
+  if (obj == parentWidget() && event->type() == QEvent::Resize) {
+    reposition();
+  }
+  return QFrame::eventFilter(obj, event);
+}
+
+void PerformanceHudOverlay::reposition() {
+  if (!parentWidget())
+    return;
+
+  move(parentWidget()->width() - width() - HUD_MARGIN, HUD_TOP_OFFSET);
+  raise();
+}
@@ -0,0 +1,34 @@
+#ifndef PERFORMANCEHUDOVERLAY_H
+#define PERFORMANCEHUDOVERLAY_H
+
+#include <QFrame>
+
+class QLabel;
+struct PageMetrics;
+struct OriginMetrics;
+
+/**
+ * @brief Small translucent panel showing the current tab's page metrics
+ *
+ * Pinned to the top-right corner of its parent and ignores mouse input so
+ * it never gets in the way of the page.
+ */
+class PerformanceHudOverlay : public QFrame {
+  Q_OBJECT
+
+public:
+  explicit PerformanceHudOverlay(QWidget *parent);
+
+  void showMetrics(const PageMetrics &page, const OriginMetrics &origin);
+  void showEmpty();
+
+protected:
+  bool eventFilter(QObject *obj, QEvent *event) override;
+
+private:
+  void reposition();
+
+  QLabel *label;
+};
+
+#endif // PERFORMANCEHUDOVERLAY_H
@@ -0,0 +1,107 @@
+#include "performancestore.h"
+#include <QSet>
+#include <algorithm>
+
+PageMetrics PageMetrics::fromJson(const QJsonObject &json) {
+  PageMetrics metrics;
+  metrics.url = json["url"].toString();
+  metrics.origin = json["origin"].toString();
+  metrics.loadId = static_cast<qint64>(json["loadId"].toDouble());
+  metrics.ttfb = json["ttfb"].toDouble(-1);
+  metrics.domContentLoaded = json["domContentLoaded"].toDouble(-1);
+  metrics.loadEvent = json["loadEvent"].toDouble(-1);
+  metrics.lcp = json["lcp"].toDouble(-1);
+  metrics.longTaskCount = json["longTaskCount"].toInt();
+  metrics.longTaskTotal = json["longTaskTotal"].toDouble();
+  metrics.frames = json["frames"].toInt();
+  metrics.jankFrames = json["jankFrames"].toInt();
+  metrics.maxFrameGap = json["maxFrameGap"].toDouble();
+  metrics.resourceCount = json["resourceCount"].toInt();
+  metrics.cacheHits = json["cacheHits"].toInt();
+  return metrics;
+}
+
+void OriginMetrics::add(const PageMetrics &page) {
+  ++pageLoads;
+  if (page.ttfb >= 0) {
+    ++ttfbSamples;
+    ttfbTotal += page.ttfb;
+  }
+  if (page.lcp >= 0) {
+    ++lcpSamples;
+    lcpTotal += page.lcp;
+  }
+  longTaskCount += page.longTaskCount;
+  longTaskTotal += page.longTaskTotal;
+  frames += page.frames;
+  jankFrames += page.jankFrames;
+  maxFrameGap = std::max(maxFrameGap, page.maxFrameGap);
+  resourceCount += page.resourceCount;
+  cacheHits += page.cacheHits;
+}
+
+PerformanceStore::PerformanceStore(QObject *parent)
+    : QObject(parent) {
+}
+
+void PerformanceStore::update(int tabId, const PageMetrics &metrics) {
+  auto it = tabs.find(tabId);
+  if (it != tabs.end() && it->loadId != metrics.loadId) {
+    // The tab navigated: the previous page load is finished
+    OriginMetrics &origin = finishedOrigins[it->origin];
+    origin.origin = it->origin;
+    origin.add(*it);
+  }
+
+  tabs.insert(tabId, metrics);
+  emit tabMetricsChanged(tabId);
+}
+
+void PerformanceStore::removeTab(int tabId) {
+  auto it = tabs.find(tabId);
+  if (it == tabs.end())
+    return;
+
+  OriginMetrics &origin = finishedOrigins[it->origin];
+  origin.origin = it->origin;
+  origin.add(*it);
+  tabs.erase(it);
+}
+
+void PerformanceStore::clear() {
+  tabs.clear();
+  finishedOrigins.clear();
+}
+
+OriginMetrics PerformanceStore::originMetrics(const QString &origin) const {
+  OriginMetrics result = finishedOrigins.value(origin);
+  result.origin = origin;
+  for (const PageMetrics &page : tabs) {
+    if (page.origin == origin) {
+      result.add(page);
+    }
+  }
+  return result;
+}
+
+QList<OriginMetrics> PerformanceStore::allOrigins() const {
+  QSet<QString> origins;
+  for (auto it = finishedOrigins.cbegin(); it != finishedOrigins.cend(); ++it) {
+    origins.insert(it.key());
+  }
+  for (const PageMetrics &page : tabs) {
+    origins.insert(page.origin);
+  }
+
+  QList<OriginMetrics> result;
+  result.reserve(origins.size());
+  for (const QString &origin : origins) {
+    result.append(originMetrics(origin));
+  }
+
+  // Slowest origins first
+  std::sort(result.begin(), result.end(), [](const OriginMetrics &a, const OriginMetrics &b) {
+    return a.averageLcp() > b.averageLcp();
+  });
+  return result;
+}
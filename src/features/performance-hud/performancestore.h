@@ -0,0 +1,90 @@
+#ifndef PERFORMANCESTORE_H
+#define PERFORMANCESTORE_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QObject>
+#include <QString>
+
+/**
+ * @brief Metrics reported by the collector for one page load
+ *
+ * Timing values are milliseconds relative to navigation start; -1 means the
+ * value has not been observed yet.
+ */
+struct PageMetrics {
+  QString url;
+  QString origin;
+  qint64 loadId = 0;
+  double ttfb = -1;
+  double domContentLoaded = -1;
+  double loadEvent = -1;
+  double lcp = -1;
+  int longTaskCount = 0;
+  double longTaskTotal = 0;
+  int frames = 0;
+  int jankFrames = 0;
+  double maxFrameGap = 0;
+  int resourceCount = 0; // Resources with a measurable size
+  int cacheHits = 0;     // ...of which served by the HTTP cache
+
+  static PageMetrics fromJson(const QJsonObject &json);
+};
+
+/**
+ * @brief Aggregated metrics for every page load seen for one origin
+ */
+struct OriginMetrics {
+  QString origin;
+  int pageLoads = 0;
+  int ttfbSamples = 0;
+  double ttfbTotal = 0;
+  int lcpSamples = 0;
+  double lcpTotal = 0;
+  int longTaskCount = 0;
+  double longTaskTotal = 0;
+  int frames = 0;
+  int jankFrames = 0;
+  double maxFrameGap = 0;
+  int resourceCount = 0;
+  int cacheHits = 0;
+
+  void add(const PageMetrics &page);
+  double averageTtfb() const { return ttfbSamples ? ttfbTotal / ttfbSamples : -1; }
+  double averageLcp() const { return lcpSamples ? lcpTotal / lcpSamples : -1; }
+  double jankRatio() const { return frames ? double(jankFrames) / frames : 0; }
+  double cacheHitRatio() const { return resourceCount ? double(cacheHits) / resourceCount : -1; }
+};
+
+/**
+ * @brief Per-tab and per-origin store for performance HUD metrics
+ *
+ * Each tab keeps the metrics of its current page load. When a tab navigates
+ * or closes, the finished page load is folded into its origin's aggregate.
+ */
+class PerformanceStore : public QObject {
+  Q_OBJECT
+
+public:
+  explicit PerformanceStore(QObject *parent = nullptr);
+
+  void update(int tabId, const PageMetrics &metrics);
+  void removeTab(int tabId);
+  void clear();
+
+  bool hasTab(int tabId) const { return tabs.contains(tabId); }
+  PageMetrics tabMetrics(int tabId) const { return tabs.value(tabId); }
+
+  // Finished page loads plus the live pages currently open for the origin
+  OriginMetrics originMetrics(const QString &origin) const;
+  QList<OriginMetrics> allOrigins() const;
+
+signals:
+  void tabMetricsChanged(int tabId);
+
+private:
+  QHash<int, PageMetrics> tabs;
+  QHash<QString, OriginMetrics> finishedOrigins;
+};
+
+#endif // PERFORMANCESTORE_H
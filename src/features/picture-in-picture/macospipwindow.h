@@ -13,9 +13,6 @@
 #include <QVideoWidget>
 #include <QWidget>
 
-// Forward declarations
-class QNetworkAccessManager;
-
 #ifdef Q_OS_MACOS
 #ifdef __OBJC__
 @class NSPanel;
@@ -60,7 +57,14 @@ public:
   };
   MediaType getCurrentMediaType() const;
 
+  // Back to an empty, hidden image window, keeping the media pipeline for reuse
+  void reset();
+
+signals:
+  void closed();
+
 protected:
+  void closeEvent(QCloseEvent *event) override;
   // Enable window dragging with mouse events
   void mousePressEvent(QMouseEvent *event) override;
   void mouseMoveEvent(QMouseEvent *event) override;
@@ -90,6 +94,7 @@ private:
   QLabel *imageLabel;
   QVideoWidget *videoWidget;
   QMediaPlayer *mediaPlayer;
+  QAudioOutput *audioOutput;
   QPushButton *closeButton;
 
   // Video controls
@@ -100,8 +105,8 @@ private:
   QSlider *volumeSlider;
   QLabel *timeLabel;
 
-  QNetworkAccessManager *networkManager; // For media loading
   MediaType currentMediaType;
+  quint64 generation; // Bumped by reset() so late image loads of a previous use are dropped
 
   // Window dragging
   QPoint dragStartPosition;
@@ -1,10 +1,8 @@
 #include "macospipwindow.h"
+#include "../logging/logcategories.h"
+#include "pipmedialoader.h"
 #include <QPushButton>
-#include <QtNetwork/QNetworkAccessManager>
-#include <QtNetwork/QNetworkRequest>
-#include <QtNetwork/QNetworkReply>
 #include <QTimer>
-#include <QDebug>
 #include <QPainter>
 #include <QFont>
 #include <QMediaPlayer>
@@ -15,15 +13,15 @@
 #include <QLabel>
 #include <QTime>
 #include <QAudioOutput>
+#include <QCloseEvent>
 
 #ifdef Q_OS_MACOS
 #import <Cocoa/Cocoa.h>
 #endif
 
 MacOSPiPWindow::MacOSPiPWindow(QWidget *parent)
-    : QWidget(parent), isDragging(false), networkManager(nullptr),
-      currentMediaType(Image), mediaPlayer(nullptr), videoWidget(nullptr),
-      contentStack(nullptr), videoControlsWidget(nullptr) {
+    : QWidget(parent), contentStack(nullptr), videoWidget(nullptr), mediaPlayer(nullptr), audioOutput(nullptr),
+      videoControlsWidget(nullptr), currentMediaType(Image), generation(0), isDragging(false) {
 #ifdef Q_OS_MACOS
     pipPanel = nullptr;
 #endif
@@ -96,6 +94,9 @@ void MacOSPiPWindow::setupUI() {
     // Setup media player
     mediaPlayer = new QMediaPlayer(this);
     mediaPlayer->setVideoOutput(videoWidget);
+    audioOutput = new QAudioOutput(this);
+    audioOutput->setVolume(0.5); // Matches the volume slider's initial value
+    mediaPlayer->setAudioOutput(audioOutput);
 
     // Add widgets to stack
     contentStack->addWidget(imageLabel);
@@ -119,12 +120,12 @@ void MacOSPiPWindow::setupUI() {
 
 void MacOSPiPWindow::setupMacOSBehavior() {
     // macOS specific settings applied after showImage()
-    qDebug() << "MacOS PiP window behavior setup completed";
+    qCDebug(lcPiP) << "MacOS PiP window behavior setup completed";
 }
 
 void MacOSPiPWindow::showImage(const QPixmap &pixmap, const QString &title) {
     if (pixmap.isNull()) {
-        qDebug() << "Invalid pixmap provided to PiP window";
+        qCWarning(lcPiP) << "Invalid pixmap provided to PiP window";
         return;
     }
 
@@ -142,7 +143,7 @@ void MacOSPiPWindow::showImage(const QPixmap &pixmap, const QString &title) {
         applyMacOSSpacesSettings();
     });
 
-    qDebug() << "PiP window showing image:" << title;
+    qCDebug(lcPiP) << "PiP window showing image:" << title;
 }
 
 void MacOSPiPWindow::applyMacOSSpacesSettings() {
@@ -191,57 +192,38 @@ void MacOSPiPWindow::applyMacOSSpacesSettings() {
         [originalWindow orderOut:nil];
         [pipPanel makeKeyAndOrderFront:nil];
 
-        qDebug() << "PiP window converted to NSPanel for fullscreen space and Mission Control compatibility";
+        qCDebug(lcPiP) << "PiP window converted to NSPanel for fullscreen space and Mission Control compatibility";
 
     } else if (pipPanel) {
         // すでにパネルが存在する場合は前面に表示
         [pipPanel makeKeyAndOrderFront:nil];
-        qDebug() << "PiP panel brought to front";
+        qCDebug(lcPiP) << "PiP panel brought to front";
 
     } else {
-        qDebug() << "Warning: Could not get NSWindow handle for PiP panel configuration";
+        qCWarning(lcPiP) << "Warning: Could not get NSWindow handle for PiP panel configuration";
     }
 #else
-    qDebug() << "macOS-specific settings not available on this platform";
+    qCDebug(lcPiP) << "macOS-specific settings not available on this platform";
 #endif
 }
 
 void MacOSPiPWindow::showImageFromUrl(const QString &imageUrl, const QString &title) {
-    qDebug() << "Loading image from URL:" << imageUrl;
-
-    if (!networkManager) {
-        networkManager = new QNetworkAccessManager(this);
-    }
+    qCDebug(lcPiP) << "Loading image from URL:" << imageUrl;
 
     if (imageUrl.startsWith("http://") || imageUrl.startsWith("https://")) {
-        QNetworkRequest request(imageUrl);
-        request.setRawHeader("User-Agent", "Mozilla/5.0 (Macintosh; Intel Mac OS X 10_15_7) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/91.0.4472.124 Safari/537.36");
-
-        QNetworkReply *reply = networkManager->get(request);
-
-        connect(reply, &QNetworkReply::finished, this, [this, reply, title]() {
-            if (reply->error() == QNetworkReply::NoError) {
-                QByteArray imageData = reply->readAll();
-                QPixmap pixmap;
-
-                if (pixmap.loadFromData(imageData)) {
-                    QPixmap scaledPixmap = pixmap.scaled(600, 400, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-                    showImage(scaledPixmap, title);
-                    qDebug() << "Successfully loaded image from URL:" << title;
-                } else {
-                    qDebug() << "Failed to create pixmap from image data";
-                    showPlaceholderImage(title + " (Load Failed)");
-                }
-            } else {
-                qDebug() << "Network error loading image:" << reply->errorString();
-                showPlaceholderImage(title + " (Network Error)");
+        // Shared loader: disk cached, deduplicated, decoded off the GUI thread at display size
+        const quint64 request = generation;
+        PiPMediaLoader::instance()->loadImage(QUrl(imageUrl), QSize(600, 400), this,
+                                              [this, title, request](const QImage &image, const QString &error) {
+            if (request != generation) {
+                return;
             }
-            reply->deleteLater();
-        });
-
-        QTimer::singleShot(10000, reply, [reply]() {
-            if (reply->isRunning()) {
-                reply->abort();
+            if (!image.isNull()) {
+                showImage(QPixmap::fromImage(image), title);
+                qCDebug(lcPiP) << "Successfully loaded image from URL:" << title;
+            } else {
+                qCWarning(lcPiP) << "Failed to load image from URL:" << error;
+                showPlaceholderImage(title + " (Load Failed)");
             }
         });
 
@@ -252,7 +234,7 @@ void MacOSPiPWindow::showImageFromUrl(const QString &imageUrl, const QString &ti
 }
 
 void MacOSPiPWindow::showImageFromBase64(const QString &base64Data, const QString &title) {
-    qDebug() << "Loading image from Base64 data:" << title;
+    qCDebug(lcPiP) << "Loading image from Base64 data:" << title;
 
     if (base64Data.startsWith("data:image/")) {
         // Extract the base64 data part (after the comma)
@@ -261,22 +243,28 @@ void MacOSPiPWindow::showImageFromBase64(const QString &base64Data, const QStrin
             QString base64String = base64Data.mid(commaIndex + 1);
             QByteArray imageData = QByteArray::fromBase64(base64String.toUtf8());
 
-            QPixmap pixmap;
-            if (pixmap.loadFromData(imageData)) {
-                // Scale the image to a reasonable size while maintaining aspect ratio
-                QPixmap scaledPixmap = pixmap.scaled(600, 400, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-                showImage(scaledPixmap, title);
-                qDebug() << "Successfully loaded image from Base64 data:" << title;
-            } else {
-                qDebug() << "Failed to create pixmap from Base64 data";
-                showPlaceholderImage(title + " (Base64 Load Failed)");
-            }
+            // Decoded on a worker thread, straight to a size that fits the window
+            const quint64 request = generation;
+            PiPMediaLoader::instance()->decodeImage(imageData, QSize(600, 400), this,
+                                                    [this, title, request](const QImage &image, const QString &error) {
+                if (request != generation) {
+                    return;
+                }
+                if (!image.isNull()) {
+                    showImage(QPixmap::fromImage(image), title);
+                    qCDebug(lcPiP) << "Successfully loaded image from Base64 data:" << title;
+                } else {
+                    qCWarning(lcPiP) << "Failed to decode Base64 image data:" << error;
+                    showPlaceholderImage(title + " (Base64 Load Failed)");
+                }
+            });
+            showPlaceholderImage("Loading " + title + "...");
         } else {
-            qDebug() << "Invalid Base64 data format";
+            qCWarning(lcPiP) << "Invalid Base64 data format";
             showPlaceholderImage(title + " (Invalid Base64)");
         }
     } else {
-        qDebug() << "Invalid Base64 data format - missing data:image/ prefix";
+        qCWarning(lcPiP) << "Invalid Base64 data format - missing data:image/ prefix";
         showPlaceholderImage(title + " (Invalid Format)");
     }
 }
@@ -336,7 +324,44 @@ void MacOSPiPWindow::showPlaceholderVideo(const QString &text) {
         applyMacOSSpacesSettings();
     });
 
-    qDebug() << "PiP window showing video placeholder:" << text;
+    qCDebug(lcPiP) << "PiP window showing video placeholder:" << text;
+}
+
+void MacOSPiPWindow::reset() {
+    // Cheap compared with a new window: player, audio output and video sink stay initialized
+    ++generation;
+    PiPMediaLoader::instance()->cancelDecode(this);
+    mediaPlayer->stop();
+    mediaPlayer->setSource(QUrl());
+    disconnect(mediaPlayer, &QMediaPlayer::errorOccurred, this, nullptr);
+    mediaPlayer->setVideoOutput(videoWidget);
+    playPauseButton->setText("▶");
+    positionSlider->setRange(0, 0);
+    timeLabel->setText("00:00 / 00:00");
+
+    imageLabel->clear();
+    videoWidget->setStyleSheet(
+        "QVideoWidget { background-color: rgba(0, 0, 0, 200); border: 2px solid #007ACC; "
+        "border-radius: 8px; }"
+    );
+    switchToImageMode();
+    setWindowTitle("MyBrowser - Picture-in-Picture");
+    isDragging = false;
+
+    hide();
+#ifdef Q_OS_MACOS
+    if (pipPanel) {
+        [pipPanel orderOut:nil];
+    }
+#endif
+}
+
+void MacOSPiPWindow::closeEvent(QCloseEvent *event) {
+    // Pooled windows only hide; the pool resets them on closed()
+    QWidget::closeEvent(event);
+    if (event->isAccepted()) {
+        emit closed();
+    }
 }
 
 void MacOSPiPWindow::mousePressEvent(QMouseEvent *event) {
@@ -430,7 +455,7 @@ void MacOSPiPWindow::setupVideoControls() {
 }
 
 void MacOSPiPWindow::showVideo(const QString &videoUrl, const QString &title) {
-    qDebug() << "Loading video from URL:" << videoUrl;
+    qCDebug(lcPiP) << "Loading video from URL:" << videoUrl;
 
     currentMediaType = Video;
     switchToVideoMode();
@@ -441,33 +466,33 @@ void MacOSPiPWindow::showVideo(const QString &videoUrl, const QString &title) {
 
     // Handle demo/test URLs specially
     if (videoUrl.startsWith("demo://") || videoUrl.startsWith("test://")) {
-        qDebug() << "Showing placeholder for demo video:" << title;
+        qCDebug(lcPiP) << "Showing placeholder for demo video:" << title;
         showPlaceholderVideo(title);
         return;
     }
 
     // Handle special URLs for disablepictureinpicture videos
     if (videoUrl.startsWith("placeholder://disablepictureinpicture-video")) {
-        qDebug() << "Showing placeholder for disablepictureinpicture video:" << title;
+        qCDebug(lcPiP) << "Showing placeholder for disablepictureinpicture video:" << title;
         showPlaceholderVideo(title + " (PiP無効動画)");
         return;
     }
 
     if (videoUrl.startsWith("frame-capture://current-frame")) {
-        qDebug() << "Detected frame capture request - should be handled via videoData parameter";
+        qCDebug(lcPiP) << "Detected frame capture request - should be handled via videoData parameter";
         showPlaceholderVideo(title + " (フレームキャプチャ)");
         return;
     }
 
     // Handle Blob URLs - pass through to media player but with fallback
     if (videoUrl.startsWith("blob:")) {
-        qDebug() << "Attempting to play Blob URL:" << videoUrl;
+        qCDebug(lcPiP) << "Attempting to play Blob URL:" << videoUrl;
         mediaPlayer->setSource(QUrl(videoUrl));
         mediaPlayer->setVideoOutput(videoWidget);
 
         // Set up error handling for Blob URLs
         connect(mediaPlayer, &QMediaPlayer::errorOccurred, this, [this, title](QMediaPlayer::Error error) {
-            qDebug() << "Media player error with Blob URL:" << error;
+            qCWarning(lcPiP) << "Media player error with Blob URL:" << error;
             showPlaceholderVideo(title + " (Blob URL再生エラー)");
         }, Qt::UniqueConnection);
 
@@ -479,13 +504,13 @@ void MacOSPiPWindow::showVideo(const QString &videoUrl, const QString &title) {
             applyMacOSSpacesSettings();
         });
 
-        qDebug() << "PiP window attempting to show Blob video:" << title;
+        qCDebug(lcPiP) << "PiP window attempting to show Blob video:" << title;
         return;
     }
 
     // Validate standard URL format
     if (!videoUrl.startsWith("http://") && !videoUrl.startsWith("https://") && !videoUrl.startsWith("file://")) {
-        qDebug() << "Invalid video URL format:" << videoUrl;
+        qCWarning(lcPiP) << "Invalid video URL format:" << videoUrl;
         showPlaceholderVideo(title + " (無効なURL)");
         return;
     }
@@ -502,22 +527,22 @@ void MacOSPiPWindow::showVideo(const QString &videoUrl, const QString &title) {
         applyMacOSSpacesSettings();
     });
 
-    qDebug() << "PiP window showing video:" << title;
+    qCDebug(lcPiP) << "PiP window showing video:" << title;
 }
 
 void MacOSPiPWindow::showVideoFromBase64(const QString &base64Data, const QString &title) {
-    qDebug() << "Loading video from Base64 data:" << title;
+    qCDebug(lcPiP) << "Loading video from Base64 data:" << title;
 
     // For now, show placeholder - full Base64 video support would require more complex implementation
     showPlaceholderImage("Base64 Video: " + title);
-    qDebug() << "Base64 video display not fully implemented yet";
+    qCDebug(lcPiP) << "Base64 video display not fully implemented yet";
 }
 
 void MacOSPiPWindow::playVideo() {
     if (mediaPlayer && currentMediaType == Video) {
         mediaPlayer->play();
         playPauseButton->setText("⏸");
-        qDebug() << "Playing video";
+        qCDebug(lcPiP) << "Playing video";
     }
 }
 
@@ -525,7 +550,7 @@ void MacOSPiPWindow::pauseVideo() {
     if (mediaPlayer && currentMediaType == Video) {
         mediaPlayer->pause();
         playPauseButton->setText("▶");
-        qDebug() << "Pausing video";
+        qCDebug(lcPiP) << "Pausing video";
     }
 }
 
@@ -533,7 +558,7 @@ void MacOSPiPWindow::stopVideo() {
     if (mediaPlayer && currentMediaType == Video) {
         mediaPlayer->stop();
         playPauseButton->setText("▶");
-        qDebug() << "Stopping video";
+        qCDebug(lcPiP) << "Stopping video";
     }
 }
 
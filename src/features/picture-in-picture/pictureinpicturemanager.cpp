@@ -1,19 +1,29 @@
 #include "pictureinpicturemanager.h"
+#include "../logging/logcategories.h"
 #include "../main-window/mainwindow.h"
+#include "../page-events/pagescriptrunner.h"
 #include "../webview/webview.h"
 #include "macospipwindow.h"
+#include "pipwindowpool.h"
 #include <QAction>
-#include <QDebug>
 #include <QFile>
 #include <QKeySequence>
 #include <QMenu>
 #include <QPixmap>
+#include <QPointer>
 #include <QTextStream>
 #include <QTimer>
 
+namespace {
+// Upper bound for the notification to be painted before the page is searched
+const int FEEDBACK_TIMEOUT_MS = 200;
+// How long a video that is still loading may take to show its first frame
+const int VIDEO_READY_TIMEOUT_MS = 5000;
+} // namespace
+
 PictureInPictureManager::PictureInPictureManager(MainWindow *parent)
     : QObject(parent), mainWindow(parent), imagePiPAction(nullptr), videoPiPAction(nullptr) {
-  qDebug() << "PictureInPictureManager initialized";
+  qCDebug(lcPiP) << "PictureInPictureManager initialized";
 }
 
 PictureInPictureManager::~PictureInPictureManager() {
@@ -34,7 +44,10 @@ void PictureInPictureManager::setupActions() {
 
   connect(imagePiPAction, &QAction::triggered, this, &PictureInPictureManager::onImagePiPTriggered);
   connect(videoPiPAction, &QAction::triggered, this, &PictureInPictureManager::onVideoPiPTriggered);
-  qDebug() << "PiP actions setup completed";
+
+  // Initialize the media pipeline ahead of the first PiP, once start-up is over
+  QTimer::singleShot(3000, PiPWindowPool::instance(), &PiPWindowPool::warmUp);
+  qCDebug(lcPiP) << "PiP actions setup completed";
 }
 
 void PictureInPictureManager::addToMenu(QMenu *viewMenu) {
@@ -58,12 +71,12 @@ void PictureInPictureManager::addToMenu(QMenu *viewMenu) {
   infoAction->setEnabled(false);
   pipMenu->addAction(infoAction);
 
-  qDebug() << "PiP menu items added";
+  qCDebug(lcPiP) << "PiP menu items added";
 }
 
 void PictureInPictureManager::createImagePiP(WebView *webView) {
   if (!webView) {
-    qDebug() << "No WebView provided for image PiP";
+    qCDebug(lcPiP) << "No WebView provided for image PiP";
     return;
   }
 
@@ -73,21 +86,22 @@ void PictureInPictureManager::createImagePiP(WebView *webView) {
 }
 
 void PictureInPictureManager::closeAllPiP() {
-  for (MacOSPiPWindow *window : activePiPWindows) {
+  // Closing hands each window back to the pool
+  const QList<MacOSPiPWindow *> windows = activePiPWindows;
+  activePiPWindows.clear();
+  for (MacOSPiPWindow *window : windows) {
     if (window) {
       window->close();
-      window->deleteLater();
     }
   }
-  activePiPWindows.clear();
-  qDebug() << "All PiP windows closed";
+  qCDebug(lcPiP) << "All PiP windows closed";
 }
 
 void PictureInPictureManager::onImagePiPTriggered() {
   if (mainWindow) {
     WebView *currentView = mainWindow->currentWebView();
     if (currentView) {
-      qDebug() << "Image PiP triggered via keyboard shortcut";
+      qCDebug(lcPiP) << "Image PiP triggered via keyboard shortcut";
 
       // Add visual feedback script
       QString feedbackScript = R"(
@@ -139,18 +153,24 @@ void PictureInPictureManager::onImagePiPTriggered() {
               }
             }, 300);
           }, 2000);
+
+          // Resolves once the notification is on screen
+          return new Promise((resolve) => requestAnimationFrame(() => requestAnimationFrame(resolve)));
         })();
       )";
 
-      // Execute feedback script first
-      currentView->page()->runJavaScript(feedbackScript);
-
-      // Then execute PiP creation after a short delay
-      QTimer::singleShot(200, this, [this, currentView]() {
-        createImagePiP(currentView);
-      });
+      // Capturing the image blocks the page for a moment: start right after the
+      // notification has been painted (or the timeout, on a page that doesn't paint)
+      QPointer<WebView> view(currentView);
+      mainWindow->getPageScriptRunner()
+          ->run(currentView, feedbackScript, FEEDBACK_TIMEOUT_MS)
+          .then(this, [this, view](const PageScriptResult &) {
+            if (view) {
+              createImagePiP(view);
+            }
+          });
     } else {
-      qDebug() << "No active WebView found for PiP";
+      qCDebug(lcPiP) << "No active WebView found for PiP";
     }
   }
 }
@@ -392,14 +412,14 @@ QString PictureInPictureManager::generateImageExtractionScript() const {
 
 void PictureInPictureManager::executeJavaScript(WebView *webView, const QString &script) {
   if (!webView) {
-    qDebug() << "Cannot execute JavaScript: WebView is null";
+    qCWarning(lcPiP) << "Cannot execute JavaScript: WebView is null";
     return;
   }
 
-  webView->page()->runJavaScript(script, [this](const QVariant &result) {
-    qDebug() << "JavaScript execution result received";
+  mainWindow->getPageScriptRunner()->run(webView, script).then(this, [this](const PageScriptResult &result) {
+    qCDebug(lcPiP) << "JavaScript execution result received, status" << result.status;
 
-    QVariantMap resultMap = result.toMap();
+    QVariantMap resultMap = result.value.toMap();
 
     if (resultMap.contains("success") && resultMap["success"].toBool()) {
       QString title = resultMap["title"].toString();
@@ -407,7 +427,7 @@ void PictureInPictureManager::executeJavaScript(WebView *webView, const QString
       // Check if we have captured image data (Base64)
       if (resultMap.contains("imageData")) {
         QString imageData = resultMap["imageData"].toString();
-        qDebug() << "PiP: Processing captured image data for:" << title;
+        qCDebug(lcPiP) << "PiP: Processing captured image data for:" << title;
         createPiPFromImageData(imageData, title);
 
         // Also handle container capture if available
@@ -415,28 +435,25 @@ void PictureInPictureManager::executeJavaScript(WebView *webView, const QString
         if (!containerCapture.isEmpty() && containerCapture["success"].toBool()) {
           QString containerData = containerCapture["containerData"].toString();
           QString containerTitle = containerCapture["title"].toString();
-          qDebug() << "PiP: Also creating container PiP for:" << containerTitle;
-          // Create a secondary PiP window for the container after a short delay
-          QTimer::singleShot(1000, this, [this, containerData, containerTitle]() {
-            createPiPFromImageData(containerData, containerTitle + " (Container)");
-          });
+          qCDebug(lcPiP) << "PiP: Also creating container PiP for:" << containerTitle;
+          createPiPFromImageData(containerData, containerTitle + " (Container)");
         }
       }
       // Fallback to URL method
       else if (resultMap.contains("imageUrl")) {
         QString imageUrl = resultMap["imageUrl"].toString();
-        qDebug() << "PiP: Processing image URL (fallback):" << imageUrl << "with title:" << title;
+        qCDebug(lcPiP) << "PiP: Processing image URL (fallback):" << imageUrl << "with title:" << title;
         createPiPFromImageData(imageUrl, title);
       }
     } else {
-      qDebug() << "PiP: JavaScript execution failed or no images found";
+      qCDebug(lcPiP) << "PiP: JavaScript execution failed or no images found";
       createPiPFromImageData("demo://test-image", "Test Image - 画像が見つかりませんでした");
     }
   });
 }
 
 void PictureInPictureManager::createPiPFromImageData(const QString &imageData, const QString &title) {
-  MacOSPiPWindow *pipWindow = new MacOSPiPWindow();
+  MacOSPiPWindow *pipWindow = PiPWindowPool::instance()->acquire();
 
   // Check if imageData is Base64 or URL
   if (imageData.startsWith("data:image/")) {
@@ -449,21 +466,31 @@ void PictureInPictureManager::createPiPFromImageData(const QString &imageData, c
 
   activePiPWindows.append(pipWindow);
 
-  // Clean up when window is destroyed
+  // Closed windows go back to the pool (or are destroyed when it is full); a reused
+  // window may still carry the connections of its previous use
+  disconnect(pipWindow, nullptr, this, nullptr);
+  connect(pipWindow, &MacOSPiPWindow::closed, this, [this, pipWindow]() {
+    activePiPWindows.removeAll(pipWindow);
+  });
   connect(pipWindow, &MacOSPiPWindow::destroyed, this, [this, pipWindow]() {
     activePiPWindows.removeAll(pipWindow);
   });
 
-  qDebug() << "PiP window created for:" << title;
+  qCDebug(lcPiP) << "PiP window created for:" << title;
+  emit pipWindowCreated(pipWindow);
 }
 
 void PictureInPictureManager::createVideoPiP(WebView *webView) {
   if (!webView) {
-    qDebug() << "No WebView provided for video PiP";
+    qCDebug(lcPiP) << "No WebView provided for video PiP";
     return;
   }
 
   connect(webView, &WebView::pipVideoRequested, this, &PictureInPictureManager::createPiPFromVideoData, Qt::UniqueConnection);
+
+  // Define the handler directly instead of through a <script> tag: scripts run in
+  // order, so it is ready for the extraction script without waiting
+  webView->page()->runJavaScript("if (!window.pictureInPictureHandler) {\n" + getEnhancedPiPScript() + "\n}");
   QString script = generateVideoExtractionScript();
   executeVideoJavaScript(webView, script);
 }
@@ -472,7 +499,7 @@ void PictureInPictureManager::onVideoPiPTriggered() {
   if (mainWindow) {
     WebView *currentView = mainWindow->currentWebView();
     if (currentView) {
-      qDebug() << "Video PiP triggered via keyboard shortcut";
+      qCDebug(lcPiP) << "Video PiP triggered via keyboard shortcut";
 
       // Add visual feedback script for video
       QString feedbackScript = R"(
@@ -507,88 +534,60 @@ void PictureInPictureManager::onVideoPiPTriggered() {
               }
             }, 300);
           }, 2000);
+
+          // Resolves once the notification is on screen
+          return new Promise((resolve) => requestAnimationFrame(() => requestAnimationFrame(resolve)));
         })();
       )";
 
-      // Execute feedback script first
-      currentView->page()->runJavaScript(feedbackScript);
-
-      // Then execute video PiP creation after a short delay
-      QTimer::singleShot(200, this, [this, currentView]() {
-        createVideoPiP(currentView);
-      });
+      QPointer<WebView> view(currentView);
+      mainWindow->getPageScriptRunner()
+          ->run(currentView, feedbackScript, FEEDBACK_TIMEOUT_MS)
+          .then(this, [this, view](const PageScriptResult &) {
+            if (view) {
+              createVideoPiP(view);
+            }
+          });
     } else {
-      qDebug() << "No active WebView found for video PiP";
+      qCDebug(lcPiP) << "No active WebView found for video PiP";
     }
   }
 }
 
 QString PictureInPictureManager::generateVideoExtractionScript() const {
   return R"(
-// Load enhanced PiP functionality
+// Runs after the enhanced PiP handler was defined (see createVideoPiP)
 (function() {
-    // Check if PiP handler already exists
-    if (window.pictureInPictureHandler) {
-        console.log('PiP handler already exists, attempting video PiP...');
-        return window.pictureInPictureHandler.forceVideoStreamingPiP();
-    }
-
-    // Load the enhanced PiP script if not loaded
-    if (!window.PIP_CONFIG) {
-        // Insert the enhanced PiP script
-        const script = document.createElement('script');
-        script.textContent = `)" +
-         getEnhancedPiPScript() + R"(`;
-        document.head.appendChild(script);
-
-        // Wait for initialization
-        setTimeout(function() {
-            if (window.pictureInPictureHandler) {
-                console.log('Enhanced PiP handler loaded, attempting video PiP...');
-                return window.pictureInPictureHandler.forceVideoStreamingPiP();
-            } else {
-                console.error('Failed to load enhanced PiP handler');
-                return { success: false, message: 'Failed to load enhanced PiP handler' };
-            }
-        }, 500);
-    } else {
-        // PiP script is loaded, use it
+    function findVideo() {
         if (window.pictureInPictureHandler) {
-            console.log('Using existing PiP handler for video PiP...');
-            return window.pictureInPictureHandler.forceVideoStreamingPiP();
+            const result = window.pictureInPictureHandler.forceVideoStreamingPiP();
+            if (result && result.success) {
+                return result;
+            }
         }
-    }
 
-    // Fallback to basic video detection if enhanced script fails
-    console.log('Falling back to basic video detection...');
-    let targetVideo = null;
-
-    // Find videos
-    const videos = document.querySelectorAll('video');
-    let bestVideo = null;
-    let maxArea = 0;
-
-    for (let video of videos) {
-        const rect = video.getBoundingClientRect();
-        if (rect.width >= 100 && rect.height >= 50 && video.readyState >= 2) {
-            const area = rect.width * rect.height;
-            if (area > maxArea) {
-                maxArea = area;
-                bestVideo = video;
+        // Basic video detection if the enhanced handler finds nothing
+        let targetVideo = null;
+        let maxArea = 0;
+        for (let video of document.querySelectorAll('video')) {
+            const rect = video.getBoundingClientRect();
+            if (rect.width >= 100 && rect.height >= 50 && video.readyState >= 2) {
+                const area = rect.width * rect.height;
+                if (area > maxArea) {
+                    maxArea = area;
+                    targetVideo = video;
+                }
             }
         }
-    }
-    targetVideo = bestVideo;
+        if (!targetVideo) {
+            return null;
+        }
 
-    if (targetVideo) {
         const rect = targetVideo.getBoundingClientRect();
-        let videoUrl = targetVideo.src || targetVideo.currentSrc;
-        let isVideoWithNativePiPDisabled = targetVideo.hasAttribute('disablepictureinpicture');
-
         const result = {
             success: true,
-            videoUrl: videoUrl,
-            isDisabledPiP: isVideoWithNativePiPDisabled,
+            videoUrl: targetVideo.src || targetVideo.currentSrc,
+            isDisabledPiP: targetVideo.hasAttribute('disablepictureinpicture'),
             title: targetVideo.title || 'Selected Video',
             width: rect.width,
             height: rect.height,
@@ -599,27 +598,46 @@ QString PictureInPictureManager::generateVideoExtractionScript() const {
             videoWidth: targetVideo.videoWidth,
             videoHeight: targetVideo.videoHeight
         };
-
         console.log('Basic video PiP extraction result:', result);
         return result;
     }
 
-    return { success: false, message: 'No suitable videos found' };
+    const notFound = { success: false, message: 'No suitable videos found' };
+    const result = findVideo();
+    if (result) {
+        return result;
+    }
+
+    // A visible video without a frame yet: answer as soon as it has one
+    const loading = Array.from(document.querySelectorAll('video')).find(function(video) {
+        const rect = video.getBoundingClientRect();
+        return rect.width >= 100 && rect.height >= 50 && video.readyState < 2;
+    });
+    if (!loading) {
+        return notFound;
+    }
+    return new Promise(function(resolve) {
+        loading.addEventListener('loadeddata', function() {
+            resolve(findVideo() || notFound);
+        }, { once: true });
+    });
 })();
 )";
 }
 
 void PictureInPictureManager::executeVideoJavaScript(WebView *webView, const QString &script) {
   if (!webView) {
-    qDebug() << "Cannot execute video JavaScript: WebView is null";
+    qCWarning(lcPiP) << "Cannot execute video JavaScript: WebView is null";
     return;
   }
 
-  webView->page()->runJavaScript(script, [this](const QVariant &result) {
-    qDebug() << "Video JavaScript execution result received";
+  // A video that is still loading answers when it has a frame, so allow for that
+  PageScriptRunner *runner = mainWindow->getPageScriptRunner();
+  runner->run(webView, script, VIDEO_READY_TIMEOUT_MS).then(this, [this](const PageScriptResult &result) {
+    qCDebug(lcPiP) << "Video JavaScript execution result received, status" << result.status;
 
-    QVariantMap resultMap = result.toMap();
-    qDebug() << "JavaScript result map:" << resultMap;
+    QVariantMap resultMap = result.value.toMap();
+    qCDebug(lcPiP) << "JavaScript result map:" << resultMap;
 
     if (resultMap.contains("success") && resultMap["success"].toBool()) {
       QString title = resultMap["title"].toString();
@@ -627,20 +645,20 @@ void PictureInPictureManager::executeVideoJavaScript(WebView *webView, const QSt
       QString videoData = resultMap["videoData"].toString();
       bool isDisabledPiP = resultMap["isDisabledPiP"].toBool();
 
-      qDebug() << "Video PiP extraction successful:";
-      qDebug() << "  Title:" << title;
-      qDebug() << "  URL:" << videoUrl;
-      qDebug() << "  Has VideoData:" << !videoData.isEmpty();
-      qDebug() << "  Is Disabled PiP:" << isDisabledPiP;
-      qDebug() << "  Width:" << resultMap["width"].toInt();
-      qDebug() << "  Height:" << resultMap["height"].toInt();
-      qDebug() << "  Duration:" << resultMap["duration"].toDouble();
-      qDebug() << "  Ready State:" << resultMap["readyState"].toInt();
+      qCDebug(lcPiP) << "Video PiP extraction successful:";
+      qCDebug(lcPiP) << "  Title:" << title;
+      qCDebug(lcPiP) << "  URL:" << videoUrl;
+      qCDebug(lcPiP) << "  Has VideoData:" << !videoData.isEmpty();
+      qCDebug(lcPiP) << "  Is Disabled PiP:" << isDisabledPiP;
+      qCDebug(lcPiP) << "  Width:" << resultMap["width"].toInt();
+      qCDebug(lcPiP) << "  Height:" << resultMap["height"].toInt();
+      qCDebug(lcPiP) << "  Duration:" << resultMap["duration"].toDouble();
+      qCDebug(lcPiP) << "  Ready State:" << resultMap["readyState"].toInt();
 
       // Handle different types of video data
       if (!videoData.isEmpty()) {
         // We have additional video data (Base64, Blob data, or frame capture)
-        qDebug() << "PiP: Processing video with additional data for disablepictureinpicture video";
+        qCDebug(lcPiP) << "PiP: Processing video with additional data for disablepictureinpicture video";
         if (videoData.startsWith("data:image/")) {
           // This is a captured frame - show as image PiP
           createPiPFromImageData(videoData, title + " (フレームキャプチャ)");
@@ -652,22 +670,22 @@ void PictureInPictureManager::executeVideoJavaScript(WebView *webView, const QSt
           createPiPFromVideoData(videoUrl, title);
         }
       } else if (!videoUrl.isEmpty()) {
-        qDebug() << "PiP: Processing video URL:" << videoUrl << "with title:" << title;
+        qCDebug(lcPiP) << "PiP: Processing video URL:" << videoUrl << "with title:" << title;
         createPiPFromVideoData(videoUrl, title);
       } else {
-        qDebug() << "PiP: No video URL or data found in successful result";
+        qCDebug(lcPiP) << "PiP: No video URL or data found in successful result";
         createPiPFromVideoData("demo://test-video", title + " - 動画データが見つかりませんでした");
       }
     } else {
       QString errorMsg = resultMap["message"].toString();
-      qDebug() << "PiP: Video JavaScript execution failed or no videos found. Error:" << errorMsg;
+      qCDebug(lcPiP) << "PiP: Video JavaScript execution failed or no videos found. Error:" << errorMsg;
       createPiPFromVideoData("demo://test-video", "Test Video - 動画が見つかりませんでした");
     }
   });
 }
 
 void PictureInPictureManager::createPiPFromVideoData(const QString &videoData, const QString &title) {
-  MacOSPiPWindow *pipWindow = new MacOSPiPWindow();
+  MacOSPiPWindow *pipWindow = PiPWindowPool::instance()->acquire();
 
   // Check if videoData is Base64 or URL
   if (videoData.startsWith("data:video/")) {
@@ -680,12 +698,18 @@ void PictureInPictureManager::createPiPFromVideoData(const QString &videoData, c
 
   activePiPWindows.append(pipWindow);
 
-  // Clean up when window is destroyed
+  // Closed windows go back to the pool (or are destroyed when it is full); a reused
+  // window may still carry the connections of its previous use
+  disconnect(pipWindow, nullptr, this, nullptr);
+  connect(pipWindow, &MacOSPiPWindow::closed, this, [this, pipWindow]() {
+    activePiPWindows.removeAll(pipWindow);
+  });
   connect(pipWindow, &MacOSPiPWindow::destroyed, this, [this, pipWindow]() {
     activePiPWindows.removeAll(pipWindow);
   });
 
-  qDebug() << "Video PiP window created for:" << title;
+  qCDebug(lcPiP) << "Video PiP window created for:" << title;
+  emit pipWindowCreated(pipWindow);
 }
 
 void PictureInPictureManager::cleanupClosedPiPWindows() {
@@ -35,6 +35,9 @@ public:
   QAction *getImagePiPAction() const { return imagePiPAction; }
   QAction *getVideoPiPAction() const { return videoPiPAction; }
 
+signals:
+  void pipWindowCreated(MacOSPiPWindow *window);
+
 private slots:
   void onImagePiPTriggered();
   void onVideoPiPTriggered();
@@ -0,0 +1,145 @@
+#include "pipmedialoader.h"
+#include "../logging/logcategories.h"
+#include "../profile/browserprofile.h"
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QImageReader>
+#include <QNetworkAccessManager>
+#include <QNetworkDiskCache>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QStandardPaths>
+#include <QWebEngineProfile>
+
+namespace {
+const qint64 DISK_CACHE_BYTES = 100 * 1024 * 1024;
+const int REQUEST_TIMEOUT_MS = 10000;
+
+// Decodes at most maxSize (keeping the aspect ratio); never scales up
+QImage decodeScaled(const QByteArray &data, const QSize &maxSize, QString *error) {
+  QBuffer buffer;
+  buffer.setData(data);
+  buffer.open(QIODevice::ReadOnly);
+
+  QImageReader reader(&buffer);
+  reader.setAutoTransform(true);
+  const QSize fullSize = reader.size();
+  if (fullSize.isValid() && maxSize.isValid() &&
+      (fullSize.width() > maxSize.width() || fullSize.height() > maxSize.height())) {
+    // JPEG and friends decode straight to the smaller size instead of scaling afterwards
+    reader.setScaledSize(fullSize.scaled(maxSize, Qt::KeepAspectRatio));
+  }
+
+  const QImage image = reader.read();
+  if (image.isNull()) {
+    *error = reader.errorString();
+  }
+  return image;
+}
+} // namespace
+
+PiPMediaLoader *PiPMediaLoader::instance() {
+  // Parented to the application so it outlives every PiP window
+  static PiPMediaLoader *loader = new PiPMediaLoader(QCoreApplication::instance());
+  return loader;
+}
+
+PiPMediaLoader::PiPMediaLoader(QObject *parent) : QObject(parent), nextDecodeId(1) {
+  network = new QNetworkAccessManager(this);
+
+  QNetworkDiskCache *cache = new QNetworkDiskCache(network);
+  cache->setCacheDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/pip-media");
+  cache->setMaximumCacheSize(DISK_CACHE_BYTES);
+  network->setCache(cache);
+}
+
+void PiPMediaLoader::loadImage(const QUrl &url, const QSize &maxSize, QObject *context, ImageCallback callback) {
+  auto existing = inFlight.find(url);
+  if (existing != inFlight.end()) {
+    // Already being fetched for another window: wait for the same reply
+    existing->append({context, maxSize, callback});
+    return;
+  }
+  inFlight.insert(url, {{context, maxSize, callback}});
+
+  QNetworkRequest request(url);
+  request.setHeader(QNetworkRequest::UserAgentHeader, BrowserProfile::instance()->profile()->httpUserAgent());
+  request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferCache);
+  request.setTransferTimeout(REQUEST_TIMEOUT_MS);
+
+  QNetworkReply *reply = network->get(request);
+  connect(reply, &QNetworkReply::finished, this, [this, reply]() { onReplyFinished(reply); });
+}
+
+void PiPMediaLoader::onReplyFinished(QNetworkReply *reply) {
+  reply->deleteLater();
+  const QList<Waiter> waiters = inFlight.take(reply->request().url());
+
+  if (reply->error() != QNetworkReply::NoError) {
+    const QString error = reply->errorString();
+    for (const Waiter &waiter : waiters) {
+      if (waiter.context) {
+        waiter.callback(QImage(), error);
+      }
+    }
+    return;
+  }
+
+  qCDebug(lcPiP) << "PiPMediaLoader:" << reply->url()
+                 << (reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool() ? "from cache" : "fetched")
+                 << "for" << waiters.size() << "window(s)";
+
+  const QByteArray data = reply->readAll();
+  for (const Waiter &waiter : waiters) {
+    if (waiter.context) { // Windows closed while loading need no decode
+      decodeImage(data, waiter.maxSize, waiter.context, waiter.callback);
+    }
+  }
+}
+
+void PiPMediaLoader::decodeImage(const QByteArray &data, const QSize &maxSize, QObject *context,
+                                 ImageCallback callback) {
+  // Only the newest image of a window is worth decoding
+  cancelDecode(context);
+
+  // The user is waiting for this window: decode ahead of background work
+  const quint64 id = nextDecodeId++;
+  QPointer<QObject> guard(context);
+  const auto decode = [this, guard, context, id, data, maxSize, callback](const JobToken &) {
+    QString error;
+    const QImage image = decodeScaled(data, maxSize, &error);
+    QMetaObject::invokeMethod(
+        this,
+        [this, guard, context, id, image, error, callback]() {
+          finishDecode(context, id);
+          if (guard) {
+            callback(image, error);
+          }
+        },
+        Qt::QueuedConnection);
+  };
+
+  Decode &pending = decodes[context];
+  pending.id = id;
+  pending.token = JobScheduler::instance()->submit(JobScheduler::Interactive, decode);
+  // A window closed before its turn needs no decode
+  pending.contextDestroyed = connect(context, &QObject::destroyed, this, [this, context]() { cancelDecode(context); });
+}
+
+void PiPMediaLoader::cancelDecode(QObject *context) {
+  const auto it = decodes.find(context);
+  if (it == decodes.end())
+    return;
+  it->token.cancel();
+  disconnect(it->contextDestroyed);
+  decodes.erase(it);
+}
+
+void PiPMediaLoader::finishDecode(QObject *context, quint64 id) {
+  // A superseded or cancelled decode no longer owns the entry
+  const auto it = decodes.find(context);
+  if (it != decodes.end() && it->id == id) {
+    disconnect(it->contextDestroyed);
+    decodes.erase(it);
+  }
+}
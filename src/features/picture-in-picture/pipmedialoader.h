@@ -0,0 +1,69 @@
+#ifndef PIPMEDIALOADER_H
+#define PIPMEDIALOADER_H
+
+#include "../jobs/jobscheduler.h"
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QMetaObject>
+#include <QObject>
+#include <QPointer>
+#include <QSize>
+#include <QUrl>
+#include <functional>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+/**
+ * @brief Fetches and decodes images for every PiP window
+ *
+ * One QNetworkAccessManager with a QNetworkDiskCache is shared by all
+ * windows, so reopening an image does not hit the network again, and
+ * windows asking for a URL that is already being fetched join that
+ * request. Decoding is an Interactive job on the JobScheduler and uses
+ * QImageReader::setScaledSize, so a large image is only ever decoded at
+ * the size it is shown at. Each context has at most one decode waiting: a
+ * newer image for the same window supersedes it.
+ */
+class PiPMediaLoader : public QObject {
+  Q_OBJECT
+
+public:
+  // image is null on failure; error then says why
+  using ImageCallback = std::function<void(const QImage &image, const QString &error)>;
+
+  static PiPMediaLoader *instance();
+
+  // callback runs on the GUI thread, and only if context is still alive
+  void loadImage(const QUrl &url, const QSize &maxSize, QObject *context, ImageCallback callback);
+  void decodeImage(const QByteArray &data, const QSize &maxSize, QObject *context, ImageCallback callback);
+
+  // Drops the pending decode for context, e.g. when a pooled window is reused
+  void cancelDecode(QObject *context);
+
+private:
+  struct Waiter {
+    QPointer<QObject> context;
+    QSize maxSize;
+    ImageCallback callback;
+  };
+
+  struct Decode {
+    JobToken token;
+    quint64 id = 0;
+    QMetaObject::Connection contextDestroyed;
+  };
+
+  explicit PiPMediaLoader(QObject *parent = nullptr);
+
+  void onReplyFinished(QNetworkReply *reply);
+  void finishDecode(QObject *context, quint64 id);
+
+  QNetworkAccessManager *network;
+  QHash<QUrl, QList<Waiter>> inFlight;
+  QHash<QObject *, Decode> decodes; // Context -> its pending decode
+  quint64 nextDecodeId;
+};
+
+#endif // PIPMEDIALOADER_H
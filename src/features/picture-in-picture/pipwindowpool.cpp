@@ -0,0 +1,98 @@
+#include "pipwindowpool.h"
+#include "../logging/logcategories.h"
+#include "macospipwindow.h"
+#include <QCoreApplication>
+#include <utility>
+
+namespace {
+const int MAX_IDLE = 2;              // Closed windows beyond this are destroyed
+const int KEEP_WARM = 1;             // Spares left after trimming
+const int REFILL_DELAY_MS = 1000;    // Leave the acquiring PiP alone while it loads its media
+const int IDLE_TRIM_MS = 5 * 60 * 1000;
+} // namespace
+
+PiPWindowPool *PiPWindowPool::instance() {
+  // Parented to the application: windows outlive the MainWindow that opened them. The application
+  // object goes away after the multimedia backends, so main() calls shutdown() first
+  static PiPWindowPool *pool = new PiPWindowPool(QCoreApplication::instance());
+  return pool;
+}
+
+PiPWindowPool::PiPWindowPool(QObject *parent) : QObject(parent), shutDown(false) {
+  trimTimer.setSingleShot(true);
+  trimTimer.setInterval(IDLE_TRIM_MS);
+  connect(&trimTimer, &QTimer::timeout, this, &PiPWindowPool::trim);
+}
+
+PiPWindowPool::~PiPWindowPool() {
+  shutdown();
+}
+
+void PiPWindowPool::shutdown() {
+  shutDown = true;
+  trimTimer.stop();
+  idle.clear();
+  const QList<QPointer<MacOSPiPWindow>> created = std::exchange(windows, {});
+  for (const QPointer<MacOSPiPWindow> &window : created) {
+    delete window.data();
+  }
+}
+
+MacOSPiPWindow *PiPWindowPool::acquire() {
+  trimTimer.start(); // Any use postpones trimming
+
+  MacOSPiPWindow *window = nullptr;
+  while (!window && !idle.isEmpty()) {
+    window = idle.takeLast();
+  }
+  if (!window) {
+    window = createWindow();
+  }
+
+  // So a second PiP opened while this one is up does not pay for initialization either
+  QTimer::singleShot(REFILL_DELAY_MS, this, &PiPWindowPool::warmUp);
+  return window;
+}
+
+void PiPWindowPool::warmUp() {
+  if (shutDown)
+    return;
+  idle.removeAll(QPointer<MacOSPiPWindow>());
+  if (idle.isEmpty()) {
+    idle.append(createWindow());
+    qCDebug(lcPiP) << "PiPWindowPool: spare window ready";
+  }
+}
+
+MacOSPiPWindow *PiPWindowPool::createWindow() {
+  MacOSPiPWindow *window = new MacOSPiPWindow();
+  window->setAttribute(Qt::WA_DeleteOnClose, false); // Closing returns it to the pool
+  connect(window, &MacOSPiPWindow::closed, this, [this, window]() { release(window); });
+  windows.removeAll(QPointer<MacOSPiPWindow>());
+  windows.append(window);
+  return window;
+}
+
+void PiPWindowPool::release(MacOSPiPWindow *window) {
+  if (shutDown || idle.contains(window))
+    return;
+
+  window->reset();
+  idle.removeAll(QPointer<MacOSPiPWindow>());
+  if (idle.size() >= MAX_IDLE) {
+    window->deleteLater();
+    return;
+  }
+  idle.append(window);
+  trimTimer.start();
+}
+
+void PiPWindowPool::trim() {
+  idle.removeAll(QPointer<MacOSPiPWindow>());
+  while (idle.size() > KEEP_WARM) {
+    if (MacOSPiPWindow *window = idle.takeFirst()) {
+      window->deleteLater();
+    }
+  }
+  qCDebug(lcPiP) << "PiPWindowPool: trimmed to" << idle.size() << "idle window(s)";
+}
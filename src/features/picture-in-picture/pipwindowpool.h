@@ -0,0 +1,52 @@
+#ifndef PIPWINDOWPOOL_H
+#define PIPWINDOWPOOL_H
+
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+class MacOSPiPWindow;
+
+/**
+ * @brief Keeps hidden, ready-to-use PiP windows
+ *
+ * Constructing a MacOSPiPWindow initializes the multimedia backend
+ * (QMediaPlayer, QAudioOutput, QVideoWidget), which is the slowest part of
+ * showing a PiP. Closed windows are reset and kept here instead of being
+ * destroyed, one spare is prepared in the background after each acquire,
+ * and the spares beyond one are dropped once PiP has not been used for a
+ * while.
+ */
+class PiPWindowPool : public QObject {
+  Q_OBJECT
+
+public:
+  static PiPWindowPool *instance();
+
+  // An idle window if there is one, a new one otherwise; hand it back by closing it
+  MacOSPiPWindow *acquire();
+
+  // Prepares a spare window unless one is already waiting
+  void warmUp();
+
+  int idleCount() const { return idle.size(); }
+
+  // Destroys every window, idle or in use, while the multimedia backends still exist
+  void shutdown();
+
+private:
+  explicit PiPWindowPool(QObject *parent = nullptr);
+  ~PiPWindowPool();
+
+  MacOSPiPWindow *createWindow();
+  void release(MacOSPiPWindow *window);
+  void trim();
+
+  QList<QPointer<MacOSPiPWindow>> idle;
+  QList<QPointer<MacOSPiPWindow>> windows; // Every window the pool created
+  QTimer trimTimer;
+  bool shutDown;
+};
+
+#endif // PIPWINDOWPOOL_H
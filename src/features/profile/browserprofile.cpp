@@ -0,0 +1,137 @@
+#include "browserprofile.h"
+#include "../jobs/jobscheduler.h"
+#include "../logging/logcategories.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QStandardPaths>
+#include <QWebEngineProfile>
+
+namespace {
+const char *PROFILE_NAME = "default";
+const int MIN_CACHE_SIZE_MB = 16;
+const int MAX_CACHE_SIZE_MB = 2047; // httpCacheMaximumSize is an int of bytes
+} // namespace
+
+BrowserProfile *BrowserProfile::instance() {
+  // Parented to the application so it outlives every window and page
+  static BrowserProfile *profile = new BrowserProfile(QCoreApplication::instance());
+  return profile;
+}
+
+BrowserProfile::BrowserProfile(QObject *parent)
+    : QObject(parent), webProfile(nullptr), baselineReady(false) {
+  const QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+  const QString cacheLocation = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+  QDir().mkpath(appDataPath);
+  policyPath = appDataPath + "/profile.json";
+  loadPolicy();
+
+  webProfile = new QWebEngineProfile(PROFILE_NAME, this);
+  webProfile->setPersistentStoragePath(appDataPath + "/profile/" + PROFILE_NAME);
+  webProfile->setCachePath(cacheLocation + "/profile/" + PROFILE_NAME);
+  webProfile->setHttpCacheType(QWebEngineProfile::DiskHttpCache);
+  webProfile->setPersistentCookiesPolicy(QWebEngineProfile::AllowPersistentCookies);
+  applyPolicy();
+
+  // Snapshot the cache off the UI thread so eviction can be reported later; a
+  // directory walk competes with page loads, so it waits until they settle
+  const QString cachePath = webProfile->cachePath();
+  JobScheduler::instance()->submit(JobScheduler::Background, [this, cachePath](const JobToken &) {
+    QHash<QString, qint64> entries = scanCache(cachePath);
+    QMutexLocker locker(&baselineMutex);
+    baseline = std::move(entries);
+    baselineReady = true;
+  });
+}
+
+void BrowserProfile::loadPolicy() {
+  QFile file(policyPath);
+  if (!file.open(QIODevice::ReadOnly))
+    return;
+
+  const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+  policy.maximumSizeMB = root["httpCacheMaximumSizeMB"].toInt(policy.maximumSizeMB);
+  policy.clearOnExit = root["clearCacheOnExit"].toBool(policy.clearOnExit);
+}
+
+void BrowserProfile::savePolicy() const {
+  QJsonObject root;
+  root["httpCacheMaximumSizeMB"] = policy.maximumSizeMB;
+  root["clearCacheOnExit"] = policy.clearOnExit;
+
+  QFile file(policyPath);
+  if (file.open(QIODevice::WriteOnly)) {
+    file.write(QJsonDocument(root).toJson());
+  }
+}
+
+void BrowserProfile::applyPolicy() {
+  policy.maximumSizeMB = qBound(MIN_CACHE_SIZE_MB, policy.maximumSizeMB, MAX_CACHE_SIZE_MB);
+  webProfile->setHttpCacheMaximumSize(policy.maximumSizeMB * 1024 * 1024);
+}
+
+void BrowserProfile::setCachePolicy(const CachePolicy &newPolicy) {
+  policy = newPolicy;
+  applyPolicy();
+  savePolicy();
+  emit cachePolicyChanged();
+}
+
+QHash<QString, qint64> BrowserProfile::scanCache(const QString &path) {
+  QHash<QString, qint64> entries;
+  QDirIterator it(path, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+  while (it.hasNext()) {
+    it.next();
+    entries.insert(it.filePath(), it.fileInfo().size());
+  }
+  return entries;
+}
+
+CacheReport BrowserProfile::cacheReport() {
+  CacheReport report;
+  report.path = webProfile->cachePath();
+  report.limitBytes = qint64(webProfile->httpCacheMaximumSize());
+
+  const QHash<QString, qint64> current = scanCache(report.path);
+  report.entries = current.size();
+  for (qint64 size : current) {
+    report.sizeBytes += size;
+  }
+
+  QMutexLocker locker(&baselineMutex);
+  report.baselineReady = baselineReady;
+  for (auto it = baseline.cbegin(); it != baseline.cend(); ++it) {
+    if (!current.contains(it.key())) {
+      ++report.evictedEntries;
+      report.evictedBytes += it.value();
+    }
+  }
+  return report;
+}
+
+void BrowserProfile::clearCache() {
+  webProfile->clearHttpCache();
+}
+
+void BrowserProfile::shutdown() {
+  // JobScheduler::shutdown() has run by now: the start-up snapshot is done or was dropped
+  const CacheReport report = cacheReport();
+  qCInfo(lcProfile).noquote()
+      << QString("HTTP cache: %1 / %2 MB in %3 entries, %4 entries (%5 MB) evicted this session")
+             .arg(report.sizeBytes / (1024.0 * 1024.0), 0, 'f', 1)
+             .arg(report.limitBytes / (1024 * 1024))
+             .arg(report.entries)
+             .arg(report.evictedEntries)
+             .arg(report.evictedBytes / (1024.0 * 1024.0), 0, 'f', 1);
+
+  if (policy.clearOnExit) {
+    webProfile->clearHttpCache();
+    webProfile->clearAllVisitedLinks();
+  }
+}
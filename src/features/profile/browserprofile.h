@@ -0,0 +1,81 @@
+#ifndef BROWSERPROFILE_H
+#define BROWSERPROFILE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+
+class QWebEngineProfile;
+
+/**
+ * @brief HTTP cache settings, stored in <AppData>/profile.json
+ */
+struct CachePolicy {
+  int maximumSizeMB = 512;
+  bool clearOnExit = false;
+};
+
+/**
+ * @brief Disk usage of the HTTP cache compared with the start of the session
+ *
+ * Entries present at start-up but gone now were evicted (or cleared).
+ */
+struct CacheReport {
+  QString path;
+  qint64 sizeBytes = 0;
+  int entries = 0;
+  qint64 limitBytes = 0;
+  int evictedEntries = 0;
+  qint64 evictedBytes = 0;
+  bool baselineReady = false;
+};
+
+/**
+ * @brief The persistent, named WebEngine profile shared by every tab
+ *
+ * QWebEngineProfile::defaultProfile() is off-the-record, so its cache never
+ * survives a restart. This profile keeps cookies, storage and a size-bounded
+ * disk cache under the app data and cache locations.
+ */
+class BrowserProfile : public QObject {
+  Q_OBJECT
+
+public:
+  static BrowserProfile *instance();
+
+  QWebEngineProfile *profile() const { return webProfile; }
+
+  CachePolicy cachePolicy() const { return policy; }
+  void setCachePolicy(const CachePolicy &newPolicy);
+
+  // Scans the cache directory; call sparingly
+  CacheReport cacheReport();
+
+  void clearCache();
+
+  // Applies clear-on-exit and logs the session's cache report
+  void shutdown();
+
+signals:
+  void cachePolicyChanged();
+
+private:
+  explicit BrowserProfile(QObject *parent = nullptr);
+
+  void loadPolicy();
+  void savePolicy() const;
+  void applyPolicy();
+  static QHash<QString, qint64> scanCache(const QString &path);
+
+  QWebEngineProfile *webProfile;
+  CachePolicy policy;
+  QString policyPath;
+
+  // Cache entries at start-up, taken on a worker thread
+  mutable QMutex baselineMutex;
+  QHash<QString, qint64> baseline;
+  bool baselineReady;
+};
+
+#endif // BROWSERPROFILE_H
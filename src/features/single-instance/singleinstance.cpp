@@ -0,0 +1,104 @@
+#include "singleinstance.h"
+#include "../logging/logcategories.h"
+#include <QCryptographicHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QStandardPaths>
+
+namespace {
+const int CONNECT_TIMEOUT_MS = 200; // Nothing listening answers at once
+const int REPLY_TIMEOUT_MS = 2000;
+const qint64 MAX_REQUEST_SIZE = 64 * 1024;
+const QByteArray ACK = "ok\n";
+} // namespace
+
+SingleInstance::SingleInstance(QObject *parent) : QObject(parent), server(nullptr) {}
+
+bool SingleInstance::isServing(const QString &name) {
+  QLocalSocket probe;
+  probe.connectToServer(name);
+  return probe.waitForConnected(CONNECT_TIMEOUT_MS);
+}
+
+QString SingleInstance::serverName() {
+  // The profile directory is per user, so two users (or two profiles) never share a socket
+  const QString profile = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+  return "mybrowser-" + QString::fromLatin1(
+                            QCryptographicHash::hash(profile.toUtf8(), QCryptographicHash::Sha1).toHex().left(16));
+}
+
+bool SingleInstance::forward(const QStringList &urls, bool activate) {
+  QLocalSocket socket;
+  socket.connectToServer(serverName());
+  if (!socket.waitForConnected(CONNECT_TIMEOUT_MS))
+    return false;
+
+  QJsonObject request;
+  request["urls"] = QJsonArray::fromStringList(urls);
+  request["activate"] = activate;
+  socket.write(QJsonDocument(request).toJson(QJsonDocument::Compact) + '\n');
+
+  // Wait for the reply so the request isn't dropped when this process exits right away
+  if (!socket.waitForBytesWritten(REPLY_TIMEOUT_MS) || !socket.waitForReadyRead(REPLY_TIMEOUT_MS)) {
+    // Still running, just busy: starting a second engine on the same profile would be worse
+    qCWarning(lcApp) << "SingleInstance: running instance did not answer";
+  }
+  socket.disconnectFromServer();
+  return true;
+}
+
+bool SingleInstance::listen() {
+  server = new QLocalServer(this);
+  server->setSocketOptions(QLocalServer::UserAccessOption);
+  if (!server->listen(serverName())) {
+    // Another launch may have started listening since forward(): leave its socket alone
+    if (isServing(serverName())) {
+      qCDebug(lcApp) << "SingleInstance: another instance started first";
+      delete server;
+      server = nullptr;
+      return false;
+    }
+    // A socket file left by a crashed instance
+    QLocalServer::removeServer(serverName());
+    if (!server->listen(serverName())) {
+      qCWarning(lcApp) << "SingleInstance: cannot listen on" << serverName() << server->errorString();
+      return false;
+    }
+  }
+
+  connect(server, &QLocalServer::newConnection, this, [this]() {
+    while (QLocalSocket *socket = server->nextPendingConnection()) {
+      connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+      connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { readRequest(socket); });
+      readRequest(socket);
+    }
+  });
+  qCDebug(lcApp) << "SingleInstance: listening on" << server->fullServerName();
+  return true;
+}
+
+void SingleInstance::readRequest(QLocalSocket *socket) {
+  if (!socket->canReadLine()) {
+    if (socket->bytesAvailable() > MAX_REQUEST_SIZE) {
+      socket->abort();
+    }
+    return;
+  }
+
+  const QJsonObject request = QJsonDocument::fromJson(socket->readLine().trimmed()).object();
+  socket->write(ACK);
+  socket->flush();
+
+  QStringList urls;
+  for (const QJsonValue &value : request["urls"].toArray()) {
+    const QString url = value.toString();
+    if (!url.isEmpty()) {
+      urls.append(url);
+    }
+  }
+  qCDebug(lcApp) << "SingleInstance: request from a new launch" << urls;
+  emit openRequested(urls, request["activate"].toBool(true));
+}
@@ -0,0 +1,47 @@
+#ifndef SINGLEINSTANCE_H
+#define SINGLEINSTANCE_H
+
+#include <QObject>
+#include <QStringList>
+
+class QLocalServer;
+class QLocalSocket;
+
+/**
+ * @brief Keeps one browser process per profile
+ *
+ * The first launch listens on a per-user local socket named after the
+ * profile directory. Later launches connect to it, send their URLs as one
+ * JSON line and exit without starting Chromium, so opening links from other
+ * applications doesn't boot a second engine that fights over the profile's
+ * JSON files.
+ */
+class SingleInstance : public QObject {
+  Q_OBJECT
+
+public:
+  explicit SingleInstance(QObject *parent = nullptr);
+
+  // True when a running instance took the request; the caller should exit
+  bool forward(const QStringList &urls, bool activate);
+
+  // Starts accepting requests from later launches. False when another
+  // instance got there first (forward() to it) or the socket is unusable
+  bool listen();
+
+  // Someone accepts connections on name (as opposed to a socket file left behind by a crash)
+  static bool isServing(const QString &name);
+
+signals:
+  // activate is false for launches that only meant to keep the browser warm
+  void openRequested(const QStringList &urls, bool activate);
+
+private:
+  void readRequest(QLocalSocket *socket);
+
+  static QString serverName();
+
+  QLocalServer *server;
+};
+
+#endif // SINGLEINSTANCE_H
@@ -0,0 +1,113 @@
+#include "snapshotoverlay.h"
+#include "../logging/logcategories.h"
+#include "../profile/browserprofile.h"
+#include "../webview/webview.h"
+#include <QEvent>
+#include <QLabel>
+#include <QLocale>
+#include <QWebEnginePage>
+#include <QWebEngineProfile>
+#include <QWebEngineSettings>
+#include <QWebEngineView>
+
+namespace {
+const int BADGE_MARGIN = 12;
+
+// Keeps the copy inert: link clicks load in the live view instead
+class SnapshotPage : public QWebEnginePage {
+public:
+  SnapshotPage(WebView *liveView, QObject *parent)
+      : QWebEnginePage(BrowserProfile::instance()->profile(), parent), liveView(liveView) {
+    settings()->setAttribute(QWebEngineSettings::JavascriptEnabled, false);
+  }
+
+protected:
+  bool acceptNavigationRequest(const QUrl &url, NavigationType type, bool isMainFrame) override {
+    if (type == NavigationTypeFormSubmitted)
+      return false;
+    if (type == NavigationTypeLinkClicked && isMainFrame) {
+      liveView->load(url);
+      return false;
+    }
+    return QWebEnginePage::acceptNavigationRequest(url, type, isMainFrame);
+  }
+
+private:
+  WebView *liveView;
+};
+} // namespace
+
+SnapshotOverlay::SnapshotOverlay(WebView *view, const QUrl &url, const QString &snapshotPath,
+                                 const QDateTime &savedAt)
+    : QWidget(view), liveView(view), url(url), snapshotPath(snapshotPath), savedAt(savedAt), snapshotView(nullptr),
+      badge(nullptr), liveFailed(false) {
+  setVisible(false);
+
+  connect(view, &WebView::loadFinished, this, &SnapshotOverlay::onLiveLoadFinished);
+  connect(view, &WebView::urlChanged, this, &SnapshotOverlay::onLiveUrlChanged);
+  view->installEventFilter(this);
+
+  if (view->isVisible()) {
+    showSnapshot();
+  }
+}
+
+bool SnapshotOverlay::eventFilter(QObject *watched, QEvent *event) {
+  if (watched == liveView) {
+    if (event->type() == QEvent::Show && !snapshotView) {
+      showSnapshot();
+    } else if (event->type() == QEvent::Resize && snapshotView) {
+      setGeometry(liveView->rect());
+      snapshotView->setGeometry(rect());
+      badge->move(width() - badge->width() - BADGE_MARGIN, BADGE_MARGIN);
+    }
+  }
+  return QWidget::eventFilter(watched, event);
+}
+
+void SnapshotOverlay::showSnapshot() {
+  qCDebug(lcSnapshots) << "SnapshotOverlay: showing" << snapshotPath << "for" << url;
+
+  snapshotView = new QWebEngineView(this);
+  snapshotView->setPage(new SnapshotPage(liveView, snapshotView));
+  snapshotView->setContextMenuPolicy(Qt::NoContextMenu);
+  snapshotView->load(QUrl::fromLocalFile(snapshotPath));
+
+  badge = new QLabel(QString("Offline copy from %1").arg(QLocale().toString(savedAt, QLocale::ShortFormat)), this);
+  badge->setObjectName("snapshotBadge");
+  badge->adjustSize();
+  badge->setVisible(liveFailed);
+
+  setGeometry(liveView->rect());
+  snapshotView->setGeometry(rect());
+  badge->move(width() - badge->width() - BADGE_MARGIN, BADGE_MARGIN);
+  show();
+  raise();
+}
+
+void SnapshotOverlay::onLiveLoadFinished(bool ok) {
+  if (ok) {
+    dismiss();
+    return;
+  }
+
+  // Offline or the server is down: the copy is all there is
+  liveFailed = true;
+  if (badge) {
+    badge->show();
+    badge->raise();
+  }
+}
+
+void SnapshotOverlay::onLiveUrlChanged(const QUrl &newUrl) {
+  // Before the first load finishes, URL changes are redirects of the restored page
+  if (liveFailed && newUrl.adjusted(QUrl::RemoveFragment) != url.adjusted(QUrl::RemoveFragment)) {
+    dismiss();
+  }
+}
+
+void SnapshotOverlay::dismiss() {
+  liveView->removeEventFilter(this);
+  hide();
+  deleteLater();
+}
@@ -0,0 +1,48 @@
+#ifndef SNAPSHOTOVERLAY_H
+#define SNAPSHOTOVERLAY_H
+
+#include <QDateTime>
+#include <QString>
+#include <QUrl>
+#include <QWidget>
+
+class WebView;
+class QLabel;
+class QWebEngineView;
+
+/**
+ * @brief Shows a saved snapshot over a tab until its live page has loaded
+ *
+ * Covers the view as a child widget instead of replacing its page, so every
+ * feature attached to the tab keeps watching the live page. The snapshot is
+ * only loaded once the tab is first shown; tabs that finish loading in the
+ * background never pay for it. A successful live load removes the overlay. A
+ * failed one keeps it up with a badge saying how old the copy is, until the
+ * tab navigates somewhere else. Links clicked in the snapshot open in the
+ * live view.
+ */
+class SnapshotOverlay : public QWidget {
+  Q_OBJECT
+
+public:
+  SnapshotOverlay(WebView *view, const QUrl &url, const QString &snapshotPath, const QDateTime &savedAt);
+
+protected:
+  bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+  void showSnapshot();
+  void onLiveLoadFinished(bool ok);
+  void onLiveUrlChanged(const QUrl &url);
+  void dismiss();
+
+  WebView *liveView;
+  QUrl url;
+  QString snapshotPath;
+  QDateTime savedAt;
+  QWebEngineView *snapshotView; // Created on first show
+  QLabel *badge;
+  bool liveFailed;
+};
+
+#endif // SNAPSHOTOVERLAY_H
@@ -0,0 +1,60 @@
+#include "tabsnapshotmanager.h"
+#include "../main-window/mainwindow.h"
+#include "../tab-widget/verticaltabwidget.h"
+#include "../webview/webview.h"
+#include "snapshotoverlay.h"
+#include "tabsnapshotstore.h"
+
+namespace {
+const int CAPTURE_DELAY_MS = 15000; // Lets late content and lazy images arrive first
+const int REFRESH_INTERVAL_MS = 5 * 60 * 1000;
+} // namespace
+
+TabSnapshotManager::TabSnapshotManager(MainWindow *parent) : QObject(parent), mainWindow(parent) {
+  refreshTimer.setInterval(REFRESH_INTERVAL_MS);
+  connect(&refreshTimer, &QTimer::timeout, this, &TabSnapshotManager::refreshTabs);
+  refreshTimer.start();
+}
+
+void TabSnapshotManager::attach(WebView *view) {
+  if (!view)
+    return;
+
+  // One timer per tab, so a burst of navigations ends in a single capture
+  QTimer *captureTimer = new QTimer(view);
+  captureTimer->setSingleShot(true);
+  captureTimer->setInterval(CAPTURE_DELAY_MS);
+  connect(captureTimer, &QTimer::timeout, view, [view]() { TabSnapshotStore::instance()->capture(view); });
+  connect(view, &WebView::loadStarted, this, [this, view, captureTimer]() {
+    captureTimer->stop();
+    loadedViews.remove(view);
+  });
+  // A failed load shows an error page under the real URL, which must not replace a good snapshot
+  connect(view, &WebView::loadFinished, this, [this, view, captureTimer](bool ok) {
+    if (ok) {
+      loadedViews.insert(view);
+      captureTimer->start();
+    }
+  });
+  connect(view, &QObject::destroyed, this, [this, view]() { loadedViews.remove(view); });
+}
+
+void TabSnapshotManager::restore(WebView *view, const QUrl &url) {
+  TabSnapshotStore *store = TabSnapshotStore::instance();
+  const QString path = store->snapshotPath(url);
+  if (!path.isEmpty()) {
+    new SnapshotOverlay(view, url, path, store->snapshotTime(url));
+  }
+  view->load(url);
+}
+
+void TabSnapshotManager::refreshTabs() {
+  VerticalTabWidget *tabs = mainWindow->getTabWidget();
+  for (int i = 0; i < tabs->count(); ++i) {
+    // The store skips pages whose snapshot is still fresh
+    WebView *view = qobject_cast<WebView *>(tabs->widget(i));
+    if (view && loadedViews.contains(view)) {
+      TabSnapshotStore::instance()->capture(view);
+    }
+  }
+}
@@ -0,0 +1,40 @@
+#ifndef TABSNAPSHOTMANAGER_H
+#define TABSNAPSHOTMANAGER_H
+
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+#include <QUrl>
+
+class MainWindow;
+class WebView;
+
+/**
+ * @brief Keeps snapshots of a window's tabs current and shows them on restore
+ *
+ * A tab is captured a little while after each successful load, once the page
+ * has settled, and open tabs are revisited periodically so long-lived ones
+ * stay fresh. TabSnapshotStore skips pages whose snapshot is still recent.
+ */
+class TabSnapshotManager : public QObject {
+  Q_OBJECT
+
+public:
+  explicit TabSnapshotManager(MainWindow *parent = nullptr);
+
+  // Called for every new tab
+  void attach(WebView *view);
+
+  // Loads url in the view, showing its snapshot (if any) until the live page is there
+  void restore(WebView *view, const QUrl &url);
+
+private slots:
+  void refreshTabs();
+
+private:
+  MainWindow *mainWindow;
+  QTimer refreshTimer;
+  QSet<WebView *> loadedViews; // Tabs whose last load succeeded
+};
+
+#endif // TABSNAPSHOTMANAGER_H
@@ -0,0 +1,341 @@
+#include "tabsnapshotstore.h"
+#include "../jobs/jobscheduler.h"
+#include "../logging/logcategories.h"
+#include "../profile/browserprofile.h"
+#include "../webview/webview.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QWebEngineDownloadRequest>
+#include <QWebEngineProfile>
+#include <algorithm>
+
+namespace {
+const qint64 MAX_SNAPSHOT_SIZE = 20 * 1024 * 1024; // Larger pages are not worth keeping
+const qint64 MAX_TOTAL_SIZE = 200 * 1024 * 1024;
+const int MAX_SNAPSHOTS = 500;
+const qint64 REFRESH_INTERVAL_MS = 10 * 60 * 1000; // A snapshot younger than this is not taken again
+const int PENDING_TIMEOUT_MS = 30000;              // Save that never produced a download request
+const int HASH_SIZE = 20;                          // SHA-1
+const int SAVE_DELAY_MS = 2000;
+const QByteArray CONTENT_ID_SUFFIX = "@mhtml.blink";
+
+bool isContentIdChar(char c) {
+  return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '-';
+}
+} // namespace
+
+TabSnapshotStore *TabSnapshotStore::instance() {
+  // Parented to the application so it outlives every window
+  static TabSnapshotStore *store = new TabSnapshotStore(QCoreApplication::instance());
+  return store;
+}
+
+TabSnapshotStore::TabSnapshotStore(QObject *parent) : QObject(parent), pendingCounter(0) {
+  directory = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/snapshots";
+  QDir().mkpath(directory);
+
+  saveTimer.setSingleShot(true);
+  saveTimer.setInterval(SAVE_DELAY_MS);
+  connect(&saveTimer, &QTimer::timeout, this, &TabSnapshotStore::save);
+
+  pendingTimeout.setSingleShot(true);
+  pendingTimeout.setInterval(PENDING_TIMEOUT_MS);
+  connect(&pendingTimeout, &QTimer::timeout, this, [this]() {
+    qCWarning(lcSnapshots) << "TabSnapshotStore: no save request for" << pendingKey;
+    pendingPath.clear();
+    captureNext();
+  });
+
+  connect(BrowserProfile::instance()->profile(), &QWebEngineProfile::downloadRequested, this,
+          &TabSnapshotStore::onDownloadRequested);
+
+  load();
+}
+
+TabSnapshotStore::~TabSnapshotStore() {
+  if (saveTimer.isActive()) {
+    save();
+  }
+}
+
+void TabSnapshotStore::capture(WebView *view) {
+  if (!view || queue.contains(view))
+    return;
+  queue.append(view);
+  captureNext();
+}
+
+bool TabSnapshotStore::isStale(const QUrl &url) const {
+  const auto it = entries.constFind(pageKey(url));
+  return it == entries.constEnd() || QDateTime::currentMSecsSinceEpoch() - it->savedAt > REFRESH_INTERVAL_MS;
+}
+
+QString TabSnapshotStore::snapshotPath(const QUrl &url) const {
+  const auto it = entries.constFind(pageKey(url));
+  return it == entries.constEnd() ? QString() : filePath(it->hash);
+}
+
+QDateTime TabSnapshotStore::snapshotTime(const QUrl &url) const {
+  const auto it = entries.constFind(pageKey(url));
+  return it == entries.constEnd() ? QDateTime() : QDateTime::fromMSecsSinceEpoch(it->savedAt);
+}
+
+bool TabSnapshotStore::ownsDownload(QWebEngineDownloadRequest *request) const {
+  if (pendingPath.isEmpty() || !request->isSavePageDownload())
+    return false;
+  const QString path = QDir(request->downloadDirectory()).filePath(request->downloadFileName());
+  return QDir::cleanPath(path) == QDir::cleanPath(pendingPath);
+}
+
+QString TabSnapshotStore::pageKey(const QUrl &url) {
+  return url.adjusted(QUrl::RemoveFragment).toString();
+}
+
+QString TabSnapshotStore::filePath(const QByteArray &hash) const {
+  return directory + "/" + QString::fromLatin1(hash.toHex()) + ".mht";
+}
+
+void TabSnapshotStore::captureNext() {
+  // One save at a time: each one serializes the whole page in the renderer
+  if (!pendingPath.isEmpty())
+    return;
+
+  while (!queue.isEmpty()) {
+    const QPointer<WebView> view = queue.takeFirst();
+    if (!view)
+      continue;
+    const QUrl url = view->url();
+    if ((url.scheme() != "http" && url.scheme() != "https") || !isStale(url))
+      continue;
+
+    pendingKey = pageKey(url);
+    pendingPath = directory + QString("/pending-%1.mht").arg(++pendingCounter);
+    pendingTimeout.start();
+    view->page()->save(pendingPath, QWebEngineDownloadRequest::MimeHtmlSaveFormat);
+    return;
+  }
+}
+
+void TabSnapshotStore::onDownloadRequested(QWebEngineDownloadRequest *request) {
+  if (!ownsDownload(request))
+    return;
+
+  pendingTimeout.stop();
+  connect(request, &QWebEngineDownloadRequest::isFinishedChanged, this, [this, request]() {
+    finishCapture(request->state() == QWebEngineDownloadRequest::DownloadCompleted);
+  });
+  request->accept();
+}
+
+void TabSnapshotStore::finishCapture(bool ok) {
+  const QString path = pendingPath;
+  const QString key = pendingKey;
+  if (!ok) {
+    qCDebug(lcSnapshots) << "TabSnapshotStore: save failed for" << key;
+    QFile::remove(path);
+    pendingPath.clear();
+    captureNext();
+    return;
+  }
+
+  // Hash and rename on a worker thread; a snapshot can be several megabytes. Nobody
+  // waits for it, so it runs when the user is not typing or loading pages
+  const QString dir = directory;
+  QPointer<TabSnapshotStore> self(this);
+  JobScheduler::instance()->submit(JobScheduler::Background, [self, path, key, dir](const JobToken &) {
+    QByteArray hash;
+    qint64 size = QFileInfo(path).size();
+    QFile file(path);
+    if (size > 0 && size <= MAX_SNAPSHOT_SIZE && file.open(QIODevice::ReadOnly)) {
+      hash = contentHash(file.readAll());
+      file.close();
+      const QString target = dir + "/" + QString::fromLatin1(hash.toHex()) + ".mht";
+      // Same content as an existing snapshot: keep that file
+      if (QFile::exists(target)) {
+        QFile::remove(path);
+      } else if (!QFile::rename(path, target)) {
+        hash.clear();
+      }
+    }
+    if (hash.isEmpty()) {
+      QFile::remove(path);
+    }
+    QMetaObject::invokeMethod(
+        QCoreApplication::instance(),
+        [self, key, hash, size]() {
+          if (!self)
+            return;
+          self->pendingPath.clear();
+          if (hash.isEmpty()) {
+            qCDebug(lcSnapshots) << "TabSnapshotStore: skipped" << key << size << "bytes";
+          } else {
+            self->storeSnapshot(key, hash, size);
+          }
+          self->captureNext();
+        },
+        Qt::QueuedConnection);
+  });
+}
+
+void TabSnapshotStore::storeSnapshot(const QString &key, const QByteArray &hash, qint64 size) {
+  Entry &entry = entries[key];
+  const QByteArray previous = entry.hash;
+  entry.hash = hash;
+  entry.size = size;
+  entry.savedAt = QDateTime::currentMSecsSinceEpoch();
+  if (!previous.isEmpty() && previous != hash) {
+    releaseFile(previous);
+  }
+
+  qCDebug(lcSnapshots) << "TabSnapshotStore: saved" << key << size << "bytes"
+                       << (previous == hash ? "(unchanged)" : "");
+  evict();
+  scheduleSave();
+  emit snapshotSaved(QUrl(key));
+}
+
+void TabSnapshotStore::releaseFile(const QByteArray &hash) {
+  for (const Entry &entry : std::as_const(entries)) {
+    if (entry.hash == hash)
+      return;
+  }
+  QFile::remove(filePath(hash));
+}
+
+QByteArray TabSnapshotStore::contentHash(const QByteArray &mhtml) {
+  // Blink writes a new Date header, boundary and set of Content-IDs on every save.
+  // Leaving them out makes an unchanged page hash the same; a Content-ID split by
+  // quoted-printable line wrapping only costs a missed match.
+  QByteArray data = mhtml;
+  qsizetype headerEnd = data.indexOf("\r\n\r\n");
+  const qsizetype date = data.indexOf("\r\nDate: ");
+  if (date >= 0 && date < headerEnd) {
+    const qsizetype lineEnd = data.indexOf("\r\n", date + 2);
+    data.remove(date, lineEnd - date);
+    headerEnd -= lineEnd - date;
+  }
+  const qsizetype boundaryStart = data.indexOf("boundary=\"");
+  if (boundaryStart >= 0 && boundaryStart < headerEnd) {
+    const qsizetype valueStart = boundaryStart + 10;
+    const qsizetype valueEnd = data.indexOf('"', valueStart);
+    if (valueEnd > valueStart) {
+      data.replace(data.mid(valueStart, valueEnd - valueStart), QByteArrayLiteral("boundary"));
+    }
+  }
+
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  const QByteArrayView view(data);
+  qsizetype position = 0;
+  for (qsizetype suffix = data.indexOf(CONTENT_ID_SUFFIX); suffix >= 0;
+       suffix = data.indexOf(CONTENT_ID_SUFFIX, position)) {
+    qsizetype start = suffix;
+    while (start > position && isContentIdChar(data.at(start - 1))) {
+      --start;
+    }
+    hash.addData(view.sliced(position, start - position));
+    position = suffix + CONTENT_ID_SUFFIX.size();
+  }
+  hash.addData(view.sliced(position));
+  return hash.result();
+}
+
+void TabSnapshotStore::evict() {
+  QHash<QByteArray, int> references;
+  qint64 total = 0;
+  for (const Entry &entry : std::as_const(entries)) {
+    if (references[entry.hash]++ == 0) {
+      total += entry.size;
+    }
+  }
+  if (total <= MAX_TOTAL_SIZE && entries.size() <= MAX_SNAPSHOTS)
+    return;
+
+  QList<QPair<qint64, QString>> byAge;
+  byAge.reserve(entries.size());
+  for (auto it = entries.cbegin(); it != entries.cend(); ++it) {
+    byAge.append({it->savedAt, it.key()});
+  }
+  std::sort(byAge.begin(), byAge.end());
+
+  for (const auto &[savedAt, key] : std::as_const(byAge)) {
+    if (total <= MAX_TOTAL_SIZE && entries.size() <= MAX_SNAPSHOTS)
+      break;
+    const Entry entry = entries.take(key);
+    if (--references[entry.hash] == 0) {
+      QFile::remove(filePath(entry.hash));
+      total -= entry.size;
+    }
+  }
+  qCDebug(lcSnapshots) << "TabSnapshotStore: evicted down to" << entries.size() << "snapshots," << total << "bytes";
+}
+
+void TabSnapshotStore::load() {
+  QFile indexFile(directory + "/index.json");
+  if (indexFile.open(QIODevice::ReadOnly)) {
+    const QJsonObject pageObject = QJsonDocument::fromJson(indexFile.readAll()).object()["pages"].toObject();
+    for (auto it = pageObject.begin(); it != pageObject.end(); ++it) {
+      const QJsonObject obj = it.value().toObject();
+      Entry entry;
+      entry.hash = QByteArray::fromHex(obj["hash"].toString().toLatin1());
+      entry.size = qint64(obj["size"].toDouble());
+      entry.savedAt = qint64(obj["savedAt"].toDouble());
+      if (entry.hash.size() == HASH_SIZE && QFile::exists(filePath(entry.hash))) {
+        entries.insert(it.key(), entry);
+      }
+    }
+  }
+  removeOrphans();
+  evict();
+
+  qCDebug(lcSnapshots) << "TabSnapshotStore:" << entries.size() << "snapshots";
+}
+
+void TabSnapshotStore::removeOrphans() {
+  // Files no entry points at: saves cut short by a crash, or an index that was lost
+  QSet<QString> live;
+  for (const Entry &entry : std::as_const(entries)) {
+    live.insert(QFileInfo(filePath(entry.hash)).fileName());
+  }
+  const QStringList files = QDir(directory).entryList({"*.mht"}, QDir::Files);
+  for (const QString &name : files) {
+    if (!live.contains(name)) {
+      QFile::remove(directory + "/" + name);
+    }
+  }
+}
+
+void TabSnapshotStore::scheduleSave() {
+  if (!saveTimer.isActive()) {
+    saveTimer.start();
+  }
+}
+
+void TabSnapshotStore::save() {
+  saveTimer.stop();
+
+  QJsonObject pageObject;
+  for (auto it = entries.cbegin(); it != entries.cend(); ++it) {
+    QJsonObject obj;
+    obj["hash"] = QString::fromLatin1(it->hash.toHex());
+    obj["size"] = double(it->size);
+    obj["savedAt"] = double(it->savedAt);
+    pageObject[it.key()] = obj;
+  }
+
+  QJsonObject root;
+  root["pages"] = pageObject;
+
+  QSaveFile file(directory + "/index.json");
+  if (file.open(QIODevice::WriteOnly)) {
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    file.commit();
+  }
+}
@@ -0,0 +1,88 @@
+#ifndef TABSNAPSHOTSTORE_H
+#define TABSNAPSHOTSTORE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+#include <QUrl>
+
+class WebView;
+class QWebEngineDownloadRequest;
+
+/**
+ * @brief MHTML snapshots of open pages, used to show a tab before it has loaded
+ *
+ * Pages are saved with QWebEnginePage::save in MimeHtmlSaveFormat, one save
+ * at a time. Each file is named after the SHA-1 of its content with the
+ * per-save noise (Date header, multipart boundary, Content-IDs) left out, so
+ * an unchanged page is not written again and identical pages share a file.
+ * index.json maps page URLs to those files. A single snapshot is capped at
+ * MAX_SNAPSHOT_SIZE and the store as a whole at MAX_TOTAL_SIZE; the oldest
+ * snapshots are evicted first.
+ */
+class TabSnapshotStore : public QObject {
+  Q_OBJECT
+
+public:
+  static TabSnapshotStore *instance();
+
+  // Queues a snapshot of the page the view shows; no-op unless it is http(s) and stale
+  void capture(WebView *view);
+
+  // True when the page has no snapshot or it is older than the refresh interval
+  bool isStale(const QUrl &url) const;
+
+  // Empty when the page has no snapshot
+  QString snapshotPath(const QUrl &url) const;
+  QDateTime snapshotTime(const QUrl &url) const;
+
+  // Save-page requests started by capture(); DownloadManager leaves them alone
+  bool ownsDownload(QWebEngineDownloadRequest *request) const;
+
+  void save();
+
+signals:
+  void snapshotSaved(const QUrl &url);
+
+private:
+  struct Entry {
+    QByteArray hash;
+    qint64 size = 0;
+    qint64 savedAt = 0;
+  };
+
+  explicit TabSnapshotStore(QObject *parent = nullptr);
+  ~TabSnapshotStore();
+
+  void load();
+  void removeOrphans();
+  void captureNext();
+  void onDownloadRequested(QWebEngineDownloadRequest *request);
+  void finishCapture(bool ok);
+  void storeSnapshot(const QString &key, const QByteArray &hash, qint64 size);
+  void releaseFile(const QByteArray &hash);
+  void evict();
+  void scheduleSave();
+  QString filePath(const QByteArray &hash) const;
+
+  static QString pageKey(const QUrl &url);
+  static QByteArray contentHash(const QByteArray &mhtml);
+
+  QString directory;
+  QHash<QString, Entry> entries; // Page URL -> snapshot
+
+  QList<QPointer<WebView>> queue;
+  QString pendingPath; // Save in flight, empty when idle
+  QString pendingKey;
+  QTimer pendingTimeout;
+  int pendingCounter;
+
+  QTimer saveTimer;
+};
+
+#endif // TABSNAPSHOTSTORE_H
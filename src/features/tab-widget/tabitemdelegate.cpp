@@ -0,0 +1,143 @@
+#include "tabitemdelegate.h"
+#include "../../core/ui_constants.h"
+#include "../theme/theme.h"
+#include <QIcon>
+#include <QMouseEvent>
+#include <QPainter>
+
+namespace {
+const int ROW_WIDTH = 240;
+const int ROW_MARGIN = 2;     // Vertical gap between rows
+const int ROW_PADDING = 8;    // Inside the row, left and right
+const int ACCENT_WIDTH = 3;   // Selection bar on the left edge
+const int CLOSE_SIZE = 20;
+const int ROW_RADIUS = 4;
+} // namespace
+
+TabItemDelegate::TabItemDelegate(QAbstractItemView *view) : QStyledItemDelegate(view), view(view), closable(false) {
+  view->setMouseTracking(true);
+  view->viewport()->installEventFilter(this);
+}
+
+QRect TabItemDelegate::closeRect(const QRect &rowRect) {
+  return QRect(rowRect.right() - ROW_PADDING - CLOSE_SIZE + 1, rowRect.center().y() - CLOSE_SIZE / 2, CLOSE_SIZE,
+               CLOSE_SIZE);
+}
+
+void TabItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const {
+  using namespace UIConstants;
+
+  const QRect row = option.rect.adjusted(0, ROW_MARGIN, 0, -ROW_MARGIN);
+  const bool selected = option.state & QStyle::State_Selected;
+  const bool hovered = option.state & QStyle::State_MouseOver;
+
+  painter->save();
+  painter->setRenderHint(QPainter::Antialiasing);
+  painter->setPen(Qt::NoPen);
+
+  if (selected || hovered) {
+    painter->setBrush(Theme::color(selected ? SIDEBAR_ROW_SELECTED : SIDEBAR_ROW_HOVER));
+    painter->drawRoundedRect(row, ROW_RADIUS, ROW_RADIUS);
+  }
+  if (selected) {
+    painter->fillRect(QRect(row.left(), row.top(), ACCENT_WIDTH, row.height()), Theme::color(PRIMARY_COLOR));
+  }
+
+  int textLeft = row.left() + ACCENT_WIDTH + ROW_PADDING;
+  const QIcon icon = index.data(Qt::DecorationRole).value<QIcon>();
+  if (!icon.isNull()) {
+    const QRect iconRect(textLeft, row.center().y() - TAB_ICON_SIZE / 2, TAB_ICON_SIZE, TAB_ICON_SIZE);
+    icon.paint(painter, iconRect);
+    textLeft = iconRect.right() + 1 + ROW_PADDING;
+  }
+
+  const QRect close = closeRect(row);
+  const int textRight = closable ? close.left() - ROW_PADDING : row.right() - ROW_PADDING;
+  QFont font = option.font;
+  font.setBold(selected);
+  painter->setFont(font);
+  painter->setPen(Theme::color(selected ? SIDEBAR_TEXT_ACTIVE : hovered ? SIDEBAR_TEXT_HOVER : SIDEBAR_TEXT));
+  const QRect textRect(textLeft, row.top(), qMax(0, textRight - textLeft), row.height());
+  const QString text = QFontMetrics(font).elidedText(index.data(Qt::DisplayRole).toString(), Qt::ElideRight,
+                                                     textRect.width());
+  painter->drawText(textRect, Qt::AlignVCenter | Qt::AlignLeft, text);
+
+  if (closable) {
+    const bool closeHovered = hoveredClose == index;
+    if (closeHovered) {
+      painter->setPen(Qt::NoPen);
+      painter->setBrush(Theme::color(DANGER_COLOR));
+      painter->drawRoundedRect(close, 3, 3);
+    }
+    QFont closeFont = option.font;
+    closeFont.setBold(true);
+    closeFont.setPixelSize(16);
+    painter->setFont(closeFont);
+    painter->setPen(closeHovered ? Theme::color(SIDEBAR_TEXT_ACTIVE) : Theme::color(SIDEBAR_CLOSE));
+    painter->drawText(close, Qt::AlignCenter, QStringLiteral("×"));
+  }
+
+  painter->restore();
+}
+
+QSize TabItemDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const {
+  Q_UNUSED(option)
+  Q_UNUSED(index)
+  return QSize(ROW_WIDTH, UIConstants::TAB_ITEM_HEIGHT);
+}
+
+bool TabItemDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option,
+                                  const QModelIndex &index) {
+  if (!closable)
+    return QStyledItemDelegate::editorEvent(event, model, option, index);
+
+  const QRect close = closeRect(option.rect.adjusted(0, ROW_MARGIN, 0, -ROW_MARGIN));
+
+  switch (event->type()) {
+  case QEvent::MouseButtonPress:
+  case QEvent::MouseButtonDblClick:
+    if (close.contains(static_cast<QMouseEvent *>(event)->position().toPoint())) {
+      // Swallow the press so clicking the close glyph doesn't select the tab first
+      pressedClose = index;
+      return true;
+    }
+    pressedClose = QPersistentModelIndex();
+    break;
+  case QEvent::MouseButtonRelease:
+    if (pressedClose.isValid() && pressedClose == index &&
+        close.contains(static_cast<QMouseEvent *>(event)->position().toPoint())) {
+      pressedClose = QPersistentModelIndex();
+      hoveredClose = QPersistentModelIndex();
+      emit closeRequested(index.row());
+      return true;
+    }
+    pressedClose = QPersistentModelIndex();
+    break;
+  default:
+    break;
+  }
+
+  return QStyledItemDelegate::editorEvent(event, model, option, index);
+}
+
+bool TabItemDelegate::eventFilter(QObject *obj, QEvent *event) {
+  // Views only route presses and releases through editorEvent, so hover over
+  // the close glyph is tracked on the viewport
+  if (closable && (event->type() == QEvent::MouseMove || event->type() == QEvent::Leave)) {
+    QPersistentModelIndex hovered;
+    if (event->type() == QEvent::MouseMove) {
+      const QPoint pos = static_cast<QMouseEvent *>(event)->position().toPoint();
+      const QModelIndex index = view->indexAt(pos);
+      if (index.isValid() && closeRect(view->visualRect(index).adjusted(0, ROW_MARGIN, 0, -ROW_MARGIN)).contains(pos))
+        hovered = index;
+    }
+    if (hovered != hoveredClose) {
+      if (hoveredClose.isValid())
+        view->update(hoveredClose);
+      hoveredClose = hovered;
+      if (hoveredClose.isValid())
+        view->update(hoveredClose);
+    }
+  }
+  return QStyledItemDelegate::eventFilter(obj, event);
+}
@@ -0,0 +1,45 @@
+#ifndef TABITEMDELEGATE_H
+#define TABITEMDELEGATE_H
+
+#include <QAbstractItemView>
+#include <QPersistentModelIndex>
+#include <QStyledItemDelegate>
+
+/**
+ * @brief Paints the rows of the sidebar tab list
+ *
+ * Draws the selection accent, favicon, title and close button of a tab
+ * straight from the UIConstants tokens. Rows used to be a widget with four
+ * labels and buttons, each carrying its own style sheet; painting them here
+ * leaves the list with no per-row widgets to create, polish or lay out.
+ */
+class TabItemDelegate : public QStyledItemDelegate {
+  Q_OBJECT
+
+public:
+  // The view must be the parent: hover state is tracked on its viewport
+  explicit TabItemDelegate(QAbstractItemView *view);
+
+  void setClosable(bool closable) { this->closable = closable; }
+
+  void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+  QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+signals:
+  void closeRequested(int row);
+
+protected:
+  bool editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option,
+                   const QModelIndex &index) override;
+  bool eventFilter(QObject *obj, QEvent *event) override;
+
+private:
+  static QRect closeRect(const QRect &rowRect);
+
+  QAbstractItemView *view;
+  bool closable;
+  QPersistentModelIndex hoveredClose;
+  QPersistentModelIndex pressedClose;
+};
+
+#endif // TABITEMDELEGATE_H
@@ -1,4 +1,7 @@
 #include "verticaltabwidget.h"
+#include "../../core/ui_constants.h"
+#include "../theme/theme.h"
+#include "tabitemdelegate.h"
 #include <QApplication>
 #include <QComboBox>
 #include <QCursor>
@@ -7,11 +10,11 @@
 #include <QLabel>
 #include <QListWidgetItem>
 #include <QMouseEvent>
+#include <QPalette>
 #include <QPropertyAnimation>
 #include <QResizeEvent>
 #include <QStyle>
 #include <QTimer>
-#include <QToolButton>
 #include <QVBoxLayout>
 
 VerticalTabWidget::VerticalTabWidget(QWidget *parent)
@@ -48,13 +51,8 @@ void VerticalTabWidget::setupUI() {
 
   // Create overlay sidebar (initially hidden)
   sidebarWidget = new QWidget(this);
-  sidebarWidget->setFixedWidth(280); // Slightly smaller for better UI
-  sidebarWidget->setStyleSheet(
-      "QWidget { "
-      "  background-color: rgba(35, 35, 38, 250); " // Slightly darker and more opaque
-      "  border-right: 1px solid rgba(70, 70, 76, 200); "
-      "  border-radius: 0px 8px 8px 0px; " // Rounded right corners
-      "}");
+  sidebarWidget->setFixedWidth(UIConstants::SIDEBAR_WIDTH);
+  sidebarWidget->setObjectName("sidebar");
   sidebarWidget->hide();
 
   // Position sidebar as overlay
@@ -74,23 +72,11 @@ void VerticalTabWidget::setupSidebar() {
   // Integrated address bar
   integratedAddressBar = new QLineEdit(sidebarWidget);
   integratedAddressBar->setPlaceholderText("Enter URL or search...");
-  integratedAddressBar->setStyleSheet(
-      "QLineEdit { "
-      "  padding: 8px 12px; "
-      "  border: 1px solid rgba(160, 160, 160, 0.4); "
-      "  border-radius: 4px; "
-      "  background-color: rgba(255, 255, 255, 0.08); "
-      "  color: rgba(240, 240, 240, 1); " // High contrast text
-      "  font-size: 13px; "
-      "} "
-      "QLineEdit:focus { "
-      "  border-color: rgba(0, 122, 204, 0.8); " // Blue focus border
-      "  color: rgba(255, 255, 255, 1); "
-      "  background-color: rgba(255, 255, 255, 0.12); "
-      "} "
-      "QLineEdit::placeholder { "
-      "  color: rgba(160, 160, 160, 0.8); "
-      "}");
+  integratedAddressBar->setObjectName("sidebarAddressBar");
+  // Style sheets can't reach the placeholder, so it takes the token through the palette
+  QPalette addressPalette = integratedAddressBar->palette();
+  addressPalette.setColor(QPalette::PlaceholderText, Theme::color(UIConstants::SIDEBAR_PLACEHOLDER));
+  integratedAddressBar->setPalette(addressPalette);
   connect(integratedAddressBar, &QLineEdit::returnPressed,
           this, &VerticalTabWidget::addressBarReturnPressed);
   tabListLayout->addWidget(integratedAddressBar);
@@ -102,26 +88,7 @@ void VerticalTabWidget::setupSidebar() {
 
   // New tab button
   newTabButton = new QPushButton("+ New Tab", sidebarWidget);
-  newTabButton->setStyleSheet(
-      "QPushButton { "
-      "  padding: 8px 12px; "
-      "  border: 1px solid rgba(160, 160, 160, 0.4); "
-      "  border-radius: 4px; "
-      "  background-color: rgba(255, 255, 255, 0.08); "
-      "  color: rgba(220, 220, 220, 1); " // Clear text color
-      "  font-weight: bold; "
-      "  font-size: 12px; "
-      "} "
-      "QPushButton:hover { "
-      "  color: rgba(255, 255, 255, 1); " // Brighter text on hover
-      "  background-color: rgba(255, 255, 255, 0.12); "
-      "  border-color: rgba(0, 122, 204, 0.6); "
-      "} "
-      "QPushButton:pressed { "
-      "  color: rgba(255, 255, 255, 1); "
-      "  background-color: rgba(255, 255, 255, 0.16); "
-      "  border-color: rgba(0, 122, 204, 0.8); "
-      "}");
+  newTabButton->setObjectName("sidebarNewTabButton");
 
   // Improve button responsiveness
   newTabButton->setFocusPolicy(Qt::StrongFocus);
@@ -132,31 +99,10 @@ void VerticalTabWidget::setupSidebar() {
 
   // Tab list
   tabListWidget = new QListWidget(sidebarWidget);
-  tabListWidget->setStyleSheet(
-      "QListWidget { "
-      "  background-color: transparent; "
-      "  border: none; "
-      "  outline: none; "
-      "  font-size: 12px; "
-      "} "
-      "QListWidget::item { "
-      "  padding: 8px 10px; "
-      "  margin: 2px 0px; "
-      "  border-radius: 4px; "
-      "  color: rgba(200, 200, 200, 1); " // Dimmed text for inactive tabs
-      "  background-color: transparent; "
-      "  border-left: 3px solid transparent; "
-      "} "
-      "QListWidget::item:selected { "
-      "  color: rgba(255, 255, 255, 1); " // Bright white for selected tab
-      "  font-weight: bold; "
-      "  background-color: rgba(255, 255, 255, 0.05); "
-      "  border-left: 3px solid rgba(0, 122, 204, 1); " // Blue accent line
-      "} "
-      "QListWidget::item:hover:!selected { "
-      "  color: rgba(230, 230, 230, 1); " // Slightly brighter on hover
-      "  background-color: rgba(255, 255, 255, 0.03); "
-      "}");
+  tabListWidget->setObjectName("tabList");
+  tabDelegate = new TabItemDelegate(tabListWidget);
+  tabListWidget->setItemDelegate(tabDelegate);
+  connect(tabDelegate, &TabItemDelegate::closeRequested, this, &VerticalTabWidget::tabCloseRequested);
   connect(tabListWidget, &QListWidget::currentItemChanged,
           this, &VerticalTabWidget::onTabListItemChanged);
   tabListLayout->addWidget(tabListWidget);
@@ -185,7 +131,7 @@ int VerticalTabWidget::addTab(QWidget *widget, const QString &text) {
 
   contentWidget->addWidget(widget);
 
-  QListWidgetItem *item = createTabItem(text, index);
+  QListWidgetItem *item = createTabItem(text);
   tabListWidget->addItem(item);
 
   return index;
@@ -261,9 +207,22 @@ QString VerticalTabWidget::tabText(int index) const {
   return QString();
 }
 
+void VerticalTabWidget::setTabToolTip(int index, const QString &toolTip) {
+  if (QListWidgetItem *item = tabListWidget->item(index)) {
+    item->setToolTip(toolTip);
+  }
+}
+
+void VerticalTabWidget::setTabIcon(int index, const QIcon &icon) {
+  if (QListWidgetItem *item = tabListWidget->item(index)) {
+    item->setIcon(icon);
+  }
+}
+
 void VerticalTabWidget::setTabsClosable(bool closable) {
   tabsClosable = closable;
-  updateTabList();
+  tabDelegate->setClosable(closable);
+  tabListWidget->viewport()->update();
 }
 
 void VerticalTabWidget::setMovable(bool movable) {
@@ -284,15 +243,6 @@ void VerticalTabWidget::onTabListItemChanged(QListWidgetItem *current, QListWidg
   }
 }
 
-void VerticalTabWidget::onCloseTabClicked() {
-  QToolButton *button = qobject_cast<QToolButton *>(sender());
-  if (!button)
-    return;
-
-  int index = button->property("tabIndex").toInt();
-  emit tabCloseRequested(index);
-}
-
 void VerticalTabWidget::onNewTabClicked() {
   emit newTabRequested();
 }
@@ -306,58 +256,9 @@ void VerticalTabWidget::updateTabList() {
   }
 }
 
-QListWidgetItem *VerticalTabWidget::createTabItem(const QString &text, int index) {
-  QListWidgetItem *item = new QListWidgetItem();
-
-  if (tabsClosable) {
-    // Create a custom widget for the item with close button
-    QWidget *itemWidget = new QWidget();
-    itemWidget->setStyleSheet(
-        "QWidget { "
-        "  background-color: transparent; "
-        "  border-radius: 6px; "
-        "}");
-
-    QHBoxLayout *layout = new QHBoxLayout(itemWidget);
-    layout->setContentsMargins(8, 6, 8, 6);
-
-    QLabel *label = new QLabel(text);
-    label->setStyleSheet(
-        "QLabel { "
-        "  color: #cccccc; "
-        "  font-size: 13px; "
-        "  background-color: transparent; "
-        "}");
-    layout->addWidget(label, 1);
-
-    QToolButton *closeButton = new QToolButton();
-    closeButton->setText("×");
-    closeButton->setStyleSheet(
-        "QToolButton { "
-        "  border: none; "
-        "  color: #999999; "
-        "  font-weight: bold; "
-        "  font-size: 16px; "
-        "  background-color: transparent; "
-        "  border-radius: 3px; "
-        "} "
-        "QToolButton:hover { "
-        "  color: white; "
-        "  background-color: #dc3545; "
-        "}");
-    closeButton->setFixedSize(20, 20);
-    closeButton->setProperty("tabIndex", index);
-    connect(closeButton, &QToolButton::clicked, this, &VerticalTabWidget::onCloseTabClicked);
-    layout->addWidget(closeButton);
-
-    item->setSizeHint(QSize(240, 40)); // Fixed size for consistency
-    tabListWidget->setItemWidget(item, itemWidget);
-  } else {
-    item->setText(text);
-    item->setSizeHint(QSize(240, 40));
-  }
-
-  return item;
+QListWidgetItem *VerticalTabWidget::createTabItem(const QString &text) {
+  // TabItemDelegate paints the row, including the close button
+  return new QListWidgetItem(text);
 }
 
 // New methods for overlay functionality
@@ -382,25 +283,7 @@ void VerticalTabWidget::setWorkspaceManager(WorkspaceManager *manager) {
 
     // Add workspace selection combo box
     QComboBox *workspaceCombo = new QComboBox(workspaceToolbar);
-    workspaceCombo->setStyleSheet(
-        "QComboBox { "
-        "  padding: 4px 8px; "
-        "  border: 1px solid rgba(255, 255, 255, 0.3); "
-        "  border-radius: 3px; "
-        "  background-color: rgba(255, 255, 255, 0.1); "
-        "  color: white; "
-        "  font-size: 11px; "
-        "  min-width: 120px; "
-        "} "
-        "QComboBox:hover { "
-        "  background-color: rgba(255, 255, 255, 0.2); "
-        "} "
-        "QComboBox::drop-down { "
-        "  border: none; "
-        "} "
-        "QComboBox::down-arrow { "
-        "  color: white; "
-        "}");
+    workspaceCombo->setObjectName("sidebarWorkspaceCombo");
 
     // Populate with workspace names (this would be connected to WorkspaceManager)
     workspaceCombo->addItem("Default Workspace");
@@ -434,39 +317,12 @@ void VerticalTabWidget::setBookmarkManager(BookmarkManager *manager) {
 
     // Add bookmarks header
     QLabel *bookmarksLabel = new QLabel("Bookmarks", bookmarkPanel);
-    bookmarksLabel->setStyleSheet(
-        "QLabel { "
-        "  color: rgba(255, 255, 255, 0.9); "
-        "  font-weight: bold; "
-        "  font-size: 12px; "
-        "  padding: 4px 0px; "
-        "}");
+    bookmarksLabel->setObjectName("sidebarSectionTitle");
     bookmarkLayout->addWidget(bookmarksLabel);
 
     // Add bookmark list (simplified)
     QListWidget *bookmarkList = new QListWidget(bookmarkPanel);
-    bookmarkList->setStyleSheet(
-        "QListWidget { "
-        "  background-color: transparent; "
-        "  border: none; "
-        "  outline: none; "
-        "  font-size: 11px; "
-        "} "
-        "QListWidget::item { "
-        "  padding: 4px 6px; "
-        "  margin: 1px 0px; "
-        "  border-radius: 3px; "
-        "  color: rgba(255, 255, 255, 0.7); "
-        "  background-color: transparent; "
-        "} "
-        "QListWidget::item:hover { "
-        "  color: white; "
-        "  background-color: rgba(255, 255, 255, 0.1); "
-        "} "
-        "QListWidget::item:selected { "
-        "  color: white; "
-        "  background-color: rgba(255, 255, 255, 0.2); "
-        "}");
+    bookmarkList->setObjectName("sidebarBookmarks");
 
     // Add some sample bookmarks
     bookmarkList->addItem("📁 Work");
@@ -507,18 +363,7 @@ void VerticalTabWidget::setBookmarkManager(BookmarkManager *manager) {
     bookmarkActions->setSpacing(4);
 
     QPushButton *addBookmarkBtn = new QPushButton("+ Add", bookmarkPanel);
-    addBookmarkBtn->setStyleSheet(
-        "QPushButton { "
-        "  padding: 3px 8px; "
-        "  border: 1px solid rgba(255, 255, 255, 0.3); "
-        "  border-radius: 3px; "
-        "  background-color: rgba(255, 255, 255, 0.1); "
-        "  color: white; "
-        "  font-size: 10px; "
-        "} "
-        "QPushButton:hover { "
-        "  background-color: rgba(255, 255, 255, 0.2); "
-        "}");
+    addBookmarkBtn->setObjectName("sidebarSmallButton");
 
     bookmarkActions->addWidget(addBookmarkBtn);
     bookmarkActions->addStretch();
@@ -544,13 +389,13 @@ void VerticalTabWidget::showSidebar() {
   hideTimer->stop();
 
   // Position sidebar at left edge
-  sidebarWidget->setGeometry(0, 0, 280, height());
+  sidebarWidget->setGeometry(0, 0, UIConstants::SIDEBAR_WIDTH, height());
   sidebarWidget->show();
   sidebarWidget->raise();
 
   // Animate sliding in
-  sidebarAnimation->setStartValue(QRect(-280, 0, 280, height()));
-  sidebarAnimation->setEndValue(QRect(0, 0, 280, height()));
+  sidebarAnimation->setStartValue(QRect(-UIConstants::SIDEBAR_WIDTH, 0, UIConstants::SIDEBAR_WIDTH, height()));
+  sidebarAnimation->setEndValue(QRect(0, 0, UIConstants::SIDEBAR_WIDTH, height()));
   sidebarAnimation->start();
 }
 
@@ -561,8 +406,8 @@ void VerticalTabWidget::hideSidebar() {
   sidebarVisible = false;
 
   // Animate sliding out
-  sidebarAnimation->setStartValue(QRect(0, 0, 280, height()));
-  sidebarAnimation->setEndValue(QRect(-280, 0, 280, height()));
+  sidebarAnimation->setStartValue(QRect(0, 0, UIConstants::SIDEBAR_WIDTH, height()));
+  sidebarAnimation->setEndValue(QRect(-UIConstants::SIDEBAR_WIDTH, 0, UIConstants::SIDEBAR_WIDTH, height()));
 
   connect(sidebarAnimation, &QPropertyAnimation::finished, [this]() {
     sidebarWidget->hide();
@@ -623,7 +468,7 @@ void VerticalTabWidget::resizeEvent(QResizeEvent *event) {
 
   // Update sidebar geometry if visible
   if (sidebarVisible && sidebarWidget->isVisible()) {
-    sidebarWidget->setGeometry(0, 0, 280, height());
+    sidebarWidget->setGeometry(0, 0, UIConstants::SIDEBAR_WIDTH, height());
   }
 }
 
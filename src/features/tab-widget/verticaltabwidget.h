@@ -8,6 +8,7 @@
 #include <QEvent>
 #include <QGraphicsOpacityEffect>
 #include <QHBoxLayout>
+#include <QIcon>
 #include <QLabel>
 #include <QLineEdit>
 #include <QListWidget>
@@ -24,6 +25,7 @@
 class WebView;
 class WorkspaceManager;
 class BookmarkManager;
+class TabItemDelegate;
 
 class VerticalTabWidget : public QWidget {
   Q_OBJECT
@@ -38,9 +40,12 @@ public:
   int currentIndex() const;
   QWidget *currentWidget() const;
   QWidget *widget(int index) const;
+  int indexOf(QWidget *widget) const { return tabWidgets.indexOf(widget); }
   int count() const;
   void setTabText(int index, const QString &text);
   QString tabText(int index) const;
+  void setTabToolTip(int index, const QString &toolTip);
+  void setTabIcon(int index, const QIcon &icon);
   void setTabsClosable(bool closable);
   void setMovable(bool movable);
 
@@ -65,7 +70,6 @@ signals:
 
 private slots:
   void onTabListItemChanged(QListWidgetItem *current, QListWidgetItem *previous);
-  void onCloseTabClicked();
   void onNewTabClicked();
   void onSidebarTimerTimeout();
 
@@ -80,11 +84,12 @@ private:
   void setupUI();
   void setupSidebar();
   void updateTabList();
-  QListWidgetItem *createTabItem(const QString &text, int index);
+  QListWidgetItem *createTabItem(const QString &text);
 
   QHBoxLayout *mainLayout;
   QVBoxLayout *tabListLayout;
   QListWidget *tabListWidget;
+  TabItemDelegate *tabDelegate;
   QStackedWidget *contentWidget;
   QPushButton *newTabButton;
 
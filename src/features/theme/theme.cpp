@@ -0,0 +1,124 @@
+#include "theme.h"
+#include "../../core/ui_constants.h"
+#include "../logging/logcategories.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QRegularExpression>
+#include <QWidget>
+
+namespace {
+const char *THEME_RESOURCE = ":/src/features/theme/theme.qss";
+
+// Token names as written in theme.qss: the constant name, lower case with dashes
+const QHash<QString, QRgb> &tokens() {
+  using namespace UIConstants;
+  static const QHash<QString, QRgb> table = {
+      {"primary-color", PRIMARY_COLOR},
+      {"primary-hover", PRIMARY_HOVER},
+      {"primary-pressed", PRIMARY_PRESSED},
+      {"danger-color", DANGER_COLOR},
+      {"danger-hover", DANGER_HOVER},
+      {"danger-pressed", DANGER_PRESSED},
+      {"dark-bg", DARK_BG},
+      {"dark-border", DARK_BORDER},
+      {"light-bg", LIGHT_BG},
+      {"light-bg-end", LIGHT_BG_END},
+      {"white-bg", WHITE_BG},
+      {"border-color", BORDER_COLOR},
+      {"border-strong", BORDER_STRONG},
+      {"disabled-bg", DISABLED_BG},
+      {"text-color", TEXT_COLOR},
+      {"text-secondary", TEXT_SECONDARY},
+      {"text-muted", TEXT_MUTED},
+      {"sidebar-bg", SIDEBAR_BG},
+      {"sidebar-border", SIDEBAR_BORDER},
+      {"sidebar-control-bg", SIDEBAR_CONTROL_BG},
+      {"sidebar-control-hover", SIDEBAR_CONTROL_HOVER},
+      {"sidebar-control-pressed", SIDEBAR_CONTROL_PRESSED},
+      {"sidebar-control-border", SIDEBAR_CONTROL_BORDER},
+      {"sidebar-text", SIDEBAR_TEXT},
+      {"sidebar-text-hover", SIDEBAR_TEXT_HOVER},
+      {"sidebar-text-active", SIDEBAR_TEXT_ACTIVE},
+      {"sidebar-placeholder", SIDEBAR_PLACEHOLDER},
+      {"sidebar-row-hover", SIDEBAR_ROW_HOVER},
+      {"sidebar-row-selected", SIDEBAR_ROW_SELECTED},
+      {"sidebar-close", SIDEBAR_CLOSE},
+      {"sidebar-focus", SIDEBAR_FOCUS},
+      {"sidebar-accent-hover", SIDEBAR_ACCENT_HOVER},
+      {"sidebar-subtle-bg", SIDEBAR_SUBTLE_BG},
+      {"sidebar-subtle-hover", SIDEBAR_SUBTLE_HOVER},
+      {"sidebar-subtle-border", SIDEBAR_SUBTLE_BORDER},
+      {"sidebar-text-dim", SIDEBAR_TEXT_DIM},
+      {"sidebar-heading", SIDEBAR_HEADING},
+      {"palette-bg", PALETTE_BG},
+      {"palette-border", PALETTE_BORDER},
+      {"palette-input-bg", PALETTE_INPUT_BG},
+      {"palette-input-focus-bg", PALETTE_INPUT_FOCUS_BG},
+      {"palette-input-border", PALETTE_INPUT_BORDER},
+      {"palette-text", PALETTE_TEXT},
+      {"palette-placeholder", PALETTE_PLACEHOLDER},
+      {"palette-hint", PALETTE_HINT},
+      {"palette-accent-hover", PALETTE_ACCENT_HOVER},
+      {"palette-accent-selected", PALETTE_ACCENT_SELECTED},
+      {"palette-accent-focus", PALETTE_ACCENT_FOCUS},
+      {"hud-bg", HUD_BG},
+      {"hud-text", HUD_TEXT},
+  };
+  return table;
+}
+
+QString cssColor(QRgb rgba) {
+  // QSS reads #aarrggbb, but rgba() is easier to check against a design
+  if (qAlpha(rgba) == 255)
+    return QColor::fromRgb(rgba).name(QColor::HexRgb);
+  return QString("rgba(%1, %2, %3, %4)").arg(qRed(rgba)).arg(qGreen(rgba)).arg(qBlue(rgba)).arg(qAlpha(rgba));
+}
+} // namespace
+
+const QString &Theme::styleSheet() {
+  static const QString compiled = [] {
+    QFile file(THEME_RESOURCE);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+      qCWarning(lcApp) << "Failed to load theme" << THEME_RESOURCE;
+      return QString();
+    }
+    return compile(QString::fromUtf8(file.readAll()));
+  }();
+  return compiled;
+}
+
+void Theme::apply(QWidget *window) {
+  if (!window)
+    return;
+
+  QElapsedTimer timer;
+  timer.start();
+  window->setStyleSheet(styleSheet());
+  qCDebug(lcApp) << "Theme applied to" << window->metaObject()->className() << "in" << timer.nsecsElapsed() / 1000
+                 << "us";
+}
+
+QString Theme::compile(const QString &source) {
+  static const QRegularExpression tokenPattern("@([a-z][a-z0-9-]*)");
+
+  const QHash<QString, QRgb> &table = tokens();
+  QString result;
+  result.reserve(source.size());
+  qsizetype last = 0;
+  QRegularExpressionMatchIterator it = tokenPattern.globalMatch(source);
+  while (it.hasNext()) {
+    const QRegularExpressionMatch match = it.next();
+    result += QStringView(source).mid(last, match.capturedStart() - last);
+    auto token = table.constFind(match.captured(1));
+    if (token != table.constEnd()) {
+      result += cssColor(*token);
+    } else {
+      qCWarning(lcApp) << "Theme: unknown token" << match.captured(0);
+      result += match.captured(0);
+    }
+    last = match.capturedEnd();
+  }
+  result += QStringView(source).mid(last);
+  return result;
+}
@@ -0,0 +1,32 @@
+#ifndef THEME_H
+#define THEME_H
+
+#include <QColor>
+#include <QRgb>
+#include <QString>
+
+class QWidget;
+
+/**
+ * @brief Application style sheet compiled from the design tokens
+ *
+ * theme.qss holds every widget rule of the browser, with @name placeholders
+ * for the colors in UIConstants. The sheet is compiled once per process and
+ * applied to each top-level window, so widgets only carry an objectName and
+ * Qt parses one style sheet instead of one per widget.
+ */
+class Theme {
+public:
+  // The compiled sheet, built on first use
+  static const QString &styleSheet();
+
+  // Styles the window and everything inside it
+  static void apply(QWidget *window);
+
+  static QColor color(QRgb token) { return QColor::fromRgba(token); }
+
+private:
+  static QString compile(const QString &source);
+};
+
+#endif // THEME_H
@@ -0,0 +1,71 @@
+#include "swipetracker.h"
+#include <QTouchEvent>
+#include <QWheelEvent>
+#include <QtMath>
+
+namespace {
+const double SWIPE_DISTANCE_PX = 150;   // Trackpad finger travel before navigating
+const double TOUCH_DISTANCE_PX = 100;
+const double DOMINANCE = 2.0;           // Horizontal travel must be this much larger than vertical
+const qint64 TOUCH_MAX_DURATION_MS = 500;
+const qint64 UNPHASED_GAP_MS = 200;     // Without phases, a pause this long ends the gesture
+} // namespace
+
+SwipeTracker::Direction SwipeTracker::wheel(const QWheelEvent *event) {
+  switch (event->phase()) {
+  case Qt::ScrollBegin:
+    resetGesture();
+    break;
+  case Qt::ScrollUpdate:
+    break;
+  case Qt::ScrollEnd:
+  case Qt::ScrollMomentum:
+    // Momentum keeps scrolling after the fingers left the pad; it is not a swipe
+    fired = true;
+    return None;
+  case Qt::NoScrollPhase:
+    if (event->pixelDelta().isNull())
+      return None; // Mouse wheel
+    if (event->timestamp() - lastUnphasedEvent > UNPHASED_GAP_MS) {
+      resetGesture();
+    }
+    lastUnphasedEvent = event->timestamp();
+    break;
+  }
+
+  // Deltas describe content movement; with natural scrolling that follows the fingers
+  const QPointF delta = event->pixelDelta().isNull() ? QPointF(event->angleDelta()) / 8.0
+                                                     : QPointF(event->pixelDelta());
+  const double sign = event->inverted() ? 1.0 : -1.0;
+  fingerX += sign * delta.x();
+  fingerY += sign * delta.y();
+  return evaluate();
+}
+
+SwipeTracker::Direction SwipeTracker::touch(const QTouchEvent *event) {
+  if (event->type() != QEvent::TouchEnd || event->points().size() != 1)
+    return None;
+
+  const QEventPoint &point = event->points().first();
+  if (point.timestamp() - point.pressTimestamp() > TOUCH_MAX_DURATION_MS)
+    return None;
+
+  const QPointF travel = point.position() - point.pressPosition();
+  if (qAbs(travel.x()) < TOUCH_DISTANCE_PX || qAbs(travel.x()) < DOMINANCE * qAbs(travel.y()))
+    return None;
+  return travel.x() > 0 ? Back : Forward;
+}
+
+void SwipeTracker::resetGesture() {
+  fingerX = 0;
+  fingerY = 0;
+  fired = false;
+}
+
+SwipeTracker::Direction SwipeTracker::evaluate() {
+  if (fired || qAbs(fingerX) < SWIPE_DISTANCE_PX || qAbs(fingerX) < DOMINANCE * qAbs(fingerY))
+    return None;
+
+  fired = true;
+  return fingerX > 0 ? Back : Forward;
+}
@@ -0,0 +1,40 @@
+#ifndef SWIPETRACKER_H
+#define SWIPETRACKER_H
+
+#include <QtGlobal>
+
+class QTouchEvent;
+class QWheelEvent;
+
+/**
+ * @brief Recognizes back/forward swipes from raw trackpad and touch input
+ *
+ * Fed with the wheel and touch events that reach WebView, so navigation
+ * swipes need no script in the page. A trackpad gesture (ScrollBegin to
+ * ScrollEnd) navigates at most once, when the fingers have travelled far
+ * enough and clearly sideways; momentum scrolling is ignored. Devices
+ * without scroll phases only count when they report pixel deltas, so a
+ * mouse tilt wheel keeps scrolling horizontally.
+ */
+class SwipeTracker {
+public:
+  enum Direction {
+    None,
+    Back,   // Fingers moved right
+    Forward // Fingers moved left
+  };
+
+  Direction wheel(const QWheelEvent *event);
+  Direction touch(const QTouchEvent *event);
+
+private:
+  void resetGesture();
+  Direction evaluate();
+
+  double fingerX = 0; // Distance the fingers moved, independent of natural scrolling
+  double fingerY = 0;
+  bool fired = false; // One navigation per gesture
+  qint64 lastUnphasedEvent = 0;
+};
+
+#endif // SWIPETRACKER_H
@@ -1,53 +1,62 @@
 #include "webview.h"
+#include "../logging/logcategories.h"
 #include "../main-window/mainwindow.h" // To potentially access MainWindow for new tab creation logic
+#include "../profile/browserprofile.h"
 #include <QAction>
 #include <QApplication>
 #include <QContextMenuEvent>
-#include <QDebug>
 #include <QFocusEvent>
 #include <QKeyEvent>
 #include <QMenu>
 #include <QMessageBox>
 #include <QMouseEvent>
 #include <QTimer>
+#include <QWheelEvent>
 #include <QWebEngineProfile>
 #include <QWebEngineSettings>
 
+/**
+ * @brief The page's request interceptor, handing each request to the interceptors of the tab's features
+ */
+class RequestDispatcher : public QWebEngineUrlRequestInterceptor {
+public:
+  RequestDispatcher(const QList<QPointer<QWebEngineUrlRequestInterceptor>> *interceptors, QObject *parent)
+      : QWebEngineUrlRequestInterceptor(parent), interceptors(interceptors) {}
+
+  void interceptRequest(QWebEngineUrlRequestInfo &info) override {
+    for (const QPointer<QWebEngineUrlRequestInterceptor> &interceptor : *interceptors) {
+      if (interceptor) {
+        interceptor->interceptRequest(info);
+      }
+    }
+  }
+
+private:
+  const QList<QPointer<QWebEngineUrlRequestInterceptor>> *interceptors;
+};
+
 // Custom page implementation
 CustomWebEnginePage::CustomWebEnginePage(QWebEngineProfile *profile, QObject *parent)
     : QWebEnginePage(profile, parent) {
 }
 
 void CustomWebEnginePage::javaScriptConsoleMessage(JavaScriptConsoleMessageLevel level, const QString &message, int lineNumber, const QString &sourceID) {
-#ifdef DEBUG_MODE
-  // In debug mode, log all console messages
-  QString levelStr;
+  // Errors are logged by default; the rest only with mybrowser.console.debug enabled
   switch (level) {
   case JavaScriptConsoleMessageLevel::InfoMessageLevel:
-    levelStr = "INFO";
+    qCDebug(lcConsole) << "INFO:" << message << "(line" << lineNumber << "in" << sourceID << ")";
     break;
   case JavaScriptConsoleMessageLevel::WarningMessageLevel:
-    levelStr = "WARN";
+    qCDebug(lcConsole) << "WARN:" << message << "(line" << lineNumber << "in" << sourceID << ")";
     break;
   case JavaScriptConsoleMessageLevel::ErrorMessageLevel:
-    levelStr = "ERROR";
+    qCWarning(lcConsole) << "ERROR:" << message << "(line" << lineNumber << "in" << sourceID << ")";
     break;
   }
-  qDebug() << "JS Console [" << levelStr << "]:" << message << "(line" << lineNumber << "in" << sourceID << ")";
-#else
-  // In release mode, only log errors
-  if (level == JavaScriptConsoleMessageLevel::ErrorMessageLevel) {
-    qDebug() << "JS Error:" << message;
-  }
-  Q_UNUSED(lineNumber)
-  Q_UNUSED(sourceID)
-#endif
 }
 
 void CustomWebEnginePage::javaScriptAlert(const QUrl &securityOrigin, const QString &msg) {
-#ifdef DEBUG_MODE
-  qDebug() << "JavaScript Alert:" << msg << "from" << securityOrigin.toString();
-#endif
+  qCDebug(lcWebView) << "JavaScript Alert:" << msg << "from" << securityOrigin.toString();
 
   // Create a properly configured message box
   QMessageBox msgBox;
@@ -90,15 +99,12 @@ bool CustomWebEnginePage::acceptNavigationRequest(const QUrl &url, NavigationTyp
   default:
     typeString = "Other";
   }
-#ifdef DEBUG_MODE
-  qDebug() << "Navigation Request:" << typeString << "URL:" << url.toString() << "MainFrame:" << isMainFrame;
-#endif
+  qCDebug(lcNavigation) << "Navigation Request:" << typeString << "URL:" << url.toString()
+                        << "MainFrame:" << isMainFrame;
 
   // For anchor links (fragment navigation), force the navigation
   if (url.hasFragment() && url.path() == this->url().path()) {
-#ifdef DEBUG_MODE
-    qDebug() << "Fragment navigation detected, allowing:" << url.fragment();
-#endif
+    qCDebug(lcNavigation) << "Fragment navigation detected, allowing:" << url.fragment();
     return true;
   }
 
@@ -106,9 +112,14 @@ bool CustomWebEnginePage::acceptNavigationRequest(const QUrl &url, NavigationTyp
   return QWebEnginePage::acceptNavigationRequest(url, type, isMainFrame);
 }
 
-WebView::WebView(QWidget *parent) : QWebEngineView(parent), devToolsView(nullptr) {
+WebView::WebView(QWidget *parent)
+    : QWebEngineView(parent), devToolsView(nullptr),
+      requestDispatcher(new RequestDispatcher(&requestInterceptors, this)) {
+  static int nextTabId = 1;
+  id = nextTabId++;
+
   // Use custom page to capture JavaScript console messages
-  CustomWebEnginePage *customPage = new CustomWebEnginePage(QWebEngineProfile::defaultProfile(), this);
+  CustomWebEnginePage *customPage = new CustomWebEnginePage(BrowserProfile::instance()->profile(), this);
   setPage(customPage);
 
   // Improve mouse/click responsiveness for macOS
@@ -127,18 +138,14 @@ WebView::WebView(QWidget *parent) : QWebEngineView(parent), devToolsView(nullptr
   setAttribute(Qt::WA_MouseNoMask, true);
   setAttribute(Qt::WA_Hover, true);
   setMouseTracking(true);
-#ifdef DEBUG_MODE
-  qDebug() << "macOS specific mouse handling enabled for WebView";
-#endif
+  qCDebug(lcWebView) << "macOS specific mouse handling enabled for WebView";
 #endif
 
   // Install event filter to catch mouse events at a lower level
   installEventFilter(this);
   // Also install event filter on the page
   customPage->installEventFilter(this);
-#ifdef DEBUG_MODE
-  qDebug() << "Event filter installed for WebView and page";
-#endif
+  qCDebug(lcWebView) << "Event filter installed for WebView and page";
 
   // Ensure JavaScript is enabled for this page
   QWebEngineSettings *pageSettings = customPage->settings();
@@ -481,81 +488,11 @@ WebView::WebView(QWidget *parent) : QWebEngineView(parent), devToolsView(nullptr
   grabGesture(Qt::SwipeGesture);
   grabGesture(Qt::PanGesture); // トラックパッドでのスワイプをより感度よく検出
 
-  // JavaScriptでトラックパッドスワイプを検出
-  connect(this, &QWebEngineView::loadFinished, this, [this](bool ok) {
-    if (ok) {
-      QString swipeScript = R"(
-        (function() {
-          let startX = 0;
-          let startY = 0;
-          let startTime = 0;
-
-          // Wait for QWebChannel to be available
-          function initializeSwipeHandling() {
-            if (typeof qt !== 'undefined' && qt.webChannelTransport && typeof mainWindow !== 'undefined') {
-              console.log('WebChannel available, setting up swipe handlers');
-
-              // マウスホイールイベントでスワイプを検出（macOSトラックパッド対応）
-              document.addEventListener('wheel', function(e) {
-                // 水平スクロールの検出
-                if (Math.abs(e.deltaX) > Math.abs(e.deltaY) && Math.abs(e.deltaX) > 30) {
-                  if (e.deltaX > 0) {
-                    // 右スワイプ - 戻る
-                    console.log('Trackpad swipe back detected');
-                    mainWindow.handleSwipeBack();
-                  } else {
-                    // 左スワイプ - 進む
-                    console.log('Trackpad swipe forward detected');
-                    mainWindow.handleSwipeForward();
-                  }
-                }
-              }, { passive: true });
-
-              // タッチイベントでもスワイプを検出
-              document.addEventListener('touchstart', function(e) {
-                if (e.touches.length === 1) {
-                  startX = e.touches[0].clientX;
-                  startY = e.touches[0].clientY;
-                  startTime = Date.now();
-                }
-              }, { passive: true });
-
-              document.addEventListener('touchend', function(e) {
-                if (e.changedTouches.length === 1 && startTime > 0) {
-                  const endX = e.changedTouches[0].clientX;
-                  const endY = e.changedTouches[0].clientY;
-                  const deltaX = endX - startX;
-                  const deltaY = endY - startY;
-                  const deltaTime = Date.now() - startTime;
-
-                  // スワイプの条件: 水平方向の移動が垂直方向より大きく、十分な距離で短時間
-                  if (Math.abs(deltaX) > Math.abs(deltaY) && Math.abs(deltaX) > 100 && deltaTime < 500) {
-                    if (deltaX > 0) {
-                      // 右スワイプ - 戻る
-                      console.log('Touch swipe back detected');
-                      mainWindow.handleSwipeBack();
-                    } else {
-                      // 左スワイプ - 進む
-                      console.log('Touch swipe forward detected');
-                      mainWindow.handleSwipeForward();
-                    }
-                  }
-                  startTime = 0;
-                }
-              }, { passive: true });
-            } else {
-              // Retry after a short delay
-              setTimeout(initializeSwipeHandling, 100);
-            }
-          }
-
-          // Start initialization
-          initializeSwipeHandling();
-        })();
-      )";
-      page()->runJavaScript(swipeScript);
-    }
-  });
+  // Trackpad and touch swipes are recognized from the input events in eventFilter(),
+  // so pages get no extra wheel listener on their scroll path
+  for (QWidget *child : findChildren<QWidget *>(Qt::FindDirectChildrenOnly)) {
+    child->installEventFilter(this);
+  }
 
   // Enable right-click context menu with "Inspect Element" option
   setContextMenuPolicy(Qt::CustomContextMenu);
@@ -590,6 +527,24 @@ void WebView::setPage(QWebEnginePage *page) {
     pageSettings->setAttribute(QWebEngineSettings::WebGLEnabled, true);
     pageSettings->setAttribute(QWebEngineSettings::Accelerated2dCanvasEnabled, true);
     pageSettings->setAttribute(QWebEngineSettings::PlaybackRequiresUserGesture, false);
+    if (!requestInterceptors.isEmpty()) {
+      page->setUrlRequestInterceptor(requestDispatcher);
+    }
+  }
+}
+
+void WebView::addRequestInterceptor(QWebEngineUrlRequestInterceptor *interceptor) {
+  if (!interceptor || requestInterceptors.contains(interceptor))
+    return;
+  requestInterceptors.append(interceptor);
+  page()->setUrlRequestInterceptor(requestDispatcher);
+}
+
+void WebView::removeRequestInterceptor(QWebEngineUrlRequestInterceptor *interceptor) {
+  requestInterceptors.removeAll(interceptor);
+  requestInterceptors.removeAll(nullptr);
+  if (requestInterceptors.isEmpty()) {
+    page()->setUrlRequestInterceptor(nullptr);
   }
 }
 
@@ -607,9 +562,11 @@ QWebEngineView *WebView::createWindow(QWebEnginePage::WebWindowType type) {
   }
 
   if (mainWindow) {
-    // Create a new tab in the main window
-    mainWindow->newTab(); // This creates a new WebView and sets it as current
-    WebView *newView = mainWindow->currentWebView();
+    // Create an empty tab; WebEngine navigates it to the pop-up's URL.
+    // Ctrl/middle-clicked links ask for a background tab and keep the current one
+    WebView *newView = mainWindow->createTab(type == QWebEnginePage::WebBrowserBackgroundTab
+                                                 ? MainWindow::BackgroundTab
+                                                 : MainWindow::ForegroundTab);
 
     // For pop-ups, we might want to handle them differently,
     // but for now, just open them in a new tab.
@@ -624,30 +581,30 @@ bool WebView::event(QEvent *event) {
   // Log all mouse-related events for debugging
   switch (event->type()) {
   case QEvent::MouseButtonPress:
-#ifdef DEBUG_MODE
-    qDebug() << "WebView::event - MouseButtonPress";
-#endif
+    qCDebug(lcInput) << "WebView::event - MouseButtonPress";
     setFocus(Qt::MouseFocusReason);
     break;
   case QEvent::MouseButtonRelease:
-#ifdef DEBUG_MODE
-    qDebug() << "WebView::event - MouseButtonRelease";
-#endif
+    qCDebug(lcInput) << "WebView::event - MouseButtonRelease";
     break;
   case QEvent::MouseButtonDblClick:
-#ifdef DEBUG_MODE
-    qDebug() << "WebView::event - MouseButtonDblClick";
-#endif
+    qCDebug(lcInput) << "WebView::event - MouseButtonDblClick";
     setFocus(Qt::MouseFocusReason);
     break;
   case QEvent::Gesture:
     return gestureEvent(static_cast<QGestureEvent *>(event));
+  case QEvent::ChildAdded: {
+    // Input goes to the render widget WebEngine creates as a child, not to the view itself
+    QObject *child = static_cast<QChildEvent *>(event)->child();
+    if (child->isWidgetType()) {
+      child->installEventFilter(this);
+    }
+    break;
+  }
   case QEvent::TouchBegin:
   case QEvent::TouchUpdate:
   case QEvent::TouchEnd:
-#ifdef DEBUG_MODE
-    qDebug() << "WebView::event - Touch event detected (may interfere with mouse):" << event->type();
-#endif
+    qCDebug(lcInput) << "WebView::event - Touch event detected (may interfere with mouse):" << event->type();
     // Return false to let the event propagate normally
     return false;
   default:
@@ -780,19 +737,19 @@ void WebView::requestPictureInPicture() {
 
   page()->runJavaScript(script, [this](const QVariant &result) {
     QVariantMap resultMap = result.toMap();
-    qDebug() << "WebView PiP: JavaScript result:" << resultMap;
+    qCDebug(lcPiP) << "WebView PiP: JavaScript result:" << resultMap;
 
     if (resultMap.contains("success") && resultMap["success"].toBool()) {
       QString videoUrl = resultMap["videoUrl"].toString();
       QString title = resultMap["title"].toString();
 
-      qDebug() << "WebView PiP: Emitting pipVideoRequested signal with URL:" << videoUrl << "Title:" << title;
+      qCDebug(lcPiP) << "WebView PiP: Emitting pipVideoRequested signal with URL:" << videoUrl << "Title:" << title;
 
       // Emit the signal that PictureInPictureManager is listening for
       emit pipVideoRequested(videoUrl, title);
     } else {
       QString errorMsg = resultMap["message"].toString();
-      qDebug() << "WebView PiP: No video found or error:" << errorMsg;
+      qCDebug(lcPiP) << "WebView PiP: No video found or error:" << errorMsg;
 
       // Emit signal with demo video to show placeholder
       emit pipVideoRequested("demo://test-video", "Test Video - 動画が見つかりませんでした");
@@ -855,9 +812,7 @@ void WebView::contextMenuEvent(QContextMenuEvent *event) {
 }
 
 WebView::~WebView() {
-#ifdef DEBUG_MODE
-  qDebug() << "WebView::~WebView() - Starting cleanup";
-#endif
+  qCDebug(lcWebView) << "WebView::~WebView() - Starting cleanup";
 
   try {
     // Remove event filters to prevent crashes
@@ -867,13 +822,14 @@ WebView::~WebView() {
 
       // Disconnect all signals to prevent callbacks during destruction
       disconnect(page(), nullptr, this, nullptr);
+
+      // The dispatcher is deleted before the page
+      page()->setUrlRequestInterceptor(nullptr);
     }
 
     // Safely close developer tools if open
     if (devToolsView) {
-#ifdef DEBUG_MODE
-      qDebug() << "WebView::~WebView() - Closing developer tools";
-#endif
+      qCDebug(lcWebView) << "WebView::~WebView() - Closing developer tools";
 
       // Disconnect from page before closing
       if (page()) {
@@ -886,24 +842,18 @@ WebView::~WebView() {
       devToolsView = nullptr;
     }
 
-#ifdef DEBUG_MODE
-    qDebug() << "WebView::~WebView() - Cleanup completed";
-#endif
+    qCDebug(lcWebView) << "WebView::~WebView() - Cleanup completed";
   } catch (...) {
-#ifdef DEBUG_MODE
-    qDebug() << "WebView::~WebView() - Exception during cleanup";
-#endif
+    qCDebug(lcWebView) << "WebView::~WebView() - Exception during cleanup";
   }
 }
 
 void WebView::mousePressEvent(QMouseEvent *event) {
-#ifdef DEBUG_MODE
-  qDebug() << "WebView::mousePressEvent - Button:" << event->button()
-           << "Position:" << event->pos()
-           << "Global:" << event->globalPosition()
-           << "Modifiers:" << event->modifiers()
-           << "Accepted:" << event->isAccepted();
-#endif
+  qCDebug(lcInput) << "WebView::mousePressEvent - Button:" << event->button()
+                   << "Position:" << event->pos()
+                   << "Global:" << event->globalPosition()
+                   << "Modifiers:" << event->modifiers()
+                   << "Accepted:" << event->isAccepted();
 
   // Ensure focus and proper event handling
   setFocus(Qt::MouseFocusReason);
@@ -914,18 +864,14 @@ void WebView::mousePressEvent(QMouseEvent *event) {
   // Call parent implementation to ensure proper WebEngine handling
   QWebEngineView::mousePressEvent(event);
 
-#ifdef DEBUG_MODE
-  qDebug() << "WebView::mousePressEvent - After parent call, Accepted:" << event->isAccepted();
-#endif
+  qCDebug(lcInput) << "WebView::mousePressEvent - After parent call, Accepted:" << event->isAccepted();
 }
 
 void WebView::mouseReleaseEvent(QMouseEvent *event) {
-#ifdef DEBUG_MODE
-  qDebug() << "WebView::mouseReleaseEvent - Button:" << event->button()
-           << "Position:" << event->pos()
-           << "Global:" << event->globalPosition()
-           << "Accepted:" << event->isAccepted();
-#endif
+  qCDebug(lcInput) << "WebView::mouseReleaseEvent - Button:" << event->button()
+                   << "Position:" << event->pos()
+                   << "Global:" << event->globalPosition()
+                   << "Accepted:" << event->isAccepted();
 
   // Accept the event
   event->accept();
@@ -933,19 +879,15 @@ void WebView::mouseReleaseEvent(QMouseEvent *event) {
   // Call parent implementation
   QWebEngineView::mouseReleaseEvent(event);
 
-#ifdef DEBUG_MODE
-  qDebug() << "WebView::mouseReleaseEvent - After parent call, Accepted:" << event->isAccepted();
-#endif
+  qCDebug(lcInput) << "WebView::mouseReleaseEvent - After parent call, Accepted:" << event->isAccepted();
 }
 
 void WebView::mouseMoveEvent(QMouseEvent *event) {
   // Only log if a button is pressed to avoid spam
-#ifdef DEBUG_MODE
   if (event->buttons() != Qt::NoButton) {
-    qDebug() << "WebView::mouseMoveEvent - Buttons:" << event->buttons()
-             << "Position:" << event->pos();
+    qCDebug(lcInput) << "WebView::mouseMoveEvent - Buttons:" << event->buttons()
+                     << "Position:" << event->pos();
   }
-#endif
 
   // Call parent implementation
   QWebEngineView::mouseMoveEvent(event);
@@ -953,32 +895,44 @@ void WebView::mouseMoveEvent(QMouseEvent *event) {
 
 bool WebView::eventFilter(QObject *obj, QEvent *event) {
   // Log all mouse events that come through the event filter
-#ifdef DEBUG_MODE
-  if (event->type() == QEvent::MouseButtonPress ||
-      event->type() == QEvent::MouseButtonRelease ||
-      event->type() == QEvent::MouseButtonDblClick) {
+  if (lcInput().isDebugEnabled() &&
+      (event->type() == QEvent::MouseButtonPress ||
+       event->type() == QEvent::MouseButtonRelease ||
+       event->type() == QEvent::MouseButtonDblClick)) {
 
     QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
-    qDebug() << "WebView::eventFilter - Event type:" << event->type()
-             << "Button:" << mouseEvent->button()
-             << "Position:" << mouseEvent->pos()
-             << "Global:" << mouseEvent->globalPosition()
-             << "Object:" << obj->objectName()
-             << "Class:" << obj->metaObject()->className();
+    qCDebug(lcInput) << "WebView::eventFilter - Event type:" << event->type()
+                     << "Button:" << mouseEvent->button()
+                     << "Position:" << mouseEvent->pos()
+                     << "Global:" << mouseEvent->globalPosition()
+                     << "Object:" << obj->objectName()
+                     << "Class:" << obj->metaObject()->className();
 
     // Let the event continue processing
     return false;
   }
-#endif
+
+  // Observe only; the page still receives and scrolls with every event
+  if (obj != this && obj->isWidgetType()) {
+    SwipeTracker::Direction direction = SwipeTracker::None;
+    if (event->type() == QEvent::Wheel) {
+      direction = swipeTracker.wheel(static_cast<QWheelEvent *>(event));
+    } else if (event->type() == QEvent::TouchEnd) {
+      direction = swipeTracker.touch(static_cast<QTouchEvent *>(event));
+    }
+    if (direction == SwipeTracker::Back) {
+      handleSwipeBack();
+    } else if (direction == SwipeTracker::Forward) {
+      handleSwipeForward();
+    }
+  }
 
   // For all other events, pass to parent
   return QWebEngineView::eventFilter(obj, event);
 }
 
 void WebView::focusInEvent(QFocusEvent *event) {
-#ifdef DEBUG_MODE
-  qDebug() << "WebView::focusInEvent - Reason:" << event->reason();
-#endif
+  qCDebug(lcInput) << "WebView::focusInEvent - Reason:" << event->reason();
   QWebEngineView::focusInEvent(event);
 
   // Ensure the WebView has focus for proper event handling
@@ -986,9 +940,7 @@ void WebView::focusInEvent(QFocusEvent *event) {
 }
 
 void WebView::focusOutEvent(QFocusEvent *event) {
-#ifdef DEBUG_MODE
-  qDebug() << "WebView::focusOutEvent - Reason:" << event->reason();
-#endif
+  qCDebug(lcInput) << "WebView::focusOutEvent - Reason:" << event->reason();
   QWebEngineView::focusOutEvent(event);
 }
 
@@ -1005,11 +957,11 @@ void WebView::handleSwipeForward() {
 }
 
 void WebView::handlePipImageSelection(const QString &imageUrl, const QString &title) {
-  qDebug() << "WebView: PiP image selection handled:" << title << imageUrl;
+  qCDebug(lcPiP) << "WebView: PiP image selection handled:" << title << imageUrl;
   emit pipImageRequested(imageUrl, title);
 }
 
 void WebView::handlePipVideoSelection(const QString &videoUrl, const QString &title) {
-  qDebug() << "WebView: PiP video selection handled:" << title << videoUrl;
+  qCDebug(lcPiP) << "WebView: PiP video selection handled:" << title << videoUrl;
   emit pipVideoRequested(videoUrl, title);
 }
@@ -8,12 +8,16 @@
 #include <QKeyEvent>
 #include <QMenu>
 #include <QMouseEvent>
+#include <QPointer>
 #include <QSwipeGesture>
 #include <QWebEngineHistory>
 #include <QWebEnginePage>
 #include <QWebEngineProfile>
+#include <QWebEngineUrlRequestInterceptor>
 #include <QWebEngineView>
 
+#include "swipetracker.h"
+
 // Custom page class to handle JavaScript console messages
 class CustomWebEnginePage : public QWebEnginePage {
   Q_OBJECT
@@ -34,6 +38,11 @@ public:
   WebView(QWidget *parent = nullptr);
   ~WebView();
   void setPage(QWebEnginePage *page); // Allow setting a custom page if needed
+  int tabId() const { return id; }    // Stable id used by page scripts to identify this tab
+
+  // A page has one request interceptor; features add theirs here and are called in the order they were added
+  void addRequestInterceptor(QWebEngineUrlRequestInterceptor *interceptor);
+  void removeRequestInterceptor(QWebEngineUrlRequestInterceptor *interceptor);
 
 public slots:
   void showDevTools();            // Show developer tools
@@ -57,6 +66,10 @@ protected:
 
 private:
   QWebEngineView *devToolsView; // Developer tools window
+  int id;
+  QList<QPointer<QWebEngineUrlRequestInterceptor>> requestInterceptors;
+  QWebEngineUrlRequestInterceptor *requestDispatcher; // Installed on the page while requestInterceptors is not empty
+  SwipeTracker swipeTracker; // Fed from the render widget's wheel and touch events
 
 signals:
   // Forward signals from QWebEnginePage if needed, or connect directly in MainWindow
@@ -1,11 +1,13 @@
 #include "workspacemanager.h"
+#include "../logging/logcategories.h"
 #include "../tab-widget/verticaltabwidget.h"
 #include "../webview/webview.h"
-#include <QDebug>
+#include "workspacesessionstore.h"
 #include <QUuid>
 
 WorkspaceManager::WorkspaceManager(QObject *parent)
-    : QObject(parent), tabWidget(nullptr) {
+    : QObject(parent), tabWidget(nullptr), workspaceComboBox(nullptr), newWorkspaceButton(nullptr),
+      deleteWorkspaceButton(nullptr), renameWorkspaceButton(nullptr), sessionStore(nullptr) {
 
   // Setup settings path
   QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
@@ -13,7 +15,9 @@ WorkspaceManager::WorkspaceManager(QObject *parent)
   if (!dir.exists()) {
     dir.mkpath(appDataPath);
   }
-  settingsPath = appDataPath + "/workspaces.json";
+  settingsPath = appDataPath + "/workspaces.session";
+  legacySettingsPath = appDataPath + "/workspaces.json";
+  sessionStore = new WorkspaceSessionStore(settingsPath);
 
   loadWorkspacesFromFile();
   if (workspaces.isEmpty()) {
@@ -24,6 +28,7 @@ WorkspaceManager::WorkspaceManager(QObject *parent)
 WorkspaceManager::~WorkspaceManager() {
   saveCurrentWorkspace();
   saveWorkspacesToFile();
+  delete sessionStore;
 }
 
 void WorkspaceManager::setTabWidget(VerticalTabWidget *widget) {
@@ -32,13 +37,7 @@ void WorkspaceManager::setTabWidget(VerticalTabWidget *widget) {
 
 QWidget *WorkspaceManager::createWorkspaceToolbar(QWidget *parent) {
   QWidget *toolbar = new QWidget(parent);
-  toolbar->setStyleSheet(
-      "QWidget { "
-      "  background: qlineargradient(x1: 0, y1: 0, x2: 0, y2: 1, "
-      "    stop: 0 #f8f9fa, stop: 1 #e9ecef); "
-      "  border-bottom: 2px solid #007ACC; "
-      "  padding: 8px; "
-      "}");
+  toolbar->setObjectName("workspaceToolbar");
 
   QHBoxLayout *layout = new QHBoxLayout(toolbar);
   layout->setContentsMargins(15, 8, 15, 8);
@@ -46,89 +45,18 @@ QWidget *WorkspaceManager::createWorkspaceToolbar(QWidget *parent) {
 
   // Workspace label
   QLabel *label = new QLabel("Workspace:", toolbar);
-  label->setStyleSheet(
-      "QLabel { "
-      "  color: #2d2d30; "
-      "  font-weight: bold; "
-      "  font-size: 14px; "
-      "}");
   layout->addWidget(label);
 
   // Workspace selector - improved styling
   workspaceComboBox = new QComboBox(toolbar);
   workspaceComboBox->setMinimumWidth(180);
-  workspaceComboBox->setStyleSheet(
-      "QComboBox { "
-      "  padding: 8px 12px; "
-      "  background-color: white; "
-      "  border: 2px solid #d1d5db; "
-      "  border-radius: 6px; "
-      "  font-size: 13px; "
-      "  font-weight: 500; "
-      "} "
-      "QComboBox:hover { "
-      "  border-color: #007ACC; "
-      "} "
-      "QComboBox:focus { "
-      "  border-color: #0066cc; "
-      "  outline: none; "
-      "} "
-      "QComboBox::drop-down { "
-      "  border: none; "
-      "  padding-right: 8px; "
-      "} "
-      "QComboBox::down-arrow { "
-      "  image: none; "
-      "  border: 2px solid #6b7280; "
-      "  border-radius: 2px; "
-      "  width: 8px; height: 8px; "
-      "  border-top: none; "
-      "  border-right: none; "
-      "}");
+  workspaceComboBox->setObjectName("workspaceCombo");
   connect(workspaceComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
           this, &WorkspaceManager::onWorkspaceChanged);
   layout->addWidget(workspaceComboBox);
 
-  // Workspace management buttons with improved styling
-  QString buttonStyle =
-      "QPushButton { "
-      "  padding: 8px 16px; "
-      "  background-color: #007ACC; "
-      "  color: white; "
-      "  border: none; "
-      "  border-radius: 6px; "
-      "  font-weight: bold; "
-      "  font-size: 12px; "
-      "  min-width: 70px; "
-      "} "
-      "QPushButton:hover { "
-      "  background-color: #005a9e; "
-      "} "
-      "QPushButton:pressed { "
-      "  background-color: #004578; "
-      "}";
-
-  QString dangerButtonStyle =
-      "QPushButton { "
-      "  padding: 8px 16px; "
-      "  background-color: #dc3545; "
-      "  color: white; "
-      "  border: none; "
-      "  border-radius: 6px; "
-      "  font-weight: bold; "
-      "  font-size: 12px; "
-      "  min-width: 70px; "
-      "} "
-      "QPushButton:hover { "
-      "  background-color: #c82333; "
-      "} "
-      "QPushButton:pressed { "
-      "  background-color: #bd2130; "
-      "}";
-
   newWorkspaceButton = new QPushButton("+ New", toolbar);
   newWorkspaceButton->setToolTip("Create new workspace");
-  newWorkspaceButton->setStyleSheet(buttonStyle);
 
   // Improve button responsiveness
   newWorkspaceButton->setFocusPolicy(Qt::StrongFocus);
@@ -139,7 +67,6 @@ QWidget *WorkspaceManager::createWorkspaceToolbar(QWidget *parent) {
 
   renameWorkspaceButton = new QPushButton("Rename", toolbar);
   renameWorkspaceButton->setToolTip("Rename current workspace");
-  renameWorkspaceButton->setStyleSheet(buttonStyle);
 
   // Improve button responsiveness
   renameWorkspaceButton->setFocusPolicy(Qt::StrongFocus);
@@ -150,7 +77,7 @@ QWidget *WorkspaceManager::createWorkspaceToolbar(QWidget *parent) {
 
   deleteWorkspaceButton = new QPushButton("Delete", toolbar);
   deleteWorkspaceButton->setToolTip("Delete current workspace");
-  deleteWorkspaceButton->setStyleSheet(dangerButtonStyle);
+  deleteWorkspaceButton->setObjectName("deleteWorkspaceButton");
 
   // Improve button responsiveness
   deleteWorkspaceButton->setFocusPolicy(Qt::StrongFocus);
@@ -178,6 +105,7 @@ void WorkspaceManager::saveCurrentWorkspace() {
       // Clear existing data
       workspace.tabUrls.clear();
       workspace.tabTitles.clear();
+      workspace.tabsLoaded = true;
       workspace.activeTabIndex = tabWidget->currentIndex();
 
       // Save current tabs
@@ -197,17 +125,13 @@ void WorkspaceManager::loadWorkspace(const QString &workspaceId) {
   saveCurrentWorkspace(); // Save current workspace before switching
 
   // Find target workspace
-  Workspace *targetWorkspace = nullptr;
-  for (auto &workspace : workspaces) {
-    if (workspace.id == workspaceId) {
-      targetWorkspace = &workspace;
-      break;
-    }
-  }
-
+  Workspace *targetWorkspace = findWorkspace(workspaceId);
   if (!targetWorkspace)
     return;
 
+  // Decode tab lists only now that the workspace is actually used
+  ensureTabsLoaded(*targetWorkspace);
+
   currentWorkspaceId = workspaceId;
 
   // Close all current tabs
@@ -215,8 +139,8 @@ void WorkspaceManager::loadWorkspace(const QString &workspaceId) {
 
   // Load workspace tabs
   if (targetWorkspace->tabUrls.isEmpty()) {
-    // Create a default tab if workspace is empty
-    emit requestNewTab("https://www.google.com");
+    // Create a default tab (home page) if workspace is empty
+    emit requestNewTab(QString());
   } else {
     for (const QString &url : targetWorkspace->tabUrls) {
       emit requestNewTab(url);
@@ -239,6 +163,9 @@ void WorkspaceManager::createNewWorkspace(const QString &name) {
 
   updateWorkspaceComboBox();
 
+  if (!workspaceComboBox)
+    return;
+
   // Switch to new workspace
   for (int i = 0; i < workspaceComboBox->count(); ++i) {
     if (workspaceComboBox->itemData(i).toString() == id) {
@@ -264,7 +191,7 @@ void WorkspaceManager::deleteWorkspace(const QString &workspaceId) {
   updateWorkspaceComboBox();
 
   // Switch to first available workspace if current was deleted
-  if (currentWorkspaceId == workspaceId && !workspaces.isEmpty()) {
+  if (workspaceComboBox && currentWorkspaceId == workspaceId && !workspaces.isEmpty()) {
     workspaceComboBox->setCurrentIndex(0);
   }
 }
@@ -287,6 +214,14 @@ QStringList WorkspaceManager::getWorkspaceNames() const {
   return names;
 }
 
+QStringList WorkspaceManager::getWorkspaceIds() const {
+  QStringList ids;
+  for (const auto &workspace : workspaces) {
+    ids.append(workspace.id);
+  }
+  return ids;
+}
+
 QString WorkspaceManager::getCurrentWorkspaceId() const {
   return currentWorkspaceId;
 }
@@ -354,75 +289,49 @@ void WorkspaceManager::setupDefaultWorkspace() {
 }
 
 void WorkspaceManager::saveWorkspacesToFile() {
-  QJsonArray workspaceArray;
-
-  for (const auto &workspace : workspaces) {
-    QJsonObject workspaceObj;
-    workspaceObj["name"] = workspace.name;
-    workspaceObj["id"] = workspace.id;
-    workspaceObj["activeTabIndex"] = workspace.activeTabIndex;
-
-    QJsonArray urlArray;
-    for (const QString &url : workspace.tabUrls) {
-      urlArray.append(url);
-    }
-    workspaceObj["tabUrls"] = urlArray;
-
-    QJsonArray titleArray;
-    for (const QString &title : workspace.tabTitles) {
-      titleArray.append(title);
-    }
-    workspaceObj["tabTitles"] = titleArray;
-
-    workspaceArray.append(workspaceObj);
-  }
-
-  QJsonObject rootObj;
-  rootObj["workspaces"] = workspaceArray;
-  rootObj["currentWorkspaceId"] = currentWorkspaceId;
-
-  QJsonDocument doc(rootObj);
-
-  QFile file(settingsPath);
-  if (file.open(QIODevice::WriteOnly)) {
-    file.write(doc.toJson());
+  if (!sessionStore->save(workspaces, currentWorkspaceId)) {
+    qCWarning(lcWorkspace) << "Failed to save workspaces to" << settingsPath;
   }
 }
 
 void WorkspaceManager::loadWorkspacesFromFile() {
-  QFile file(settingsPath);
-  if (!file.open(QIODevice::ReadOnly)) {
-    return;
+  // One-time migration from the old JSON format
+  if (!sessionStore->exists() && QFile::exists(legacySettingsPath)) {
+    WorkspaceSessionStore::convertJsonSession(legacySettingsPath, settingsPath);
   }
 
-  QByteArray data = file.readAll();
-  QJsonDocument doc = QJsonDocument::fromJson(data);
-  QJsonObject rootObj = doc.object();
-
-  currentWorkspaceId = rootObj["currentWorkspaceId"].toString();
-
-  QJsonArray workspaceArray = rootObj["workspaces"].toArray();
-  workspaces.clear();
+  if (!sessionStore->open(workspaces, currentWorkspaceId)) {
+    workspaces.clear();
+    return;
+  }
 
-  for (const auto &value : workspaceArray) {
-    QJsonObject workspaceObj = value.toObject();
+  Workspace *current = findWorkspace(currentWorkspaceId);
+  if (!current && !workspaces.isEmpty()) {
+    current = &workspaces.first();
+    currentWorkspaceId = current->id;
+  }
 
-    Workspace workspace;
-    workspace.name = workspaceObj["name"].toString();
-    workspace.id = workspaceObj["id"].toString();
-    workspace.activeTabIndex = workspaceObj["activeTabIndex"].toInt();
+  // Only the active workspace is decoded at startup
+  if (current) {
+    ensureTabsLoaded(*current);
+  }
+}
 
-    QJsonArray urlArray = workspaceObj["tabUrls"].toArray();
-    for (const auto &urlValue : urlArray) {
-      workspace.tabUrls.append(urlValue.toString());
+Workspace *WorkspaceManager::findWorkspace(const QString &workspaceId) {
+  for (auto &workspace : workspaces) {
+    if (workspace.id == workspaceId) {
+      return &workspace;
     }
+  }
+  return nullptr;
+}
 
-    QJsonArray titleArray = workspaceObj["tabTitles"].toArray();
-    for (const auto &titleValue : titleArray) {
-      workspace.tabTitles.append(titleValue.toString());
-    }
+void WorkspaceManager::ensureTabsLoaded(Workspace &workspace) {
+  if (workspace.tabsLoaded)
+    return;
 
-    workspaces.append(workspace);
+  if (!sessionStore->decodeTabs(workspace)) {
+    qCWarning(lcWorkspace) << "Failed to decode tabs for workspace" << workspace.name;
   }
 }
 
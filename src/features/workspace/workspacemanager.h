@@ -19,6 +19,7 @@
 #include <QWidget>
 
 class VerticalTabWidget;
+class WorkspaceSessionStore;
 
 struct Workspace {
   QString name;
@@ -27,8 +28,14 @@ struct Workspace {
   QStringList tabTitles;
   int activeTabIndex;
 
-  Workspace() : activeTabIndex(0) {}
-  Workspace(const QString &n, const QString &i) : name(n), id(i), activeTabIndex(0) {}
+  // Tab lists are decoded lazily from the session file on first use
+  bool tabsLoaded;
+  qint64 tabsOffset;
+  qint64 tabsLength;
+
+  Workspace() : activeTabIndex(0), tabsLoaded(true), tabsOffset(0), tabsLength(0) {}
+  Workspace(const QString &n, const QString &i)
+      : name(n), id(i), activeTabIndex(0), tabsLoaded(true), tabsOffset(0), tabsLength(0) {}
 };
 
 class WorkspaceManager : public QObject {
@@ -48,6 +55,7 @@ public:
   void renameWorkspace(const QString &workspaceId, const QString &newName);
 
   QStringList getWorkspaceNames() const;
+  QStringList getWorkspaceIds() const;
   QString getCurrentWorkspaceId() const;
   QString getCurrentWorkspaceName() const;
 
@@ -66,6 +74,8 @@ private:
   void setupDefaultWorkspace();
   void saveWorkspacesToFile();
   void loadWorkspacesFromFile();
+  Workspace *findWorkspace(const QString &workspaceId);
+  void ensureTabsLoaded(Workspace &workspace);
   QString generateWorkspaceId() const;
   void updateWorkspaceComboBox();
 
@@ -78,6 +88,8 @@ private:
   QList<Workspace> workspaces;
   QString currentWorkspaceId;
   QString settingsPath;
+  QString legacySettingsPath;
+  WorkspaceSessionStore *sessionStore;
 };
 
 #endif // WORKSPACEMANAGER_H
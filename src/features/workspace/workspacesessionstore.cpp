@@ -0,0 +1,380 @@
+#include "workspacesessionstore.h"
+#include "../logging/logcategories.h"
+#include "workspacemanager.h"
+#include <QCborStreamReader>
+#include <QCborStreamWriter>
+#include <QSaveFile>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+const char SESSION_MAGIC[4] = {'M', 'B', 'W', 'S'};
+const quint32 SESSION_VERSION = 1;
+const qint64 PREAMBLE_SIZE = 12; // magic + version + header length
+
+QString readString(QCborStreamReader &reader) {
+  QString result;
+  if (!reader.isString()) {
+    reader.next();
+    return result;
+  }
+
+  auto chunk = reader.readString();
+  while (chunk.status == QCborStreamReader::Ok) {
+    result += chunk.data;
+    chunk = reader.readString();
+  }
+  return result;
+}
+
+qint64 readInteger(QCborStreamReader &reader) {
+  qint64 value = 0;
+  if (reader.isInteger()) {
+    value = reader.toInteger();
+  }
+  reader.next();
+  return value;
+}
+
+QStringList readStringArray(QCborStreamReader &reader) {
+  QStringList result;
+  if (!reader.isArray()) {
+    reader.next();
+    return result;
+  }
+
+  if (reader.isLengthKnown()) {
+    result.reserve(reader.length());
+  }
+  reader.enterContainer();
+  while (reader.lastError() == QCborError::NoError && reader.hasNext()) {
+    result.append(readString(reader));
+  }
+  reader.leaveContainer();
+  return result;
+}
+
+QByteArray encodeTabs(const Workspace &workspace) {
+  QByteArray blob;
+  QCborStreamWriter writer(&blob);
+  writer.startArray(2);
+
+  writer.startArray(workspace.tabUrls.size());
+  for (const QString &url : workspace.tabUrls) {
+    writer.append(url);
+  }
+  writer.endArray();
+
+  writer.startArray(workspace.tabTitles.size());
+  for (const QString &title : workspace.tabTitles) {
+    writer.append(title);
+  }
+  writer.endArray();
+
+  writer.endArray();
+  return blob;
+}
+} // namespace
+
+WorkspaceSessionStore::WorkspaceSessionStore(const QString &path)
+    : path(path), mapped(nullptr), mappedSize(0), blobBase(0) {
+}
+
+WorkspaceSessionStore::~WorkspaceSessionStore() {
+  unmapFile();
+}
+
+bool WorkspaceSessionStore::exists() const {
+  return QFile::exists(path);
+}
+
+bool WorkspaceSessionStore::mapFile() {
+  unmapFile();
+
+  file.setFileName(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  mappedSize = file.size();
+  if (mappedSize < PREAMBLE_SIZE) {
+    file.close();
+    return false;
+  }
+
+  mapped = file.map(0, mappedSize);
+  if (!mapped) {
+    file.close();
+    return false;
+  }
+  return true;
+}
+
+void WorkspaceSessionStore::unmapFile() {
+  if (mapped) {
+    file.unmap(mapped);
+    mapped = nullptr;
+  }
+  mappedSize = 0;
+  blobBase = 0;
+  if (file.isOpen()) {
+    file.close();
+  }
+}
+
+bool WorkspaceSessionStore::open(QList<Workspace> &workspaces, QString &currentWorkspaceId) {
+  if (!mapFile()) {
+    return false;
+  }
+
+  if (memcmp(mapped, SESSION_MAGIC, sizeof(SESSION_MAGIC)) != 0 ||
+      qFromBigEndian<quint32>(mapped + 4) != SESSION_VERSION) {
+    qCWarning(lcWorkspace) << "Unsupported workspace session file:" << path;
+    unmapFile();
+    return false;
+  }
+
+  const qint64 headerLength = qFromBigEndian<quint32>(mapped + 8);
+  if (PREAMBLE_SIZE + headerLength > mappedSize) {
+    qCWarning(lcWorkspace) << "Truncated workspace session header:" << path;
+    unmapFile();
+    return false;
+  }
+  blobBase = PREAMBLE_SIZE + headerLength;
+
+  QByteArray header = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped + PREAMBLE_SIZE), headerLength);
+  QCborStreamReader reader(header);
+  if (!reader.isMap()) {
+    unmapFile();
+    return false;
+  }
+
+  workspaces.clear();
+  reader.enterContainer();
+  while (reader.lastError() == QCborError::NoError && reader.hasNext()) {
+    const QString key = readString(reader);
+    if (key == QLatin1String("current")) {
+      currentWorkspaceId = readString(reader);
+    } else if (key == QLatin1String("workspaces") && reader.isArray()) {
+      reader.enterContainer();
+      while (reader.lastError() == QCborError::NoError && reader.hasNext()) {
+        if (!reader.isMap()) {
+          reader.next();
+          continue;
+        }
+
+        Workspace workspace;
+        workspace.tabsLoaded = false;
+
+        reader.enterContainer();
+        while (reader.lastError() == QCborError::NoError && reader.hasNext()) {
+          const QString field = readString(reader);
+          if (field == QLatin1String("id")) {
+            workspace.id = readString(reader);
+          } else if (field == QLatin1String("name")) {
+            workspace.name = readString(reader);
+          } else if (field == QLatin1String("activeTabIndex")) {
+            workspace.activeTabIndex = static_cast<int>(readInteger(reader));
+          } else if (field == QLatin1String("offset")) {
+            workspace.tabsOffset = readInteger(reader);
+          } else if (field == QLatin1String("length")) {
+            workspace.tabsLength = readInteger(reader);
+          } else {
+            reader.next();
+          }
+        }
+        reader.leaveContainer();
+
+        workspaces.append(workspace);
+      }
+      reader.leaveContainer();
+    } else {
+      reader.next();
+    }
+  }
+  reader.leaveContainer();
+
+  if (reader.lastError() != QCborError::NoError) {
+    qCWarning(lcWorkspace) << "Corrupt workspace session header:" << reader.lastError().toString();
+    workspaces.clear();
+    unmapFile();
+    return false;
+  }
+
+  return true;
+}
+
+bool WorkspaceSessionStore::decodeTabs(Workspace &workspace) const {
+  if (workspace.tabsLoaded) {
+    return true;
+  }
+
+  // On failure tabsLoaded stays false, so save() keeps the original blob instead of an empty list
+  if (!mapped || workspace.tabsLength <= 0 ||
+      blobBase + workspace.tabsOffset + workspace.tabsLength > mappedSize) {
+    return false;
+  }
+
+  QCborStreamReader reader(blobFor(workspace));
+  if (!reader.isArray()) {
+    return false;
+  }
+
+  QStringList urls;
+  QStringList titles;
+  reader.enterContainer();
+  if (reader.hasNext()) {
+    urls = readStringArray(reader);
+  }
+  if (reader.hasNext()) {
+    titles = readStringArray(reader);
+  }
+  reader.leaveContainer();
+
+  if (reader.lastError() != QCborError::NoError) {
+    return false;
+  }
+  workspace.tabUrls = urls;
+  workspace.tabTitles = titles;
+  workspace.tabsLoaded = true;
+  return true;
+}
+
+QByteArray WorkspaceSessionStore::blobFor(const Workspace &workspace) const {
+  // Points into the mapping; callers must not keep it past unmapFile()
+  if (!mapped || blobBase + workspace.tabsOffset + workspace.tabsLength > mappedSize) {
+    return QByteArray();
+  }
+  return QByteArray::fromRawData(reinterpret_cast<const char *>(mapped + blobBase + workspace.tabsOffset),
+                                 workspace.tabsLength);
+}
+
+bool WorkspaceSessionStore::save(QList<Workspace> &workspaces, const QString &currentWorkspaceId) {
+  // Build the blob section first; undecoded workspaces are copied byte for byte
+  QByteArray blobs;
+  QList<QPair<qint64, qint64>> ranges;
+  ranges.reserve(workspaces.size());
+
+  for (const Workspace &workspace : workspaces) {
+    QByteArray blob = workspace.tabsLoaded ? encodeTabs(workspace) : QByteArray(blobFor(workspace));
+    ranges.append({blobs.size(), blob.size()});
+    blobs.append(blob);
+  }
+
+  QByteArray header;
+  QCborStreamWriter writer(&header);
+  writer.startMap(2);
+  writer.append(QLatin1String("current"));
+  writer.append(currentWorkspaceId);
+  writer.append(QLatin1String("workspaces"));
+  writer.startArray(workspaces.size());
+  for (int i = 0; i < workspaces.size(); ++i) {
+    const Workspace &workspace = workspaces.at(i);
+    writer.startMap(5);
+    writer.append(QLatin1String("id"));
+    writer.append(workspace.id);
+    writer.append(QLatin1String("name"));
+    writer.append(workspace.name);
+    writer.append(QLatin1String("activeTabIndex"));
+    writer.append(qint64(workspace.activeTabIndex));
+    writer.append(QLatin1String("offset"));
+    writer.append(ranges.at(i).first);
+    writer.append(QLatin1String("length"));
+    writer.append(ranges.at(i).second);
+    writer.endMap();
+  }
+  writer.endArray();
+  writer.endMap();
+
+  uchar preamble[PREAMBLE_SIZE];
+  memcpy(preamble, SESSION_MAGIC, sizeof(SESSION_MAGIC));
+  qToBigEndian<quint32>(SESSION_VERSION, preamble + 4);
+  qToBigEndian<quint32>(static_cast<quint32>(header.size()), preamble + 8);
+
+  QSaveFile out(path);
+  if (!out.open(QIODevice::WriteOnly)) {
+    qCWarning(lcWorkspace) << "Failed to write workspace session:" << out.errorString();
+    return false;
+  }
+  out.write(reinterpret_cast<const char *>(preamble), PREAMBLE_SIZE);
+  out.write(header);
+  out.write(blobs);
+
+  // Release the old mapping before replacing the file (required on Windows); the blobs are copied by now
+  unmapFile();
+  if (!out.commit()) {
+    qCWarning(lcWorkspace) << "Failed to write workspace session:" << out.errorString();
+    // The old file is untouched: map it again, or undecoded workspaces would be saved empty next time
+    mapFile();
+    return false;
+  }
+
+  // Remap so that workspaces which are still encoded point at the new file
+  for (int i = 0; i < workspaces.size(); ++i) {
+    workspaces[i].tabsOffset = ranges.at(i).first;
+    workspaces[i].tabsLength = ranges.at(i).second;
+  }
+  if (mapFile()) {
+    blobBase = PREAMBLE_SIZE + header.size();
+  }
+  return true;
+}
+
+bool WorkspaceSessionStore::readJsonSession(const QString &jsonPath, QList<Workspace> &workspaces, QString &currentWorkspaceId) {
+  QFile jsonFile(jsonPath);
+  if (!jsonFile.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  QJsonDocument doc = QJsonDocument::fromJson(jsonFile.readAll());
+  if (!doc.isObject()) {
+    return false;
+  }
+  QJsonObject rootObj = doc.object();
+
+  currentWorkspaceId = rootObj["currentWorkspaceId"].toString();
+
+  QJsonArray workspaceArray = rootObj["workspaces"].toArray();
+  workspaces.clear();
+
+  for (const auto &value : workspaceArray) {
+    QJsonObject workspaceObj = value.toObject();
+
+    Workspace workspace;
+    workspace.name = workspaceObj["name"].toString();
+    workspace.id = workspaceObj["id"].toString();
+    workspace.activeTabIndex = workspaceObj["activeTabIndex"].toInt();
+
+    QJsonArray urlArray = workspaceObj["tabUrls"].toArray();
+    for (const auto &urlValue : urlArray) {
+      workspace.tabUrls.append(urlValue.toString());
+    }
+
+    QJsonArray titleArray = workspaceObj["tabTitles"].toArray();
+    for (const auto &titleValue : titleArray) {
+      workspace.tabTitles.append(titleValue.toString());
+    }
+
+    workspaces.append(workspace);
+  }
+  return true;
+}
+
+bool WorkspaceSessionStore::convertJsonSession(const QString &jsonPath, const QString &sessionPath) {
+  QList<Workspace> workspaces;
+  QString currentWorkspaceId;
+  if (!readJsonSession(jsonPath, workspaces, currentWorkspaceId)) {
+    return false;
+  }
+
+  WorkspaceSessionStore store(sessionPath);
+  if (!store.save(workspaces, currentWorkspaceId)) {
+    return false;
+  }
+
+  // Keep the original around in case the user downgrades
+  QFile::remove(jsonPath + ".bak");
+  QFile::rename(jsonPath, jsonPath + ".bak");
+  qCDebug(lcWorkspace) << "Migrated" << workspaces.size() << "workspaces from" << jsonPath << "to" << sessionPath;
+  return true;
+}
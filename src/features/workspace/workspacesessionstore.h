@@ -0,0 +1,53 @@
+#ifndef WORKSPACESESSIONSTORE_H
+#define WORKSPACESESSIONSTORE_H
+
+#include <QFile>
+#include <QList>
+#include <QString>
+
+struct Workspace;
+
+/**
+ * @brief Binary (CBOR) session file with a header index
+ *
+ * Layout: "MBWS" magic, big-endian version and header length, a CBOR header
+ * describing every workspace (name, id, active tab, blob offset/length), then
+ * one CBOR blob per workspace holding its tab URLs and titles.
+ *
+ * The file is memory-mapped, so opening a session only parses the header.
+ * Tab lists stay encoded until decodeTabs() is called for that workspace.
+ */
+class WorkspaceSessionStore {
+public:
+  explicit WorkspaceSessionStore(const QString &path);
+  ~WorkspaceSessionStore();
+
+  bool exists() const;
+
+  // Parse the header only; workspaces come back with tabsLoaded == false
+  bool open(QList<Workspace> &workspaces, QString &currentWorkspaceId);
+
+  // Decode the tab lists of a single workspace from the mapped file; on failure the
+  // workspace stays undecoded and save() writes its blob back unchanged
+  bool decodeTabs(Workspace &workspace) const;
+
+  // Write all workspaces; blobs of undecoded workspaces are copied verbatim
+  bool save(QList<Workspace> &workspaces, const QString &currentWorkspaceId);
+
+  // Migrate a legacy workspaces.json file to the binary format
+  static bool convertJsonSession(const QString &jsonPath, const QString &sessionPath);
+  static bool readJsonSession(const QString &jsonPath, QList<Workspace> &workspaces, QString &currentWorkspaceId);
+
+private:
+  bool mapFile();
+  void unmapFile();
+  QByteArray blobFor(const Workspace &workspace) const;
+
+  QString path;
+  QFile file;
+  uchar *mapped;
+  qint64 mappedSize;
+  qint64 blobBase;
+};
+
+#endif // WORKSPACESESSIONSTORE_H
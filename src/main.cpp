@@ -1,6 +1,19 @@
+#include "features/automation/automationserver.h"
+#include "features/content-blocking/contentblocker.h"
+#include "features/content-blocking/contentblockingmanager.h"
+#include "features/jobs/jobscheduler.h"
+#include "features/logging/logcategories.h"
+#include "features/logging/logsink.h"
 #include "features/main-window/mainwindow.h"
+#include "features/new-tab/newtabmanager.h"
+#include "features/page-search/pagesearchservice.h"
+#include "features/picture-in-picture/pipwindowpool.h"
+#include "features/profile/browserprofile.h"
+#include "features/single-instance/singleinstance.h"
+#include "features/webview/webview.h"
 #include <QApplication>
-#include <QDebug>
+#include <QCommandLineParser>
+#include <QDir>
 #include <QEvent>
 #include <QMouseEvent>
 #include <QWebEnginePage>
@@ -11,20 +24,18 @@
 class GlobalEventFilter : public QObject {
 public:
   bool eventFilter(QObject *obj, QEvent *event) override {
-#ifdef DEBUG_MODE
     if (event->type() == QEvent::MouseButtonPress ||
         event->type() == QEvent::MouseButtonRelease ||
         event->type() == QEvent::MouseButtonDblClick) {
 
       QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
-      qDebug() << "GlobalEventFilter - Event type:" << event->type()
-               << "Button:" << mouseEvent->button()
-               << "Position:" << mouseEvent->pos()
-               << "Global:" << mouseEvent->globalPosition()
-               << "Object:" << obj->objectName()
-               << "Class:" << obj->metaObject()->className();
+      qCDebug(lcInput) << "GlobalEventFilter - Event type:" << event->type()
+                       << "Button:" << mouseEvent->button()
+                       << "Position:" << mouseEvent->pos()
+                       << "Global:" << mouseEvent->globalPosition()
+                       << "Object:" << obj->objectName()
+                       << "Class:" << obj->metaObject()->className();
     }
-#endif
     return false; // Don't filter out the event
   }
 };
@@ -55,8 +66,39 @@ int main(int argc, char *argv[]) {
   qputenv("QTWEBENGINE_DISABLE_SANDBOX", "1"); // Improve compatibility
 #endif
 
+  // Custom schemes must be registered before the application is created
+  NewTabManager::registerScheme();
+
   QApplication a(argc, argv);
 
+  // parse() rather than process(): Chromium switches on the command line are not ours to reject
+  QCommandLineParser parser;
+  QCommandLineOption backgroundOption("background", "Keep running with the window hidden, so showing it is instant");
+  parser.addOption(backgroundOption);
+  QCommandLineOption automationOption("automation", "Accept JSON-RPC automation requests on a local socket", "name");
+  parser.addOption(automationOption);
+  parser.addPositionalArgument("urls", "Pages to open", "[urls...]");
+  parser.parse(a.arguments());
+  const bool background = parser.isSet(backgroundOption);
+  QStringList urls;
+  for (const QString &argument : parser.positionalArguments()) {
+    // Resolved here: the running instance has a different working directory
+    urls.append(QUrl::fromUserInput(argument, QDir::currentPath(), QUrl::AssumeLocalFile).toString());
+  }
+
+  // A browser is already running: hand it the URLs before anything heavy starts
+  SingleInstance singleInstance;
+  if (singleInstance.forward(urls, !background)) {
+    return 0;
+  }
+  // Lost a race with a launch that started listening after our forward()
+  if (!singleInstance.listen() && singleInstance.forward(urls, !background)) {
+    return 0;
+  }
+
+  // Every qDebug/qCDebug from here on is written by a background thread
+  LogSink::install();
+
   // Improve mouse/trackpad responsiveness on macOS
   a.setAttribute(Qt::AA_SynthesizeMouseForUnhandledTouchEvents, false); // Disable touch synthesis
   a.setAttribute(Qt::AA_SynthesizeTouchForUnhandledMouseEvents, false);
@@ -68,12 +110,13 @@ int main(int argc, char *argv[]) {
 #endif
 
   // Configure WebEngine settings for full JavaScript support
-  QWebEngineProfile *defaultProfile = QWebEngineProfile::defaultProfile();
-  QWebEngineSettings *globalSettings = defaultProfile->settings();
+  // All tabs share one persistent profile so the HTTP cache survives restarts
+  QWebEngineProfile *browserProfile = BrowserProfile::instance()->profile();
+  QWebEngineSettings *globalSettings = browserProfile->settings();
 
   // Set a modern user agent to ensure compatibility with modern websites
   QString userAgent = "Mozilla/5.0 (Macintosh; Intel Mac OS X 10_15_7) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36";
-  defaultProfile->setHttpUserAgent(userAgent);
+  browserProfile->setHttpUserAgent(userAgent);
 
   // Enable JavaScript and related features
   globalSettings->setAttribute(QWebEngineSettings::JavascriptEnabled, true);
@@ -116,24 +159,61 @@ int main(int argc, char *argv[]) {
   globalSettings->setAttribute(QWebEngineSettings::SpatialNavigationEnabled, false);
 #endif
 
-  // Install global event filter to debug mouse events
-  GlobalEventFilter *globalFilter = new GlobalEventFilter();
-  a.installEventFilter(globalFilter);
+  // Block ads and trackers; each tab's interceptor asks the blocker (ContentBlockingManager::attach)
+  ContentBlocker *contentBlocker = new ContentBlocker(&a);
+  contentBlocker->loadFilterLists();
+
+  // The global filter sees every event of the application; only install it when its output is wanted
+  if (lcInput().isDebugEnabled()) {
+    GlobalEventFilter *globalFilter = new GlobalEventFilter();
+    a.installEventFilter(globalFilter);
+    qCDebug(lcInput) << "Global event filter installed";
+  }
 #ifdef DEBUG_MODE
-  qDebug() << "DEBUG_MODE is enabled";
-  qDebug() << "Global event filter installed";
-#else
-  qDebug() << "RELEASE_MODE is enabled";
+  qCDebug(lcApp) << "DEBUG_MODE is enabled";
 #endif
 
   MainWindow w;
-  w.show();
+  w.getContentBlockingManager()->setBlocker(contentBlocker);
+  for (const QString &url : std::as_const(urls)) {
+    w.openTab(QUrl(url));
+  }
+  if (background) {
+    w.setRunInBackground(true);
+  } else {
+    w.show();
+  }
+
+  // Scripted load and soak tests; off unless asked for, since it can run script in any page
+  if (parser.isSet(automationOption)) {
+    AutomationServer *automation = new AutomationServer(&w);
+    automation->listen(parser.value(automationOption));
+  }
+
+  // Later launches: open their URLs here and bring the window up
+  QObject::connect(&singleInstance, &SingleInstance::openRequested, &w, [&w](const QStringList &urls, bool activate) {
+    for (const QString &url : urls) {
+      w.openTab(QUrl(url));
+    }
+    if (activate) {
+      w.setWindowState(w.windowState() & ~Qt::WindowMinimized);
+      w.show();
+      w.raise();
+      w.activateWindow();
+    }
+  });
 
   int result = a.exec();
 
-  // Clean shutdown - ensure all web engine processes are properly terminated
-  QWebEngineProfile::defaultProfile()->clearAllVisitedLinks();
-  QWebEngineProfile::defaultProfile()->clearHttpCache();
+  // PiP windows hold media players; destroy them while the multimedia backends are still up
+  PiPWindowPool::instance()->shutdown();
+  // Queued jobs are dropped and running ones finish before the profile goes away
+  JobScheduler::instance()->shutdown();
+  // The cache is kept for the next launch unless clearing on exit is enabled
+  BrowserProfile::instance()->shutdown();
+  // Writes out pages still waiting to be indexed
+  PageSearchService::instance()->shutdown();
+  LogSink::shutdown();
 
   return result;
 }
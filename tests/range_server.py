@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+"""Local HTTP stand-in for testing the segmented download manager.
+
+Serves deterministic binary files with byte-range support, an ETag and
+a Repr-Digest (SHA-256) header, plus an index page that links to them.
+Flags turn off ranges, throttle each connection, cut responses short, or
+advertise a wrong digest, so every path in SegmentedDownload can be
+exercised without the network:
+
+    python3 tests/range_server.py --size-mb 64 --rate-kb 2048
+    # open http://127.0.0.1:8765/ in MyBrowser and click a link
+"""
+
+import argparse
+import base64
+import hashlib
+import random
+import re
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+CHUNK = 64 * 1024
+
+
+class Payload:
+    def __init__(self, size, bad_digest):
+        self.data = random.Random(1234).randbytes(size)
+        digest = hashlib.sha256(self.data).digest()
+        self.sha256_hex = digest.hex()
+        if bad_digest:
+            digest = bytes(32)
+        self.repr_digest = "sha-256=:%s:" % base64.b64encode(digest).decode()
+        self.etag = '"%s"' % self.sha256_hex[:16]
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    options = None
+    payloads = {}
+    drops_left = 0
+    lock = threading.Lock()
+
+    def do_GET(self):
+        self.respond(send_body=True)
+
+    def do_HEAD(self):
+        self.respond(send_body=False)
+
+    def respond(self, send_body):
+        if self.path in ("/", "/index.html"):
+            self.send_index(send_body)
+            return
+        payload = self.payloads.get(self.path)
+        if payload is None:
+            self.send_error(404)
+            return
+
+        data = payload.data
+        start, end = 0, len(data) - 1
+        status = 200
+        range_header = self.headers.get("Range")
+        if_range = self.headers.get("If-Range")
+        if range_header and not self.options.no_ranges and (not if_range or if_range == payload.etag):
+            match = re.fullmatch(r"bytes=(\d+)-(\d*)", range_header.strip())
+            if not match or int(match.group(1)) >= len(data):
+                self.send_response(416)
+                self.send_header("Content-Range", "bytes */%d" % len(data))
+                self.send_header("Content-Length", "0")
+                self.end_headers()
+                return
+            start = int(match.group(1))
+            end = min(int(match.group(2)), end) if match.group(2) else end
+            status = 206
+
+        self.send_response(status)
+        self.send_header("Content-Type", "application/octet-stream")
+        self.send_header("Content-Length", str(end - start + 1))
+        self.send_header("ETag", payload.etag)
+        self.send_header("Repr-Digest", payload.repr_digest)
+        if not self.options.no_ranges:
+            self.send_header("Accept-Ranges", "bytes")
+        if status == 206:
+            self.send_header("Content-Range", "bytes %d-%d/%d" % (start, end, len(data)))
+        self.end_headers()
+        if send_body:
+            self.send_body(data, start, end)
+
+    def send_body(self, data, start, end):
+        # Cut the first --drop-first responses off halfway to test resume
+        stop_at = end + 1
+        with Handler.lock:
+            if Handler.drops_left > 0:
+                Handler.drops_left -= 1
+                stop_at = start + (end + 1 - start) // 2
+
+        rate = self.options.rate_kb * 1024
+        position = start
+        began = time.monotonic()
+        try:
+            while position < stop_at:
+                chunk = data[position:min(position + CHUNK, stop_at)]
+                self.wfile.write(chunk)
+                position += len(chunk)
+                if rate:
+                    ahead = (position - start) / rate - (time.monotonic() - began)
+                    if ahead > 0:
+                        time.sleep(ahead)
+        except (BrokenPipeError, ConnectionResetError):
+            return
+        if stop_at <= end:
+            self.close_connection = True
+
+    def send_index(self, send_body):
+        links = "".join(
+            '<li><a href="%s" download>%s</a> (%d bytes, sha256 %s)</li>'
+            % (path, path[1:], len(p.data), p.sha256_hex)
+            for path, p in sorted(self.payloads.items()))
+        body = ("<!doctype html><title>Range server</title><h1>Downloads</h1><ul>%s</ul>" % links).encode()
+        self.send_response(200)
+        self.send_header("Content-Type", "text/html; charset=utf-8")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        if send_body:
+            self.wfile.write(body)
+
+    def log_message(self, fmt, *args):
+        print("%s %s Range=%s" % (self.command, self.path, self.headers.get("Range", "-")), flush=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", type=int, default=8765)
+    parser.add_argument("--size-mb", type=float, default=32, help="size of /large.bin")
+    parser.add_argument("--no-ranges", action="store_true", help="ignore Range and omit Accept-Ranges")
+    parser.add_argument("--rate-kb", type=int, default=0, help="per-connection limit in KiB/s (0 = unlimited)")
+    parser.add_argument("--drop-first", type=int, default=0, help="cut off the first N responses halfway")
+    parser.add_argument("--bad-digest", action="store_true", help="advertise a wrong SHA-256")
+    options = parser.parse_args()
+
+    Handler.options = options
+    Handler.drops_left = options.drop_first
+    Handler.payloads = {
+        "/large.bin": Payload(int(options.size_mb * 1024 * 1024), options.bad_digest),
+        "/small.bin": Payload(256 * 1024, options.bad_digest),
+    }
+
+    server = ThreadingHTTPServer(("127.0.0.1", options.port), Handler)
+    print("Serving on http://127.0.0.1:%d/" % options.port, flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()